@@ -42,6 +42,14 @@ namespace Trick {
                 name_to_attr_map[type] = attr ;
             }
 
+            /**
+             * Adds a type, the corresponding attributes, and the order of the attributes by name.
+             * @param type    The name of the type.
+             * @param attr    Pointer to the attributes.
+             * @param name_order    Indexes of the attributes sorted by name, as printed by ICG.
+             */
+            void add_attr( std::string type , ATTRIBUTES * attr , const unsigned int * name_order ) ;
+
             /**
              * Gets the attributes of a type.
              * @param type    The name of the type.
@@ -54,6 +62,15 @@ namespace Trick {
                 return NULL ;
             }
 
+            /**
+             * Finds a member of a class/struct by name.  Attributes added with their name order are
+             * binary searched, others are searched from the start.
+             * @param attr    The attributes of the class/struct.
+             * @param name    The name of the member.
+             * @return    The attributes of the member, NULL if there is no such member.
+             */
+            ATTRIBUTES * find_member( ATTRIBUTES * attr , const char * name ) ;
+
             // routines to sanitize the xml output
             std::string & replace_special_chars( std::string & str) ;
             std::string & type_remove_dims( std::string & type ) ;
@@ -66,7 +83,13 @@ namespace Trick {
             void print_json(std::ofstream & sie_out ) ;
 
         private:
+            struct NameOrder {
+                const unsigned int * order ;
+                unsigned int count ;
+            } ;
+
             std::map<std::string, ATTRIBUTES *> name_to_attr_map ;
+            std::map<ATTRIBUTES *, NameOrder> attr_to_name_order_map ;
             static AttributesMap * pInstance ;
 
     } ;
@@ -0,0 +1,289 @@
+#ifndef BINARYCHECKPOINTAGENT_HH
+#define BINARYCHECKPOINTAGENT_HH
+/*
+    PURPOSE: ( BinaryCheckPointAgent - writes checkpoints as raw memory blocks with
+               a pointer fix-up table and restores them from a memory mapped file.)
+*/
+
+#include <stdint.h>
+#include <pthread.h>
+#include <string>
+#include <vector>
+#include <map>
+#include "trick/ClassicCheckPointAgent.hh"
+
+namespace Trick {
+
+    /**
+     One piece of the flattened layout of a type.  RAW pieces are copied as bytes, the rest
+     are pointers, strings and STLs that cannot be copied between processes.
+     */
+    struct BinaryCheckPointSegment {
+        enum Kind { RAW, POINTER, STRING, STL, ARRAY } ;
+        Kind kind ;
+        /** Offset from the start of the object, or the address of a static member. */
+        long offset ;
+        bool is_static ;
+        /** POINTER: a character pointer that may point to a string outside of managed memory. */
+        bool is_char_ptr ;
+        /** RAW: number of bytes.  ARRAY: size of one element. */
+        size_t size ;
+        /** POINTER, STRING, STL, ARRAY: number of elements. */
+        int count ;
+        ATTRIBUTES * attr ;
+        /** ARRAY: layout of one element. */
+        struct BinaryCheckPointLayout * sub_layout ;
+    } ;
+
+    /**
+     The checkpointed parts of a type in member order.
+     */
+    struct BinaryCheckPointLayout {
+        std::vector< BinaryCheckPointSegment > segments ;
+        /** Number of RAW bytes written for one object. */
+        uint64_t raw_size ;
+        /** Hash of the segments, used to refuse data from a differently built sim. */
+        uint64_t hash ;
+        /** Allocation layouts: the attributes describing the whole allocation. */
+        ATTRIBUTES alloc_attr ;
+    } ;
+
+    /**
+     An entry of the allocation table.
+     */
+    struct BinaryCheckPointAlloc {
+        std::string name ;
+        std::string user_type_name ;
+        int32_t type ;
+        int32_t flags ;
+        int32_t size ;
+        int32_t num ;
+        int32_t num_index ;
+        int32_t index[TRICK_MAX_INDEX] ;
+        uint64_t layout_hash ;
+        /** Offset of the raw data block from the start of the data section. */
+        uint64_t data_offset ;
+        uint64_t data_size ;
+        /** Restore: the raw data block, which may be in the base checkpoint of a delta. */
+        const char * data ;
+        /** Hash of the name, used in the content hashes of pointers to the allocation. */
+        uint64_t name_hash ;
+        /** The allocation the entry was restored into, NULL if it was not restored. */
+        ALLOC_INFO * alloc_info ;
+        BinaryCheckPointLayout * layout ;
+    } ;
+
+    /**
+     A pointer to be set after the allocations are restored.  target is the index of the
+     allocation pointed into, or -1 for NULL.
+     */
+    struct BinaryCheckPointPointer {
+        uint32_t alloc ;
+        int32_t target ;
+        uint64_t offset ;
+        uint64_t target_offset ;
+    } ;
+
+    /**
+     A std::string or character pointer value to be assigned after the allocations are restored.
+     */
+    struct BinaryCheckPointString {
+        uint32_t alloc ;
+        uint32_t kind ;
+        uint64_t offset ;
+        const char * value ;
+        uint64_t length ;
+    } ;
+
+    /**
+     A binary checkpoint file read into memory or mapped.
+     */
+    struct BinaryCheckPointFile {
+        std::string name ;
+        /** Id of this checkpoint, and the id of the base it was written against, 0 for a full checkpoint. */
+        uint64_t id ;
+        uint64_t base_id ;
+        /** Name of the checkpoint this file is a delta of, empty for a full checkpoint. */
+        std::string base_name ;
+        /** Contents of a checkpoint read from a stream. */
+        std::string buffer ;
+        void * map ;
+        uint64_t map_size ;
+        std::vector< BinaryCheckPointAlloc > allocs ;
+        std::vector< BinaryCheckPointPointer > pointers ;
+        /** Start and number of the string records. */
+        const char * strings ;
+        const char * end ;
+        uint64_t num_strings ;
+    } ;
+
+    /**
+     A piece of restore work: a raw block, part of a large raw block, or a range of pointers.
+     */
+    struct BinaryCheckPointJob {
+        enum Kind { BLOCK, CHUNK, POINTERS } ;
+        Kind kind ;
+        uint32_t alloc ;
+        uint64_t begin ;
+        uint64_t end ;
+    } ;
+
+    /**
+     This class writes a checkpoint as a header, a table of allocation declarations, one raw
+     block per allocation holding the bytes of its checkpointed members, a pointer fix-up table,
+     and a table of std::string and character pointer values.
+
+     Restore maps the file, declares the allocations, then copies the blocks and sets the
+     pointers with several threads.  STL members are checkpointed and restored through the same
+     allocations as the classic checkpoint.  Blocks are only restored into allocations whose
+     layout hash matches, so a checkpoint cannot be restored into a sim built with different
+     types.  The file is in the byte order of the machine that wrote it.
+
+     When #max_deltas is set, checkpoints written to a file record a hash of the contents of each
+     allocation.  The following checkpoints are deltas that name the last full checkpoint as their
+     base and hold only the allocations whose contents changed since it was written.  A delta
+     restores the unchanged allocations from its base.  Each checkpoint has a unique id and a delta
+     records the id of its base, so a delta whose base was overwritten is refused.  compact() folds a
+     delta and its base into a full checkpoint.
+
+     Single variable output (write_var) and stream restores of text still use the classic
+     format.
+     */
+    class BinaryCheckPointAgent : public ClassicCheckPointAgent {
+
+        public:
+
+        /** Number of threads used to restore a checkpoint.  0 = the number of online CPUs, at most 8. */
+        int num_threads ;
+
+        /** Number of delta checkpoints written against a full checkpoint before the next full one.
+            0 = incremental checkpoints are off. */
+        int max_deltas ;
+
+        /**
+         Constructor.
+         @param  MM MemoryManager.
+         */
+        BinaryCheckPointAgent( Trick::MemoryManager *MM) ;
+
+        ~BinaryCheckPointAgent() ;
+
+        /**
+         Write the given allocations to the stream.
+         @param chkpnt_os - the output stream.
+         @param dependencies - the allocations to checkpoint, named.
+         */
+        void write_checkpoint( std::ostream& chkpnt_os, std::vector<ALLOC_INFO*>& dependencies) ;
+
+        /**
+         Restore a binary checkpoint from a stream, or a classic checkpoint if the stream does not
+         start with the binary header.
+         @param checkpoint_stream Input stream from which the checkpoint is read.
+         @return 0/1 success flag
+         */
+        int restore( std::istream* checkpoint_stream) ;
+
+        /**
+         Map the named binary checkpoint file and restore it.  A delta is restored together with the
+         checkpoints it is based on.
+         @return 0/1 success flag
+         */
+        int restore_file( const char* filename) ;
+
+        /**
+         Called before a checkpoint is written to a file.  Decides whether the next write_checkpoint
+         writes a delta.  A checkpoint written over its base is a full checkpoint.
+         @param filename - the file about to be written.
+         @param allow_delta - false if the checkpoint is not of all allocations or is not binary.
+         */
+        void begin_file( const char* filename, bool allow_delta) ;
+
+        /**
+         Called after a checkpoint is written to a file.  A full checkpoint becomes the base of the
+         following deltas.
+         @param ok - false if the file could not be written.
+         */
+        void end_file( bool ok) ;
+
+        /**
+         Write a full checkpoint holding the contents of a delta checkpoint and its bases.
+         @param delta_file - the checkpoint to compact.
+         @param out_file - the full checkpoint to write.
+         @return 0/1 success flag
+         */
+        int compact( const char* delta_file, const char* out_file) ;
+
+        /**
+         @return true if the file starts with the binary checkpoint header.
+         */
+        static bool is_binary_checkpoint( const char* filename) ;
+
+        private:
+
+        /** Layouts of structured types, mapped by their attributes. */
+        std::map< ATTRIBUTES *, BinaryCheckPointLayout * > type_layouts ;
+
+        /** Allocation table of the checkpoint being written or restored. */
+        std::vector< BinaryCheckPointAlloc > allocs ;
+
+        /** Index of each allocation in the table being written. */
+        std::map< ALLOC_INFO *, uint32_t > alloc_index_of ;
+
+        /** Pointers of the checkpoint being written or restored. */
+        std::vector< BinaryCheckPointPointer > pointers ;
+
+        /** Strings of the checkpoint being restored. */
+        std::vector< BinaryCheckPointString > string_values ;
+
+        /** Last full checkpoint written, its id, and the content hash of each of its allocations. */
+        std::string base_file ;
+        uint64_t base_id ;
+        std::map< std::string, uint64_t > base_hashes ;
+        /** Number of deltas written against base_file. */
+        int num_deltas ;
+
+        /** The file being written, the id written in its header, whether its content hashes are kept,
+            and whether it is a delta. */
+        std::string output_file ;
+        uint64_t written_id ;
+        bool track_hashes ;
+        bool write_delta ;
+        bool wrote_file ;
+        std::map< std::string, uint64_t > new_hashes ;
+
+        /** Restore jobs and the index of the next job to run. */
+        std::vector< BinaryCheckPointJob > jobs ;
+        size_t next_job ;
+        pthread_mutex_t job_mutex ;
+
+        /** Number of pointers restored as NULL because their target was not restored. */
+        unsigned int bad_pointer_count ;
+
+        BinaryCheckPointLayout * get_type_layout( ATTRIBUTES * attr_list) ;
+        BinaryCheckPointLayout * make_alloc_layout( ALLOC_INFO * alloc_info) ;
+        void add_member( BinaryCheckPointLayout * layout, ATTRIBUTES * attr, long offset, bool is_static) ;
+        void finish_layout( BinaryCheckPointLayout * layout) ;
+        void clear_tables() ;
+
+        int32_t pointer_target( void * pointer, uint64_t & target_offset) ;
+        void collect_pointers( BinaryCheckPointLayout * layout, char * address, uint32_t alloc_index,
+                               std::string & strings, uint64_t & num_strings) ;
+        uint64_t hash_raw( BinaryCheckPointLayout * layout, char * address, uint64_t hash) ;
+        void write_raw( BinaryCheckPointLayout * layout, char * address, std::ostream& chkpnt_os, std::string & buffer) ;
+        void write_tables( std::ostream& chkpnt_os, const std::string & base_name, uint64_t in_base_id,
+                           uint64_t data_size, uint64_t num_strings) ;
+        const char * read_raw( BinaryCheckPointLayout * layout, char * address, const char * data) ;
+
+        int open_file( BinaryCheckPointFile & file, const char * filename) ;
+        int parse_file( BinaryCheckPointFile & file, const char * buffer, uint64_t length) ;
+        void close_file( BinaryCheckPointFile & file) ;
+        int load_chain( BinaryCheckPointFile * file, std::vector< BinaryCheckPointFile * > & chain) ;
+        int merge_chain( std::vector< BinaryCheckPointFile * > & chain) ;
+        int restore_chain( BinaryCheckPointFile * file) ;
+        int apply_restore() ;
+        int resolve_alloc( BinaryCheckPointAlloc & entry) ;
+        void run_job( BinaryCheckPointJob & job) ;
+        static void * restore_thread( void * agent) ;
+    } ;
+}
+#endif
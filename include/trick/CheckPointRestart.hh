@@ -9,11 +9,16 @@
 #include <string>
 #include <vector>
 #include <queue>
+#include <list>
+#include <pthread.h>
 
 #include "trick/Scheduler.hh"
 
 namespace Trick {
 
+    /** A checkpoint being written by a forked process or a writer thread. */
+    struct CheckPointWriter ;
+
     /**
      *
      * This class wraps the MemoryManager class for use in Trick simulations
@@ -44,6 +49,18 @@ namespace Trick {
             /** The specified sim objs for checkpoint, if it's null, checkpoint everything */
             Trick::JobData * safestore_checkpoint_job ;              /* ** */
 
+            /** Checkpoints being written in the background, oldest first. */
+            std::list<Trick::CheckPointWriter *> writers ;           /* ** */
+
+            /** Protects the completion flags of the writer threads. */
+            pthread_mutex_t writers_mutex ;                          /* ** */
+
+            /** Report a finished background writer and forget it. */
+            void finish_writer( Trick::CheckPointWriter * writer ) ;
+
+            /** Block until the oldest background writer finishes. */
+            void wait_for_oldest_writer() ;
+
             /**
              * Internal call the MemoryManager checkpoint method with the string argument file_name
              * @param file_name - file name to write checkpoint
@@ -96,6 +113,21 @@ namespace Trick {
             /** CPU to use for checkpoints\n */
             int cpu_num ;                                  /**< trick_units(--) */
 
+            /** Maximum number of checkpoints written in the background at once\n */
+            int max_writers ;                              /**< trick_units(--) */
+
+            /** If true background checkpoints are staged in memory and written by a thread instead of a forked process\n */
+            bool snapshot_enabled ;                        /**< trick_units(--) */
+
+            /** Wall clock time the simulation was stalled by the last checkpoint\n */
+            double last_stall_time ;                       /**< trick_units(s) */
+
+            /** Wall clock time from the start to the end of the last finished checkpoint write\n */
+            double last_write_time ;                       /**< trick_units(s) */
+
+            /** Status of the last finished checkpoint write, 0 = success\n */
+            int last_write_status ;                        /**< trick_units(--) */
+
             /**
              * This is the constructor of the CheckPointRestart class.  It initializes
              * the checkpoint, pre_load_checkpoint, and the restart_queues
@@ -184,6 +216,53 @@ namespace Trick {
              */
             int set_cpu_num(int in_cpu_num) ;
 
+            /**
+             @brief @userdesc Command to set the number of checkpoints that may be written in the background at once.
+             A checkpoint started while this many writers are still running waits for the oldest one to finish.
+             The default is 1.
+             @par Python Usage:
+             @code trick.checkpoint_max_writers(<in_max_writers>) @endcode
+             @param in_max_writers - maximum number of background writers, at least 1
+             @return always 0
+             */
+            int set_max_writers(int in_max_writers) ;
+
+            /**
+             @brief @userdesc Command to write background checkpoints without forking.  The checkpoint is written
+             to a memory buffer at the frame boundary and a writer thread saves the buffer to the file.
+             Forking a large simulation can stall it for longer than writing a binary checkpoint to memory.
+             Writes go to the background when this is set or a checkpoint CPU is set.
+             @par Python Usage:
+             @code trick.checkpoint_snapshot(<yes_no>) @endcode
+             @param yes_no - boolean yes (C integer 1) = stage checkpoints in memory, no (C integer 0) = fork (default)
+             @return always 0
+             */
+            int set_snapshot_enabled(bool yes_no) ;
+
+            /**
+             @brief @userdesc Command to get the number of checkpoints still being written in the background.
+             @par Python Usage:
+             @code trick.checkpoint_num_writers() @endcode
+             @return number of background writers that have not been reaped
+             */
+            int get_num_writers() ;
+
+            /**
+             * Reaps background writers that have finished and reports their status.
+             * Run at the end of every frame and in freeze.
+             * @return always 0
+             */
+            int check_writers() ;
+
+            /**
+             @brief @userdesc Command to wait for all background checkpoint writers to finish.
+             Called at shutdown and before a checkpoint is loaded.
+             @par Python Usage:
+             @code trick.checkpoint_wait() @endcode
+             @return number of writers that failed
+             */
+            int wait_for_writers() ;
+
             /**
              * Get the write_checkpoint_job and safestore_checkpoint jobs.
              * @return always 0
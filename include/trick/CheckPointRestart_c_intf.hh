@@ -34,6 +34,18 @@ int checkpoint_safestore(int yes_no) ;
 /* set the cpu to use for checkpoints */
 int checkpoint_cpu( int in_cpu_num ) ;
 
+/* set the number of checkpoints written in the background at once */
+int checkpoint_max_writers( int in_max_writers ) ;
+
+/* stage background checkpoints in memory and write them from a thread */
+int checkpoint_snapshot( int yes_no ) ;
+
+/* get the number of checkpoints being written in the background */
+int checkpoint_num_writers() ;
+
+/* wait for background checkpoints to be written */
+int checkpoint_wait() ;
+
 /* safestore checkpoint call accessible from C code */
 int checkpoint_safestore_period( double in_period ) ;
 
@@ -92,10 +92,12 @@ namespace Trick {
          */
         std::string ref_string_from_ptr( void* pointer, ATTRIBUTES* attr, int curr_dim);
 
-    private:
+    protected:
 
         Trick::MemoryManager *mem_mgr;                 /**< ** Associated MemoryManager. */
 
+    private:
+
         /** Don't Allow the default constructor to be used. */
         ClassicCheckPointAgent();
 
@@ -85,6 +85,11 @@ namespace Trick {
              */
             virtual int format_specific_write_data(unsigned int writer_offset) ;
 
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_flush
+             */
+            virtual int format_specific_flush() ;
+
             /**
              @copybrief Trick::DataRecordGroup::format_specific_shutdown
              */
@@ -142,6 +147,9 @@ namespace Trick {
             /** Output stream for the log file */
             std::fstream out_stream ; /**< trick_io(**)  */
 
+            /** Worst case size of one formatted row in bytes */
+            unsigned int row_size ; /**< trick_io(**)  */
+
     } ;
 
 } ;
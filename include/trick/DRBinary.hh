@@ -10,6 +10,7 @@ PROGRAMMERS:
 
 #include <stdio.h>
 #include <string>
+#include <vector>
 
 #include "trick/DataRecordGroup.hh"
 
@@ -74,6 +75,22 @@ namespace Trick {
       </center>
 
       See Trick::MemoryManager::TRICK_TYPE for a definition of the Trick data <type> values used in the above table.
+
+      When the group shuts down a time index is written beside the log as log_<group_name>.trk.idx.  The data
+      products use it to start reading at a time without reading the records before it.  A missing or out of date
+      index is rebuilt by the reader.
+
+      <center>
+      <table>
+      <tr><th>Value</th><th>Description</th><th>Type</th><th>Bytes</th></tr>
+      <tr><td>TrickIdx-\<e\></td><td>\<e\> is endianness, L or B, as in the log</td><td>string</td><td>10</td></tr>
+      <tr><td>\<stride\></td><td>Number of records between index entries</td><td>int</td><td>4</td></tr>
+      <tr><td>\<monotonic\></td><td>1 if the recorded times never decrease</td><td>int</td><td>4</td></tr>
+      <tr><td>\<numrecords\></td><td>Number of records indexed</td><td>long long</td><td>8</td></tr>
+      <tr><td>\<time\></td><td>Time of records 0, \<stride\>, 2*\<stride\> ...</td><td>double</td><td>8 each</td></tr>
+      </table>
+      <b>Binary Time Index Format</b>
+      </center>
     */
     class DRBinary : public Trick::DataRecordGroup {
 
@@ -110,6 +127,27 @@ namespace Trick {
              */
             virtual int format_specific_write_data(unsigned int writer_offset) ;
 
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_flush
+             */
+            virtual int format_specific_flush() ;
+
+            /**
+             @brief @userdesc Command to tell the kernel recorded data will not be read back, so long runs do
+             not fill the page cache with the log file (Linux only, default is false).
+             @par Python Usage:
+             @code <dr_group>.set_drop_page_cache(<yes_no>) @endcode
+             @param yes_no - boolean true drops written pages from the page cache
+             @return always 0
+             */
+            int set_drop_page_cache(bool yes_no) ;
+
+            /** Drop written pages from the page cache.\n */
+            bool drop_page_cache ;  /**< trick_io(*io) trick_units(--) */
+
+            /** Bytes of recorded rows that could not be written to the file.  Recording stops at the first failed write.\n */
+            uint64_t bytes_not_written ;  /**< trick_io(*o) trick_units(--) */
+
             /**
              @copybrief Trick::DataRecordGroup::shutdown
              */
@@ -119,6 +157,24 @@ namespace Trick {
             /** The log file.\n */
             int fd ;             /**< trick_io(**) trick_units(--) */
 
+            /** Size of one recorded row in bytes.\n */
+            unsigned int row_size ;  /**< trick_io(**) trick_units(--) */
+
+            /** Number of rows written.\n */
+            long long num_rows ;  /**< trick_io(**) trick_units(--) */
+
+            /** Time of every index_stride'th row, written to the time index at shutdown.\n */
+            std::vector< double > time_index ;  /**< trick_io(**) trick_units(--) */
+
+            /** False once a recorded time is less than the one before it.\n */
+            bool times_monotonic ;  /**< trick_io(**) trick_units(--) */
+
+            /** Time of the last row written.\n */
+            double last_time ;  /**< trick_io(**) trick_units(--) */
+
+            /** Write the time index beside the log file. */
+            void write_time_index() ;
+
     } ;
 
 } ;
@@ -0,0 +1,178 @@
+/*
+PURPOSE:
+    (Data Record Compressed class.)
+*/
+
+#ifndef DRCOMPRESSED_HH
+#define DRCOMPRESSED_HH
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "trick/DataRecordGroup.hh"
+
+#ifdef SWIG
+%feature("compactdefaultargs","0") ;
+%feature("shadow") Trick::DRCompressed::DRCompressed(std::string in_name) %{
+    def __init__(self, *args):
+        this = $action(*args)
+        try: self.this.append(this)
+        except: self.this = this
+        this.own(0)
+        self.this.own(0)
+%}
+#endif
+
+namespace Trick {
+
+    /** Location and time range of one chunk in a DRCompressed log file. */
+    class DRCompressedChunk {
+        public:
+            /** File offset of the chunk header */
+            int64_t offset ;     /**< trick_io(**) trick_units(--) */
+            /** Number of rows in the chunk */
+            int num_rows ;       /**< trick_io(**) trick_units(--) */
+            /** Time of the first row */
+            double start_time ;  /**< trick_io(**) trick_units(s) */
+            /** Time of the last row */
+            double end_time ;    /**< trick_io(**) trick_units(s) */
+    } ;
+
+    /**
+      The DRCompressed recording format stores rows in compressed column chunks.  Files written in this
+      format are named log_<group_name>.trz and are read by the Trick Data Products packages.
+
+      Rows are gathered in memory until #rows_per_chunk rows are held.  The chunk is then compressed one
+      column at a time with the codec in trick/dr_compress.h and written.  Compression runs wherever
+      write_data runs, the writer thread for DR_Buffer groups.  At shutdown the partial last chunk and
+      an index of every chunk's file offset and time range are written.  Readers use the index to seek
+      by time and read only the columns they need.  If the index is missing because the sim did not
+      shut down, readers find the chunks by walking the chunk headers.  Rows not yet in a written chunk
+      are lost in that case.
+
+      All values are in the byte order given by the header.
+
+      <center>
+      <table>
+      <tr><th>Value</th><th>Description</th><th>Type</th><th>Bytes</th></tr>
+      <tr><td colspan=4 align=center>START OF HEADER</td></tr>
+      <tr><td>Trick-Z1-\<e\></td><td>\<e\> is endianness, L for little endian, B for big endian</td><td>string</td><td>10</td></tr>
+      <tr><td>\<numparms\></td><td>Number of parameters recorded</td><td>int</td><td>4</td></tr>
+      <tr><td colspan=4 align=center>name length, name, units length, units, type, and size of each
+       parameter, the same as Trick::DRBinary</td></tr>
+      <tr><td>\<rows_per_chunk\></td><td>Maximum rows in a chunk</td><td>int</td><td>4</td></tr>
+      <tr><td colspan=4 align=center>END OF HEADER, START OF CHUNKS</td></tr>
+      <tr><td>\<rows\></td><td>Rows in the chunk</td><td>int</td><td>4</td></tr>
+      <tr><td>\<start\></td><td>Time of the first row</td><td>double</td><td>8</td></tr>
+      <tr><td>\<end\></td><td>Time of the last row</td><td>double</td><td>8</td></tr>
+      <tr><td>\<bytes\></td><td>Compressed length of each column</td><td>int</td><td>4 * numparms</td></tr>
+      <tr><td>\<data\></td><td>Compressed columns, in parameter order</td><td>bytes</td><td>sum of \<bytes\></td></tr>
+      <tr><td colspan=4 align=center>REPEAT FOR EACH CHUNK, START OF INDEX</td></tr>
+      <tr><td>\<offset\></td><td>File offset of the chunk</td><td>long long</td><td>8</td></tr>
+      <tr><td>\<rows\></td><td>Rows in the chunk</td><td>int</td><td>4</td></tr>
+      <tr><td>\<start\></td><td>Time of the first row</td><td>double</td><td>8</td></tr>
+      <tr><td>\<end\></td><td>Time of the last row</td><td>double</td><td>8</td></tr>
+      <tr><td colspan=4 align=center>REPEAT FOR EACH CHUNK</td></tr>
+      <tr><td>\<numchunks\></td><td>Number of chunks</td><td>int</td><td>4</td></tr>
+      <tr><td>\<index\></td><td>File offset of the index</td><td>long long</td><td>8</td></tr>
+      <tr><td>TrkZIndx</td><td>Index marker</td><td>string</td><td>8</td></tr>
+      </table>
+      <b>Compressed Data Format</b>
+      </center>
+    */
+    class DRCompressed : public Trick::DataRecordGroup {
+
+        public:
+
+            #ifndef SWIG
+            /**
+             @brief DRCompressed default constructor.
+             */
+            DRCompressed() {}
+            #endif
+            ~DRCompressed() ;
+
+            /**
+             @brief @userdesc Create a new compressed data recording group.
+             @par Python Usage:
+             @code <my_drg> = trick.DRCompressed("<in_name>") @endcode
+             @copydoc Trick::DataRecordGroup::DataRecordGroup(string in_name)
+             */
+            DRCompressed( std::string in_name ) ;
+
+            /**
+             @brief @userdesc Command to set the number of rows compressed together (default is 4096).
+             Larger chunks compress better, smaller chunks lose fewer rows if the sim does not shut down.
+             Must be called before the group is initialized.
+             @par Python Usage:
+             @code <dr_group>.set_rows_per_chunk(<num>) @endcode
+             @param num - rows per chunk, at least 1
+             @return 0 on success, -1 if num is 0
+             */
+            int set_rows_per_chunk( unsigned int num ) ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_header
+             */
+            virtual int format_specific_header(std::fstream & outstream) ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_init
+             */
+            virtual int format_specific_init() ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::format_specific_write_data
+             */
+            virtual int format_specific_write_data(unsigned int writer_offset) ;
+
+            /**
+             @copybrief Trick::DataRecordGroup::shutdown
+             */
+            virtual int format_specific_shutdown() ;
+
+            /** Maximum rows in a chunk.\n */
+            unsigned int rows_per_chunk ;  /**< trick_io(*io) trick_units(--) */
+
+            /** Bytes of chunks and index that could not be written to the file.  Recording stops at the first failed write.\n */
+            uint64_t bytes_not_written ;  /**< trick_io(*o) trick_units(--) */
+
+        private:
+            /** Compresses the gathered rows and writes them as one chunk.  Returns bytes written. */
+            int write_chunk() ;
+
+            /** Writes len bytes, retrying partial and interrupted writes.  Returns bytes written. */
+            int write_all( const char * buf , unsigned int len ) ;
+
+            /** The log file.\n */
+            int fd ;             /**< trick_io(**) trick_units(--) */
+
+            /** Current file offset.\n */
+            int64_t file_offset ;  /**< trick_io(**) trick_units(--) */
+
+            /** Size of each column value in bytes.\n */
+            std::vector< unsigned int > column_sizes ;  /**< trick_io(**) trick_units(--) */
+
+            /** Uncompressed columns of the chunk being gathered, column ii starts at rows_per_chunk * column_offsets[ii].\n */
+            char * chunk_buff ;  /**< trick_io(**) trick_units(--) */
+
+            /** Start of each column in chunk_buff divided by rows_per_chunk.\n */
+            std::vector< unsigned int > column_offsets ;  /**< trick_io(**) trick_units(--) */
+
+            /** Rows gathered in chunk_buff.\n */
+            unsigned int chunk_rows ;  /**< trick_io(**) trick_units(--) */
+
+            /** Index of the chunks written so far.\n */
+            std::vector< Trick::DRCompressedChunk > chunks ;  /**< trick_io(**) trick_units(--) */
+
+    } ;
+
+} ;
+
+#ifdef SWIG
+%feature("compactdefaultargs","1") ;
+#endif
+
+#endif
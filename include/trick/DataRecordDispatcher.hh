@@ -9,6 +9,7 @@ PROGRAMMERS:
 #define DATARECORDDISPATCHER_HH
 
 #include <iostream>
+#include <deque>
 #include <pthread.h>
 
 #include "trick/Scheduler.hh"
@@ -28,6 +29,14 @@ namespace Trick {
             pthread_cond_t init_complete_cv;        /**< trick_io(**) */
             /** Data writer initialized mutex. */
             pthread_mutex_t init_complete_mutex;    /**< trick_io(**) */
+            /** Signaled when a writer finishes a group.  Used with dr_go_mutex. */
+            pthread_cond_t write_done_cv;   /**< trick_io(**) */
+            /** Groups waiting for a writer thread.  Protected by dr_go_mutex. */
+            std::deque <Trick::DataRecordGroup *> write_queue ;  /**< trick_io(**) */
+            /** Number of times the writers have been signaled. */
+            uint64_t num_signals ;          /**< trick_io(**) */
+            /** Largest number of groups waiting in write_queue at once. */
+            unsigned int max_queue_depth ;  /**< trick_io(**) */
     } ;
 
     class DRDWriterThread : public Trick::ThreadBase {
@@ -36,6 +45,13 @@ namespace Trick {
 
             virtual void * thread_body() ;
             virtual void dump( std::ostream & oss = std::cout ) ;
+
+            /** Group this writer is writing, NULL when idle.  Protected by dr_go_mutex. */
+            Trick::DataRecordGroup * active_group ;  // trick_io(**)
+
+            /** Number of group writes done by this writer. */
+            uint64_t groups_written ;  // trick_io(**)
+
         protected:
             Trick::DRDMutexes & drd_mutexes ;  // trick_io(**)
             std::vector <Trick::DataRecordGroup *> & groups ;  // trick_io(**)
@@ -58,9 +74,25 @@ namespace Trick {
             /** @brief Removes old data recording files. */
             int remove_files() ;
 
-            /** @brief Creates a new thread for writing simulation data to disk. */
+            /** @brief Creates the threads for writing simulation data to disk. */
             int init() ;
 
+            /**
+             @brief @userdesc Command to set the number of threads writing DR_Buffer groups to disk
+             (default is 1).  Groups are written concurrently, one writer per group at a time.
+             @par Python Usage:
+             @code trick.dr_set_num_writer_threads(<num>) @endcode
+             @param num - number of writer threads, at least 1
+             @return 0 on success, -1 if num is 0 or smaller than the number of running writers
+             */
+            int set_num_writer_threads( unsigned int num ) ;
+
+            /** @brief Gets the number of writer threads. */
+            unsigned int get_num_writer_threads() ;
+
+            /** @brief Gets writer thread ii, 0 is drd_writer_thread.  Returns NULL if it does not exist. */
+            DRDWriterThread * get_writer_thread( unsigned int ii ) ;
+
             /** @brief Init all groups (only needed if restoring checkpoint during initialization). */
             int init_groups() ;
 
@@ -120,6 +152,12 @@ namespace Trick {
 
         protected:
 
+            /** Queues a group for the writers and checks how full its buffer is.  Called with dr_go_mutex held. */
+            void queue_group( Trick::DataRecordGroup * in_group ) ;
+
+            /** Writer threads in addition to drd_writer_thread */
+            std::vector <Trick::DRDWriterThread *> extra_writer_threads ; // trick_io(**)
+
             /** All groups using this buffering technique */
             std::vector <Trick::DataRecordGroup *> groups ; /* trick_io(**) trick_units(--) */
 
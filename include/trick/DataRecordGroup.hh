@@ -11,7 +11,9 @@ PROGRAMMERS:
 #include <vector>
 #include <string>
 #include <fstream>
+#include <iostream>
 #include <pthread.h>
+#include <stdint.h>
 
 #include "trick/SimObject.hh"
 #include "trick/reference.h"
@@ -45,7 +47,6 @@ namespace Trick {
     class DataRecordBuffer {
         public:
             char *buffer;       /* ** generic holding buffer for data */
-            char *curr_buffer;  /* ** current position in the buffer */
             char *last_value;   /* ** holding buffer for last value, used for DR_Changes_step */
             REF2 * ref ;        /* ** size/address/units information of variable */
             bool ref_searched ; /* ** reference information has been searched */
@@ -55,6 +56,17 @@ namespace Trick {
             ~DataRecordBuffer() ;
     } ;
 
+    /**
+     * One step of a DataRecordGroup copy plan.  Copies size bytes from address into buffer,
+     * either the column of a recorded variable or the saved value of a change variable.
+     */
+    class DataRecordCopy {
+        public:
+            char *address ;     /* ** address of the value in the simulation */
+            char *buffer ;      /* ** start of the destination buffer */
+            unsigned int size ; /* ** number of bytes copied */
+    } ;
+
     class DataRecordGroup : public Trick::SimObject {
 
         public:
@@ -109,11 +121,29 @@ namespace Trick {
             /** Maximum records to hold in memory before writing.\n */
             unsigned int max_num;       /**< trick_io(*io) trick_units(--) */
 
-            /** Current buffering record number.\n */
-            unsigned int buffer_num;    /**< trick_io(**) trick_units(--) */
+            /*
+               The buffers are a single producer, single consumer ring of max_num rows.  buffer_num is the
+               number of rows data_record has published and writer_num the number write_data has consumed;
+               row n is held in slot n % max_num of every variable's buffer.  Each is written only by its
+               side and read by the other with acquire/release ordering, and they are kept on separate
+               cache lines.  Each buffer has one more slot, max_num, where a ring buffer's writer copies
+               a row before formatting it, because data_record may reuse the row's slot meanwhile.
+             */
+
+            /** Rows published by data_record, the head of the ring.\n */
+            uint64_t buffer_num;        /**< trick_io(**) trick_units(--) */
+
+            /** Rows data_record has started to fill, buffer_num or one more.\n */
+            uint64_t buffer_claimed;    /**< trick_io(**) trick_units(--) */
 
-            /** Current write to file record number.\n */
-            unsigned int writer_num;    /**< trick_io(**) trick_units(--) */
+            /** Keeps buffer_num and writer_num on separate cache lines.\n */
+            char ring_pad[64] ;         /**< trick_io(**) trick_units(--) */
+
+            /** Rows consumed by write_data, the tail of the ring.\n */
+            uint64_t writer_num;        /**< trick_io(**) trick_units(--) */
+
+            /** Rows overwritten in the ring before they were written.\n */
+            uint64_t rows_dropped ;     /**< trick_io(**) trick_units(--) */
 
             /** Maximum file size for data record file in bytes.\n */
             uint64_t max_file_size;    /**< trick_io(**) trick_units(--) */
@@ -127,6 +157,30 @@ namespace Trick {
             /** Buffer to hold formatted data ready for disk or other destination.\n */
             char * writer_buff ;        /**< trick_io(**) trick_units(--) */
 
+            /** Minimum size of writer_buff in bytes.  Formats that stage many rows flush when it fills.\n */
+            unsigned int writer_buff_size ; /**< trick_io(*io) trick_units(--) */
+
+            /** Bytes of formatted rows waiting in writer_buff.\n */
+            unsigned int writer_buff_len ;  /**< trick_io(**) trick_units(--) */
+
+            /** Number of rows written since init.\n */
+            uint64_t rows_written ;     /**< trick_io(**) trick_units(--) */
+
+            /** Number of writes to the destination since init.\n */
+            uint64_t write_calls ;      /**< trick_io(**) trick_units(--) */
+
+            /** Wall clock time of init, used to report write rates.\n */
+            double write_start_time ;   /**< trick_io(**) trick_units(s) */
+
+            /** True while the group waits in the dispatcher's write queue.\n */
+            bool write_queued ;         /**< trick_io(**) trick_units(--) */
+
+            /** Most records seen waiting to be written at once.\n */
+            unsigned int max_buffered ; /**< trick_io(**) trick_units(--) */
+
+            /** True after the buffer nearly full warning, cleared when the buffer drains to half.\n */
+            bool overflow_warning ;     /**< trick_io(**) trick_units(--) */
+
             /**  Little_endian or big_endian indicator.\n */
             std::string byte_order;          /**< trick_io(*io) trick_units(--) */
 
@@ -226,6 +280,17 @@ namespace Trick {
             */
             virtual int set_max_file_size(uint64_t bytes) ;
 
+            /**
+             @brief @userdesc Command to set the size of the buffer formatted rows are gathered in before
+             they are written to disk (default is 1MB).  DRAscii and DRBinary write once per full buffer
+             instead of once per row.
+             @par Python Usage:
+             @code <dr_group>.set_writer_buff_size(<bytes>) @endcode
+             @param bytes - the buffer size in bytes
+             @return always 0
+            */
+            virtual int set_writer_buff_size(unsigned int bytes) ;
+
 
             /**
              @brief @userdesc Command to print double variable values as single precision (float) in the log file to save space.
@@ -311,6 +376,13 @@ namespace Trick {
             */
             virtual int format_specific_write_data(unsigned int writer_offset) = 0 ;
 
+            /**
+             @brief Write rows staged by format_specific_write_data to the destination.  Called after every
+             batch of rows in write_data.  The default does nothing.
+             @returns always 0
+            */
+            virtual int format_specific_flush() ;
+
             /**
              @brief Shutdown loggroup. implemented in derived groups.
              @returns always 0
@@ -401,6 +473,16 @@ namespace Trick {
             */
             std::string type_string(int item_type, int item_size) ;
 
+            /**
+             @brief Prints rows and writes per second since init.
+            */
+            void dump_write_rates( std::ostream & oss = std::cout ) ;
+
+            /**
+             @brief Number of rows published and not yet consumed.  Safe to call from either side of the ring.
+            */
+            unsigned int buffered_rows() ;
+
         protected:
             /**
              @brief This routine adds the sys.exec.out.time variable to the data record group
@@ -414,9 +496,74 @@ namespace Trick {
             /** Data thread condition mutex.  */
             pthread_mutex_t buffer_mutex;    /**< trick_io(**) */
 
+            /**
+             @brief Claims the next row for data_record to fill.
+             @returns the slot of the row
+            */
+            unsigned int claim_row() ;
+
+            /**
+             @brief Publishes the row data_record just filled, making it visible to write_data.
+            */
+            void publish_row() ;
+
+            /**
+             @brief Copies a claimed row of a ring buffer to the writer's slot, max_num, and checks
+             data_record did not start to reuse its slot during the copy.
+             @param row - the number of the row
+             @returns true if the copy is good, false if the row was overwritten
+            */
+            bool copy_ring_row( uint64_t row ) ;
+
+            /**
+             @brief Claims the published rows for writing.  Rows the ring overwrote are skipped and counted
+             in rows_dropped.  The caller must hold buffer_mutex and call release_rows when done.
+             @param first - set to the number of the first row claimed
+             @returns the number of rows claimed, at most max_num
+            */
+            unsigned int consume_rows( uint64_t & first ) ;
+
+            /**
+             @brief Returns the slots of the rows claimed by consume_rows to data_record.
+             @param end - one past the number of the last row written
+            */
+            void release_rows( uint64_t end ) ;
+
             /** Current time saved in Trick::DataRecordGroup::data_record.\n */
             double curr_time ;          /**< trick_io(*i) trick_units(--) */
 
+            /**
+             @brief Builds the copy plans data_record uses from rec_buffer and change_buffer.
+             Variables with fixed addresses are sorted into lists by size so each list is copied
+             with a single tight loop.  Only variables reached through pointers are resolved
+             every cycle.
+            */
+            void build_copy_plan() ;
+
+            /** Copy plan is out of date with rec_buffer or change_buffer.\n */
+            bool copy_plan_stale ;      /**< trick_io(**) */
+
+            /** Fixed address recorded variables of 8, 4, 2, and 1 bytes.\n */
+            std::vector <Trick::DataRecordCopy> copy_plan_8 ;       /**< trick_io(**) */
+            std::vector <Trick::DataRecordCopy> copy_plan_4 ;       /**< trick_io(**) */
+            std::vector <Trick::DataRecordCopy> copy_plan_2 ;       /**< trick_io(**) */
+            std::vector <Trick::DataRecordCopy> copy_plan_1 ;       /**< trick_io(**) */
+
+            /** Fixed address recorded variables of any other size.\n */
+            std::vector <Trick::DataRecordCopy> copy_plan_other ;   /**< trick_io(**) */
+
+            /** Recorded variables whose address is followed through pointers every cycle.\n */
+            std::vector <Trick::DataRecordBuffer *> copy_plan_pointers ;  /**< trick_io(**) */
+
+            /** Fixed address change variables split into 8, 4, 2, and 1 byte words.\n */
+            std::vector <Trick::DataRecordCopy> change_plan_8 ;     /**< trick_io(**) */
+            std::vector <Trick::DataRecordCopy> change_plan_4 ;     /**< trick_io(**) */
+            std::vector <Trick::DataRecordCopy> change_plan_2 ;     /**< trick_io(**) */
+            std::vector <Trick::DataRecordCopy> change_plan_1 ;     /**< trick_io(**) */
+
+            /** Change variables whose address is followed through pointers every cycle.\n */
+            std::vector <Trick::DataRecordBuffer *> change_plan_pointers ;  /**< trick_io(**) */
+
     } ;
 
 } ;
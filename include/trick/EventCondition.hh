@@ -0,0 +1,80 @@
+#ifndef EVENTCONDITION_HH
+#define EVENTCONDITION_HH
+/*
+    PURPOSE: ( EventCondition Class evaluates simple event condition strings without python.)
+*/
+#include <string>
+#include <vector>
+#include "trick/reference.h"
+
+namespace Trick {
+
+/**
+  An event condition string compiled to a native predicate.
+
+  Conditions are Python expressions.  Those limited to numbers, True, False, model variables, parentheses,
+  the arithmetic operators + - * /, the comparisons < <= > >= == !=, and the boolean operators and, or, not
+  are compiled once into a program over the variables' resolved references.  Evaluating the program needs
+  neither the Python interpreter nor its lock.  Any other condition is left to Python.  As in Python, "and"
+  and "or" only evaluate their right operand when the left one does not decide the result.
+
+  A condition is also left to Python where the two might disagree: a chained comparison, an integer divided
+  by an integer, or an operator between variables with different units.
+ */
+    class EventCondition {
+
+        public:
+
+            /**
+             @brief Compile a condition string.
+             @param str - the condition's Python expression
+             @return the compiled condition, or NULL if the string is not in the supported subset
+            */
+            static EventCondition * compile( const std::string & str ) ;
+
+            ~EventCondition() ;
+
+            /**
+             @brief Evaluate the condition.
+             @return true if the condition is true; false if it is false or a variable cannot be read
+            */
+            bool evaluate() ;
+
+        private:
+
+            enum OpCode {
+                PUSH_CONSTANT , PUSH_VARIABLE ,
+                NEGATE , NOT ,
+                ADD , SUBTRACT , MULTIPLY , DIVIDE ,
+                LESS , LESS_EQUAL , GREATER , GREATER_EQUAL , EQUAL , NOT_EQUAL ,
+                JUMP_IF_FALSE_OR_POP , JUMP_IF_TRUE_OR_POP
+            } ;
+
+            struct Instruction {
+                OpCode op ;
+                double constant ;
+                unsigned int variable ;
+                /* Instruction a jump goes to */
+                unsigned int target ;
+            } ;
+
+            friend class EventConditionParser ;
+
+            EventCondition() {}
+            EventCondition( const EventCondition & ) ;
+            EventCondition & operator = ( const EventCondition & ) ;
+
+            /** The program in postfix order. */
+            std::vector< Instruction > program ;
+
+            /** The model variables read by the program. */
+            std::vector< REF2 * > variables ;
+
+            /** Operand stack reused by each evaluation. */
+            std::vector< double > stack ;
+
+    } ;
+
+}
+
+#endif
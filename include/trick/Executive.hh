@@ -10,6 +10,7 @@
 #include <fstream>
 #include <string>
 #include <map>
+#include <set>
 #include <vector>
 #include <queue>
 #include <pthread.h>
@@ -210,6 +211,12 @@ namespace Trick {
             /** Queue to hold unfreeze jobs.\n */
             Trick::ScheduledJobQueue time_tic_changed_queue ; /**< trick_io(**) */
 
+            /** Jobs are added to the queues in batches that are sorted once when committed.\n */
+            bool batch_job_queues ;                           /**< trick_io(**) */
+
+            /** Queues holding a batch of jobs waiting to be committed.\n */
+            std::set <Trick::ScheduledJobQueue *> batch_queues ;   /**< trick_io(**) */
+
             /** Enough threads to accomodate the number of children specified in the S_define file.\n */
             std::vector <Trick::Threads *> threads ;               /**< trick_io(**) */
 
@@ -288,6 +295,11 @@ namespace Trick {
             */
             bool isThreadReadyToRun( Trick::Threads * curr_thread , long long time_tics) ;
 
+            /**
+             Internal call to add a job to a queue, or to the queue's batch while batch_job_queues is set
+            */
+            void queue_job( Trick::ScheduledJobQueue & queue , Trick::JobData * job ) ;
+
         public:
 
             Executive() ;
@@ -1019,6 +1031,13 @@ namespace Trick {
              */
             virtual int add_job_to_queue( Trick::JobData * job_data ) ;
 
+            /**
+             * @brief Adds the batches of jobs collected by add_jobs_to_queue to their queues.  Each queue
+             * sorts its batch once instead of searching the queue for every job.
+             * @return always 0
+             */
+            virtual int commit_job_queues() ;
+
             /**
              * @brief Removes the sim_object and all of its jobs from the simulation.
              * @param in_object - Trick::SimObject pointer to the sim_object.
@@ -1175,6 +1194,29 @@ namespace Trick {
             */
             virtual int set_thread_cpu_affinity(unsigned int thread_id , int cpu_num) ;
 
+            /**
+             @userdesc Command to give a thread helper threads that run its independent scheduled jobs in parallel.
+             Jobs of the same job class and phase that belong to different sim objects are spread across the
+             helpers.  Must be called before the simulation threads are created.
+             @par Python Usage:
+             @code trick.exec_set_thread_job_workers(<thread_id>, <num_workers>) @endcode
+             @param thread_id - thread id as specified in S_define file
+             @param num_workers - number of helper threads, 0 disables parallel job execution
+             @return 0 if successful, -1 if the helpers are already running, -2 if thread does not exist.
+            */
+            virtual int set_thread_job_workers(unsigned int thread_id , unsigned int num_workers) ;
+
+            /**
+             @userdesc Command to set the processor for a job worker helper thread to run on.
+             @par Python Usage:
+             @code trick.exec_set_thread_job_worker_cpu_affinity(<thread_id>, <worker>, <cpu_num>) @endcode
+             @param thread_id - thread id as specified in S_define file
+             @param worker - helper thread index, 0 through num_workers - 1
+             @param cpu_num - the processor number to run the helper on
+             @return 0 if successful, -1 if the helper does not exist, -2 if thread does not exist.
+            */
+            virtual int set_thread_job_worker_cpu_affinity(unsigned int thread_id , unsigned int worker , int cpu_num) ;
+
             /**
              @userdesc Command to run the simulation (after a freeze). Set exec_command to RunCmd.
              @par Python Usage:
@@ -17,11 +17,13 @@ namespace Trick {
 
     class IPPython ;
     class MTV ;
+    class EventCondition ;
 
     /** Data associated with each event condition.\n */
     struct condition_t {
 
         condition_t() ;
+        ~condition_t() ;
         /** True means condition is to be evaluated during event processing.\n */
         char enabled ;                          /**< trick_io(*io) trick_units(--) */
         /** True means that when fired, condition stays fired.\n */
@@ -42,6 +44,10 @@ namespace Trick {
         Trick::JobData * job ;                  /**< trick_io(**) trick_units(--) */
         /** Type of condition string: 0=python, 1=variable, 2=job.\n */
         int  cond_type ;                        /**< trick_io(*io) trick_units(--) */
+        /** A python condition string compiled to native code, NULL if python must evaluate it.\n */
+        Trick::EventCondition * compiled ;      /**< trick_io(**) trick_units(--) */
+        /** True once compiling the python condition string has been tried.\n */
+        bool compile_tried ;                    /**< trick_io(**) trick_units(--) */
     } ;
 
     /** Data associated with each event action.\n */
@@ -90,6 +96,9 @@ namespace Trick {
             /** Toggle to turn on/off event info messages (e.g., when an event fires).\n */
             static bool info_msg ;            /**< trick_io(**) trick_units(--) */
 
+            /** Toggle to turn on/off native evaluation of simple condition strings.\n */
+            static bool native_conditions ;   /**< trick_io(**) trick_units(--) */
+
             /** True when ALL conditions must be true to make action(s) run; default is false.\n */
             bool cond_all ;                         /**< trick_io(*io) trick_units(--) */
             /** @userdesc True when event conditions setup was evaluated as true.\n */
@@ -184,6 +193,23 @@ namespace Trick {
             */
             static void set_event_info_msg_off() ;
 
+            /**
+             @brief @userdesc Command to evaluate simple condition strings natively (on is the default).
+             A condition string using only numbers, True, False, model variables, parentheses, + - * /,
+             comparisons, and/or/not is compiled the first time it is evaluated and thereafter evaluated
+             without the Python interpreter.  Other condition strings are always evaluated by Python.
+             @par Python Usage:
+             @code trick.set_event_native_conditions_on() @endcode
+            */
+            static void set_event_native_conditions_on() ;
+
+            /**
+             @brief @userdesc Command to evaluate all condition strings with Python.
+             @par Python Usage:
+             @code trick.set_event_native_conditions_off() @endcode
+            */
+            static void set_event_native_conditions_off() ;
+
             /**
              @brief called by the event manager when the event is loaded from a checkpoint
             */
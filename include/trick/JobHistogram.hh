@@ -0,0 +1,101 @@
+/*
+PURPOSE:
+    ( Latency histogram of one job for the job profiler )
+*/
+
+#ifndef JOBHISTOGRAM_HH
+#define JOBHISTOGRAM_HH
+
+namespace Trick {
+
+    /**
+     * A log-linear latency histogram in the style of HdrHistogram.  Values below 2 * sub_buckets are
+     * counted exactly.  Above that each power of two is split into sub_buckets equal buckets, so a value
+     * is known to within 1 / sub_buckets of itself.  Values of 2^max_exponent and more are counted in
+     * the last bucket.
+     *
+     * Only one thread, the thread running the job, calls record.  It updates the counts with relaxed
+     * atomic stores, which take neither a lock nor a locked instruction, so any other thread may read
+     * the histogram at any time and sees each count whole.
+     */
+    class JobHistogram {
+
+        public:
+
+            static const unsigned int sub_bucket_bits = 5 ;
+            static const unsigned int sub_buckets = 1 << sub_bucket_bits ;
+            static const unsigned int max_exponent = 40 ;
+            static const unsigned int num_buckets = ( max_exponent - sub_bucket_bits + 1 ) * sub_buckets ;
+
+            JobHistogram() ;
+
+            /**
+             @brief Count a value.  Called only by the thread that owns the histogram.
+             @param value - the value, in the profiler's clock tics
+            */
+            void record( unsigned long long value ) {
+                unsigned int index = bucket_index(value) ;
+                increment(counts[index], 1) ;
+                increment(total_count, 1) ;
+                increment(total_sum, value) ;
+                if ( value > __atomic_load_n(&max_value, __ATOMIC_RELAXED) ) {
+                    __atomic_store_n(&max_value, value, __ATOMIC_RELAXED) ;
+                }
+            }
+
+            /** @return the number of values recorded */
+            unsigned long long count() const { return __atomic_load_n(&total_count, __ATOMIC_RELAXED) ; }
+
+            /** @return the sum of the values recorded */
+            unsigned long long sum() const { return __atomic_load_n(&total_sum, __ATOMIC_RELAXED) ; }
+
+            /** @return the largest value recorded */
+            unsigned long long max() const { return __atomic_load_n(&max_value, __ATOMIC_RELAXED) ; }
+
+            /**
+             @brief The value at or below which the given percentage of the recorded values fall.
+             @param percentile - percentage from 0 to 100
+             @return the highest value of the bucket holding the percentile, no more than max(); 0 if nothing was recorded
+            */
+            unsigned long long value_at_percentile( double percentile ) const ;
+
+            /**
+             @brief value_at_percentile for several percentiles in one pass over the buckets.
+             @param percentiles - percentages from 0 to 100 in increasing order
+             @param values - the value at each percentile
+             @param num - number of percentiles
+            */
+            void values_at_percentiles( const double * percentiles , unsigned long long * values , unsigned int num ) const ;
+
+            /** @return the bucket counting value */
+            static unsigned int bucket_index( unsigned long long value ) {
+                if ( value < 2 * sub_buckets ) {
+                    return (unsigned int)value ;
+                }
+                unsigned int exponent = 63 - __builtin_clzll(value) ;
+                if ( exponent >= max_exponent ) {
+                    return num_buckets - 1 ;
+                }
+                return ( exponent - sub_bucket_bits ) * sub_buckets + (unsigned int)( value >> ( exponent - sub_bucket_bits ) ) ;
+            }
+
+            /** @return the highest value counted in the bucket */
+            static unsigned long long bucket_highest_value( unsigned int index ) ;
+
+        private:
+
+            /* Add to a count only this thread writes. */
+            static void increment( unsigned long long & count , unsigned long long value ) {
+                __atomic_store_n(&count, __atomic_load_n(&count, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED) ;
+            }
+
+            unsigned long long counts[num_buckets] ;  /**< trick_io(**) */
+            unsigned long long total_count ;          /**< trick_io(**) */
+            unsigned long long total_sum ;            /**< trick_io(**) */
+            unsigned long long max_value ;            /**< trick_io(**) */
+
+    } ;
+
+}
+
+#endif
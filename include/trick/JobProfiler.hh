@@ -0,0 +1,225 @@
+/*
+PURPOSE:
+    ( Per job latency histograms and hardware counters )
+*/
+
+#ifndef JOBPROFILER_HH
+#define JOBPROFILER_HH
+
+#include <string>
+#include <vector>
+
+#include "trick/InstrumentBase.hh"
+#include "trick/JobData.hh"
+#include "trick/JobHistogram.hh"
+
+namespace Trick {
+
+    /** Hardware counters read around each profiled job. */
+    enum JobProfilerCounter {
+        JobProfilerCycles ,
+        JobProfilerInstructions ,
+        JobProfilerCacheMisses ,
+        JobProfilerNumCounters
+    } ;
+
+    /**
+     * The timing of one profiled job.  Written only by the thread running the job.
+     */
+    class JobRecorder {
+
+        public:
+
+            JobRecorder() ;
+
+            /** Histogram of the job's run times in profiler clock tics */
+            Trick::JobHistogram histogram ;                                   /**< trick_io(**) */
+
+            /** Profiler clock when the job started */
+            unsigned long long start_time ;                                   /**< trick_io(**) */
+
+            /** Hardware counters when the job started */
+            unsigned long long start_counts[Trick::JobProfilerNumCounters] ;  /**< trick_io(**) */
+
+            /** Hardware counts summed over all calls */
+            unsigned long long counter_sums[Trick::JobProfilerNumCounters] ;  /**< trick_io(**) */
+
+    } ;
+
+    /**
+     * Statistics of one profiled job.  The job profiler refreshes them from the job's recorder
+     * every software frame and when it writes its dump file.
+     */
+    class JobProfile {
+
+        public:
+
+            JobProfile() ;
+
+            /** Job name */
+            std::string name ;              /**< trick_io(*o) trick_units(--) */
+
+            /** Thread the job runs on */
+            unsigned int thread ;           /**< trick_io(*o) trick_units(--) */
+
+            /** Number of calls timed */
+            unsigned long long calls ;      /**< trick_io(*o) trick_units(--) */
+
+            /** Mean run time */
+            double mean ;                   /**< trick_io(*o) trick_units(s) */
+
+            /** Median run time */
+            double p50 ;                    /**< trick_io(*o) trick_units(s) */
+
+            /** 99th percentile run time */
+            double p99 ;                    /**< trick_io(*o) trick_units(s) */
+
+            /** 99.9th percentile run time */
+            double p999 ;                   /**< trick_io(*o) trick_units(s) */
+
+            /** Longest run time */
+            double max ;                    /**< trick_io(*o) trick_units(s) */
+
+            /** Mean cpu cycles per call, 0 without hardware counters */
+            double cycles ;                 /**< trick_io(*o) trick_units(--) */
+
+            /** Mean instructions per call, 0 without hardware counters */
+            double instructions ;           /**< trick_io(*o) trick_units(--) */
+
+            /** Mean cache misses per call, 0 without hardware counters */
+            double cache_misses ;           /**< trick_io(*o) trick_units(--) */
+
+            /** The recorder timing the job */
+            Trick::JobRecorder * recorder ; /**< trick_io(**) */
+
+    } ;
+
+    /**
+     * Instrument inserted immediately before or after a profiled job.
+     */
+    class JobProfilerInstrument : public Trick::InstrumentBase {
+
+        public:
+
+            /**
+             @brief constructor
+             @param in_recorder - recorder of the target job
+             @param in_target_job - the profiled job
+             @param in_start - true to start the timing, false to stop it
+            */
+            JobProfilerInstrument( Trick::JobRecorder * in_recorder , Trick::JobData * in_target_job , bool in_start ) ;
+
+            /**
+             @brief Start or stop the timing of the target job.
+             @return always 0
+            */
+            virtual int call() ;
+
+        protected:
+
+            Trick::JobRecorder * recorder ;  /**< trick_io(**) */
+            bool start ;                     /**< trick_io(**) */
+
+    } ;
+
+    /**
+     * This class profiles every job in the sim.  Each job gets a latency histogram and, optionally,
+     * perf_event_open counts of cpu cycles, instructions, and cache misses.  The histograms are
+     * recorded by the job's own thread without locks.  The median, 99th, and 99.9th percentile,
+     * and longest run time of each job are refreshed every software frame into the jobs array,
+     * where the variable server can read them, and are written to job_profile.csv in the output
+     * directory at shutdown.
+     */
+    class JobProfiler {
+
+        public:
+
+            /** True while jobs are profiled */
+            bool enabled ;                      /**< trick_io(*io) trick_units(--) */
+
+            /** Set to read cpu cycles, instructions, and cache misses around each job.  Set before profiling starts */
+            bool hardware_counters ;            /**< trick_io(*io) trick_units(--) */
+
+            /** Number of entries in jobs */
+            unsigned int num_jobs ;             /**< trick_io(*o) trick_chkpnt_io(**) trick_units(--) */
+
+            /** Statistics of each profiled job, in the executive's job order.  Not checkpointed */
+            Trick::JobProfile * jobs ;          /**< trick_io(*o) trick_chkpnt_io(**) trick_units(--) */
+
+            /**
+             @brief This is the constructor of the JobProfiler class.
+            */
+            JobProfiler() ;
+
+            /**
+             @brief @userdesc Command to start profiling every job in the sim.  Profiling starts over
+             with empty histograms each time it is turned on.
+             @par Python Usage:
+             @code trick.job_profiler_on() @endcode
+             @return always 0
+            */
+            int profiler_on() ;
+
+            /**
+             @brief @userdesc Command to stop profiling.  The statistics are kept.
+             @par Python Usage:
+             @code trick.job_profiler_off() @endcode
+             @return always 0
+            */
+            int profiler_off() ;
+
+            /**
+             @brief Statistics of the named job.
+             @param job_name - job name as shown by echo jobs
+             @return the job's statistics, or NULL if it is not profiled
+            */
+            Trick::JobProfile * get_profile( std::string job_name ) ;
+
+            /**
+             @brief end_of_frame job that refreshes the statistics in jobs from the recorders.
+             @return always 0
+            */
+            int update_statistics() ;
+
+            /**
+             @brief preload_checkpoint job that removes the instruments before the jobs they are
+             inserted in are deleted, and frees the recorders and statistics.
+             @return always 0
+            */
+            int preload_checkpoint() ;
+
+            /**
+             @brief restart job that starts profiling over if it was on in the checkpoint.
+             @return always 0
+            */
+            int restart() ;
+
+            /**
+             @brief shutdown job that writes the statistics of every profiled job to job_profile.csv.
+             @return always 0
+            */
+            int shutdown() ;
+
+        private:
+
+            /** Instruments inserted around the jobs */
+            std::vector< Trick::JobProfilerInstrument * > instruments ;  /**< trick_io(**) */
+
+            /** Recorders of the jobs */
+            std::vector< Trick::JobRecorder * > recorders ;  /**< trick_io(**) */
+
+            /** Profiler clock and system clock when profiling started, to find the profiler clock rate */
+            unsigned long long start_tics ;  /**< trick_io(**) */
+            long long start_nanoseconds ;    /**< trick_io(**) */
+
+            void remove_instruments() ;
+            void free_statistics() ;
+
+            // This object is not copyable
+            void operator =(const JobProfiler &) {};
+
+    } ;
+
+}
+
+#endif
@@ -0,0 +1,187 @@
+/*
+    PURPOSE:
+        (Trick job worker pool.  Runs independent scheduled jobs of one thread in parallel.)
+*/
+
+#ifndef JOBWORKERPOOL_HH
+#define JOBWORKERPOOL_HH
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <string>
+#include <pthread.h>
+
+#include "trick/ThreadBase.hh"
+#include "trick/JobData.hh"
+#include "trick/ScheduledJobQueue.hh"
+#include "trick/ExecutiveException.hh"
+
+namespace Trick {
+
+    class JobWorkerPool ;
+
+    /**
+     * A helper thread owned by a JobWorkerPool.  The thread sleeps until the pool posts a
+     * level of jobs, runs chains from its own deque and steals chains from the other workers
+     * when its deque runs dry.
+     */
+    class JobWorker : public Trick::ThreadBase {
+
+        public:
+
+            JobWorker( Trick::JobWorkerPool * in_pool , unsigned int in_worker_id , std::string in_name ) ;
+
+            /**
+             * Inherited from ThreadBase.  Waits for work from the pool.
+             */
+            virtual void * thread_body() ;
+
+        protected:
+
+            /** The pool this worker belongs to */
+            Trick::JobWorkerPool * pool ;   /**< trick_io(**) */
+
+            /** Index of this worker's deque in the pool.  Index 0 is reserved for the owning thread. */
+            unsigned int worker_id ;        /**< trick_io(**) */
+
+    } ;
+
+    /**
+     * The JobWorkerPool runs the scheduled jobs of a single Trick thread on several CPUs.
+     *
+     * The jobs due at a time step are handed out one level at a time.  A level is the run of
+     * non-system jobs sharing the same job class and phase.  Levels run in queue order, and a
+     * level finishes before the next begins.  Inside a level the jobs of one sim object form a
+     * chain that runs in queue order on a single worker; chains of different sim objects run
+     * concurrently.  System jobs run on the owning thread between levels.  A level holding a
+     * job with depends_on_job waits runs on the owning thread in queue order, as it would
+     * without the pool, so a worker never spins on a job queued behind it.
+     *
+     * Results are the same as serial execution as long as the jobs of one sim object do not
+     * write data owned by another sim object in the same class and phase.
+     */
+    class JobWorkerPool {
+
+        friend class JobWorker ;
+
+        public:
+
+            JobWorkerPool() ;
+            ~JobWorkerPool() ;
+
+            /**
+             * Sets the number of helper threads.  0 disables the pool.
+             * Must be called before the workers are created.
+             * @param num_workers - number of helper threads in addition to the owning thread
+             * @return 0 if successful, -1 if the workers are already running.
+             */
+            int set_num_workers( unsigned int num_workers ) ;
+
+            /**
+             * Gets the number of helper threads.
+             */
+            unsigned int get_num_workers() ;
+
+            /**
+             * Adds a CPU to the affinity of a helper thread.
+             * @param worker - helper thread index, 0 through num_workers - 1
+             * @param cpu_num - the processor number
+             * @return 0 if successful, -1 if the worker does not exist.
+             */
+            int set_worker_cpu_affinity( unsigned int worker , int cpu_num ) ;
+
+            /**
+             * Sets the name prefix and nap flag, and starts the helper threads.
+             * Workers that are already running are left alone.
+             * @return always 0
+             */
+            int create_workers( std::string in_name , bool in_rt_nap ) ;
+
+            /**
+             * Cancels the helper threads.
+             */
+            void cancel_workers() ;
+
+            /**
+             * Calls all jobs in the queue that are due at time_tics.
+             * @param job_queue - queue of the owning thread
+             * @param time_tics - current time of the owning thread
+             * @return always 0
+             */
+            int call_jobs( Trick::ScheduledJobQueue & job_queue , long long time_tics ) ;
+
+        protected:
+
+            /** Adds a job to the level being gathered, chained behind earlier jobs of its sim object. */
+            void add_job( Trick::JobData * curr_job ) ;
+
+            /** Runs the gathered level on all workers and waits for it to finish. */
+            void run_level() ;
+
+            /** Runs chains from deque worker_id, then steals from the others until none remain. */
+            void run_chains( unsigned int worker_id ) ;
+
+            /** Pops a chain from the back of deque worker_id or the front of another deque. */
+            bool get_chain( unsigned int worker_id , unsigned int & chain ) ;
+
+            /** Runs a list of jobs in order and records the first exception. */
+            void call_chain( std::vector< Trick::JobData * > & jobs ) ;
+
+            /** Helper threads.  Deque ii + 1 belongs to workers[ii] */
+            std::vector< Trick::JobWorker * > workers ;  /**< trick_io(**) */
+
+            /** Jobs in the current level, grouped by chain */
+            std::vector< std::vector< Trick::JobData * > > chains ;  /**< trick_io(**) */
+
+            /** Jobs in the current level in queue order */
+            std::vector< Trick::JobData * > level_jobs ;  /**< trick_io(**) */
+
+            /** True if a job in the current level waits on other jobs */
+            bool level_depends ;            /**< trick_io(**) */
+
+            /** Number of chains used in the current level */
+            unsigned int num_chains ;       /**< trick_io(**) */
+
+            /** Maps a sim object id to its chain in the current level */
+            std::map< int , unsigned int > chain_index ;  /**< trick_io(**) */
+
+            /** Job class and phase of the current level */
+            int level_class ;               /**< trick_io(**) */
+            unsigned short level_phase ;    /**< trick_io(**) */
+
+            /** Per worker deques of chain indexes */
+            std::vector< std::deque< unsigned int > > deques ;  /**< trick_io(**) */
+
+            /** One mutex per deque */
+            std::vector< pthread_mutex_t > deque_mutexes ;  /**< trick_io(**) */
+
+            /** Protects generation, remaining, and the recorded exception */
+            pthread_mutex_t level_mutex ;   /**< trick_io(**) */
+
+            /** Signaled when a new level is posted */
+            pthread_cond_t work_cv ;        /**< trick_io(**) */
+
+            /** Signaled when the last chain of a level completes */
+            pthread_cond_t done_cv ;        /**< trick_io(**) */
+
+            /** Incremented every time a level is posted */
+            unsigned int generation ;       /**< trick_io(**) */
+
+            /** Chains of the current level not yet complete */
+            unsigned int remaining ;        /**< trick_io(**) */
+
+            /** Copied parameter from the owning thread to allow release of processor */
+            bool rt_nap ;                   /**< trick_io(**) */
+
+            /** True if a job in the current level threw */
+            bool level_error ;              /**< trick_io(**) */
+
+            /** First exception thrown in the current level, rethrown on the owning thread */
+            Trick::ExecutiveException level_exception ;  /**< trick_io(**) */
+
+    } ;
+
+}
+
+#endif
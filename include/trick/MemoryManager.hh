@@ -30,11 +30,14 @@ struct ut_system ;
 
 namespace Trick {
 
+    class BinaryCheckPointAgent ;
+
     typedef std::map<void*, ALLOC_INFO*, std::greater<void*> > ALLOC_INFO_MAP;
     typedef std::map<void*, ALLOC_INFO*, std::greater<void*> >::const_iterator ALLOC_INFO_MAP_ITER ;
     typedef std::map<std::string, ALLOC_INFO*> VARIABLE_MAP;
     typedef std::map<std::string, ALLOC_INFO*>::const_iterator VARIABLE_MAP_ITER ;
     typedef std::map<std::string, ENUM_ATTR*> ENUMERATION_MAP;
+    typedef std::map<std::string, std::map<std::string, REF2*> > REF_CACHE;
 
 /**
   The Memory Manager provides memory-resource administration services.
@@ -279,6 +282,48 @@ namespace Trick {
              */
              void set_hexfloat_checkpoint( bool flag);
 
+            /**
+             Indicate whether checkpoints should be written in the binary format.  Binary checkpoints
+             hold the raw bytes of each allocation and a pointer fix-up table.  They are restored from
+             a memory mapped file by several threads, but can only be restored into the same build of
+             the sim on the same kind of machine.  read_checkpoint() reads either format.
+             @param flag - true: Write binary checkpoints.
+                           false: (default) Write classic text checkpoints.
+             */
+             void set_binary_checkpoint( bool flag);
+
+            /**
+             @return true if checkpoints are written in the binary format.
+             */
+             bool get_binary_checkpoint();
+
+            /**
+             Write binary checkpoints of all allocations to files incrementally.  A checkpoint is a
+             delta holding only the allocations that changed since the last full checkpoint, until
+             max_deltas deltas have been written against it.  A checkpoint written to the file name
+             of its full checkpoint, as safestore checkpoints are, is a full checkpoint.  Restoring a
+             delta also reads its full checkpoint, and is refused if that was overwritten.
+             @param max_deltas - number of deltas between full checkpoints. 0 = (default) no deltas.
+             */
+             void set_incremental_checkpoint( int max_deltas);
+
+            /**
+             Write a full binary checkpoint holding the contents of a delta checkpoint and the
+             checkpoints it is based on.
+             @param delta_file - name of the delta checkpoint.
+             @param out_file - name of the full checkpoint to write.
+             @return 0 on success.
+             */
+             int compact_checkpoint( const char* delta_file, const char* out_file);
+
+            /**
+             Called before another process, e.g. a forked checkpoint writer, writes a checkpoint to
+             the named file.  Its hashes never reach this process, so it cannot become the base of
+             later deltas, and a base of the same name it overwrites is dropped.
+             @param filename - name of the file the other process writes.
+             */
+             void discard_checkpoint_base( const char* filename);
+
             /**
              Set the value(s) of the variable at the given address to 0, 0.0, NULL, false or "", as appropriate for the type.
              @param address - The address of the variable to be cleared.
@@ -335,8 +380,19 @@ namespace Trick {
             /**
              Checkpoint all allocations known to the MemoryManager to a file.
              @param filename  Name of file to be written.
+             @return 0 if the whole checkpoint was written, 1 if not.
+             */
+            int write_checkpoint( const char* filename);
+
+            /**
+             Checkpoint all allocations known to the MemoryManager to a stream that the caller saves
+             as the named file, e.g. a memory buffer written out by another thread.  An incremental
+             binary checkpoint may be a delta, so the stream must be saved under that name.
+             @param out_s output stream.
+             @param filename  Name of file the stream will be saved as.
+             @return 0 if the whole checkpoint was written to the stream, 1 if not.
              */
-            void write_checkpoint( const char* filename);
+            int write_checkpoint_for_file( std::ostream& out_s, const char* filename);
 
             /**
              Checkpoint the named variable (allocation) and it dependencies to the given stream.
@@ -349,8 +405,9 @@ namespace Trick {
              Checkpoint the named variable (allocation) and it dependencies to a file.
              @param filename  Checkpoint file.
              @param var_name  Variable name.
+             @return 0 if the whole checkpoint was written, 1 if not.
              */
-            void write_checkpoint( const char* filename, const char* var_name);
+            int write_checkpoint( const char* filename, const char* var_name);
 
             /**
              Checkpoint the named variables and their dependencies to a stream.
@@ -363,8 +420,9 @@ namespace Trick {
              Checkpoint the named variables and their dependencies to a file.
              @param filename output file name.
              @param var_name_list List of variable names.
+             @return 0 if the whole checkpoint was written, 1 if not.
              */
-            void write_checkpoint( const char* filename, std::vector<const char*>& var_name_list);
+            int write_checkpoint( const char* filename, std::vector<const char*>& var_name_list);
 
             /**
              Restore a checkpoint from the given stream.
@@ -470,6 +528,13 @@ namespace Trick {
              */
             REF2 *ref_attributes( const char* name);
 
+            /**
+             Forget the cached references that start with the named variable.  Called when the
+             variable is declared, deleted, renamed, or resized.
+             @param name - name of a named allocation.
+             */
+            void ref_cache_invalidate( const char* name);
+
             /**
              @param address - Address for which a name reference is needed.
              @return a name reference for the given address.
@@ -668,9 +733,11 @@ namespace Trick {
             const char* extern_anon_var_prefix; /**< -- Temporary-variable-name prefix. */
             CheckPointAgent* currentCheckPointAgent; /**< ** currently active Check point agent. */
             CheckPointAgent* defaultCheckPointAgent; /**< ** the classic Check point agent. */
+            BinaryCheckPointAgent* binaryCheckPointAgent; /**< ** the binary Check point agent. */
 
             bool reduced_checkpoint;    /**< -- true = Don't write zero valued variables in the checkpoint. false= Write all values. */
             bool hexfloat_checkpoint;   /**< -- true = Represent floating point values as hexidecimal to preserve precision. false= Normal. */
+            bool binary_checkpoint;     /**< -- true = Write checkpoints in the binary format. false= Classic text format. */
             bool expanded_arrays;       /**< -- true = array element values are set in separate assignments. */
 
             ALLOC_INFO_MAP  alloc_info_map;  /**< ** Map of <address, ALLOC_INFO*> key-value pairs for each of the managed allocations. */
@@ -678,6 +745,35 @@ namespace Trick {
             ENUMERATION_MAP enumeration_map; /**< ** Enumeration map. */
             pthread_mutex_t mm_mutex;        /**< ** Mutex to control access to memory manager maps */
 
+            REF_CACHE ref_cache;                 /**< ** Resolved references mapped by named allocation, then by reference. */
+            unsigned int ref_cache_generation;   /**< ** Incremented by every ref_cache_invalidate. */
+            pthread_mutex_t ref_cache_mutex;     /**< ** Mutex to control access to the ref_cache */
+
+            /**
+             Resolve a reference made only of names, "." and decimal indexes without the reference parser.
+             @param name - fully qualified variable name.
+             @return pointer to REF2 object, or NULL on failure.
+             */
+            REF2 *ref_attributes_fast( const char* name);
+
+            /**
+             Restore the STLs of all allocations if requested, then remove the temporary names
+             a checkpoint gave to anonymous allocations.
+             @param do_restore_stls - true: restore the STLs.
+             @return 0
+             */
+            int finish_restore( bool do_restore_stls);
+
+            /**
+             Return a copy of the cached reference, or NULL if it is not cached.
+             */
+            REF2 *ref_cache_lookup( const std::string& top_name, const char* name);
+
+            /**
+             Cache a copy of a resolved reference unless the cache was invalidated while it was resolved.
+             */
+            void ref_cache_insert( const std::string& top_name, REF2* R, unsigned int generation);
+
             int alloc_info_map_counter ;     /**< ** counter to assign unique ids to allocations as they are added to map */
             int extern_alloc_info_map_counter ; /**< ** counter to assign unique ids to allocations as they are added to map */
 
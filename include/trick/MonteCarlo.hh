@@ -7,9 +7,12 @@
 
 #include <deque>
 #include <vector>
+#include <map>
 #include <climits>
+#include <sys/types.h>
 
 #include "trick/MonteVar.hh"
+#include "trick/MonteResult.hh"
 #include "trick/Executive.hh"
 #include "trick/RemoteShell.hh"
 #include "trick/tc.h"
@@ -19,10 +22,14 @@
 %factory(Trick::MonteVar * Trick::MonteCarlo::get_variable, Trick::MonteVarCalculated, Trick::MonteVarFile, Trick::MonteVarFixed, Trick::MonteVarRandom) ;
 // This, paired with get_variables, allows access to the variables from the input file.
 %template(MonteVarVector) std::vector<Trick::MonteVar*>;
+%template(MonteResultVector) std::vector<Trick::MonteResult*>;
 #endif
 
 namespace Trick {
 
+    /** A Monte Carlo variable resolved by a slave for binary run values. */
+    struct MonteSlaveVariable ;
+
     /**
      * Represents a particular iteration in a Monte Carlo simulation. In addition to some bookkeeping information, a run
      * contains the variable values specific to this iteration.
@@ -66,6 +73,12 @@ namespace Trick {
         /** Manner in which this run exited. */
         ExitStatus exit_status;    /**< \n trick_units(--) */
 
+        /** Indices within #variables of the values that are dispatched in binary instead of as Python. */
+        std::vector <unsigned int> binary_variables; /**< \n trick_units(--) */
+
+        /** Numeric values of the #binary_variables. */
+        std::vector <double> binary_values; /**< \n trick_units(--) */
+
         /**
          * Constructs a MonteRun with the specified id.
          *
@@ -112,7 +125,8 @@ namespace Trick {
         enum Command {
             MC_PROCESS_RUN, /**< process a new run */
             MC_SHUTDOWN,    /**< kill any executing run, call shutdown jobs, and shutdown cleanly */
-            MC_DIE          /**< kill any executing run, do not call shutdown jobs, and exit */
+            MC_DIE,         /**< kill any executing run, do not call shutdown jobs, and exit */
+            MC_DEFINE_VARIABLES /**< name the variables of the binary values of following runs */
         };
 
         /** Unique identifier assigned by the master. */
@@ -160,6 +174,22 @@ namespace Trick {
         /** Remote program name. */
         std::string S_main_name;              /**< \n trick_units(--) */
 
+        /**
+         * Number of runs this slave executes at once. Each run is a child forked from the one slave process, so a
+         * single slave per machine can use every CPU. The master tracks each additional worker as a slave of its own
+         * whose #host_id is this slave's id. Defaults to one.
+         */
+        unsigned int num_workers;        /**< \n trick_units(--) */
+
+        /**
+         * CPU to which this slave's runs are bound. Additional workers are bound to the CPUs that follow.
+         * Defaults to -1, which leaves runs unbound.
+         */
+        int cpu_num;                     /**< \n trick_units(--) */
+
+        /** Id of the slave whose process executes this worker's runs, or zero if this slave has its own process. */
+        unsigned int host_id;            /**< \n trick_units(--) */
+
         void set_S_main_name(std::string name);    /**< \n trick_units(--) */
 
         /**
@@ -176,7 +206,10 @@ namespace Trick {
             num_results(0),
             cpu_time(0),
             remote_shell(Trick::TRICK_SSH),
-            multiplier(1) {
+            multiplier(1),
+            num_workers(1),
+            cpu_num(-1),
+            host_id(0) {
             if (name.empty()) {
                 machine_name = "localhost";
             }
@@ -278,6 +311,8 @@ namespace Trick {
 
         void print_statistics(FILE** fp) ;
 
+        void write_results_file() ;
+
         void dryrun() ;
 
         void initialize_slave(Trick::MonteSlave* slave_to_init) ;
@@ -318,6 +353,13 @@ namespace Trick {
         /** Maximum number of times that a run may be dispatched. Defaults to two. Specify zero for no limit. */
         unsigned int max_tries;                         /**< \n trick_units(--) */
 
+        /**
+         * Indicates whether numeric variable values are dispatched in binary and assigned directly through the
+         * MemoryManager by the slave. Calculated variables, values that are not numbers, and variables the slave
+         * cannot resolve are still dispatched as Python. Defaults to true.
+         */
+        bool binary_dispatch;                           /**< \n trick_units(--) */
+
         /** Options to be passed to the remote shell when spawning new slaves. */
         std::string user_cmd_string;                         /**< \n trick_units(--) */
 
@@ -336,6 +378,21 @@ namespace Trick {
         /** Device over which data is sent and received. */
         TCDevice connection_device;                     /**< \n trick_units(--) */
 
+        /** Slave: connection from the master over which runs are dispatched. It stays open between runs. */
+        TCDevice dispatch_device;                       /**< \n trick_units(--) */
+
+        /** Master: open dispatch connection to each slave process, by slave id. */
+        std::map<unsigned int, TCDevice *> dispatch_devices; /**< \n trick_io(**) trick_units(--) */
+
+        /** Slave: the variables named by the master for binary run values, in the master's order. */
+        std::vector<MonteSlaveVariable *> slave_variables; /**< \n trick_io(**) trick_units(--) */
+
+        /** Slave: the results named by the master, in the master's order. */
+        std::vector<MonteSlaveVariable *> slave_results; /**< \n trick_io(**) trick_units(--) */
+
+        /** Slave: the id of the worker each running child process is executing a run for, by process id. */
+        std::map<pid_t, unsigned int> slave_children;   /**< \n trick_io(**) trick_units(--) */
+
         /** Runs to be dispatched. */
         std::deque <Trick::MonteRun *> runs;                 /**< \n trick_io(**) trick_units(--) */
 
@@ -351,6 +408,15 @@ namespace Trick {
         /** Variables. */
         std::vector <Trick::MonteVar *> variables;           /**< \n trick_io(**) trick_units(--) */
 
+        /** Results returned by each run. */
+        std::vector <Trick::MonteResult *> results;          /**< \n trick_io(**) trick_units(--) */
+
+        /** Ids of the runs that returned results, in the order received. */
+        std::vector <unsigned int> result_runs;              /**< \n trick_io(**) trick_units(--) */
+
+        /** Values of the #results of each run in #result_runs, one row per run. */
+        std::vector <double> result_values;                  /**< \n trick_io(**) trick_units(--) */
+
         /** Slaves. */
         std::vector <Trick::MonteSlave *> slaves;            /**< \n trick_io(**) trick_units(--) */
 
@@ -524,6 +590,16 @@ namespace Trick {
          */
         unsigned int get_max_tries();
 
+        /**
+         * Sets #binary_dispatch.
+         */
+        void set_binary_dispatch(bool binary_dispatch);
+
+        /**
+         * Gets #binary_dispatch.
+         */
+        bool get_binary_dispatch();
+
         /**
          * Sets #user_cmd_string.
          */
@@ -641,6 +717,28 @@ namespace Trick {
          */
         const std::vector<Trick::MonteVar*>& get_variables();
 
+        /**
+         * Adds the specified result. Each run returns the value of the result's variable to the master when it
+         * finishes. The results are written to the monte_results file and summarized in the run_summary file.
+         *
+         * @param result the result to add
+         */
+        void add_result(Trick::MonteResult *result);
+
+        /**
+         * Gets the specified result.
+         *
+         * @param result_name name of the result's variable
+         */
+        Trick::MonteResult * get_result(std::string result_name);
+
+        /**
+         * Gets the list of added results.
+         *
+         * @return the current list of results
+         */
+        const std::vector<Trick::MonteResult*>& get_results();
+
         /**
          * Adds a new slave with the specified machine name.
          *
@@ -781,6 +879,61 @@ namespace Trick {
         void handle_run_data(MonteSlave& slave);
         void set_disconnected_state(MonteSlave& slave);
 
+        /**
+         * Adds a slave for each additional worker of the specified slave.
+         *
+         * @param slave the slave being spawned
+         *
+         * @see MonteSlave::num_workers
+         */
+        void add_workers(MonteSlave* slave);
+
+        /**
+         * Gets the open dispatch connection to the process executing the specified slave's runs, connecting if needed.
+         *
+         * @param slave the slave or worker
+         *
+         * @return the connection, or <code>NULL</code> if the slave could not be reached
+         */
+        TCDevice *get_dispatch_device(MonteSlave* slave);
+
+        /** Closes the dispatch connection to the slave process with the specified id. */
+        void close_dispatch_device(unsigned int id);
+
+        /**
+         * Picks the values of the specified run that can be dispatched in binary.
+         *
+         * @param run the run whose variable values have just been generated
+         */
+        void set_binary_values(MonteRun *run);
+
+        /**
+         * Sends the names and units of #variables so that the slave can resolve them for binary run values.
+         *
+         * @param device the slave's dispatch connection
+         *
+         * @return 0 on success
+         */
+        int send_variable_definitions(TCDevice *device);
+
+        /**
+         * Encodes the binary values of the specified run.
+         *
+         * @param run the run being dispatched
+         *
+         * @return the count, indices, and values of the binary values in network byte order
+         */
+        std::string encode_binary_values(MonteRun *run);
+
+        /**
+         * Reads the result values a run sent after its exit status.
+         *
+         * @param run the run that sent them
+         *
+         * @return 0 on success
+         */
+        int receive_results_values(MonteRun *run);
+
         /**
          * Handles the retrying of the current run of the specified slave with the specified exit status.
          *
@@ -882,13 +1035,39 @@ namespace Trick {
         /** Processes an incoming run. */
         int slave_process_run();
 
+        /**
+         * Waits until the dispatch connection has data, reaping finished runs while waiting.
+         *
+         * @param socket the socket to wait on
+         */
+        void slave_wait_for_master(int socket);
+
+        /** Reaps finished runs and reports runs killed by a signal to the master. */
+        void slave_reap_runs();
+
+        /** Sends the values of the results to the master. */
+        void slave_send_results();
+
+        /** Reads the master's variable and result definitions and resolves them. */
+        void slave_define_variables();
+
+        /**
+         * Assigns binary run values to their variables.
+         *
+         * @param values the values as encoded by #encode_binary_values, after the count
+         * @param count the number of values
+         * @param python receives the equivalent Python of every value, for the run's monte_input file
+         * @param fallback receives the Python of the values whose variables could not be resolved
+         */
+        void slave_apply_binary_values(const char *values, unsigned int count, std::string &python, std::string &fallback);
+
         /** Shuts down the slave. */
         void slave_shutdown();
 
         /** Kills the slave. */
         void slave_die();
 
-        /** Kills the current run. */
+        /** Kills the current runs. */
         void slave_kill_run();
 
         int instrument_job_before(Trick::JobData* instrument_job);
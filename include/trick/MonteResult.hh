@@ -0,0 +1,140 @@
+/*
+  PURPOSE:                     (Monte carlo result statistics)
+  REFERENCE:                   (Trick Users Guide)
+  ASSUMPTIONS AND LIMITATIONS: (None)
+*/
+
+#ifndef MONTERESULT_HH
+#define MONTERESULT_HH
+
+#include <string>
+#include <vector>
+#include <map>
+
+// This block of code disowns the pointer on the python side so you can reassign
+// python variables without freeing the C++ class underneath
+#ifdef SWIG
+%feature("compactdefaultargs","0") ;
+%feature("shadow") Trick::MonteResult::MonteResult(std::string name, std::string unit) %{
+    def __init__(self, *args):
+        this = $action(*args)
+        try: self.this.append(this)
+        except: self.this = this
+        this.own(0)
+        self.this.own(0)
+%}
+#endif
+
+namespace Trick {
+
+    /**
+     * A simulation variable whose value at the end of each run is returned to the master. The master folds each value
+     * into streaming statistics as it arrives, so no run's data has to be read back from disk.
+     *
+     * Quantiles are estimated from logarithmically sized buckets. An estimate is within #relative_accuracy of the
+     * value of the returned rank.
+     */
+    class MonteResult {
+
+        public:
+        /** The fully qualified name of the simulation variable. */
+        std::string name;                 /**< \n trick_units(--) */
+
+        /** The units in which the value is returned. Empty for the variable's own units. */
+        std::string unit;                 /**< \n trick_units(--) */
+
+        /** Number of values received. */
+        unsigned long long count;         /**< \n trick_units(--) */
+
+        /** Number of runs whose value could not be read. */
+        unsigned long long num_missing;   /**< \n trick_units(--) */
+
+        /** Number of infinite values received. They are left out of the other statistics. */
+        unsigned long long num_infinite;  /**< \n trick_units(--) */
+
+        /** Running mean of the values. */
+        double mean;                      /**< \n trick_units(--) */
+
+        /** Smallest value received. */
+        double min;                       /**< \n trick_units(--) */
+
+        /** Largest value received. */
+        double max;                       /**< \n trick_units(--) */
+
+        /** Relative accuracy of the quantile estimates. Cannot be changed after the first value. */
+        double relative_accuracy;         /**< \n trick_units(--) */
+
+        /** Lower bound of the histogram. */
+        double histogram_lower;           /**< \n trick_units(--) */
+
+        /** Upper bound of the histogram. */
+        double histogram_upper;           /**< \n trick_units(--) */
+
+        /** Counts of the values in each histogram bin, which include their lower bound. */
+        std::vector<unsigned long long> histogram; /**< \n trick_io(**) trick_units(--) */
+
+        /** Number of values below the lower bound of the histogram. */
+        unsigned long long histogram_underflow; /**< \n trick_units(--) */
+
+        /** Number of values at or above the upper bound of the histogram. */
+        unsigned long long histogram_overflow; /**< \n trick_units(--) */
+
+        /**
+         * Constructs a MonteResult for the specified variable.
+         *
+         * @param name the fully qualified name of the simulation variable
+         * @param unit the units in which to return the value
+         */
+        MonteResult(std::string name, std::string unit = "");
+
+        /**
+         * Sets the bounds and number of bins of the histogram and clears it.
+         *
+         * @param lower the lower bound
+         * @param upper the upper bound
+         * @param num_bins the number of bins. Zero disables the histogram.
+         */
+        void set_histogram(double lower, double upper, unsigned int num_bins);
+
+        /**
+         * Folds a value into the statistics.
+         *
+         * @param value the value of the variable at the end of a run
+         */
+        void add_value(double value);
+
+        /** Returns the sample variance of the values. */
+        double get_variance();
+
+        /** Returns the sample standard deviation of the values. */
+        double get_standard_deviation();
+
+        /**
+         * Returns an estimate of the specified quantile.
+         *
+         * @param quantile the quantile, between 0 and 1
+         */
+        double get_quantile(double quantile);
+
+        /** Describes the statistics of this result. */
+        std::string describe_result();
+
+        protected:
+        /** Sum of the squares of the differences from the mean (Welford). */
+        double m2;                        /**< \n trick_units(--) */
+
+        /** Counts of the positive and negative values by bucket, and of the values near zero. */
+        std::map<int, unsigned long long> positive_buckets; /**< \n trick_io(**) trick_units(--) */
+        std::map<int, unsigned long long> negative_buckets; /**< \n trick_io(**) trick_units(--) */
+        unsigned long long zero_count;    /**< \n trick_units(--) */
+
+        /** Returns the bucket holding the specified magnitude. */
+        int bucket_of(double magnitude);
+
+        /** Returns the representative magnitude of the specified bucket. */
+        double bucket_value(int bucket);
+
+    };
+
+};
+#endif
@@ -7,6 +7,8 @@
 #define SCHEDULEDJOBQUEUE_HH
 
 #include <string>
+#include <vector>
+#include <map>
 
 #include "trick/JobData.hh"
 
@@ -17,6 +19,11 @@ namespace Trick {
      * allocate memory during normal cycling through jobs and is considerably
      * faster than the generalized priority_queue.
      *
+     * The queue may optionally keep a calendar of its jobs bucketed by next call time.  With the
+     * calendar enabled find_next_job and get_next_job_call_time only visit the jobs that are due
+     * instead of walking the entire list.  The (job_class, phase, sim_object_id, id) ordering
+     * within a time tic is unchanged.
+     *
      * @author Robert W. Bailey
      * @author many other Trick developers of the past who did not add their names.
      * @author Alexander S. Lin
@@ -56,6 +63,21 @@ namespace Trick {
              */
             int push_ignore_sim_object(JobData * in_job ) ;
 
+            /**
+             * @brief Adds a new job to a batch of jobs waiting to be added to the list.  Building a
+             * queue from a batch sorts the jobs once instead of searching the list for every job.
+             * @param in_job - Job to add to the batch
+             * @return always 0.
+             */
+            int batch_push(JobData * in_job ) ;
+
+            /**
+             * @brief Adds all jobs in the batch to the list.  Jobs are placed exactly where
+             * push() would have placed them had they been pushed in the same order.
+             * @return always 0.
+             */
+            int batch_commit() ;
+
             /**
              * @brief Removes a job from the list if present.
              * @param in_job - Job to remove to the list
@@ -190,19 +212,111 @@ namespace Trick {
              */
             int test_next_job_call_time(Trick::JobData * curr_job, long long time_tics) ;
 
+            /**
+             @userdesc Command to bucket the jobs in this queue by next call time.  Useful for queues
+             holding thousands of jobs at mixed rates where only a few jobs are due each pass.
+             @par Python Usage:
+             @code trick.exec_get_thread(<thread_id>).job_queue.set_calendar(<yes_no>) @endcode
+             @param yes_no - True to use the calendar, False for the linear search
+             @return always 0
+             */
+            int set_calendar(bool yes_no) ;
+
+            /**
+             * @brief Returns true if the calendar is in use
+             */
+            bool get_calendar() ;
+
+            /**
+             * @brief Notifies the queue that next call times were changed outside of find_next_job.
+             * Non system jobs are rebucketed before the next search.  Has no effect on the linear search.
+             * @return always 0
+             */
+            int reschedule() ;
+
         private:
 
+            /**
+             * @brief Returns true if job_a executes before job_b by job_class, phase, sim_object_id, and id.
+             */
+            static bool job_order( const JobData * job_a , const JobData * job_b ) ;
+
+            /**
+             * @brief Grows the list to hold at least num_jobs jobs.
+             */
+            void reserve( unsigned int num_jobs ) ;
+
+            /**
+             * @brief Rebuilds the calendar from the list if it is out of date.
+             */
+            void build_calendar() ;
+
+            /**
+             * @brief Files the job at list index ii into the calendar bucket at time_tics.
+             */
+            void calendar_insert(long long time_tics , unsigned int ii) ;
+
+            /**
+             * @brief Returns the index of the next job at or after curr_index whose next call time
+             * equals time_tics, or list_size if none remain.
+             */
+            unsigned int calendar_find(long long time_tics) ;
+
             /** number of jobs in list */
             unsigned int list_size ;
 
+            /** number of jobs the list has room for */
+            unsigned int list_capacity ; /* ** */
+
+            /** list is sorted by job_order, false once jobs are pushed ignoring their sim_object id */
+            bool list_sorted ; /* ** */
+
             /** Simple reallocable list of JobData pointers.  */
             JobData ** list ; /* ** This list is allocated outside of the memory manager. */
 
+            /** jobs waiting to be added to the list by batch_commit() */
+            std::vector< JobData * > batch_list ; /* ** */
+
             /** current index to top job in list */
             unsigned int curr_index ;
 
             /** next lowest job call time as tracked by calls to find_next_job(long long) */
             long long next_job_time ;
+
+            /** use the calendar instead of searching the whole list */
+            bool use_calendar ;
+
+            /** calendar must be rebuilt from the list before the next search */
+            bool calendar_stale ; /* ** */
+
+            /** time of the last calendar search by find_next_job(long long) */
+            long long calendar_time ; /* ** */
+
+            /** non system jobs bucketed by next call time.  Each bucket holds the count of jobs still due
+                at that time and the list indexes filed there in ascending order.  Indexes of jobs that
+                have since been rescheduled are left behind and skipped. */
+            std::map< long long , std::pair< unsigned int , std::vector< unsigned int > > > calendar ; /* ** */
+
+            /** storage from emptied buckets kept for reuse */
+            std::vector< std::vector< unsigned int > > calendar_spares ; /* ** */
+
+            /** list indexes of system jobs, these set their own next call times and are always checked */
+            std::vector< unsigned int > calendar_system_jobs ; /* ** */
+
+            /** bucket last searched by calendar_find(long long) */
+            std::pair< unsigned int , std::vector< unsigned int > > * calendar_due ; /* ** */
+
+            /** time of the bucket last searched by calendar_find(long long) */
+            long long calendar_due_time ; /* ** */
+
+            /** position reached in the bucket last searched by calendar_find(long long) */
+            unsigned int calendar_due_pos ; /* ** */
+
+            /** bucket last filled by calendar_insert(long long, unsigned int) */
+            std::pair< unsigned int , std::vector< unsigned int > > * calendar_last ; /* ** */
+
+            /** time of the bucket last filled by calendar_insert(long long, unsigned int) */
+            long long calendar_last_time ; /* ** */
     } ;
 
 }
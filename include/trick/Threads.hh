@@ -19,6 +19,7 @@
 #include "trick/ThreadTrigger.hh"
 #include "trick/SimObject.hh"
 #include "trick/ScheduledJobQueue.hh"
+#include "trick/JobWorkerPool.hh"
 
 namespace Trick {
 
@@ -125,6 +126,9 @@ namespace Trick {
             /** Queue to hold scheduled jobs assigned to this thread. */
             Trick::ScheduledJobQueue job_queue ;  /**< trick_io(**) */
 
+            /** Optional helper threads that run independent scheduled jobs of this thread in parallel. */
+            Trick::JobWorkerPool job_pool ;  /**< trick_io(**) */
+
             /** Queue to hold AMF top of frame jobs.\n */
             Trick::ScheduledJobQueue top_of_frame_queue ; /**< trick_io(**) */
 
@@ -0,0 +1,291 @@
+/*
+PURPOSE:
+    ( Timeline trace of executive activity in Chrome trace format )
+*/
+
+#ifndef TRACELOG_HH
+#define TRACELOG_HH
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include "trick/InstrumentBase.hh"
+#include "trick/JobData.hh"
+#include "trick/ThreadBase.hh"
+
+namespace Trick {
+
+    /** One event in a thread's trace buffer.  name and category must outlive the trace. */
+    struct TraceEvent {
+        const char * name ;
+        const char * category ;
+        /** Start time in nanoseconds of the monotonic clock */
+        unsigned long long start ;
+        /** Duration in nanoseconds, or instant_event for an instant */
+        unsigned long long duration ;
+    } ;
+
+    /**
+     * A single producer, single consumer ring of trace events.  The thread the buffer belongs to
+     * adds events.  The trace writer thread removes them.  Neither takes a lock.  Events added to
+     * a full buffer are dropped and counted.
+     */
+    class TraceBuffer {
+
+        public:
+
+            TraceBuffer( unsigned int in_size ) ;
+            ~TraceBuffer() ;
+
+            /** Add an event.  Called only by the thread the buffer belongs to. */
+            void push( const Trick::TraceEvent & event ) {
+                unsigned long long head = write_index ;
+                if ( head - __atomic_load_n(&read_index, __ATOMIC_ACQUIRE) >= size ) {
+                    __atomic_store_n(&dropped, dropped + 1, __ATOMIC_RELAXED) ;
+                    return ;
+                }
+                events[head & mask] = event ;
+                __atomic_store_n(&write_index, head + 1, __ATOMIC_RELEASE) ;
+            }
+
+            /**
+             @brief Remove the waiting events.  Called only by the trace writer thread.
+             @param out - receives the events
+            */
+            void pop( std::vector< Trick::TraceEvent > & out ) ;
+
+            /** @return the number of events dropped because the buffer was full */
+            unsigned long long get_dropped() { return __atomic_load_n(&dropped, __ATOMIC_RELAXED) ; }
+
+            /** Kernel thread id of the thread the buffer belongs to */
+            long tid ;
+            /** Name of the thread the buffer belongs to */
+            std::string thread_name ;
+            /** True once the thread name has been written to the trace */
+            bool named ;
+
+        private:
+
+            Trick::TraceEvent * events ;
+            unsigned int size ;
+            unsigned int mask ;
+            /* The writer's and reader's positions are kept on separate cache lines. */
+            char pad0[64] ;
+            unsigned long long write_index ;
+            unsigned long long dropped ;
+            char pad1[64] ;
+            unsigned long long read_index ;
+
+            TraceBuffer( const TraceBuffer & ) ;
+            TraceBuffer & operator = ( const TraceBuffer & ) ;
+    } ;
+
+    class TraceLog ;
+
+    /**
+     * The thread that drains the trace buffers into the trace file.
+     */
+    class TraceWriterThread : public Trick::ThreadBase {
+
+        public:
+
+            TraceWriterThread( Trick::TraceLog & in_trace_log ) ;
+
+            virtual void * thread_body() ;
+
+            /** Set to stop the thread after it drains the buffers once more */
+            bool stop ;  // trick_io(**)
+
+        protected:
+
+            Trick::TraceLog & trace_log ;  // trick_io(**)
+
+        private:
+
+            void operator =(const Trick::TraceWriterThread &) ;
+    } ;
+
+    /**
+     * Instrument inserted immediately before or after a traced job.
+     */
+    class TraceInstrument : public Trick::InstrumentBase {
+
+        public:
+
+            /**
+             @brief constructor
+             @param in_start_time - where the start of the target job is kept between the two instruments
+             @param in_target_job - the traced job
+             @param in_start - true for the instrument before the job, false for the one after
+            */
+            TraceInstrument( unsigned long long * in_start_time , Trick::JobData * in_target_job , bool in_start ) ;
+
+            /**
+             @brief Note the start of the target job, or trace the job when it ends.
+             @return always 0
+            */
+            virtual int call() ;
+
+        protected:
+
+            unsigned long long * start_time ;  /**< trick_io(**) */
+            const char * category ;            /**< trick_io(**) */
+            const char * job_name ;            /**< trick_io(**) */
+            bool start ;                       /**< trick_io(**) */
+
+    } ;
+
+    /**
+     * This class writes a timeline of the simulation's activity to trace.json in the output
+     * directory, in the Chrome trace event format read by chrome://tracing and Perfetto.
+     *
+     * Each thread adds events to its own buffer without locks.  A writer thread drains the
+     * buffers to the file.  The events are every job's run, each child thread's wait for its
+     * trigger and the main thread firing it, the real-time sleep and spin at the end of each
+     * frame and each overrun, data record group writes, and variable server copies.
+     *
+     * Code that traces an activity brackets it with start() and complete():
+     * @code
+     * unsigned long long trace_start = Trick::TraceLog::start() ;
+     * do_something() ;
+     * Trick::TraceLog::complete("category", "do_something", trace_start) ;
+     * @endcode
+     * Both do nothing but test a flag when tracing is off.
+     */
+    class TraceLog {
+
+        public:
+
+            /** True while tracing */
+            bool enabled ;                  /**< trick_io(*io) trick_units(--) */
+
+            /** Number of events each thread can hold until the writer drains them.  Set before tracing starts.  Rounded up to a power of two */
+            unsigned int buffer_events ;    /**< trick_io(*io) trick_units(--) */
+
+            /** Time between writer drains */
+            double drain_period ;           /**< trick_io(*io) trick_units(s) */
+
+            /** The thread writing the trace file.  Its cpu affinity and priority may be set before tracing starts */
+            Trick::TraceWriterThread writer ;
+
+            /** Duration of an instant event */
+            static const unsigned long long instant_event = ~0ULL ;
+
+            /** True while events are added to the buffers */
+            static bool active ;            /**< trick_io(**) */
+
+            /**
+             @brief This is the constructor of the TraceLog class.
+            */
+            TraceLog() ;
+
+            /**
+             @brief @userdesc Command to start tracing.  The trace file is created the first time
+             tracing is turned on and written until shutdown.
+             @par Python Usage:
+             @code trick.trace_on() @endcode
+             @return always 0
+            */
+            int trace_on() ;
+
+            /**
+             @brief @userdesc Command to stop tracing.  Tracing may be turned on again.
+             @par Python Usage:
+             @code trick.trace_off() @endcode
+             @return always 0
+            */
+            int trace_off() ;
+
+            /**
+             @brief preload_checkpoint job that removes the instruments before the jobs they are
+             inserted in are deleted.
+             @return always 0
+            */
+            int preload_checkpoint() ;
+
+            /**
+             @brief restart job that turns tracing back on if it was on in the checkpoint.
+             @return always 0
+            */
+            int restart() ;
+
+            /**
+             @brief shutdown job that stops the writer thread and finishes the trace file.
+             @return always 0
+            */
+            int shutdown() ;
+
+            /** @return the monotonic clock in nanoseconds if tracing, else 0 */
+            static unsigned long long start() {
+                return __atomic_load_n(&active, __ATOMIC_RELAXED) ? now() : 0 ;
+            }
+
+            /**
+             @brief Trace an activity that began at start.
+             @param category - category of the event
+             @param name - name of the event.  Only the pointer is kept until the writer drains it,
+                    so the name must live for the rest of the run.
+             @param start - the value start() returned before the activity, 0 to trace nothing
+            */
+            static void complete( const char * category , const char * name , unsigned long long start ) {
+                if ( start != 0 ) {
+                    add_event(category, name, start, now() - start) ;
+                }
+            }
+
+            /**
+             @brief Trace an instant.
+             @param category - category of the event
+             @param name - name of the event
+            */
+            static void instant( const char * category , const char * name ) {
+                if ( __atomic_load_n(&active, __ATOMIC_RELAXED) ) {
+                    add_event(category, name, now(), instant_event) ;
+                }
+            }
+
+            /** @return the monotonic clock in nanoseconds */
+            static unsigned long long now() ;
+
+            /**
+             @brief Drain every thread's buffer into the trace file.  Called by the writer thread.
+            */
+            void drain() ;
+
+        private:
+
+            /* Add an event to the calling thread's buffer, creating the buffer on the thread's first event. */
+            static void add_event( const char * category , const char * name , unsigned long long start ,
+                                   unsigned long long duration ) ;
+
+            void write_event( Trick::TraceBuffer * buffer , const Trick::TraceEvent & event ) ;
+
+            /** The trace file */
+            FILE * fp ;                                                     /**< trick_io(**) */
+
+            /** Clock when the trace file was created.  Event times are written relative to it */
+            unsigned long long trace_start ;                                /**< trick_io(**) */
+
+            /** True when an event has been written, so the next one needs a separator */
+            bool events_written ;                                           /**< trick_io(**) */
+
+            /** Start times of the traced jobs, kept between their two instruments */
+            std::vector< unsigned long long * > job_start_times ;           /**< trick_io(**) */
+
+            /** Instruments inserted around the jobs */
+            std::vector< Trick::TraceInstrument * > instruments ;           /**< trick_io(**) */
+
+            /** Events removed from a buffer, reused by each drain */
+            std::vector< Trick::TraceEvent > drained ;                      /**< trick_io(**) */
+
+            void remove_instruments() ;
+
+            // This object is not copyable
+            void operator =(const TraceLog &) {};
+
+    } ;
+
+}
+
+#endif
@@ -18,6 +18,7 @@
 #include "trick/variable_server_sync_types.h"
 #include "trick/VariableServerThread.hh"
 #include "trick/VariableServerListenThread.hh"
+#include "trick/VariableServerSnapshot.hh"
 #include "trick/ThreadBase.hh"
 
 namespace Trick {
@@ -254,6 +255,11 @@ namespace Trick {
             */
             void set_copy_data_freeze_job( Trick::JobData * ) ;
 
+            /**
+             @brief Returns the snapshot of variables shared by all clients.
+            */
+            Trick::VariableServerSnapshot & get_snapshot() ;
+
         protected:
 
             /** Toggle to enable/disable the variable server.\n */
@@ -287,6 +293,9 @@ namespace Trick {
             /** Mutex to ensure only one thread manipulates the map of var_server_threads\n */
             pthread_mutex_t map_mutex ;     /**<  trick_io(**) */
 
+            /** Variables added by all clients, each copied once per copy cycle.\n */
+            VariableServerSnapshot snapshot ; /**<  trick_io(**) */
+
             /** Map of additional listen threads created by create_tcp_socket.\n */
             std::map < pthread_t , VariableServerListenThread * > additional_listen_threads ; /**<  trick_io(**) */
 
@@ -295,7 +304,8 @@ namespace Trick {
 
 }
 
-int vs_format_ascii(Trick::VariableReference * var, char *value);
+int vs_format_ascii(Trick::VariableReference * var, char *value, size_t value_size);
+Trick::VariableReference::AsciiFormatter vs_ascii_formatter(Trick::VariableReference * var);
 
 Trick::VariableServer * var_server_get_var_server() ;
 
@@ -318,6 +328,7 @@ int var_debug(int level) ;
 int var_ascii() ;
 int var_binary() ;
 int var_binary_nonames() ;
+int var_binary_delta() ;
 int var_validate_address(int on_off) ;
 int var_set_copy_mode(int mode) ;
 int var_set_write_mode(int mode) ;
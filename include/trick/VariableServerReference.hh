@@ -11,6 +11,10 @@
 
 union cv_converter ;
 
+namespace Trick {
+    class VariableServerSnapshotEntry ;
+}
+
 #define MAX_ARRAY_LENGTH 4096
 
 namespace Trick {
@@ -27,15 +31,22 @@ namespace Trick {
 
             friend std::ostream& operator<< (std::ostream& s, const Trick::VariableReference& vref);
 
+            /** Writes the value in buffer_out as ascii text, see vs_format_ascii.\n */
+            typedef bool (*AsciiFormatter)( VariableReference * var , char *& out , char * end ) ;
+
             /** Pointer to trick variable reference structure.\n */
             REF2 * ref ;
             cv_converter * conversion_factor ; // ** udunits conversion factor
+            bool needs_conversion ;   // -- false while conversion_factor is trivial, so it can be skipped
+            AsciiFormatter ascii_formatter ; // ** formats the value in ascii mode, chosen by type whenever ref is set
             void * buffer_in ;
             void * buffer_out ;
             void * address ;          // -- address of data copied to buffer
             int size ;                // -- size of data copied to buffer
             TRICK_TYPE string_type ;  // -- indicate if this is a string or wstring
             bool need_deref ;         // -- inidicate this is a painter to be dereferenced
+            VariableServerSnapshotEntry * shared ; // ** shared snapshot entry, NULL if copied by this client only
+            unsigned int shared_generation ;       // -- ref generation of the shared entry this ref was taken from
     } ;
 
 }
@@ -0,0 +1,205 @@
+/*
+    PURPOSE:
+        (VariableServerSnapshot)
+*/
+
+#ifndef VARIABLESERVERSNAPSHOT_HH
+#define VARIABLESERVERSNAPSHOT_HH
+
+#include <map>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include "trick/reference.h"
+#include "trick/VariableServerReference.hh"
+
+namespace Trick {
+
+    class VariableServerThread ;
+
+/**
+  One unique variable in the snapshot.  The entry is shared by every client that added the variable.
+  The sim thread copies the value into values[buffer] of the snapshot buffer it is filling.  Clients
+  read only the values of the published buffer.
+ */
+    class VariableServerSnapshotEntry {
+        public:
+            VariableServerSnapshotEntry(REF2 * in_ref) ;
+            ~VariableServerSnapshotEntry() ;
+
+            /** The variable name the entry is mapped by.\n */
+            std::string name ;               /**<  trick_io(**) */
+
+            /** Reference resolved and copied by the sim thread only.\n */
+            VariableReference * source ;     /**<  trick_io(**) */
+
+            /** Size of each of the value buffers.\n */
+            int buffer_size ;                /**<  trick_io(**) */
+
+            /** Number of client variables using this entry, protected by the snapshot mutex.\n */
+            unsigned int num_clients ;       /**<  trick_io(**) */
+
+            /** A client has address validation on, the sim thread checks the address.\n */
+            bool validate_address ;          /**<  trick_io(**) */
+
+            /** Incremented by the sim thread each time source->ref is replaced.\n */
+            unsigned int ref_generation ;    /**<  trick_io(**) */
+
+            /** The value copied in each snapshot buffer.\n */
+            void * values[2] ;               /**<  trick_io(**) */
+
+            /** Size of the value copied in each snapshot buffer.\n */
+            int value_sizes[2] ;             /**<  trick_io(**) */
+
+            /** Copy of source->ref for clients when the value was copied, NULL until the ref is replaced.\n */
+            REF2 * value_refs[2] ;           /**<  trick_io(**) */
+
+            /** ref_generation of value_refs.\n */
+            unsigned int value_generations[2] ;        /**<  trick_io(**) */
+
+            /** Sequence of the snapshot buffer the value was copied for.\n */
+            unsigned long long value_sequences[2] ;    /**<  trick_io(**) */
+
+            /**
+             @brief Copy a reference for a new owner.  The copy has its own reference name and units, so it
+             outlives the original.  The attributes are shared, they belong to the memory manager.
+             @param in_ref - the reference to copy
+             @param in_units - units of the copy, taken over by the copy, or NULL
+             @return the copy
+            */
+            static REF2 * copy_ref( REF2 * in_ref , char * in_units ) ;
+
+            /**
+             @brief Free a reference and its name.  The units are not freed, the owner passes them on.
+             @param in_ref - the reference to free, may be NULL
+            */
+            static void free_ref( REF2 * in_ref ) ;
+    } ;
+
+/**
+  This class holds one reference counted entry for every unique variable added by all variable server
+  clients.  Values are double buffered.  Once per copy cycle the sim thread copies every entry into the
+  buffer clients are not reading and publishes it.  Clients copy out of the published buffer on their
+  own threads when they write.  The sim thread never blocks on a client.  If a client still holds the
+  unpublished buffer the sim thread skips the cycle and clients get the previous values again.  Sim
+  thread cost scales with unique variables rather than clients times variables.
+ */
+    class VariableServerSnapshot {
+        public:
+            VariableServerSnapshot() ;
+            ~VariableServerSnapshot() ;
+
+            /**
+             @brief Get the entry for a client variable, creating it if it is the first use of the variable.
+             Called by client threads.
+             @param var - the client variable
+             @return the shared entry, or NULL if the variable cannot be shared.
+            */
+            VariableServerSnapshotEntry * subscribe( VariableReference * var ) ;
+
+            /**
+             @brief Release an entry.  The sim thread deletes it after the last client releases it.
+            */
+            void unsubscribe( VariableServerSnapshotEntry * entry ) ;
+
+            /**
+             @brief Start a new copy cycle.  Called by the sim thread copy jobs.
+            */
+            void start_cycle() ;
+
+            /**
+             @brief Get the current copy cycle.
+            */
+            unsigned long long get_cycle() ;
+
+            /**
+             @brief Copy every entry from the sim into the unpublished buffer and publish it.  Called by
+             the sim thread for each client copy, only the first call in a copy cycle copies.
+             @param vst - the client copying, used to resolve the variables
+             @param in_time - the sim time of the copy
+            */
+            void refresh( VariableServerThread * vst , double in_time ) ;
+
+            /**
+             @brief Hold the published buffer for reading.  Called by client threads.
+             @return the buffer index, pass it to release.
+            */
+            unsigned int acquire() ;
+
+            /**
+             @brief Release a buffer returned by acquire.
+            */
+            void release( unsigned int buffer ) ;
+
+            /**
+             @brief Get the sequence number of a buffer.  Entry values with another sequence were not
+             copied into the buffer.
+            */
+            unsigned long long get_sequence( unsigned int buffer ) ;
+
+            /**
+             @brief Get the sim time a buffer was copied at.
+            */
+            double get_time( unsigned int buffer ) ;
+
+            /**
+             @brief Get the number of copy cycles skipped because a client was still reading.
+            */
+            unsigned long long get_cycles_skipped() ;
+
+            /**
+             @brief Tag every entry as a bad reference while a checkpoint is reloaded, they resolve again
+             after the reload.  Called by the sim thread.
+            */
+            void preload_checkpoint() ;
+
+            /**
+             @brief Get the number of unique variables subscribed by clients.
+            */
+            unsigned int size() ;
+
+        protected:
+            /** Moves new entries to active and deletes released ones.  Called by the sim thread with the
+                snapshot mutex held.\n */
+            void update_active() ;
+
+            /** Entries mapped by variable name, protected by the snapshot mutex.\n */
+            std::map < std::string , VariableServerSnapshotEntry * > entries ;  /**<  trick_io(**) */
+
+            /** Entries created by clients and not yet copied by the sim, protected by the snapshot mutex.\n */
+            std::vector < VariableServerSnapshotEntry * > pending ;  /**<  trick_io(**) */
+
+            /** Entries copied by the sim thread, only used by the sim thread.\n */
+            std::vector < VariableServerSnapshotEntry * > active ;   /**<  trick_io(**) */
+
+            /** The current copy cycle.\n */
+            unsigned long long cycle ;           /**<  trick_io(**) */
+
+            /** The last copy cycle refreshed or skipped.\n */
+            unsigned long long refreshed_cycle ; /**<  trick_io(**) */
+
+            /** The buffer clients read.\n */
+            unsigned int published ;             /**<  trick_io(**) */
+
+            /** Number of clients reading each buffer.\n */
+            unsigned int readers[2] ;            /**<  trick_io(**) */
+
+            /** Sequence number of each buffer, 0 before it is first copied.\n */
+            unsigned long long sequences[2] ;    /**<  trick_io(**) */
+
+            /** Sim time each buffer was copied at.\n */
+            double times[2] ;                    /**<  trick_units(s) */
+
+            /** Sequence number of the next buffer copied.\n */
+            unsigned long long next_sequence ;   /**<  trick_io(**) */
+
+            /** Copy cycles skipped because a client was still reading.\n */
+            unsigned long long cycles_skipped ;  /**<  trick_io(**) */
+
+            /** Protects the entries map, pending entries and client counts.  The sim thread only tries it.\n */
+            pthread_mutex_t snapshot_mutex ;     /**<  trick_io(**) */
+    } ;
+
+}
+
+#endif
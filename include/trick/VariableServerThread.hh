@@ -30,6 +30,9 @@ namespace Trick {
 
             friend std::ostream& operator<< (std::ostream& s, Trick::VariableServerThread& vst);
 
+            /** The snapshot resolves and copies shared variables the way a client copies its own. */
+            friend class VariableServerSnapshot ;
+
             /**
              @brief Constructor.
              @param listen_dev - the TCDevice set up in listen()
@@ -213,6 +216,17 @@ namespace Trick {
             */
             int var_binary_nonames() ;
 
+            /**
+             @brief @userdesc Command to instruct the variable server to return values in the binary delta format.
+             A schema message giving each variable a numeric id, name, type, and size is sent when the variable
+             list changes.  After that only the id, size, and value of variables whose values changed are sent.
+             Messages are length prefixed and are not limited in size.
+             @par Python Usage:
+             @code trick.var_binary_delta() @endcode
+             @return always 0
+            */
+            int var_binary_delta() ;
+
             /**
              @brief @userdesc Command to tell the server when to copy data
              - VS_COPY_ASYNC = copies data asynchronously. (default)
@@ -366,8 +380,10 @@ namespace Trick {
 
             /**
              @brief Copy client variable values from Trick memory to each variable's output buffer.
+             @param in_copy_cycle - true when called from a variable server copy job.  Shared variables
+              already copied by another client in the current copy cycle are not copied from the sim again.
             */
-            int copy_sim_data();
+            int copy_sim_data( bool in_copy_cycle = false );
 
             /**
              @brief Write data in the appropriate format (var_ascii or var_binary) from variable output buffers to socket.
@@ -430,6 +446,35 @@ namespace Trick {
             */
             int write_binary_data( int Start, char *buf1, int PacketNum );
 
+            /**
+             @brief Resolve the address of one variable and copy its value from Trick memory to its buffer_in.
+             @param curr_var - the variable to copy
+             @param in_validate - check the address with the memory manager
+            */
+            void copy_sim_variable( VariableReference * curr_var , bool in_validate ) ;
+
+            /**
+             @brief Copy the shared variables out of the published snapshot buffer into their buffer_in.
+             Called by write_data on the thread writing, with copy_mutex held.
+            */
+            void copy_snapshot_data() ;
+
+            /**
+             @brief Tag a variable as a bad reference while a checkpoint is reloaded.
+            */
+            static void bad_ref_preload( VariableReference * var ) ;
+
+            /**
+             @brief Called by write_data to write changed values to socket in var_binary_delta format.
+            */
+            int write_delta_data() ;
+
+            /** Helpers for write_delta_data to build messages in delta_buffer. */
+            void delta_append_int( int value ) ;
+            void delta_append_value( unsigned int ii ) ;
+            unsigned int delta_start_message( int msg_type , int count ) ;
+            void delta_end_message( unsigned int msg_start ) ;
+
             /**
              @brief Make a time reference.
              */
@@ -518,6 +563,24 @@ namespace Trick {
             /** Toggle to tell variable server return data in binary format without the variable names.\n */
             bool binary_data_nonames ;       /**<  trick_io(**) */
 
+            /** Toggle to tell variable server return data in binary delta format.\n */
+            bool binary_delta ;              /**<  trick_io(**) */
+
+            /** The variable list changed since the last binary delta schema message was sent.\n */
+            bool delta_schema_dirty ;        /**<  trick_io(**) */
+
+            /** Type of each variable in the last binary delta schema message.\n */
+            std::vector <int> delta_types ;  /**<  trick_io(**) */
+
+            /** Last value sent for each variable in binary delta format.\n */
+            std::vector <std::string> delta_last_values ;  /**<  trick_io(**) */
+
+            /** A value has been sent for each variable since the last schema message.\n */
+            std::vector <bool> delta_sent ;  /**<  trick_io(**) */
+
+            /** Outgoing binary delta messages.\n */
+            std::string delta_buffer ;       /**<  trick_io(**) */
+
             /** Toggle to tell variable server to send data multicast or point to point.\n */
             bool multicast ;                 /**<  trick_io(**) */
 
@@ -539,6 +602,9 @@ namespace Trick {
             /** Indicate whether variable data has been written into buffer_in.\n */
             bool var_data_staged; /**<  trick_io(**) */
 
+            /** The shared variables of the staged data are still to be copied from the snapshot.\n */
+            bool snapshot_staged ; /**<  trick_io(**) */
+
             /** number of packets copied to client \n */
             unsigned int packets_copied ; /**< trick_io(**) */
 
@@ -15,6 +15,7 @@ int dr_enable_group( const char * in_name ) ;
 int dr_disable_group( const char * in_name ) ;
 int dr_record_now_group( const char * in_name ) ;
 int dr_set_max_file_size ( uint64_t bytes ) ;
+int dr_set_num_writer_threads ( unsigned int num ) ;
 void remove_all_data_record_groups(void) ;
 int set_max_size_record_group (const char * in_name, uint64_t bytes ) ;
 
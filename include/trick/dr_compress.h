@@ -0,0 +1,154 @@
+/*
+PURPOSE:
+    (Column codec for the DRCompressed data recording format.  Shared by the recording group
+     and the data products reader.)
+ICG:
+    (No)
+*/
+
+#ifndef DR_COMPRESS_H
+#define DR_COMPRESS_H
+
+#include <string.h>
+
+/* Header byte that starts a run of values equal to the previous value. */
+#define DR_COMPRESS_RUN 0xFF
+
+/* Largest value size encoded with the leading/trailing zero byte header. */
+#define DR_COMPRESS_MAX_PACKED 15
+
+/*
+   Each value is XORed with the previous value of the column.  Slowly varying values share their
+   high order bytes with the previous value, leaving zero bytes at one end of the XOR.
+
+   Values up to DR_COMPRESS_MAX_PACKED bytes are stored as a header byte, (leading zero bytes << 4) |
+   trailing zero bytes, followed by the remaining XOR bytes.  Larger values are stored as a 0 header
+   byte followed by the full XOR.  A run of values equal to the previous value is stored as
+   DR_COMPRESS_RUN followed by the run length as a base 128 varint.  The zero byte counts of a packed
+   header never add up to more than the value size, so a packed header can never be DR_COMPRESS_RUN.
+*/
+
+/* Worst case encoded size of a column of num values of size bytes. */
+static inline unsigned int dr_compress_bound( unsigned int num , unsigned int size ) {
+    return num * (size + 1) ;
+}
+
+static inline unsigned char * dr_compress_put_run( unsigned char * op , unsigned int run ) {
+    *op++ = DR_COMPRESS_RUN ;
+    while ( run >= 0x80 ) {
+        *op++ = (unsigned char)(run | 0x80) ;
+        run >>= 7 ;
+    }
+    *op++ = (unsigned char)run ;
+    return op ;
+}
+
+/* Encodes num values of size bytes from in to out.  Returns the encoded length. */
+static inline unsigned int dr_compress_column( const unsigned char * in , unsigned int num , unsigned int size ,
+ unsigned char * out ) {
+
+    unsigned char * op = out ;
+    const unsigned char * prev = NULL ;
+    const unsigned char * value ;
+    unsigned char xor_value[DR_COMPRESS_MAX_PACKED] ;
+    unsigned int run = 0 ;
+    unsigned int ii , kk ;
+    unsigned int lead , trail ;
+
+    for ( ii = 0 ; ii < num ; ii++ ) {
+        value = in + ii * size ;
+        if ( prev != NULL and ! memcmp(value, prev, size) ) {
+            run++ ;
+            continue ;
+        }
+        if ( run ) {
+            op = dr_compress_put_run(op, run) ;
+            run = 0 ;
+        }
+        if ( size <= DR_COMPRESS_MAX_PACKED ) {
+            for ( kk = 0 ; kk < size ; kk++ ) {
+                xor_value[kk] = value[kk] ^ ( prev ? prev[kk] : 0 ) ;
+            }
+            for ( lead = 0 ; lead < size and xor_value[lead] == 0 ; lead++ ) ;
+            for ( trail = 0 ; trail < size - lead and xor_value[size - 1 - trail] == 0 ; trail++ ) ;
+            *op++ = (unsigned char)((lead << 4) | trail) ;
+            memcpy(op, xor_value + lead, size - lead - trail) ;
+            op += size - lead - trail ;
+        } else {
+            *op++ = 0 ;
+            for ( kk = 0 ; kk < size ; kk++ ) {
+                *op++ = value[kk] ^ ( prev ? prev[kk] : 0 ) ;
+            }
+        }
+        prev = value ;
+    }
+    if ( run ) {
+        op = dr_compress_put_run(op, run) ;
+    }
+    return op - out ;
+}
+
+/* Decodes num values of size bytes from in to out.  Returns 0 on success, -1 if in is malformed. */
+static inline int dr_decompress_column( const unsigned char * in , unsigned int in_len , unsigned int num ,
+ unsigned int size , unsigned char * out ) {
+
+    const unsigned char * ip = in ;
+    const unsigned char * end = in + in_len ;
+    unsigned char * value ;
+    unsigned int ii = 0 ;
+    unsigned int kk ;
+    unsigned int lead , trail , run , shift ;
+    unsigned char header ;
+
+    while ( ii < num ) {
+        if ( ip >= end ) {
+            return -1 ;
+        }
+        header = *ip++ ;
+        value = out + ii * size ;
+        if ( header == DR_COMPRESS_RUN ) {
+            run = 0 ;
+            shift = 0 ;
+            do {
+                if ( ip >= end or shift > 28 ) {
+                    return -1 ;
+                }
+                run |= (unsigned int)(*ip & 0x7f) << shift ;
+                shift += 7 ;
+            } while ( *ip++ & 0x80 ) ;
+            if ( ii == 0 or run > num - ii ) {
+                return -1 ;
+            }
+            for ( kk = 0 ; kk < run ; kk++ , ii++ ) {
+                memcpy(out + ii * size, out + (ii - 1) * size, size) ;
+            }
+            continue ;
+        }
+        if ( ii == 0 ) {
+            memset(value, 0, size) ;
+        } else {
+            memcpy(value, value - size, size) ;
+        }
+        if ( size <= DR_COMPRESS_MAX_PACKED ) {
+            lead = header >> 4 ;
+            trail = header & 0x0f ;
+            if ( lead + trail > size or (unsigned int)(end - ip) < size - lead - trail ) {
+                return -1 ;
+            }
+            for ( kk = lead ; kk < size - trail ; kk++ ) {
+                value[kk] ^= *ip++ ;
+            }
+        } else {
+            if ( header != 0 or (unsigned int)(end - ip) < size ) {
+                return -1 ;
+            }
+            for ( kk = 0 ; kk < size ; kk++ ) {
+                value[kk] ^= *ip++ ;
+            }
+        }
+        ii++ ;
+    }
+    return 0 ;
+}
+
+#endif
@@ -72,10 +72,13 @@
 #include "trick/DataRecordDispatcher.hh"
 #include "trick/DRAscii.hh"
 #include "trick/DRBinary.hh"
+#include "trick/DRCompressed.hh"
 #include "trick/DRHDF5.hh"
 #include "trick/DebugPause.hh"
 #include "trick/EchoJobs.hh"
 #include "trick/FrameLog.hh"
+#include "trick/JobProfiler.hh"
+#include "trick/TraceLog.hh"
 #include "trick/UnitTest.hh"
 #include "trick/CheckPointRestart.hh"
 #include "trick/Sie.hh"
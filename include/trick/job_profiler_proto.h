@@ -0,0 +1,16 @@
+#ifndef JOB_PROFILER_PROTO_H
+#define JOB_PROFILER_PROTO_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int job_profiler_on(void) ;
+int job_profiler_off(void) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -39,6 +39,9 @@ int   TMM_is_alloced(char *addr) ;
 void  TMM_set_debug_level(int level);
 void  TMM_reduced_checkpoint(int flag);
 void  TMM_hexfloat_checkpoint(int flag);
+void  TMM_binary_checkpoint(int flag);
+void  TMM_incremental_checkpoint(int max_deltas);
+int   TMM_compact_checkpoint(const char* delta_file, const char* out_file);
 
 void  TMM_clear_var_a( void* address);
 void  TMM_clear_var_n( const char* var_name );
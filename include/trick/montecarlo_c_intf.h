@@ -89,6 +89,18 @@ void mc_set_max_tries(unsigned int max_tries);
  */
 unsigned int mc_get_max_tries(void);
 
+/**
+ * @relates Trick::MonteCarlo
+ * @copydoc set_binary_dispatch
+ */
+void mc_set_binary_dispatch(int binary_dispatch);
+
+/**
+ * @relates Trick::MonteCarlo
+ * @copydoc get_binary_dispatch
+ */
+int mc_get_binary_dispatch(void);
+
 /**
  * @relates Trick::MonteCarlo
  * @copydoc set_user_cmd_string
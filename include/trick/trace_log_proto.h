@@ -0,0 +1,16 @@
+#ifndef TRACE_LOG_PROTO_H
+#define TRACE_LOG_PROTO_H
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int trace_on(void) ;
+int trace_off(void) ;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
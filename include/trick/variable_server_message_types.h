@@ -12,7 +12,9 @@ typedef enum {
     VS_VAR_EXISTS = 1,
     VS_SIE_RESOURCE = 2,
     VS_LIST_SIZE = 3 ,
-    VS_STDIO = 4
+    VS_STDIO = 4 ,
+    VS_VAR_SCHEMA = 5 ,
+    VS_VAR_DELTA = 6
 } VS_MESSAGE_TYPE ;
 
 #endif
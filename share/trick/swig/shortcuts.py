@@ -45,6 +45,8 @@ if hasattr(top.cvar, 'trick_ip'):
 
 set_event_info_msg_on = trick.IPPythonEvent.set_event_info_msg_on
 set_event_info_msg_off = trick.IPPythonEvent.set_event_info_msg_off
+set_event_native_conditions_on = trick.IPPythonEvent.set_event_native_conditions_on
+set_event_native_conditions_off = trick.IPPythonEvent.set_event_native_conditions_off
 
 # bind pyton input_processor event routines to shortcut names.
 new_event = trick.ippython_new_event
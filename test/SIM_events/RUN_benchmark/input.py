@@ -0,0 +1,42 @@
+##########################################################
+# Event condition benchmark: 1000 active events whose condition strings
+# are evaluated every frame.  Run as
+#     ./S_main_*.exe RUN_benchmark/input.py
+# and again with EVENTS_PYTHON_CONDITIONS=1 in the environment to time
+# the same conditions evaluated by python.
+import os
+import time
+
+trick.exec_set_software_frame(0.01)
+trick.exec_set_enable_freeze(False)
+
+stop_time = 10
+trick.stop(stop_time)
+
+if os.getenv("EVENTS_PYTHON_CONDITIONS"):
+    trick.set_event_native_conditions_off()
+
+num_events = 1000
+for ii in range(num_events):
+    bench = trick.new_event("bench%d" % ii)
+    # never true, so every event is evaluated every cycle for the whole run
+    bench.condition(0, "ev.count > %d and not ev.cond_var_false" % (1000000 + ii))
+    bench.action(0, "pass")
+    bench.set_cycle(0.01)
+    bench.activate()
+    trick.add_event(bench)
+
+start_time = time.time()
+
+##########################################################
+# REPORT AT SHUTDOWN
+report_event = trick.new_event("report_event")
+report_event.condition(0, "True")
+report_event.action(0, """
+elapsed = time.time() - start_time
+evaluations = num_events * int(round(stop_time / 0.01))
+print ("%d event conditions evaluated %d times in %.3f s (%.3f us per evaluation)" %
+       (num_events, evaluations, elapsed, elapsed * 1.0e6 / evaluations))
+""")
+report_event.activate()
+trick.add_event_after(report_event, "ev.shutdown")
@@ -198,6 +198,15 @@ trick.add_read(3.5, """manual12.manual_fire()""")
 expected.append(3.5)
 result.append(0)
 
+# TEST 13: condition string evaluated natively, fire only once
+event13 = trick.new_event("event13")
+event13.condition(0, "ev.count >= 3 and not ev.cond_var_false")
+event13.action(0, "print (\"event13\"); result[13] += 1");
+event13.activate()
+trick.add_event(event13)
+expected.append(1)
+result.append(0)
+
 ##########################################################
 # TEST RESULTS AT SHUTDOWN
 result_event = trick.new_event("result_event")
@@ -219,6 +228,7 @@ TRICK_EXPECT_EQ(result[9], expected[9], test_suite, "event9")
 TRICK_EXPECT_EQ(result[10], expected[10], test_suite, "manual10")
 TRICK_EXPECT_EQ(result[11], expected[11], test_suite, "manual11")
 TRICK_EXPECT_EQ(result[12], expected[12], test_suite, "manual12")
+TRICK_EXPECT_EQ(result[13], expected[13], test_suite, "event13")
 """)
 result_event.activate() 
 trick.add_event_after(result_event, "ev.shutdown")
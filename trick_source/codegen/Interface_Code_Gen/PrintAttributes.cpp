@@ -114,6 +114,24 @@ static void _mkdir(const char *dir) {
     }
 }
 
+/*
+   Writes contents to the file unless the file already holds them.  Leaving an unchanged file alone
+   keeps its time stamp, so make does not recompile it.  Returns true if the file was written.
+ */
+static bool writeFileIfChanged(const std::string& file_name, const std::string& contents) {
+    std::ifstream existing(file_name.c_str(), std::ios::binary) ;
+    if ( existing ) {
+        std::ostringstream existing_contents ;
+        existing_contents << existing.rdbuf() ;
+        if ( existing_contents.str() == contents ) {
+            return false ;
+        }
+    }
+    std::ofstream outfile(file_name.c_str(), std::ios::binary) ;
+    outfile << contents ;
+    return true ;
+}
+
 bool PrintAttributes::openIOFile(const std::string& header_file_name) {
     /**
      * There are a lot of conditions to be met in order to open an IO file.  We store the headers
@@ -121,11 +139,7 @@ bool PrintAttributes::openIOFile(const std::string& header_file_name) {
      */
     if (visited_files.find(header_file_name) != visited_files.end()) {
         // We have visited this header before. If there is a valid name, append to the existing IO file.
-        if (out_of_date_io_files.find(header_file_name) != out_of_date_io_files.end()) {
-            outfile.open(out_of_date_io_files[header_file_name].c_str(), std::fstream::app);
-            return true ;
-        }
-        return false;
+        return out_of_date_io_files.find(header_file_name) != out_of_date_io_files.end() ;
     }
 
     visited_files.insert(header_file_name) ;
@@ -155,9 +169,7 @@ bool PrintAttributes::openIOFile(const std::string& header_file_name) {
     out_of_date_io_files[header_file_name] = io_file_name ;
 
     // write header information
-    std::cout << color(INFO, "Writing    ") << out_of_date_io_files[header_file_name] << std::endl;
-    outfile.open(out_of_date_io_files[header_file_name].c_str());
-    printer->printIOHeader(outfile, header_file_name);
+    printer->printIOHeader(io_file_contents[io_file_name], header_file_name);
     if (!cs.hasTrickHeader(header_file_name) ) {
         std::cout << bold(color(WARNING, "Warning    ") + header_file_name) << std::endl
             << "           No Trick header comment found" << std::endl;
@@ -235,8 +247,7 @@ void PrintAttributes::printClass( ClassValues * cv ) {
 
     const std::string& fileName = classValues.getFileName();
     if (openIOFile(fileName)) {
-        printer->printClass(outfile, cv);
-        outfile.close();
+        printer->printClass(io_file_contents[out_of_date_io_files[fileName]], cv);
         printSieClass(cv);
     }
 
@@ -262,8 +273,7 @@ void PrintAttributes::printEnum(EnumValues* ev) {
 
     const std::string& fileName = enumValues.getFileName();
     if (openIOFile(fileName)) {
-        printer->printEnum(outfile, ev) ;
-        outfile.close() ;
+        printer->printEnum(io_file_contents[out_of_date_io_files[fileName]], ev) ;
         printSieEnum(&enumValues) ;
     }
     
@@ -273,6 +283,17 @@ void PrintAttributes::printEnum(EnumValues* ev) {
 }
 
 
+void PrintAttributes::writeIOFiles() {
+    for ( auto& io_file : io_file_contents ) {
+        if ( writeFileIfChanged(io_file.first, io_file.second.str()) ) {
+            std::cout << color(INFO, "Writing    ") << io_file.first << std::endl;
+        } else if ( verboseBuild ) {
+            std::cout << skipping << "Unchanged: " << io_file.first << std::endl;
+        }
+    }
+    io_file_contents.clear() ;
+}
+
 void PrintAttributes::printSieClass( ClassValues * cv ) {
     std::string xmlFileName;
     if(sim_services_flag) {
@@ -375,16 +396,17 @@ void PrintAttributes::closeMapFiles() {
     printer->printEnumMapFooter(enum_map_outfile) ;
     enum_map_outfile.close() ;
 
-    // If we wrote any new io_src files, move the temporary class and enum map files to new location
+    // If we regenerated any io_src files, move the temporary class and enum map files to new location
+    // unless the class_map.cpp there is the same.
     if ( out_of_date_io_files.size() > 0 ) {
         std::ifstream class_map(std::string(map_dir + "/.class_map.cpp").c_str()) ;
         std::ifstream enum_map(std::string(map_dir + "/.enum_map.cpp").c_str()) ;
-        std::ofstream combined_map(std::string(map_dir + "/class_map.cpp").c_str()) ;
+        std::ostringstream combined_map ;
         combined_map << class_map.rdbuf() << enum_map.rdbuf() ;
-    } else {
-        remove( std::string(map_dir + "/.class_map.cpp").c_str() ) ;
-        remove( std::string(map_dir + "/.enum_map.cpp").c_str() ) ;
+        writeFileIfChanged(map_dir + "/class_map.cpp", combined_map.str()) ;
     }
+    remove( std::string(map_dir + "/.class_map.cpp").c_str() ) ;
+    remove( std::string(map_dir + "/.enum_map.cpp").c_str() ) ;
 }
 
 // Make a list of the empty files we processed.
@@ -4,6 +4,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <map>
@@ -46,6 +47,9 @@ class PrintAttributes {
         virtual void createMapFiles() ;
         virtual void closeMapFiles() ;
 
+        /** Writes the io_src files whose contents changed */
+        virtual void writeIOFiles() ;
+
         /** Create makefile for IO files */
         virtual void printIOMakefile() ;
 
@@ -75,8 +79,8 @@ class PrintAttributes {
         /** Directory to put class and enum map files */
         std::string map_dir ;
 
-        /** Output stream to be used to print individual io_src files */
-        std::ofstream outfile ;
+        /** Contents of the out of date io_src files by io_src file name, written by writeIOFiles */
+        std::map< std::string , std::ostringstream > io_file_contents ;
 
         /** Output stream to be used for class_map */
         std::ofstream class_map_outfile ;
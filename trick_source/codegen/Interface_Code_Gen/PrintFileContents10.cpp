@@ -122,9 +122,31 @@ void PrintFileContents10::print_class_attr(std::ostream & ostream , ClassValues
     print_field_attr(ostream, new_fdes) ;
     ostream << " };" << std::endl ;
 
+    print_name_order(ostream, c) ;
+
     print_close_extern_c(ostream) ;
 }
 
+/** Prints the indexes of the class attributes sorted by field name, ending with the index of the sentinel.
+    AttributesMap::find_member searches it instead of comparing every name. */
+void PrintFileContents10::print_name_order(std::ostream & ostream , ClassValues * c ) {
+    std::vector<FieldDescription*> fields = getPrintableFields(*c) ;
+    std::vector<unsigned int> order ;
+    for ( unsigned int ii = 0 ; ii < fields.size() ; ii++ ) {
+        order.push_back(ii) ;
+    }
+    // stable so the first of two fields with the same name is found, as a linear search would
+    std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) {
+        return fields[a]->getName() < fields[b]->getName() ;
+    }) ;
+
+    ostream << "unsigned int attr" << c->getFullyQualifiedMangledTypeName("__") << "_name_order[] = {" ;
+    for ( unsigned int index : order ) {
+        ostream << index << ", " ;
+    }
+    ostream << fields.size() << "} ;" << std::endl ;
+}
+
 /** Prints init_attr function for each class */
 void PrintFileContents10::print_field_init_attr_stmts( std::ostream & ostream , FieldDescription * fdes ,
  ClassValues * cv , unsigned int index ) {
@@ -379,7 +401,8 @@ void PrintFileContents10::printClassMap( std::ostream & ostream , ClassValues *
     std::string name = cv->getFullyQualifiedMangledTypeName("__");
     ostream << "    // " << cv->getFileName() << std::endl
             << "    extern ATTRIBUTES  attr" << name << "[] ;" << std::endl
-            << "    class_attribute_map->add_attr(\"" << cv->getFullyQualifiedMangledTypeName() << "\" , attr" << name << ") ;" << std::endl ;
+            << "    extern unsigned int attr" << name << "_name_order[] ;" << std::endl
+            << "    class_attribute_map->add_attr(\"" << cv->getFullyQualifiedMangledTypeName() << "\" , attr" << name << " , attr" << name << "_name_order) ;" << std::endl ;
 }
 
 void PrintFileContents10::printClassMapFooter( std::ostream & ostream ) {
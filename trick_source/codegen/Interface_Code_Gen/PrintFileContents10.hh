@@ -58,6 +58,9 @@ class PrintFileContents10 : public PrintFileContentsBase {
         /** Prints class attributes */
         void print_class_attr(std::ostream & outfile , ClassValues * in_class) ;
 
+        /** Prints the indexes of the class attributes sorted by name */
+        void print_name_order(std::ostream & outfile , ClassValues * in_class) ;
+
         /** Prints init_attr function for each class */
         void print_field_init_attr_stmts(std::ostream & outfile , FieldDescription * fdes ,
          ClassValues * cv , unsigned int index ) ;
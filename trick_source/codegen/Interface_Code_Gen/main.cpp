@@ -236,6 +236,9 @@ int main(int argc, char * argv[]) {
     clang::ParseAST(ci.getSema());
     ci.getDiagnosticClient().EndSourceFile();
 
+    // Write the io_src files that changed
+    printAttributes.writeIOFiles();
+
     if (!sim_services_flag) {
         printAttributes.printIOMakefile();
     }
@@ -4,6 +4,7 @@
 #include "Log/TrickBinary.hh"
 #include <string.h>
 #include <stdlib.h>
+#include <float.h>
 
 static const char *usage_doc[] = {
 "----------------------------------------------------------------------------",
@@ -24,6 +25,10 @@ static const char *usage_doc[] = {
 "                          Change the default delimiter used in 'csv' & 'fix'",
 "                          ascii formats from comma separated \",\" to another ",
 "                          string (Note: do not use spaces before quotes).   ",
+"     start=<time>         Begin with the first record at or after <time>.   ",
+"                          Logs are searched with their time index (.idx)    ",
+"                          rather than read from the beginning.              ",
+"     stop=<time>          End with the last record at or before <time>.     ",
 "                                                                            ",
 "----------------------------------------------------------------------------"};
 #define N_USAGE_LINES (sizeof(usage_doc)/sizeof(usage_doc[0]))
@@ -40,6 +45,13 @@ void usage() {
     print_doc((char **)usage_doc,N_USAGE_LINES);
 }
 
+void seek_all(vector <DataStream*> & ds_list, double start_time) {
+    vector <DataStream*>::size_type idx;
+    for ( idx = 0; idx < ds_list.size(); idx++ ) {
+        ds_list[idx]->seekTime(start_time);
+    }
+}
+
 int main(int argc, char* argv[])
 {
     double t, y ;
@@ -53,6 +65,9 @@ int main(int argc, char* argv[])
     enum {CSV, FIX, XML};
     int Format=0;  /* default to csv */
     string delimiter(",");  /* default delimter */
+    double start_time = -DBL_MAX;
+    double stop_time = DBL_MAX;
+    bool seek_start = false;
 
     int i, done;
     char *prog_name = argv[0];
@@ -100,6 +115,11 @@ int main(int argc, char* argv[])
                 if (found_it>=0) {
                     delimiter = option.substr(found_it+1);
                 }
+            } else if (option.find("start=") == 0) {
+                start_time = atof(option.substr(6).c_str());
+                seek_start = true;
+            } else if (option.find("stop=") == 0) {
+                stop_time = atof(option.substr(5).c_str());
             } else {
                 cerr << "\"" << option.c_str() << "\" is not a valid option.\n";
                 cerr.flush();
@@ -176,13 +196,16 @@ int main(int argc, char* argv[])
             fprintf(fp,"%4s</Columns>\n", "");
 
             fprintf(fp,"%4s<Data>\n", "");
+            if ( seek_start ) {
+                seek_all(ds_list, start_time);
+            }
             done = 0;
             while ( !done ) {
                 current_line.clear();
                 sprintf(buf, "%8s<Row>", "");
                 current_line.append(buf);
                 for ( idx = 0; idx < ds_list.size(); idx++ ) {
-                    if ( ds_list[idx]->get( &t, &y) == 0 ) {
+                    if ( ds_list[idx]->get( &t, &y) == 0 || t > stop_time ) {
                         done = 1;
                         break;
                     }
@@ -219,11 +242,14 @@ int main(int argc, char* argv[])
 
             fprintf(fp,"\n");
 
+            if ( seek_start ) {
+                seek_all(ds_list, start_time);
+            }
             done = 0;
             while ( !done ) {
                 current_line.clear();
                 for ( idx = 0; idx < ds_list.size(); idx++ ) {
-                    if ( ds_list[idx]->get( &t, &y) == 0 ) {
+                    if ( ds_list[idx]->get( &t, &y) == 0 || t > stop_time ) {
                         done = 1;
                         break;
                     }
@@ -78,7 +78,13 @@ void DPC_TimeCstrDataStream::begin() {
   bix = 0;
   eos[0] = 0;
   eos[1] = 0;
-  ds->begin();
+  // Skip the points before tstart without reading them when the source can.  A start of 0 is
+  // the default, beginning there needs no search.
+  if (tstart > 0.0) {
+    ds->seekTime(tstart);
+  } else {
+    ds->begin();
+  }
   step();
 }
 
@@ -143,6 +143,11 @@ void DPC_UnitConvDataStream::begin() {
     source_ds->begin();
 }
 
+// MEMBER FUNCTION
+int DPC_UnitConvDataStream::seekTime(double timestamp) {
+    return( source_ds->seekTime(timestamp));
+}
+
 // MEMBER FUNCTION
 int DPC_UnitConvDataStream::end() {
     return( source_ds->end());
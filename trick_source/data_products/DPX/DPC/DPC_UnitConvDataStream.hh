@@ -75,6 +75,12 @@ public:
      */
     void begin();
 
+    /**
+     * Set the DataStream to read from the first point at or after the time.
+     * @return 1 if there is such a point, 0 otherwise.
+     */
+    int seekTime(double timestamp);
+
     /**
      * Test for the end of the DataStream.
      * @return 1 if the end of the DataStream has been reached, 0 otherwise.
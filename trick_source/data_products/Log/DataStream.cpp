@@ -25,6 +25,22 @@ int DataStream::getValueAtTime(double time , double * value ) {
 
 }
 
+int DataStream::seekTime(double time) {
+
+        double value_time ;
+        double value ;
+
+        begin() ;
+        while ( peek( &value_time , &value ) ) {
+                if ( value_time >= time ) {
+                        return(1) ;
+                }
+                step() ;
+        }
+
+        return(0) ;
+}
+
 string DataStream::getFileName() {
         return(fileName_) ;
 }
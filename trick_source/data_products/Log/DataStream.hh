@@ -15,7 +15,11 @@ class DataStream {
                virtual int get(double * timeStamp , double * paramValue) = 0 ;
                virtual int peek(double * timeStamp , double * paramValue) = 0 ;
 
-               int getValueAtTime(double timeStamp, double *paramValue ) ;
+               virtual int getValueAtTime(double timeStamp, double *paramValue ) ;
+
+               // Position the stream on the first point at or after the time.
+               // Returns 0 if there is no such point.
+               virtual int seekTime(double timeStamp) ;
 
                virtual string getFileName() ;
                virtual string getUnit() ;
@@ -91,6 +91,23 @@ DataStream* DataStreamFactory::create( const char* iRunDir,
         }
     }
 
+    // Trick compressed binary
+    rewinddir(dirp) ;
+    while ((dp = readdir(dirp)) != NULL) {
+        len = strlen(dp->d_name);
+        if ( len > 4 && !strcmp( &(dp->d_name[len - 4]) , ".trz")) {
+            full_path = (char*) malloc (runDir.length() + strlen(dp->d_name) + 2) ;
+            sprintf(full_path, "%s/%s", runDir.c_str(), dp->d_name);
+            if ( TrickCompressedLocateParam((const char*)full_path , paramName.c_str()) ) {
+                closedir(dirp) ;
+                stream = new TrickCompressed(full_path , (char *)paramName.c_str()) ;
+                free( full_path ) ;
+                return(stream) ;
+            }
+            free( full_path ) ;
+        }
+    }
+
     // CSV Files
     rewinddir(dirp) ;
     while ((dp = readdir(dirp)) != NULL) {
@@ -183,7 +200,16 @@ int getVariableNames( const char* pathToData,
         }
         *variableNames = TrickBinaryGetVariableNames(pathToData) ;
         return 1 ;
-}
+    }
+
+    if ( !strcmp( &pathToData[len - 4] , ".trz" )) {
+        *numVariables  = TrickCompressedGetNumVariables(pathToData) ;
+        if ( *numVariables == 0 ) {
+            return 0 ;
+        }
+        *variableNames = TrickCompressedGetVariableNames(pathToData) ;
+        return 1 ;
+    }
 
     return(0);
 }
@@ -4,6 +4,7 @@
 
 #include <stdio.h>
 #include "DataStream.hh"
+#include "TrickBinaryFile.hh"
 
 class TrickBinary : public DataStream {
 
@@ -14,22 +15,16 @@ class TrickBinary : public DataStream {
                int get(double * time , double * value ) ;
                int peek(double * time , double * value ) ;
 
+               int seekTime(double time) ;
+
                void begin() ;
                int end() ;
                int step() ;
 
        private:
-               FILE *fp_ ;
-               int swap_ ;
-               int time_size_ ;
-               int num_params_ ;
-               int record_offset_ ;
-               int record_size_ ;
-               char * record_ ;
-               int type_ ;
-               int size_ ;
-
-               int data_offset_ ;
+               TrickBinaryFile * file_ ;
+               int column_ ;
+               size_t record_ ;
 
 } ;
 
@@ -0,0 +1,546 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "TrickBinaryFile.hh"
+#include "trick/parameter_types.h"
+#include "trick_byte_order.h"
+#include "trick_byteswap.h"
+#include "trick/units_conv.h"
+
+/* Records are decoded in blocks of this many records. */
+static const size_t block_records = 65536 ;
+
+/* All decoded blocks are dropped when they would exceed this many bytes. */
+static const size_t max_decoded_bytes = (size_t)1 << 30 ;
+
+std::map< std::string , TrickBinaryFile * > TrickBinaryFile::open_files_ ;
+
+TrickBinaryFile * TrickBinaryFile::open( const char * file_name ) {
+
+        std::map< std::string , TrickBinaryFile * >::iterator it = open_files_.find(file_name) ;
+        if ( it != open_files_.end() ) {
+                it->second->ref_count_++ ;
+                return it->second ;
+        }
+
+        TrickBinaryFile * file = new TrickBinaryFile(file_name) ;
+        if ( file->map() != 0 || file->read_header() != 0 ) {
+                delete file ;
+                return NULL ;
+        }
+        open_files_[file_name] = file ;
+        return file ;
+}
+
+void TrickBinaryFile::close( TrickBinaryFile * file ) {
+
+        if ( file != NULL && --file->ref_count_ == 0 ) {
+                open_files_.erase(file->file_name_) ;
+                delete file ;
+        }
+}
+
+TrickBinaryFile::TrickBinaryFile( const std::string & file_name ) :
+ file_name_(file_name) , ref_count_(1) , fd_(-1) , map_(NULL) , map_size_(0) , swap_(0) ,
+ data_offset_(0) , record_size_(0) , num_records_(0) , time_column_(0) , decoded_bytes_(0) ,
+ index_stride_(1024) , index_records_(0) , index_monotonic_(false) , index_loaded_(false) {
+}
+
+TrickBinaryFile::~TrickBinaryFile() {
+        unmap() ;
+        if ( fd_ >= 0 ) {
+                ::close(fd_) ;
+        }
+}
+
+int TrickBinaryFile::map() {
+
+        struct stat st ;
+
+        if ( fd_ < 0 && (fd_ = ::open(file_name_.c_str() , O_RDONLY)) < 0 ) {
+                std::cerr << "ERROR:  Couldn't open \"" << file_name_ << "\": " << std::strerror(errno) << std::endl;
+                return -1 ;
+        }
+        if ( fstat(fd_ , &st) != 0 || st.st_size == 0 ) {
+                return -1 ;
+        }
+        void * address = mmap(NULL , (size_t)st.st_size , PROT_READ , MAP_PRIVATE , fd_ , 0) ;
+        if ( address == MAP_FAILED ) {
+                std::cerr << "ERROR:  Couldn't map \"" << file_name_ << "\": " << std::strerror(errno) << std::endl;
+                return -1 ;
+        }
+        madvise(address , (size_t)st.st_size , MADV_SEQUENTIAL) ;
+        map_ = (char *)address ;
+        map_size_ = (size_t)st.st_size ;
+        return 0 ;
+}
+
+void TrickBinaryFile::unmap() {
+        if ( map_ != NULL ) {
+                munmap(map_ , map_size_) ;
+                map_ = NULL ;
+                map_size_ = 0 ;
+        }
+}
+
+int TrickBinaryFile::read_header() {
+
+        const size_t file_type_len = 10 ;
+        int my_byte_order ;
+        size_t pos ;
+        int num_params ;
+        int len ;
+        int ii ;
+        std::map<int, TRICK_TYPE> seven_to_ten_params  ;
+
+        seven_to_ten_params[0] = TRICK_CHARACTER ;
+        seven_to_ten_params[1] = TRICK_UNSIGNED_CHARACTER ;
+        seven_to_ten_params[2] = TRICK_STRING ;
+        seven_to_ten_params[3] = TRICK_SHORT ;
+        seven_to_ten_params[4] = TRICK_UNSIGNED_SHORT ;
+        seven_to_ten_params[5] = TRICK_INTEGER ;
+        seven_to_ten_params[6] = TRICK_UNSIGNED_INTEGER ;
+        seven_to_ten_params[7] = TRICK_LONG ;
+        seven_to_ten_params[8] = TRICK_UNSIGNED_LONG ;
+        seven_to_ten_params[9] = TRICK_FLOAT ;
+        seven_to_ten_params[10] = TRICK_DOUBLE ;
+        seven_to_ten_params[11] = TRICK_BITFIELD ;
+        seven_to_ten_params[12] = TRICK_UNSIGNED_BITFIELD ;
+        seven_to_ten_params[13] = TRICK_LONG_LONG ;
+        seven_to_ten_params[14] = TRICK_UNSIGNED_LONG_LONG ;
+        seven_to_ten_params[15] = TRICK_FILE_PTR ;
+        seven_to_ten_params[16] = TRICK_VOID ;
+        seven_to_ten_params[17] = TRICK_BOOLEAN ;
+        // 18 = TRICK_COMPLX , 19 = TRICK_DBL_COMPLX , 20 = TRICK_REF. These don't exist in 10
+        seven_to_ten_params[21] =  TRICK_WCHAR ;
+        seven_to_ten_params[22] =  TRICK_WSTRING ;
+        seven_to_ten_params[99] = TRICK_VOID_PTR ;
+        seven_to_ten_params[102] = TRICK_ENUMERATED ;
+        seven_to_ten_params[103] = TRICK_STRUCTURED ;
+
+        if ( map_size_ < file_type_len + 4 ||
+             ( strncmp( map_ , "Trick-05" , 8 ) &&
+               strncmp( map_ , "Trick-07" , 8 ) &&
+               strncmp( map_ , "Trick-10" , 8 ) ) ) {
+                return -1 ;
+        }
+        bool trick_05 = !strncmp( map_ , "Trick-05" , 8 ) ;
+        bool trick_10 = !strncmp( map_ , "Trick-10" , 8 ) ;
+
+        TRICK_GET_BYTE_ORDER(my_byte_order) ;
+        switch ( map_[file_type_len - 1] ) {
+            case 'L':
+                    swap_ = ( my_byte_order == TRICK_LITTLE_ENDIAN ) ? 0 : 1 ;
+                    break ;
+            case 'B':
+                    swap_ = ( my_byte_order == TRICK_BIG_ENDIAN ) ? 0 : 1 ;
+                    break ;
+        }
+        pos = file_type_len ;
+
+// Read a 4 byte integer from the header, failing if the header is cut short.
+#define READ_INT( VAR ) \
+        if ( pos + 4 > map_size_ ) { return -1 ; } \
+        memcpy(&VAR , map_ + pos , 4) ; \
+        pos += 4 ; \
+        if ( swap_ ) { VAR = trick_byteswap_int(VAR) ; }
+
+        READ_INT(num_params) ;
+
+        for ( ii = 0  ; ii < num_params ; ii++ ) {
+                Column column ;
+
+                // name
+                READ_INT(len) ;
+                if ( len < 0 || pos + len > map_size_ ) {
+                        return -1 ;
+                }
+                column.name.assign(map_ + pos , len) ;
+                pos += len ;
+
+                // units
+                READ_INT(len) ;
+                if ( len < 0 || pos + len > map_size_ ) {
+                        return -1 ;
+                }
+                column.units.assign(map_ + pos , len) ;
+                pos += len ;
+
+                // If this is an 05 log file, we need to convert the units to 07 units
+                // ( where explicit asterisk for multiplication is required. )
+                if ( trick_05 )  {
+                        char new_units_spec[100];
+                        new_units_spec[0] = 0;
+                        if ( convert_units_spec (column.units.c_str(), new_units_spec) != 0 ) {
+                                printf (" ERROR: Attempt to convert Trick-05 units spec \"%s\" failed.\n\n",column.units.c_str());
+                        }
+                        column.units = new_units_spec ;
+                }
+
+                // type of param
+                READ_INT(column.type) ;
+                // adjust the recorded types for 05 & 07 because they are 1 less than Trick10 types (because of Penn!)
+                if ( ! trick_10 )  {
+                    column.type = (int)seven_to_ten_params[column.type] ;
+                }
+
+                // size of param
+                READ_INT(column.size) ;
+                if ( column.size < 0 ) {
+                        return -1 ;
+                }
+
+                // correct the "type" according to the size recorded
+                switch ( column.type ) {
+                    case TRICK_LONG:
+                        if ( column.size == 4 ) {
+                            column.type = TRICK_INTEGER ;
+                        } else if ( column.size == 8 ) {
+                            column.type = TRICK_LONG_LONG ;
+                        }
+                        break ;
+                    case TRICK_UNSIGNED_LONG:
+                        if ( column.size == 4 ) {
+                            column.type = TRICK_UNSIGNED_INTEGER ;
+                        } else if ( column.size == 8 ) {
+                            column.type = TRICK_UNSIGNED_LONG_LONG ;
+                        }
+                        break ;
+                    default:
+                        break ;
+                }
+
+                if ( column.name == "sys.exec.out.time" ) {
+                        time_column_ = ii ;
+                }
+
+                column.offset = (int)record_size_ ;
+                record_size_ += column.size ;
+                columns_.push_back(column) ;
+        }
+#undef READ_INT
+
+        if ( record_size_ == 0 ) {
+                return -1 ;
+        }
+        data_offset_ = pos ;
+        num_records_ = (map_size_ - data_offset_) / record_size_ ;
+        return 0 ;
+}
+
+int TrickBinaryFile::find( const char * name ) {
+
+        for ( size_t ii = 0 ; ii < columns_.size() ; ii++ ) {
+                if ( columns_[ii].name == name ) {
+                        return (int)ii ;
+                }
+        }
+        return -1 ;
+}
+
+size_t TrickBinaryFile::num_records( bool refresh ) {
+
+        struct stat st ;
+
+        /* A log still being written may have grown. */
+        if ( refresh && fstat(fd_ , &st) == 0 && (size_t)st.st_size > map_size_ ) {
+                unmap() ;
+                if ( map() != 0 ) {
+                        num_records_ = 0 ;
+                        return 0 ;
+                }
+                num_records_ = (map_size_ - data_offset_) / record_size_ ;
+        }
+        return num_records_ ;
+}
+
+static inline unsigned long bswap_long( unsigned long bits ) {
+        return sizeof(bits) == 8 ? (unsigned long)__builtin_bswap64(bits) : (unsigned long)__builtin_bswap32(bits) ;
+}
+
+// Load a value of the given size, swapping its bytes if the file is in the other byte order.
+#define LOAD( TYPE , UINT , SWAP ) \
+        { \
+                UINT bits ; \
+                TYPE val ; \
+                memcpy(&bits , address , sizeof(bits)) ; \
+                if ( swap_ ) { bits = SWAP(bits) ; } \
+                memcpy(&val , &bits , sizeof(val)) ; \
+                return (double)val ; \
+        }
+
+double TrickBinaryFile::decode( const char * address , int index ) {
+
+        const Column & column = columns_[index] ;
+
+        switch ( column.type ) {
+                case TRICK_CHARACTER:
+                        return (double)*(const char *)address ;
+                case TRICK_UNSIGNED_CHARACTER:
+                        return (double)*(const unsigned char *)address ;
+                case TRICK_SHORT:
+                        LOAD(short , uint16_t , __builtin_bswap16) ;
+                case TRICK_UNSIGNED_SHORT:
+                        LOAD(unsigned short , uint16_t , __builtin_bswap16) ;
+                case TRICK_ENUMERATED:
+                case TRICK_INTEGER:
+                        LOAD(int , uint32_t , __builtin_bswap32) ;
+                case TRICK_UNSIGNED_INTEGER:
+                        LOAD(unsigned int , uint32_t , __builtin_bswap32) ;
+                case TRICK_LONG:
+                        LOAD(long , unsigned long , bswap_long) ;
+                case TRICK_UNSIGNED_LONG:
+                        LOAD(unsigned long , unsigned long , bswap_long) ;
+                case TRICK_FLOAT:
+                        LOAD(float , uint32_t , __builtin_bswap32) ;
+                case TRICK_DOUBLE:
+                        LOAD(double , uint64_t , __builtin_bswap64) ;
+                case TRICK_LONG_LONG:
+                        LOAD(long long , uint64_t , __builtin_bswap64) ;
+                case TRICK_UNSIGNED_LONG_LONG:
+                        LOAD(unsigned long long , uint64_t , __builtin_bswap64) ;
+                case TRICK_BITFIELD:
+                        switch ( column.size ) {
+                                case 1 :
+                                        return (double)*(const char *)address ;
+                                case 2 :
+                                        LOAD(short , uint16_t , __builtin_bswap16) ;
+                                case 4 :
+                                        LOAD(int , uint32_t , __builtin_bswap32) ;
+                        }
+                        break ;
+                case TRICK_UNSIGNED_BITFIELD:
+                        switch ( column.size ) {
+                                case 1 :
+                                        return (double)*(const unsigned char *)address ;
+                                case 2 :
+                                        LOAD(unsigned short , uint16_t , __builtin_bswap16) ;
+                                case 4 :
+                                        LOAD(unsigned int , uint32_t , __builtin_bswap32) ;
+                        }
+                        break ;
+                case TRICK_BOOLEAN:
+                        switch ( column.size ) {
+                                case 1 :
+                                        return (double)*(const unsigned char *)address ;
+                                case 4 :
+                                        LOAD(int , uint32_t , __builtin_bswap32) ;
+                        }
+                        break ;
+        }
+        return 0.0 ;
+}
+#undef LOAD
+
+void TrickBinaryFile::use( int column ) {
+
+        if ( decoded_.find(column) != decoded_.end() ) {
+                return ;
+        }
+        /* The blocks decoded so far lack the new column, so they are decoded again. */
+        clear_blocks() ;
+        decoded_[column] ;
+}
+
+void TrickBinaryFile::clear_blocks() {
+
+        std::map< int , std::vector< std::vector< double > > >::iterator it ;
+
+        for ( it = decoded_.begin() ; it != decoded_.end() ; it++ ) {
+                it->second.clear() ;
+        }
+        block_sizes_.clear() ;
+        decoded_bytes_ = 0 ;
+}
+
+/*
+ * Decode a block of records, walking its records once and decoding every column in
+ * use from each.
+ */
+void TrickBinaryFile::decode_block( size_t block ) {
+
+        std::map< int , std::vector< std::vector< double > > >::iterator it ;
+        std::vector< double * > values ;
+        std::vector< int > indexes ;
+        size_t first = block * block_records ;
+        size_t count = std::min(block_records , num_records_ - first) ;
+
+        if ( decoded_bytes_ + count * decoded_.size() * sizeof(double) > max_decoded_bytes ) {
+                clear_blocks() ;
+        }
+        if ( block_sizes_.size() <= block ) {
+                block_sizes_.resize(block + 1 , 0) ;
+        }
+        for ( it = decoded_.begin() ; it != decoded_.end() ; it++ ) {
+                if ( it->second.size() <= block ) {
+                        it->second.resize(block + 1) ;
+                }
+                it->second[block].resize(count) ;
+                values.push_back(&it->second[block][0]) ;
+                indexes.push_back(it->first) ;
+        }
+        for ( size_t ii = block_sizes_[block] ; ii < count ; ii++ ) {
+                const char * record = map_ + data_offset_ + (first + ii) * record_size_ ;
+                for ( size_t jj = 0 ; jj < indexes.size() ; jj++ ) {
+                        values[jj][ii] = decode(record + columns_[indexes[jj]].offset , indexes[jj]) ;
+                }
+        }
+        decoded_bytes_ += (count - block_sizes_[block]) * decoded_.size() * sizeof(double) ;
+        block_sizes_[block] = count ;
+}
+
+double TrickBinaryFile::value( size_t record , int column ) {
+
+        std::map< int , std::vector< std::vector< double > > >::iterator it = decoded_.find(column) ;
+        if ( it != decoded_.end() ) {
+                size_t block = record / block_records ;
+                size_t offset = record % block_records ;
+                if ( block >= block_sizes_.size() || offset >= block_sizes_[block] ) {
+                        decode_block(block) ;
+                }
+                return it->second[block][offset] ;
+        }
+        return decode(map_ + data_offset_ + record * record_size_ + columns_[column].offset , column) ;
+}
+
+/*
+ * The sidecar holds "TrickIdx-L" or "TrickIdx-B" for the byte order of the rest, the
+ * stride as an int, 1 if the times never decrease as an int, the number of records
+ * covered as a long long, and the time of every stride'th record as doubles.
+ */
+int TrickBinaryFile::read_index() {
+
+        std::string index_name = file_name_ + ".idx" ;
+        char magic[10] ;
+        int stride ;
+        int monotonic ;
+        long long num_indexed ;
+        int my_byte_order ;
+        int swap = 0 ;
+        FILE * fp ;
+
+        if ((fp = fopen(index_name.c_str() , "r")) == NULL ) {
+                return -1 ;
+        }
+        if ( fread(magic , sizeof(magic) , 1 , fp) != 1 || strncmp(magic , "TrickIdx-" , 9) ||
+             fread(&stride , sizeof(stride) , 1 , fp) != 1 ||
+             fread(&monotonic , sizeof(monotonic) , 1 , fp) != 1 ||
+             fread(&num_indexed , sizeof(num_indexed) , 1 , fp) != 1 ) {
+                fclose(fp) ;
+                return -1 ;
+        }
+        TRICK_GET_BYTE_ORDER(my_byte_order) ;
+        swap = ( magic[9] == 'L' ) != ( my_byte_order == TRICK_LITTLE_ENDIAN ) ;
+        if ( swap ) {
+                stride = trick_byteswap_int(stride) ;
+                monotonic = trick_byteswap_int(monotonic) ;
+                num_indexed = trick_byteswap_long_long(num_indexed) ;
+        }
+        /* The index is stale if it covers records the log does not have. */
+        if ( stride <= 0 || num_indexed < 0 || (size_t)num_indexed > num_records_ ) {
+                fclose(fp) ;
+                return -1 ;
+        }
+        size_t num_entries = ((size_t)num_indexed + stride - 1) / stride ;
+        index_times_.resize(num_entries) ;
+        if ( num_entries && fread(&index_times_[0] , sizeof(double) , num_entries , fp) != num_entries ) {
+                fclose(fp) ;
+                return -1 ;
+        }
+        fclose(fp) ;
+        if ( swap ) {
+                for ( size_t ii = 0 ; ii < num_entries ; ii++ ) {
+                        index_times_[ii] = trick_byteswap_double(index_times_[ii]) ;
+                }
+        }
+        index_stride_ = stride ;
+        index_records_ = num_indexed ;
+        index_monotonic_ = monotonic ;
+
+        /* Or if the times it holds are not those of the log. */
+        if ( num_entries &&
+             ( index_times_[0] != value(0 , time_column_) ||
+               index_times_[num_entries - 1] != value((num_entries - 1) * index_stride_ , time_column_) ) ) {
+                return -1 ;
+        }
+        return 0 ;
+}
+
+void TrickBinaryFile::build_index() {
+
+        double last_time = 0.0 ;
+
+        index_times_.clear() ;
+        index_records_ = num_records_ ;
+        index_monotonic_ = true ;
+        for ( size_t ii = 0 ; ii < index_records_ ; ii++ ) {
+                double time = decode(map_ + data_offset_ + ii * record_size_ + columns_[time_column_].offset , time_column_) ;
+                if ( ii % index_stride_ == 0 ) {
+                        index_times_.push_back(time) ;
+                }
+                if ( ii > 0 && time < last_time ) {
+                        index_monotonic_ = false ;
+                }
+                last_time = time ;
+        }
+}
+
+/* Write the sidecar next to the log.  A log in a read only directory simply goes without. */
+void TrickBinaryFile::write_index() {
+
+        std::string index_name = file_name_ + ".idx" ;
+        std::string temp_name = index_name + ".tmp" ;
+        int my_byte_order ;
+        int stride = (int)index_stride_ ;
+        int monotonic = index_monotonic_ ;
+        long long num_indexed = index_records_ ;
+        FILE * fp ;
+
+        if ((fp = fopen(temp_name.c_str() , "w")) == NULL ) {
+                return ;
+        }
+        TRICK_GET_BYTE_ORDER(my_byte_order) ;
+        fwrite(my_byte_order == TRICK_LITTLE_ENDIAN ? "TrickIdx-L" : "TrickIdx-B" , 10 , 1 , fp) ;
+        fwrite(&stride , sizeof(stride) , 1 , fp) ;
+        fwrite(&monotonic , sizeof(monotonic) , 1 , fp) ;
+        fwrite(&num_indexed , sizeof(num_indexed) , 1 , fp) ;
+        if ( ! index_times_.empty() ) {
+                fwrite(&index_times_[0] , sizeof(double) , index_times_.size() , fp) ;
+        }
+        if ( fclose(fp) != 0 || rename(temp_name.c_str() , index_name.c_str()) != 0 ) {
+                unlink(temp_name.c_str()) ;
+        }
+}
+
+/*
+ * Binary search the index for the stride holding the time, then step through the
+ * records of that stride.  Records added to the log after the index was made are
+ * stepped through from the last indexed record.
+ */
+size_t TrickBinaryFile::find_time( double time ) {
+
+        if ( ! index_loaded_ ) {
+                if ( read_index() != 0 ) {
+                        build_index() ;
+                        write_index() ;
+                }
+                index_loaded_ = true ;
+        }
+        if ( ! index_monotonic_ || index_times_.empty() ) {
+                return 0 ;
+        }
+        size_t entry = std::lower_bound(index_times_.begin() , index_times_.end() , time) - index_times_.begin() ;
+        size_t record = entry > 0 ? (entry - 1) * index_stride_ : 0 ;
+        while ( record < num_records_ && value(record , time_column_) < time ) {
+                record++ ;
+        }
+        return record ;
+}
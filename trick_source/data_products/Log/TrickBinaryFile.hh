@@ -0,0 +1,97 @@
+
+#ifndef TRICKBINARYFILE_HH
+#define TRICKBINARYFILE_HH
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <map>
+
+/*
+ * A memory mapped Trick binary log file shared by all of the TrickBinary streams
+ * reading from it.  The header is parsed once.  The columns the streams read are
+ * decoded together, a block of records at a time, so reading many variables from
+ * one file touches each record once.
+ *
+ * Seeks by time use a sparse index of the time column kept in a <file>.idx sidecar.
+ * DRBinary writes the sidecar when the log is closed.  A missing or stale sidecar is
+ * rebuilt on the first seek.
+ */
+class TrickBinaryFile {
+
+       public:
+               struct Column {
+                       std::string name ;
+                       std::string units ;
+                       int type ;
+                       int size ;
+                       int offset ;
+               } ;
+
+               /* Open the named file, or share it if it is already open. Returns NULL on failure. */
+               static TrickBinaryFile * open( const char * file_name ) ;
+
+               /* Release a file returned by open. */
+               static void close( TrickBinaryFile * file ) ;
+
+               /* Index of the named column, -1 if the file does not hold it. */
+               int find( const char * name ) ;
+
+               /* Ask for the column to be decoded with the others in use. */
+               void use( int column ) ;
+
+               /* Number of complete records, remapping the file if it has grown since it was mapped. */
+               size_t num_records( bool refresh = false ) ;
+
+               /* Value of a column in a record. */
+               double value( size_t record , int column ) ;
+
+               /* First record at or after the time.  Record 0 if the times in the file ever decrease. */
+               size_t find_time( double time ) ;
+
+               const Column & column( int index ) { return columns_[index] ; }
+               int time_column() { return time_column_ ; }
+
+       private:
+               TrickBinaryFile( const std::string & file_name ) ;
+               ~TrickBinaryFile() ;
+
+               int map() ;
+               void unmap() ;
+               int read_header() ;
+               double decode( const char * address , int column ) ;
+               void decode_block( size_t block ) ;
+               void clear_blocks() ;
+               int read_index() ;
+               void build_index() ;
+               void write_index() ;
+
+               std::string file_name_ ;
+               int ref_count_ ;
+               int fd_ ;
+               char * map_ ;
+               size_t map_size_ ;
+               int swap_ ;
+               size_t data_offset_ ;
+               size_t record_size_ ;
+               size_t num_records_ ;
+               std::vector< Column > columns_ ;
+               int time_column_ ;
+
+               /* Decoded values of the columns in use by block, and the number of records decoded in each block. */
+               std::map< int , std::vector< std::vector< double > > > decoded_ ;
+               std::vector< size_t > block_sizes_ ;
+               size_t decoded_bytes_ ;
+
+               /* Time of every index_stride_'th record of the first index_records_ records, from the
+                  <file>.idx sidecar or built on the first seek. */
+               std::vector< double > index_times_ ;
+               size_t index_stride_ ;
+               size_t index_records_ ;
+               bool index_monotonic_ ;
+               bool index_loaded_ ;
+
+               static std::map< std::string , TrickBinaryFile * > open_files_ ;
+} ;
+
+#endif
@@ -0,0 +1,493 @@
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "TrickCompressed.hh"
+#include "trick/parameter_types.h"
+#include "trick/dr_compress.h"
+#include "trick_byte_order.h"
+#include "trick_byteswap.h"
+#include "trick/map_trick_units_to_udunits.hh"
+
+// Size of the index trailer: number of chunks, index offset, and the "TrkZIndx" marker
+static const long trailer_size = 4 + 8 + 8 ;
+
+// Size of one index entry: offset, rows, start time, end time
+static const long index_entry_size = 8 + 4 + 8 + 8 ;
+
+static int readInt( FILE * fp , int swap , int * value ) {
+        if ( fread(value , 4 , 1 , fp ) != 1 ) {
+                return 0 ;
+        }
+        if ( swap ) { *value = trick_byteswap_int(*value) ; }
+        return 1 ;
+}
+
+static int readString( FILE * fp , int swap , std::string & str ) {
+        int len ;
+        if ( ! readInt(fp , swap , &len) || len < 0 ) {
+                return 0 ;
+        }
+        str.resize(len) ;
+        if ( len > 0 && fread(&str[0] , len , 1 , fp ) != 1 ) {
+                return 0 ;
+        }
+        return 1 ;
+}
+
+static long long getLongLong( const unsigned char * cp , int swap ) {
+        long long value ;
+        memcpy(&value , cp , 8) ;
+        return swap ? trick_byteswap_long_long(value) : value ;
+}
+
+static double getDouble( const unsigned char * cp , int swap ) {
+        double value ;
+        memcpy(&value , cp , 8) ;
+        return swap ? trick_byteswap_double(value) : value ;
+}
+
+static int getInt( const unsigned char * cp , int swap ) {
+        int value ;
+        memcpy(&value , cp , 4) ;
+        return swap ? trick_byteswap_int(value) : value ;
+}
+
+// Reads the header of a .trz file.  Returns 1 if the file is a compressed log file.
+static int TrickCompressedReadHeader( FILE * fp , int * swap ,
+                                      std::vector<std::string> & names ,
+                                      std::vector<std::string> & units ,
+                                      std::vector<int> & types ,
+                                      std::vector<int> & sizes ) {
+
+        const int file_type_len = 10 ;
+        char file_type[file_type_len + 1] ;
+        int my_byte_order ;
+        int num_params ;
+        int rows_per_chunk ;
+        int type , size ;
+        std::string name , unit ;
+        int ii ;
+
+        memset(file_type, 0 , file_type_len + 1 ) ;
+        if ( fread(file_type , file_type_len , 1 , fp ) != 1 ||
+             strncmp( file_type , "Trick-Z1" , 8 ) ) {
+                return 0 ;
+        }
+
+        TRICK_GET_BYTE_ORDER(my_byte_order) ;
+        if ( file_type[file_type_len - 1] == 'L' ) {
+                *swap = ( my_byte_order == TRICK_LITTLE_ENDIAN ) ? 0 : 1 ;
+        } else {
+                *swap = ( my_byte_order == TRICK_BIG_ENDIAN ) ? 0 : 1 ;
+        }
+
+        if ( ! readInt(fp , *swap , &num_params) || num_params <= 0 ) {
+                return 0 ;
+        }
+        for ( ii = 0 ; ii < num_params ; ii++ ) {
+                if ( ! readString(fp , *swap , name) ||
+                     ! readString(fp , *swap , unit) ||
+                     ! readInt(fp , *swap , &type) ||
+                     ! readInt(fp , *swap , &size) ||
+                     size <= 0 ) {
+                        return 0 ;
+                }
+                names.push_back(name) ;
+                units.push_back(unit) ;
+                types.push_back(type) ;
+                sizes.push_back(size) ;
+        }
+        if ( ! readInt(fp , *swap , &rows_per_chunk) ) {
+                return 0 ;
+        }
+        return 1 ;
+}
+
+// Converts one recorded value to a double
+static double toDouble( const unsigned char * cp , int type , int size , int swap ) {
+
+        switch ( type ) {
+                case TRICK_CHARACTER:
+                        return (double)*(const char *)cp ;
+                case TRICK_UNSIGNED_CHARACTER:
+                        return (double)*cp ;
+                case TRICK_FLOAT: {
+                        float f ;
+                        memcpy(&f , cp , 4) ;
+                        return (double)(swap ? trick_byteswap_float(f) : f) ;
+                }
+                case TRICK_DOUBLE:
+                        return getDouble(cp , swap) ;
+                case TRICK_SHORT:
+                case TRICK_INTEGER:
+                case TRICK_ENUMERATED:
+                case TRICK_LONG:
+                case TRICK_LONG_LONG:
+                case TRICK_BITFIELD:
+                case TRICK_BOOLEAN:
+                        switch ( size ) {
+                                case 1 : return (double)*(const char *)cp ;
+                                case 2 : {
+                                        short s ;
+                                        memcpy(&s , cp , 2) ;
+                                        return (double)(swap ? trick_byteswap_short(s) : s) ;
+                                }
+                                case 4 : return (double)getInt(cp , swap) ;
+                                case 8 : return (double)getLongLong(cp , swap) ;
+                        }
+                        break ;
+                case TRICK_UNSIGNED_SHORT:
+                case TRICK_UNSIGNED_INTEGER:
+                case TRICK_UNSIGNED_LONG:
+                case TRICK_UNSIGNED_LONG_LONG:
+                case TRICK_UNSIGNED_BITFIELD:
+                        switch ( size ) {
+                                case 1 : return (double)*cp ;
+                                case 2 : {
+                                        short s ;
+                                        memcpy(&s , cp , 2) ;
+                                        return (double)(unsigned short)(swap ? trick_byteswap_short(s) : s) ;
+                                }
+                                case 4 : return (double)(unsigned int)getInt(cp , swap) ;
+                                case 8 : return (double)(unsigned long long)getLongLong(cp , swap) ;
+                        }
+                        break ;
+        }
+        return 0.0 ;
+}
+
+TrickCompressed::TrickCompressed(char * file_name , char * param_name ) :
+ fp_(0) , swap_(0) , num_params_(0) , param_index_(-1) , type_(0) , size_(0) , data_offset_(0) ,
+ curr_chunk_(0) , curr_row_(0) , loaded_chunk_(-1) {
+
+        std::vector<std::string> names , units ;
+        std::vector<int> types ;
+        int ii ;
+
+        fileName_ = file_name ;
+
+        if ((fp_ = fopen(file_name , "r")) == 0 ) {
+                std::cerr << "ERROR:  Couldn't open \"" << file_name << "\": " << std::strerror(errno) << std::endl;
+                return ;
+        }
+
+        if ( ! TrickCompressedReadHeader(fp_ , &swap_ , names , units , types , sizes_ )) {
+                std::cerr << "ERROR:  \"" << file_name << "\" is not a compressed Trick log file" << std::endl;
+                return ;
+        }
+        data_offset_ = ftell(fp_) ;
+        num_params_ = names.size() ;
+
+        unitTimeStr_ = units[0] ;
+        for ( ii = 0 ; ii < num_params_ ; ii++ ) {
+                if ( names[ii] == param_name ) {
+                        if ( units[ii] == "--" ) {
+                                unitStr_ = units[ii] ;
+                        } else {
+                                unitStr_ = map_trick_units_to_udunits(units[ii]) ;
+                        }
+                        param_index_ = ii ;
+                        type_ = types[ii] ;
+                        size_ = sizes_[ii] ;
+                        break ;
+                }
+        }
+
+        // A file without an index was not shut down cleanly, find the chunks by their headers
+        if ( ! readIndex() ) {
+                scanChunks() ;
+        }
+}
+
+TrickCompressed::~TrickCompressed()
+{
+        if ( fp_ ) {
+                fclose(fp_);
+        }
+}
+
+int TrickCompressed::readIndex() {
+
+        unsigned char trailer[trailer_size] ;
+        std::vector<unsigned char> index ;
+        long file_size ;
+        long long index_offset ;
+        int num_chunks ;
+        int ii ;
+
+        fseek(fp_ , 0 , SEEK_END) ;
+        file_size = ftell(fp_) ;
+        if ( file_size - data_offset_ < trailer_size ||
+             fseek(fp_ , file_size - trailer_size , SEEK_SET) ||
+             fread(trailer , trailer_size , 1 , fp_ ) != 1 ||
+             memcmp(trailer + 12 , "TrkZIndx" , 8) ) {
+                return 0 ;
+        }
+
+        num_chunks = getInt(trailer , swap_) ;
+        index_offset = getLongLong(trailer + 4 , swap_) ;
+        if ( num_chunks < 0 || index_offset < data_offset_ ||
+             index_offset + num_chunks * index_entry_size + trailer_size != file_size ) {
+                return 0 ;
+        }
+
+        index.resize(num_chunks * index_entry_size + 1) ;
+        fseek(fp_ , index_offset , SEEK_SET) ;
+        if ( num_chunks > 0 && fread(&index[0] , num_chunks * index_entry_size , 1 , fp_ ) != 1 ) {
+                return 0 ;
+        }
+        chunks_.resize(num_chunks) ;
+        for ( ii = 0 ; ii < num_chunks ; ii++ ) {
+                const unsigned char * entry = &index[ii * index_entry_size] ;
+                chunks_[ii].offset = getLongLong(entry , swap_) ;
+                chunks_[ii].num_rows = getInt(entry + 8 , swap_) ;
+                chunks_[ii].start_time = getDouble(entry + 12 , swap_) ;
+                chunks_[ii].end_time = getDouble(entry + 20 , swap_) ;
+        }
+        return 1 ;
+}
+
+void TrickCompressed::scanChunks() {
+
+        unsigned char times[16] ;
+        Chunk chunk ;
+        long long data_bytes ;
+        int column_bytes ;
+        int ii ;
+
+        chunks_.clear() ;
+        fseek(fp_ , data_offset_ , SEEK_SET) ;
+        while ( 1 ) {
+                chunk.offset = ftell(fp_) ;
+                if ( ! readInt(fp_ , swap_ , &chunk.num_rows) || chunk.num_rows <= 0 ||
+                     fread(times , 16 , 1 , fp_ ) != 1 ) {
+                        break ;
+                }
+                chunk.start_time = getDouble(times , swap_) ;
+                chunk.end_time = getDouble(times + 8 , swap_) ;
+                data_bytes = 0 ;
+                for ( ii = 0 ; ii < num_params_ ; ii++ ) {
+                        if ( ! readInt(fp_ , swap_ , &column_bytes) ) {
+                                return ;
+                        }
+                        data_bytes += column_bytes ;
+                }
+                // A truncated last chunk is dropped
+                if ( fseek(fp_ , data_bytes - 1 , SEEK_CUR) || fgetc(fp_) == EOF ) {
+                        break ;
+                }
+                chunks_.push_back(chunk) ;
+        }
+}
+
+/*
+ * Reads the chunk header, then decompresses the time column and the parameter column.
+ * The other columns are skipped.
+ */
+int TrickCompressed::loadChunk( unsigned int chunk ) {
+
+        std::vector<int> column_bytes(num_params_) ;
+        long column_offset ;
+        int num_rows ;
+        int ii ;
+
+        if ( (int)chunk == loaded_chunk_ ) {
+                return 1 ;
+        }
+        loaded_chunk_ = -1 ;
+        if ( param_index_ < 0 || chunk >= chunks_.size() ) {
+                return 0 ;
+        }
+
+        fseek(fp_ , chunks_[chunk].offset + 4 + 16 , SEEK_SET) ;
+        num_rows = chunks_[chunk].num_rows ;
+        for ( ii = 0 ; ii < num_params_ ; ii++ ) {
+                if ( ! readInt(fp_ , swap_ , &column_bytes[ii]) ) {
+                        return 0 ;
+                }
+        }
+
+        column_offset = ftell(fp_) ;
+        for ( ii = 0 ; ii <= param_index_ ; ii++ ) {
+                if ( ii == 0 || ii == param_index_ ) {
+                        std::vector<unsigned char> & column = ( ii == 0 ) ? time_col_ : param_col_ ;
+                        packed_.resize(column_bytes[ii] + 1) ;
+                        column.resize(num_rows * sizes_[ii]) ;
+                        fseek(fp_ , column_offset , SEEK_SET) ;
+                        if ( fread(&packed_[0] , column_bytes[ii] , 1 , fp_ ) != 1 ||
+                             dr_decompress_column(&packed_[0] , column_bytes[ii] , num_rows , sizes_[ii] , &column[0]) ) {
+                                std::cerr << "ERROR:  \"" << fileName_ << "\" chunk " << chunk << " is corrupt" << std::endl;
+                                return 0 ;
+                        }
+                }
+                column_offset += column_bytes[ii] ;
+        }
+        if ( param_index_ == 0 ) {
+                param_col_ = time_col_ ;
+        }
+
+        loaded_chunk_ = chunk ;
+        return 1 ;
+}
+
+int TrickCompressed::readValue( double * time , double * value ) {
+
+        while ( curr_chunk_ < chunks_.size() ) {
+                if ( curr_row_ < chunks_[curr_chunk_].num_rows ) {
+                        if ( ! loadChunk(curr_chunk_) ) {
+                                return 0 ;
+                        }
+                        *time = getDouble(&time_col_[curr_row_ * 8] , swap_) ;
+                        *value = toDouble(&param_col_[curr_row_ * size_] , type_ , size_ , swap_) ;
+                        return 1 ;
+                }
+                curr_chunk_++ ;
+                curr_row_ = 0 ;
+        }
+        return 0 ;
+}
+
+int TrickCompressed::get( double * time , double * value ) {
+
+        if ( readValue(time , value) ) {
+                curr_row_++ ;
+                return(1) ;
+        }
+        return(0) ;
+}
+
+int TrickCompressed::peek( double * time , double * value ) {
+        return readValue(time , value) ;
+}
+
+/*
+ * Binary searches the chunk index for the first chunk ending at or after timeStamp,
+ * then looks for the row inside that chunk.
+ */
+int TrickCompressed::getValueAtTime( double timeStamp , double * paramValue ) {
+
+        unsigned int lo = 0 ;
+        unsigned int hi = chunks_.size() ;
+        unsigned int mid ;
+        double value_time ;
+
+        while ( lo < hi ) {
+                mid = (lo + hi) / 2 ;
+                if ( chunks_[mid].end_time < timeStamp - 1e-9 ) {
+                        lo = mid + 1 ;
+                } else {
+                        hi = mid ;
+                }
+        }
+
+        curr_chunk_ = lo ;
+        curr_row_ = 0 ;
+        while ( get( &value_time , paramValue ) ) {
+                if ( fabs( value_time - timeStamp ) <= 1e-9 ) {
+                        return(1) ;
+                }
+                if ( value_time > timeStamp ) {
+                        break ;
+                }
+        }
+        return(0) ;
+}
+
+void TrickCompressed::begin() {
+        curr_chunk_ = 0 ;
+        curr_row_ = 0 ;
+        return ;
+}
+
+int TrickCompressed::end() {
+
+        unsigned int ii ;
+
+        if ( curr_chunk_ < chunks_.size() && curr_row_ < chunks_[curr_chunk_].num_rows ) {
+                return(0) ;
+        }
+        for ( ii = curr_chunk_ + 1 ; ii < chunks_.size() ; ii++ ) {
+                if ( chunks_[ii].num_rows > 0 ) {
+                        return(0) ;
+                }
+        }
+        return(1) ;
+}
+
+int TrickCompressed::step() {
+
+        double time , value ;
+
+        return get(&time , &value) ;
+}
+
+int TrickCompressedGetNumVariables(const char* file_name) {
+
+        std::vector<std::string> names , units ;
+        std::vector<int> types , sizes ;
+        FILE *fp ;
+        int swap ;
+
+        if ((fp = fopen(file_name , "r")) == 0 ) {
+                std::cerr << "ERROR:  Couldn't open \"" << file_name << "\": " << std::strerror(errno) << std::endl;
+                return(0) ;
+        }
+        TrickCompressedReadHeader(fp , &swap , names , units , types , sizes) ;
+        fclose(fp) ;
+
+        return names.size() ;
+}
+
+char** TrickCompressedGetVariableNames(const char* file_name) {
+
+        std::vector<std::string> names , units ;
+        std::vector<int> types , sizes ;
+        FILE *fp ;
+        int swap ;
+        unsigned int ii ;
+        char** variable_names = 0 ;
+
+        if ((fp = fopen(file_name , "r")) == 0 ) {
+                std::cerr << "ERROR:  Couldn't open \"" << file_name << "\": " << std::strerror(errno) << std::endl;
+                return(0) ;
+        }
+        if ( TrickCompressedReadHeader(fp , &swap , names , units , types , sizes) ) {
+                variable_names = new char*[names.size()] ;
+                for ( ii = 0 ; ii < names.size() ; ii++ ) {
+                        variable_names[ii] = new char[names[ii].length() + 1] ;
+                        strcpy(variable_names[ii] , names[ii].c_str()) ;
+                }
+        }
+        fclose(fp) ;
+
+        return( variable_names ) ;
+}
+
+int TrickCompressedLocateParam( const char * file_name , const char * param_name ) {
+
+        std::vector<std::string> names , units ;
+        std::vector<int> types , sizes ;
+        FILE *fp ;
+        int swap ;
+        unsigned int ii ;
+        int found = 0 ;
+
+        if ((fp = fopen(file_name , "r")) == 0 ) {
+                return 0 ;
+        }
+        if ( TrickCompressedReadHeader(fp , &swap , names , units , types , sizes) ) {
+                for ( ii = 0 ; ii < names.size() ; ii++ ) {
+                        if ( names[ii] == param_name ) {
+                                found = 1 ;
+                                break ;
+                        }
+                }
+        }
+        fclose(fp) ;
+
+        return(found) ;
+}
@@ -0,0 +1,64 @@
+
+#ifndef TRICKCOMPRESSED_HH
+#define TRICKCOMPRESSED_HH
+
+#include <stdio.h>
+#include <vector>
+#include <string>
+#include "DataStream.hh"
+
+// Reads one parameter from a Trick::DRCompressed log file (.trz).
+// Only the time column and the parameter's column of a chunk are decompressed.
+class TrickCompressed : public DataStream {
+
+       public:
+               TrickCompressed(char * file, char * param ) ;
+               ~TrickCompressed() ;
+
+               int get(double * time , double * value ) ;
+               int peek(double * time , double * value ) ;
+
+               // Uses the chunk index to go straight to the chunk holding timeStamp
+               int getValueAtTime(double timeStamp, double * paramValue ) ;
+
+               void begin() ;
+               int end() ;
+               int step() ;
+
+       private:
+               struct Chunk {
+                       long long offset ;
+                       int num_rows ;
+                       double start_time ;
+                       double end_time ;
+               } ;
+
+               int readIndex() ;
+               void scanChunks() ;
+               int loadChunk( unsigned int chunk ) ;
+               int readValue( double * time , double * value ) ;
+
+               FILE *fp_ ;
+               int swap_ ;
+               int num_params_ ;
+               int param_index_ ;
+               int type_ ;
+               int size_ ;
+               long data_offset_ ;
+
+               std::vector<int> sizes_ ;
+               std::vector<Chunk> chunks_ ;
+
+               unsigned int curr_chunk_ ;
+               int curr_row_ ;
+               int loaded_chunk_ ;
+               std::vector<unsigned char> packed_ ;
+               std::vector<unsigned char> time_col_ ;
+               std::vector<unsigned char> param_col_ ;
+} ;
+
+int    TrickCompressedLocateParam( const char * file_name , const char * param_name ) ;
+char** TrickCompressedGetVariableNames(const char* file_name) ;
+int    TrickCompressedGetNumVariables(const char* file_name) ;
+
+#endif
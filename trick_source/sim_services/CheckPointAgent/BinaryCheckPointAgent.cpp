@@ -0,0 +1,1375 @@
+#include "trick/MemoryManager.hh"
+#include "trick/BinaryCheckPointAgent.hh"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <libgen.h>
+
+/*
+ File layout, all values in the byte order of the writer:
+   header      magic[8] version byte_order pointer_size long_size                (4 bytes each)
+               id base_id num_allocs table_size data_size num_pointers num_strings  (8 bytes each)
+   table       base_name, then num_allocs entries:
+               name type_name type flags size num num_index index[] hash data_offset data_size
+   data        data_size bytes, the raw block of each allocation
+   pointers    num_pointers BinaryCheckPointPointer records
+   strings     num_strings records: alloc kind offset length bytes[length]
+
+ Every checkpoint has an id that differs from all other checkpoints.  A delta names the checkpoint it
+ is based on and records its id, base_id is 0 in a full checkpoint.  Its allocations marked unchanged
+ have no data block, pointers, or strings in the delta, they are found by name in the base.
+*/
+
+static const char binary_checkpoint_magic[8] = { 'T', 'R', 'I', 'C', 'K', 'B', 'C', 'P' } ;
+static const uint32_t binary_checkpoint_version = 3 ;
+static const uint32_t byte_order_mark = 0x01020304 ;
+
+/* allocation table entry flags */
+static const int32_t ALLOC_DECLARE = 0x1 ;  // a local allocation that restore declares
+static const int32_t ALLOC_DATA = 0x2 ;     // the allocation has a raw block
+static const int32_t ALLOC_UNCHANGED = 0x4 ; // the raw block, pointers and strings are in the base checkpoint
+
+/* string record kinds */
+static const uint32_t STRING_STD = 0 ;      // std::string
+static const uint32_t STRING_CHAR_PTR = 1 ; // char * to a string outside of managed memory
+
+/* Large blocks of plain data are split into chunks of this size so they are restored in parallel. */
+static const uint64_t restore_chunk_size = 64 * 1024 * 1024 ;
+static const uint64_t pointers_per_job = 64 * 1024 ;
+static const size_t write_buffer_size = 4 * 1024 * 1024 ;
+/* Longest chain of deltas followed when restoring, guards against a delta that is its own base. */
+static const unsigned int max_chain_length = 64 ;
+
+static void put_u32( std::string & s, uint32_t value ) {
+    s.append((const char *)&value, sizeof(value)) ;
+}
+
+static void put_u64( std::string & s, uint64_t value ) {
+    s.append((const char *)&value, sizeof(value)) ;
+}
+
+static void put_string( std::string & s, const std::string & value ) {
+    put_u32(s, value.size()) ;
+    s.append(value) ;
+}
+
+static bool get_bytes( const char *& p, const char * end, void * value, size_t size ) {
+    if ( (size_t)(end - p) < size ) {
+        return false ;
+    }
+    memcpy(value, p, size) ;
+    p += size ;
+    return true ;
+}
+
+static bool get_u32( const char *& p, const char * end, uint32_t & value ) {
+    return get_bytes(p, end, &value, sizeof(value)) ;
+}
+
+static bool get_u64( const char *& p, const char * end, uint64_t & value ) {
+    return get_bytes(p, end, &value, sizeof(value)) ;
+}
+
+static bool get_string( const char *& p, const char * end, std::string & value ) {
+    uint32_t len ;
+    if ( !get_u32(p, end, len) or (size_t)(end - p) < len ) {
+        return false ;
+    }
+    value.assign(p, len) ;
+    p += len ;
+    return true ;
+}
+
+static void hash_value( uint64_t & hash , uint64_t value ) {
+    for ( unsigned int ii = 0 ; ii < sizeof(value) ; ii++ ) {
+        hash ^= (value >> (ii * 8)) & 0xff ;
+        hash *= 0x100000001b3ULL ;
+    }
+}
+
+/* An id for a new checkpoint, different for every checkpoint written by any process.  Never 0. */
+static uint64_t new_checkpoint_id() {
+    static uint64_t count = 0 ;
+    struct timespec now ;
+    uint64_t id = 0xcbf29ce484222325ULL ;
+
+    clock_gettime(CLOCK_REALTIME, &now) ;
+    hash_value(id, now.tv_sec) ;
+    hash_value(id, now.tv_nsec) ;
+    hash_value(id, getpid()) ;
+    hash_value(id, ++count) ;
+    return id != 0 ? id : 1 ;
+}
+
+static std::string dir_name( std::string path ) {
+    return std::string(dirname(&path[0])) ;
+}
+
+static std::string base_name( std::string path ) {
+    return std::string(basename(&path[0])) ;
+}
+
+/* Hash of the contents of an allocation.  Used only to find allocations that changed, a word at a time. */
+static uint64_t hash_bytes( uint64_t hash , const char * p , size_t len ) {
+    uint64_t word ;
+    for ( ; len >= sizeof(word) ; p += sizeof(word) , len -= sizeof(word) ) {
+        memcpy(&word, p, sizeof(word)) ;
+        hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL ;
+        hash ^= hash >> 29 ;
+    }
+    word = 0 ;
+    memcpy(&word, p, len) ;
+    hash = (hash ^ word ^ len) * 0x9e3779b97f4a7c15ULL ;
+    return hash ^ (hash >> 29) ;
+}
+
+// MEMBER FUNCTION
+Trick::BinaryCheckPointAgent::BinaryCheckPointAgent( Trick::MemoryManager *MM) :
+ ClassicCheckPointAgent(MM) ,
+ num_threads(0) ,
+ max_deltas(0) ,
+ base_id(0) ,
+ num_deltas(0) ,
+ written_id(0) ,
+ track_hashes(false) ,
+ write_delta(false) ,
+ wrote_file(false) ,
+ next_job(0) ,
+ bad_pointer_count(0) {
+    pthread_mutex_init(&job_mutex, NULL) ;
+}
+
+// MEMBER FUNCTION
+Trick::BinaryCheckPointAgent::~BinaryCheckPointAgent() {
+    std::map< ATTRIBUTES *, BinaryCheckPointLayout * >::iterator it ;
+
+    clear_tables() ;
+    for ( it = type_layouts.begin() ; it != type_layouts.end() ; it++ ) {
+        delete it->second ;
+    }
+    pthread_mutex_destroy(&job_mutex) ;
+}
+
+// MEMBER FUNCTION
+void Trick::BinaryCheckPointAgent::clear_tables() {
+    unsigned int ii ;
+    for ( ii = 0 ; ii < allocs.size() ; ii++ ) {
+        delete allocs[ii].layout ;
+    }
+    allocs.clear() ;
+    alloc_index_of.clear() ;
+    pointers.clear() ;
+    string_values.clear() ;
+    jobs.clear() ;
+}
+
+/*
+ Append the member described by attr to the layout.  Adjacent plain data members are merged
+ into one RAW segment.  Only the plain data of static members is kept.
+*/
+void Trick::BinaryCheckPointAgent::add_member( BinaryCheckPointLayout * layout, ATTRIBUTES * attr, long offset, bool is_static) {
+
+    BinaryCheckPointSegment seg ;
+    int ii ;
+    int first_ptr_dim = attr->num_index ;
+    size_t count = 1 ;
+
+    for ( ii = 0 ; ii < attr->num_index ; ii++ ) {
+        if ( attr->index[ii].size == 0 ) {
+            first_ptr_dim = ii ;
+            break ;
+        }
+        count *= attr->index[ii].size ;
+    }
+
+    seg.kind = BinaryCheckPointSegment::RAW ;
+    seg.offset = offset ;
+    seg.is_static = is_static ;
+    seg.is_char_ptr = false ;
+    seg.size = 0 ;
+    seg.count = count ;
+    seg.attr = attr ;
+    seg.sub_layout = NULL ;
+
+    if ( first_ptr_dim < attr->num_index or attr->type == TRICK_VOID_PTR ) {
+        seg.kind = BinaryCheckPointSegment::POINTER ;
+        seg.size = sizeof(void *) ;
+        seg.is_char_ptr = (attr->type == TRICK_CHARACTER and first_ptr_dim == attr->num_index - 1) ;
+    } else {
+        switch ( attr->type ) {
+            case TRICK_STRUCTURED:
+                if ( attr->attr == NULL ) {
+                    return ;
+                }
+                seg.sub_layout = get_type_layout((ATTRIBUTES *)attr->attr) ;
+                if ( seg.sub_layout->segments.empty() ) {
+                    return ;
+                }
+                // A type that is entirely plain data with no padding is copied as one block.
+                if ( seg.sub_layout->segments.size() == 1 and
+                     seg.sub_layout->segments[0].kind == BinaryCheckPointSegment::RAW and
+                     !seg.sub_layout->segments[0].is_static and
+                     seg.sub_layout->segments[0].offset == 0 and
+                     seg.sub_layout->segments[0].size == (size_t)attr->size ) {
+                    seg.size = count * attr->size ;
+                    seg.sub_layout = NULL ;
+                } else {
+                    seg.kind = BinaryCheckPointSegment::ARRAY ;
+                    seg.size = attr->size ;
+                }
+                break ;
+            case TRICK_STRING:
+                seg.kind = BinaryCheckPointSegment::STRING ;
+                seg.size = sizeof(std::string) ;
+                break ;
+            case TRICK_STL:
+                seg.kind = BinaryCheckPointSegment::STL ;
+                seg.size = attr->size ;
+                break ;
+            case TRICK_VOID:
+            case TRICK_FILE_PTR:
+            case TRICK_WSTRING:
+            case TRICK_OPAQUE_TYPE:
+                return ;
+            default:
+                // Bitfields are copied as their whole storage unit.
+                seg.size = count * attr->size ;
+                break ;
+        }
+    }
+
+    if ( is_static and seg.kind != BinaryCheckPointSegment::RAW ) {
+        return ;
+    }
+
+    if ( seg.kind == BinaryCheckPointSegment::RAW and !is_static and !layout->segments.empty() ) {
+        BinaryCheckPointSegment & last = layout->segments.back() ;
+        if ( last.kind == BinaryCheckPointSegment::RAW and !last.is_static and
+             seg.offset >= last.offset and seg.offset <= last.offset + (long)last.size ) {
+            last.size = std::max(last.offset + last.size, seg.offset + seg.size) - last.offset ;
+            return ;
+        }
+    }
+    layout->segments.push_back(seg) ;
+}
+
+// MEMBER FUNCTION
+void Trick::BinaryCheckPointAgent::finish_layout( BinaryCheckPointLayout * layout) {
+
+    std::vector< BinaryCheckPointSegment >::iterator it ;
+
+    layout->raw_size = 0 ;
+    layout->hash = 0xcbf29ce484222325ULL ;
+    for ( it = layout->segments.begin() ; it != layout->segments.end() ; it++ ) {
+        hash_value(layout->hash, it->kind) ;
+        hash_value(layout->hash, it->is_static ? 0 : it->offset) ;
+        hash_value(layout->hash, it->is_static) ;
+        hash_value(layout->hash, it->is_char_ptr) ;
+        hash_value(layout->hash, it->size) ;
+        hash_value(layout->hash, it->count) ;
+        if ( it->kind == BinaryCheckPointSegment::RAW ) {
+            layout->raw_size += it->size ;
+        } else if ( it->kind == BinaryCheckPointSegment::ARRAY ) {
+            hash_value(layout->hash, it->sub_layout->hash) ;
+            layout->raw_size += it->count * it->sub_layout->raw_size ;
+        }
+    }
+}
+
+// MEMBER FUNCTION
+Trick::BinaryCheckPointLayout * Trick::BinaryCheckPointAgent::get_type_layout( ATTRIBUTES * attr_list) {
+
+    std::map< ATTRIBUTES *, BinaryCheckPointLayout * >::iterator it ;
+    BinaryCheckPointLayout * layout ;
+    int ii ;
+
+    it = type_layouts.find(attr_list) ;
+    if ( it != type_layouts.end() ) {
+        return it->second ;
+    }
+
+    layout = new BinaryCheckPointLayout ;
+    for ( ii = 0 ; attr_list[ii].name[0] != '\0' ; ii++ ) {
+        ATTRIBUTES * attr = &attr_list[ii] ;
+        // Output only members are written as comments in the classic checkpoint, they are not restored.
+        if ( !output_perm_check(attr) or !input_perm_check(attr) or (attr->mods & 1) ) {
+            continue ;
+        }
+        add_member(layout, attr, attr->offset, (attr->mods & 2) != 0) ;
+    }
+    finish_layout(layout) ;
+    type_layouts[attr_list] = layout ;
+    return layout ;
+}
+
+// MEMBER FUNCTION
+Trick::BinaryCheckPointLayout * Trick::BinaryCheckPointAgent::make_alloc_layout( ALLOC_INFO * alloc_info) {
+
+    BinaryCheckPointLayout * layout = new BinaryCheckPointLayout ;
+    ATTRIBUTES & attr = layout->alloc_attr ;
+    int ii ;
+
+    memset(&attr, 0, sizeof(ATTRIBUTES)) ;
+    attr.name = alloc_info->name ;
+    attr.io = TRICK_VAR_OUTPUT | TRICK_VAR_INPUT | TRICK_CHKPNT_OUTPUT | TRICK_CHKPNT_INPUT ;
+    attr.type = alloc_info->type ;
+    attr.size = alloc_info->size ;
+    attr.language = alloc_info->language ;
+    attr.attr = alloc_info->attr ;
+    attr.num_index = alloc_info->num_index ;
+    for ( ii = 0 ; ii < attr.num_index ; ii++ ) {
+        attr.index[ii].size = alloc_info->index[ii] ;
+    }
+    add_member(layout, &attr, 0, false) ;
+    finish_layout(layout) ;
+    return layout ;
+}
+
+/*
+ Return the table index of the allocation holding pointer, adding a reference-only entry if the
+ allocation is not being checkpointed.  Returns -1 if the pointer is not in managed memory, -2 if
+ the allocation holding it has no name.
+*/
+int32_t Trick::BinaryCheckPointAgent::pointer_target( void * pointer, uint64_t & target_offset) {
+
+    ALLOC_INFO * alloc_info ;
+    std::map< ALLOC_INFO *, uint32_t >::iterator it ;
+    BinaryCheckPointAlloc entry ;
+    int ii ;
+
+    alloc_info = mem_mgr->get_alloc_info_of(pointer) ;
+    if ( alloc_info == NULL ) {
+        return -1 ;
+    }
+    target_offset = (char *)pointer - (char *)alloc_info->start ;
+    it = alloc_index_of.find(alloc_info) ;
+    if ( it != alloc_index_of.end() ) {
+        return it->second ;
+    }
+    if ( alloc_info->name == NULL ) {
+        return -2 ;
+    }
+
+    // Restore finds this allocation by name.
+    entry.name = alloc_info->name ;
+    entry.type = alloc_info->type ;
+    entry.flags = 0 ;
+    entry.size = alloc_info->size ;
+    entry.num = alloc_info->num ;
+    entry.num_index = alloc_info->num_index ;
+    for ( ii = 0 ; ii < alloc_info->num_index ; ii++ ) {
+        entry.index[ii] = alloc_info->index[ii] ;
+    }
+    entry.layout_hash = 0 ;
+    entry.data_offset = 0 ;
+    entry.data_size = 0 ;
+    entry.data = NULL ;
+    entry.name_hash = hash_bytes(0, entry.name.data(), entry.name.size()) ;
+    entry.alloc_info = alloc_info ;
+    entry.layout = NULL ;
+    alloc_index_of[alloc_info] = allocs.size() ;
+    allocs.push_back(entry) ;
+    return allocs.size() - 1 ;
+}
+
+/*
+ Add a pointer record for every pointer and a string record for every std::string and every
+ character pointer to a string outside of managed memory in the object at address.
+*/
+void Trick::BinaryCheckPointAgent::collect_pointers( BinaryCheckPointLayout * layout, char * address,
+ uint32_t alloc_index, std::string & strings, uint64_t & num_strings) {
+
+    std::vector< BinaryCheckPointSegment >::iterator it ;
+    char * alloc_start = (char *)allocs[alloc_index].alloc_info->start ;
+    char * base ;
+    int ii ;
+
+    for ( it = layout->segments.begin() ; it != layout->segments.end() ; it++ ) {
+        base = address + it->offset ;
+        switch ( it->kind ) {
+            case BinaryCheckPointSegment::POINTER:
+                for ( ii = 0 ; ii < it->count ; ii++ ) {
+                    void ** slot = (void **)base + ii ;
+                    BinaryCheckPointPointer record ;
+                    record.alloc = alloc_index ;
+                    record.offset = (char *)slot - alloc_start ;
+                    record.target = -1 ;
+                    record.target_offset = 0 ;
+                    if ( *slot != NULL ) {
+                        int32_t target = pointer_target(*slot, record.target_offset) ;
+                        if ( target >= 0 ) {
+                            record.target = target ;
+                        } else if ( target == -1 and it->is_char_ptr ) {
+                            const char * s = (const char *)*slot ;
+                            put_u32(strings, alloc_index) ;
+                            put_u32(strings, STRING_CHAR_PTR) ;
+                            put_u64(strings, record.offset) ;
+                            put_u64(strings, strlen(s)) ;
+                            strings.append(s) ;
+                            num_strings++ ;
+                            continue ;
+                        } else if ( target == -1 ) {
+                            message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Pointer <%p> at offset %lu of \"%s\" is not in Trick managed memory\n"
+                                                       "nor is it a character pointer.\n", *slot, (unsigned long)record.offset,
+                                                       allocs[alloc_index].name.c_str()) ;
+                        } else {
+                            message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Pointer <%p> at offset %lu of \"%s\" points to an allocation with no name.\n",
+                                                       *slot, (unsigned long)record.offset, allocs[alloc_index].name.c_str()) ;
+                        }
+                    }
+                    pointers.push_back(record) ;
+                }
+                break ;
+            case BinaryCheckPointSegment::STRING:
+                for ( ii = 0 ; ii < it->count ; ii++ ) {
+                    std::string * s = (std::string *)base + ii ;
+                    put_u32(strings, alloc_index) ;
+                    put_u32(strings, STRING_STD) ;
+                    put_u64(strings, (char *)s - alloc_start) ;
+                    put_u64(strings, s->size()) ;
+                    strings.append(*s) ;
+                    num_strings++ ;
+                }
+                break ;
+            case BinaryCheckPointSegment::ARRAY:
+                for ( ii = 0 ; ii < it->count ; ii++ ) {
+                    collect_pointers(it->sub_layout, base + ii * it->size, alloc_index, strings, num_strings) ;
+                }
+                break ;
+            default:
+                break ;
+        }
+    }
+}
+
+// MEMBER FUNCTION
+void Trick::BinaryCheckPointAgent::write_raw( BinaryCheckPointLayout * layout, char * address, std::ostream& chkpnt_os, std::string & buffer) {
+
+    std::vector< BinaryCheckPointSegment >::iterator it ;
+    char * base ;
+    int ii ;
+
+    for ( it = layout->segments.begin() ; it != layout->segments.end() ; it++ ) {
+        base = it->is_static ? (char *)it->offset : address + it->offset ;
+        if ( it->kind == BinaryCheckPointSegment::RAW ) {
+            if ( it->size >= write_buffer_size ) {
+                chkpnt_os.write(buffer.data(), buffer.size()) ;
+                buffer.clear() ;
+                chkpnt_os.write(base, it->size) ;
+            } else {
+                buffer.append(base, it->size) ;
+                if ( buffer.size() >= write_buffer_size ) {
+                    chkpnt_os.write(buffer.data(), buffer.size()) ;
+                    buffer.clear() ;
+                }
+            }
+        } else if ( it->kind == BinaryCheckPointSegment::ARRAY ) {
+            for ( ii = 0 ; ii < it->count ; ii++ ) {
+                write_raw(it->sub_layout, base + ii * it->size, chkpnt_os, buffer) ;
+            }
+        }
+    }
+}
+
+
+// MEMBER FUNCTION
+uint64_t Trick::BinaryCheckPointAgent::hash_raw( BinaryCheckPointLayout * layout, char * address, uint64_t hash) {
+
+    std::vector< BinaryCheckPointSegment >::iterator it ;
+    char * base ;
+    int ii ;
+
+    for ( it = layout->segments.begin() ; it != layout->segments.end() ; it++ ) {
+        base = it->is_static ? (char *)it->offset : address + it->offset ;
+        if ( it->kind == BinaryCheckPointSegment::RAW ) {
+            hash = hash_bytes(hash, base, it->size) ;
+        } else if ( it->kind == BinaryCheckPointSegment::ARRAY ) {
+            for ( ii = 0 ; ii < it->count ; ii++ ) {
+                hash = hash_raw(it->sub_layout, base + ii * it->size, hash) ;
+            }
+        }
+    }
+    return hash ;
+}
+
+// MEMBER FUNCTION
+void Trick::BinaryCheckPointAgent::write_tables( std::ostream& chkpnt_os, const std::string & base_name,
+ uint64_t in_base_id, uint64_t data_size, uint64_t num_strings) {
+
+    std::string header ;
+    std::string table ;
+    unsigned int ii ;
+    int jj ;
+
+    put_string(table, base_name) ;
+    for ( ii = 0 ; ii < allocs.size() ; ii++ ) {
+        BinaryCheckPointAlloc & entry = allocs[ii] ;
+        put_string(table, entry.name) ;
+        put_string(table, entry.user_type_name) ;
+        put_u32(table, entry.type) ;
+        put_u32(table, entry.flags) ;
+        put_u32(table, entry.size) ;
+        put_u32(table, entry.num) ;
+        put_u32(table, entry.num_index) ;
+        for ( jj = 0 ; jj < entry.num_index ; jj++ ) {
+            put_u32(table, entry.index[jj]) ;
+        }
+        put_u64(table, entry.layout_hash) ;
+        put_u64(table, entry.data_offset) ;
+        put_u64(table, entry.data_size) ;
+    }
+
+    header.append(binary_checkpoint_magic, sizeof(binary_checkpoint_magic)) ;
+    put_u32(header, binary_checkpoint_version) ;
+    put_u32(header, byte_order_mark) ;
+    put_u32(header, sizeof(void *)) ;
+    put_u32(header, sizeof(long)) ;
+    written_id = new_checkpoint_id() ;
+    put_u64(header, written_id) ;
+    put_u64(header, in_base_id) ;
+    put_u64(header, allocs.size()) ;
+    put_u64(header, table.size()) ;
+    put_u64(header, data_size) ;
+    put_u64(header, pointers.size()) ;
+    put_u64(header, num_strings) ;
+
+    chkpnt_os.write(header.data(), header.size()) ;
+    chkpnt_os.write(table.data(), table.size()) ;
+}
+
+/**
+@details
+-# Give each allocation an entry in the allocation table and build the layout of its checkpointed members
+-# Collect the pointers and strings of every allocation.  Allocations that are pointed to but not
+   checkpointed are added to the table so restore can find them by name.
+-# When checkpointing incrementally, hash the data, pointer targets, and strings of each allocation.
+   In a delta, an allocation with the same hash as in the base is marked unchanged and its pointers
+   and strings are dropped.
+-# Write the header, the table, the raw block of each changed allocation, the pointers, and the strings
+*/
+void Trick::BinaryCheckPointAgent::write_checkpoint( std::ostream& chkpnt_os, std::vector<ALLOC_INFO*>& dependencies) {
+
+    std::string strings ;
+    std::string buffer ;
+    std::string delta_base ;
+    uint64_t delta_base_id = 0 ;
+    uint64_t num_strings = 0 ;
+    uint64_t data_size = 0 ;
+    unsigned int num_deps = dependencies.size() ;
+    unsigned int num_unchanged = 0 ;
+    unsigned int ii ;
+    int jj ;
+
+    clear_tables() ;
+
+    for ( ii = 0 ; ii < num_deps ; ii++ ) {
+        ALLOC_INFO * alloc_info = dependencies[ii] ;
+        BinaryCheckPointAlloc entry ;
+
+        entry.name = alloc_info->name ;
+        if ( alloc_info->user_type_name != NULL ) {
+            entry.user_type_name = alloc_info->user_type_name ;
+        }
+        entry.type = alloc_info->type ;
+        entry.flags = ALLOC_DATA ;
+        if ( alloc_info->stcl == TRICK_LOCAL ) {
+            entry.flags |= ALLOC_DECLARE ;
+        }
+        entry.size = alloc_info->size ;
+        entry.num = alloc_info->num ;
+        entry.num_index = alloc_info->num_index ;
+        for ( jj = 0 ; jj < alloc_info->num_index ; jj++ ) {
+            entry.index[jj] = alloc_info->index[jj] ;
+        }
+        entry.data = NULL ;
+        entry.name_hash = hash_bytes(0, entry.name.data(), entry.name.size()) ;
+        entry.alloc_info = alloc_info ;
+        entry.layout = make_alloc_layout(alloc_info) ;
+        entry.layout_hash = entry.layout->hash ;
+        entry.data_offset = 0 ;
+        entry.data_size = entry.layout->raw_size ;
+
+        alloc_index_of[alloc_info] = ii ;
+        allocs.push_back(entry) ;
+    }
+
+    for ( ii = 0 ; ii < num_deps ; ii++ ) {
+        size_t pointers_mark = pointers.size() ;
+        size_t strings_mark = strings.size() ;
+        uint64_t num_strings_mark = num_strings ;
+        uint64_t hash ;
+        size_t kk ;
+
+        collect_pointers(allocs[ii].layout, (char *)allocs[ii].alloc_info->start, ii, strings, num_strings) ;
+
+        if ( track_hashes ) {
+            BinaryCheckPointAlloc & entry = allocs[ii] ;
+            hash = entry.layout_hash ;
+            hash_value(hash, entry.num) ;
+            hash = hash_raw(entry.layout, (char *)entry.alloc_info->start, hash) ;
+            // Pointers are compared by the name of the allocation they point into.
+            for ( kk = pointers_mark ; kk < pointers.size() ; kk++ ) {
+                hash_value(hash, pointers[kk].offset) ;
+                hash_value(hash, pointers[kk].target >= 0 ? allocs[pointers[kk].target].name_hash : 0) ;
+                hash_value(hash, pointers[kk].target_offset) ;
+            }
+            hash = hash_bytes(hash, strings.data() + strings_mark, strings.size() - strings_mark) ;
+            new_hashes[entry.name] = hash ;
+
+            if ( write_delta ) {
+                std::map< std::string, uint64_t >::iterator hit = base_hashes.find(entry.name) ;
+                if ( hit != base_hashes.end() and hit->second == hash ) {
+                    entry.flags = (entry.flags & ALLOC_DECLARE) | ALLOC_UNCHANGED ;
+                    entry.data_size = 0 ;
+                    pointers.resize(pointers_mark) ;
+                    strings.resize(strings_mark) ;
+                    num_strings = num_strings_mark ;
+                    num_unchanged++ ;
+                }
+            }
+        }
+    }
+
+    for ( ii = 0 ; ii < num_deps ; ii++ ) {
+        allocs[ii].data_offset = data_size ;
+        data_size += allocs[ii].data_size ;
+    }
+
+    if ( write_delta ) {
+        // Name the base relative to the delta when they are in the same directory.
+        if ( dir_name(base_file) == dir_name(output_file) ) {
+            delta_base = base_name(base_file) ;
+        } else {
+            delta_base = base_file ;
+        }
+        delta_base_id = base_id ;
+    }
+
+    write_tables(chkpnt_os, delta_base, delta_base_id, data_size, num_strings) ;
+
+    buffer.reserve(write_buffer_size) ;
+    for ( ii = 0 ; ii < num_deps ; ii++ ) {
+        if ( allocs[ii].flags & ALLOC_DATA ) {
+            write_raw(allocs[ii].layout, (char *)allocs[ii].alloc_info->start, chkpnt_os, buffer) ;
+        }
+    }
+    chkpnt_os.write(buffer.data(), buffer.size()) ;
+
+    if ( !pointers.empty() ) {
+        chkpnt_os.write((const char *)&pointers[0], pointers.size() * sizeof(BinaryCheckPointPointer)) ;
+    }
+    chkpnt_os.write(strings.data(), strings.size()) ;
+    chkpnt_os.flush() ;
+    wrote_file = true ;
+
+    if ( debug_level ) {
+        message_publish(MSG_DEBUG, "Checkpoint Agent INFO: Wrote %lu allocations (%u unchanged), %llu data bytes, %lu pointers, %llu strings.\n",
+                        (unsigned long)allocs.size(), num_unchanged, (unsigned long long)data_size,
+                        (unsigned long)pointers.size(), (unsigned long long)num_strings) ;
+    }
+
+    clear_tables() ;
+}
+
+/**
+@details
+-# Write a delta if there is a base and fewer than #max_deltas deltas have been written against it
+-# A base is never overwritten by a delta.  A checkpoint written over its own base, as safestore
+   checkpoints are, is a full checkpoint, and the base is forgotten.  Deltas of the old base no longer
+   restore, their base id does not match.
+*/
+void Trick::BinaryCheckPointAgent::begin_file( const char* filename, bool allow_delta) {
+
+    output_file = filename ;
+    track_hashes = allow_delta and max_deltas > 0 ;
+    write_delta = false ;
+    wrote_file = false ;
+    new_hashes.clear() ;
+
+    if ( output_file == base_file ) {
+        base_file.clear() ;
+        base_hashes.clear() ;
+        base_id = 0 ;
+    }
+
+    if ( track_hashes and !base_file.empty() and num_deltas < max_deltas and access(base_file.c_str(), R_OK) == 0 ) {
+        write_delta = true ;
+    }
+}
+
+// MEMBER FUNCTION
+void Trick::BinaryCheckPointAgent::end_file( bool ok) {
+
+    if ( track_hashes and wrote_file and ok ) {
+        if ( write_delta ) {
+            num_deltas++ ;
+        } else {
+            base_file = output_file ;
+            base_hashes.swap(new_hashes) ;
+            base_id = written_id ;
+            num_deltas = 0 ;
+        }
+    }
+    output_file.clear() ;
+    new_hashes.clear() ;
+    track_hashes = false ;
+    write_delta = false ;
+    wrote_file = false ;
+}
+
+/*
+ Find or declare the allocation of a table entry and check it has the checkpointed layout.
+*/
+int Trick::BinaryCheckPointAgent::resolve_alloc( BinaryCheckPointAlloc & entry) {
+
+    void * address = NULL ;
+    ALLOC_INFO * alloc_info ;
+    BinaryCheckPointLayout * layout ;
+    REF2 R ;
+    int ii ;
+
+    if ( (entry.flags & ALLOC_DECLARE) and !mem_mgr->var_exists(entry.name) ) {
+        int cdims[TRICK_MAX_INDEX] ;
+        int n_cdims = 0 ;
+        int n_stars = 0 ;
+        for ( ii = 0 ; ii < entry.num_index ; ii++ ) {
+            if ( entry.index[ii] == 0 ) {
+                n_stars++ ;
+            } else {
+                cdims[n_cdims++] = entry.index[ii] ;
+            }
+        }
+        address = mem_mgr->declare_var((TRICK_TYPE)entry.type, entry.user_type_name, n_stars, entry.name, n_cdims, cdims) ;
+    } else {
+        memset(&R, 0, sizeof(REF2)) ;
+        if ( mem_mgr->ref_var(&R, (char *)entry.name.c_str()) == MM_OK ) {
+            address = R.address ;
+            free(R.ref_attr) ;
+        }
+    }
+
+    if ( address == NULL or (alloc_info = mem_mgr->get_alloc_info_at(address)) == NULL ) {
+        message_publish(MSG_ERROR, "Checkpoint Agent ERROR: \"%s\" could not be declared or found.\n", entry.name.c_str()) ;
+        return 1 ;
+    }
+
+    if ( entry.flags & ALLOC_DATA ) {
+        layout = make_alloc_layout(alloc_info) ;
+        if ( alloc_info->size != entry.size or alloc_info->num != entry.num or
+             layout->hash != entry.layout_hash or layout->raw_size != entry.data_size ) {
+            message_publish(MSG_ERROR, "Checkpoint Agent ERROR: \"%s\" does not have the layout it was checkpointed with.\n",
+                            entry.name.c_str()) ;
+            delete layout ;
+            return 1 ;
+        }
+        entry.layout = layout ;
+    }
+    entry.alloc_info = alloc_info ;
+    return 0 ;
+}
+
+/*
+ Copy the raw block of the object at address from data.  STLs are cleared, restore_stls refills them.
+ Returns the end of the block.
+*/
+const char * Trick::BinaryCheckPointAgent::read_raw( BinaryCheckPointLayout * layout, char * address, const char * data) {
+
+    std::vector< BinaryCheckPointSegment >::iterator it ;
+    char * base ;
+    int ii ;
+
+    for ( it = layout->segments.begin() ; it != layout->segments.end() ; it++ ) {
+        base = it->is_static ? (char *)it->offset : address + it->offset ;
+        switch ( it->kind ) {
+            case BinaryCheckPointSegment::RAW:
+                memcpy(base, data, it->size) ;
+                data += it->size ;
+                break ;
+            case BinaryCheckPointSegment::ARRAY:
+                for ( ii = 0 ; ii < it->count ; ii++ ) {
+                    data = read_raw(it->sub_layout, base + ii * it->size, data) ;
+                }
+                break ;
+            case BinaryCheckPointSegment::STL:
+                if ( it->attr->clear_stl ) {
+                    for ( ii = 0 ; ii < it->count ; ii++ ) {
+                        (*it->attr->clear_stl)(base + ii * it->size) ;
+                    }
+                }
+                break ;
+            default:
+                break ;
+        }
+    }
+    return data ;
+}
+
+// MEMBER FUNCTION
+void Trick::BinaryCheckPointAgent::run_job( BinaryCheckPointJob & job) {
+
+    uint64_t ii ;
+
+    switch ( job.kind ) {
+        case BinaryCheckPointJob::BLOCK: {
+            BinaryCheckPointAlloc & entry = allocs[job.alloc] ;
+            read_raw(entry.layout, (char *)entry.alloc_info->start, entry.data) ;
+        } break ;
+        case BinaryCheckPointJob::CHUNK: {
+            BinaryCheckPointAlloc & entry = allocs[job.alloc] ;
+            memcpy((char *)entry.alloc_info->start + entry.layout->segments[0].offset + job.begin,
+                   entry.data + job.begin, job.end - job.begin) ;
+        } break ;
+        case BinaryCheckPointJob::POINTERS:
+            for ( ii = job.begin ; ii < job.end ; ii++ ) {
+                BinaryCheckPointPointer & record = pointers[ii] ;
+                ALLOC_INFO * alloc_info ;
+                ALLOC_INFO * target_info ;
+                void * value = NULL ;
+
+                // A pointer in an allocation that was not restored was already reported.
+                if ( record.alloc >= allocs.size() or (alloc_info = allocs[record.alloc].alloc_info) == NULL or
+                     record.offset + sizeof(void *) > (uint64_t)alloc_info->size * alloc_info->num ) {
+                    continue ;
+                }
+                if ( record.target >= 0 ) {
+                    if ( (uint32_t)record.target < allocs.size() and
+                         (target_info = allocs[record.target].alloc_info) != NULL and
+                         record.target_offset < (uint64_t)target_info->size * target_info->num ) {
+                        value = (char *)target_info->start + record.target_offset ;
+                    } else {
+                        pthread_mutex_lock(&job_mutex) ;
+                        bad_pointer_count++ ;
+                        pthread_mutex_unlock(&job_mutex) ;
+                    }
+                }
+                *(void **)((char *)alloc_info->start + record.offset) = value ;
+            }
+            break ;
+    }
+}
+
+// STATIC MEMBER FUNCTION
+void * Trick::BinaryCheckPointAgent::restore_thread( void * agent_ptr) {
+
+    BinaryCheckPointAgent * agent = (BinaryCheckPointAgent *)agent_ptr ;
+    size_t job ;
+
+    while ( 1 ) {
+        pthread_mutex_lock(&agent->job_mutex) ;
+        job = agent->next_job++ ;
+        pthread_mutex_unlock(&agent->job_mutex) ;
+        if ( job >= agent->jobs.size() ) {
+            break ;
+        }
+        agent->run_job(agent->jobs[job]) ;
+    }
+    return NULL ;
+}
+
+/**
+@details
+-# Check the header was written by a machine with the same byte order and type sizes
+-# Read the ids of the checkpoint and its base, the name of the base checkpoint, and the allocation table
+-# Copy the pointer records.  The data blocks and strings are used in place.
+*/
+int Trick::BinaryCheckPointAgent::parse_file( BinaryCheckPointFile & file, const char * buffer, uint64_t length) {
+
+    const char * p = buffer ;
+    const char * end = buffer + length ;
+    const char * table_end ;
+    const char * data ;
+    char magic[sizeof(binary_checkpoint_magic)] ;
+    uint32_t version , byte_order , pointer_size , long_size ;
+    uint64_t num_allocs , table_size , data_size , num_pointers ;
+    uint64_t ii , jj ;
+
+    if ( !get_bytes(p, end, magic, sizeof(magic)) or memcmp(magic, binary_checkpoint_magic, sizeof(magic)) or
+         !get_u32(p, end, version) or !get_u32(p, end, byte_order) or
+         !get_u32(p, end, pointer_size) or !get_u32(p, end, long_size) or
+         !get_u64(p, end, file.id) or !get_u64(p, end, file.base_id) or !get_u64(p, end, num_allocs) or !get_u64(p, end, table_size) or !get_u64(p, end, data_size) or
+         !get_u64(p, end, num_pointers) or !get_u64(p, end, file.num_strings) ) {
+        message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Binary checkpoint header is not valid.\n") ;
+        return 1 ;
+    }
+    if ( version != binary_checkpoint_version or byte_order != byte_order_mark or
+         pointer_size != sizeof(void *) or long_size != sizeof(long) ) {
+        message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Binary checkpoint version %u was written by a different kind of machine.\n",
+                        version) ;
+        return 1 ;
+    }
+
+    if ( table_size > (uint64_t)(end - p) ) {
+        message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Binary checkpoint is truncated.\n") ;
+        return 1 ;
+    }
+    table_end = p + table_size ;
+    data = table_end ;
+    if ( !get_string(p, table_end, file.base_name) ) {
+        message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Binary checkpoint allocation table is not valid.\n") ;
+        return 1 ;
+    }
+    for ( ii = 0 ; ii < num_allocs ; ii++ ) {
+        BinaryCheckPointAlloc entry ;
+        uint32_t value ;
+        bool ok = get_string(p, table_end, entry.name) and get_string(p, table_end, entry.user_type_name) ;
+        ok = ok and get_u32(p, table_end, value) ; entry.type = value ;
+        ok = ok and get_u32(p, table_end, value) ; entry.flags = value ;
+        ok = ok and get_u32(p, table_end, value) ; entry.size = value ;
+        ok = ok and get_u32(p, table_end, value) ; entry.num = value ;
+        ok = ok and get_u32(p, table_end, value) ; entry.num_index = value ;
+        ok = ok and entry.num_index >= 0 and entry.num_index <= TRICK_MAX_INDEX ;
+        for ( jj = 0 ; ok and jj < (uint64_t)entry.num_index ; jj++ ) {
+            ok = get_u32(p, table_end, value) ; entry.index[jj] = value ;
+        }
+        ok = ok and get_u64(p, table_end, entry.layout_hash) and get_u64(p, table_end, entry.data_offset) and
+             get_u64(p, table_end, entry.data_size) ;
+        if ( !ok or entry.data_offset > data_size or entry.data_size > data_size - entry.data_offset ) {
+            message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Binary checkpoint allocation table is not valid.\n") ;
+            return 1 ;
+        }
+        entry.data = data + entry.data_offset ;
+        entry.name_hash = 0 ;
+        entry.alloc_info = NULL ;
+        entry.layout = NULL ;
+        file.allocs.push_back(entry) ;
+    }
+
+    p = table_end ;
+    if ( data_size > (uint64_t)(end - p) or
+         num_pointers > (uint64_t)(end - p - data_size) / sizeof(BinaryCheckPointPointer) ) {
+        message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Binary checkpoint is truncated.\n") ;
+        return 1 ;
+    }
+    p += data_size ;
+    file.pointers.resize(num_pointers) ;
+    if ( num_pointers > 0 ) {
+        memcpy(&file.pointers[0], p, num_pointers * sizeof(BinaryCheckPointPointer)) ;
+    }
+    p += num_pointers * sizeof(BinaryCheckPointPointer) ;
+    file.strings = p ;
+    file.end = end ;
+    return 0 ;
+}
+
+// MEMBER FUNCTION
+int Trick::BinaryCheckPointAgent::open_file( BinaryCheckPointFile & file, const char * filename) {
+
+    struct stat file_stat ;
+    void * map ;
+    int fd ;
+
+    file.name = filename ;
+    file.map = NULL ;
+    file.map_size = 0 ;
+    if ( (fd = open(filename, O_RDONLY)) < 0 ) {
+        message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Couldn't open \"%s\".\n", filename) ;
+        return 1 ;
+    }
+    if ( fstat(fd, &file_stat) != 0 or file_stat.st_size == 0 or
+         (map = mmap(NULL, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) == MAP_FAILED ) {
+        message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Couldn't map \"%s\".\n", filename) ;
+        close(fd) ;
+        return 1 ;
+    }
+    close(fd) ;
+    // Blocks are read by several threads in no particular order.
+    madvise(map, file_stat.st_size, MADV_WILLNEED) ;
+    file.map = map ;
+    file.map_size = file_stat.st_size ;
+
+    return parse_file(file, (const char *)map, file_stat.st_size) ;
+}
+
+// MEMBER FUNCTION
+void Trick::BinaryCheckPointAgent::close_file( BinaryCheckPointFile & file) {
+    if ( file.map != NULL ) {
+        munmap(file.map, file.map_size) ;
+        file.map = NULL ;
+    }
+}
+
+/*
+ Open the bases of file, newest first.  A relative base name is looked for next to the delta first.
+ A base whose id is not the one its delta recorded was overwritten after the delta was written, the
+ chain is refused.  chain holds file and every base opened, even if one fails to open.
+*/
+int Trick::BinaryCheckPointAgent::load_chain( BinaryCheckPointFile * file, std::vector< BinaryCheckPointFile * > & chain) {
+
+    chain.push_back(file) ;
+    while ( !chain.back()->base_name.empty() ) {
+        std::string base_path = chain.back()->base_name ;
+        BinaryCheckPointFile * base ;
+
+        if ( chain.size() >= max_chain_length ) {
+            message_publish(MSG_ERROR, "Checkpoint Agent ERROR: \"%s\" is a delta of more than %u checkpoints.\n",
+                            chain[0]->name.c_str(), max_chain_length) ;
+            return 1 ;
+        }
+        if ( base_path[0] != '/' and chain.back()->name.find('/') != std::string::npos ) {
+            std::string next_to = dir_name(chain.back()->name) + "/" + base_path ;
+            if ( access(next_to.c_str(), R_OK) == 0 ) {
+                base_path = next_to ;
+            }
+        }
+
+        base = new BinaryCheckPointFile ;
+        chain.push_back(base) ;
+        if ( open_file(*base, base_path.c_str()) != 0 ) {
+            message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Couldn't read \"%s\", the base of \"%s\".\n",
+                            base_path.c_str(), chain[chain.size() - 2]->name.c_str()) ;
+            return 1 ;
+        }
+        if ( base->id != chain[chain.size() - 2]->base_id ) {
+            message_publish(MSG_ERROR, "Checkpoint Agent ERROR: \"%s\" is not the checkpoint \"%s\" was written against, it was overwritten.\n",
+                            base_path.c_str(), chain[chain.size() - 2]->name.c_str()) ;
+            return 1 ;
+        }
+    }
+    return 0 ;
+}
+
+/**
+@details
+-# The allocation table of the newest file is the table restored
+-# For each allocation marked unchanged, find the newest base that holds its data by name
+-# Keep the pointers and strings of each allocation from the file that holds its data.  Pointer
+   targets are found by name in the newest table.
+*/
+int Trick::BinaryCheckPointAgent::merge_chain( std::vector< BinaryCheckPointFile * > & chain) {
+
+    std::vector< std::map< std::string, uint32_t > > names(chain.size()) ;
+    std::vector< std::vector< int32_t > > owner(chain.size()) ;
+    std::map< std::string, uint32_t >::iterator nit ;
+    unsigned int ff ;
+    uint64_t ii ;
+    int status = 0 ;
+
+    clear_tables() ;
+    allocs = chain[0]->allocs ;
+
+    for ( ff = 0 ; ff < chain.size() ; ff++ ) {
+        for ( ii = 0 ; ii < chain[ff]->allocs.size() ; ii++ ) {
+            names[ff][chain[ff]->allocs[ii].name] = ii ;
+        }
+        owner[ff].assign(chain[ff]->allocs.size(), -1) ;
+    }
+
+    for ( ii = 0 ; ii < allocs.size() ; ii++ ) {
+        BinaryCheckPointAlloc & entry = allocs[ii] ;
+        if ( entry.flags & ALLOC_DATA ) {
+            owner[0][ii] = ii ;
+        } else if ( entry.flags & ALLOC_UNCHANGED ) {
+            for ( ff = 1 ; ff < chain.size() ; ff++ ) {
+                nit = names[ff].find(entry.name) ;
+                if ( nit == names[ff].end() ) {
+                    break ;
+                }
+                BinaryCheckPointAlloc & base_entry = chain[ff]->allocs[nit->second] ;
+                if ( base_entry.flags & ALLOC_DATA ) {
+                    owner[ff][nit->second] = ii ;
+                    entry.data = base_entry.data ;
+                    entry.data_size = base_entry.data_size ;
+                    entry.flags = (entry.flags & ~ALLOC_UNCHANGED) | ALLOC_DATA ;
+                    break ;
+                }
+            }
+            if ( entry.flags & ALLOC_UNCHANGED ) {
+                message_publish(MSG_ERROR, "Checkpoint Agent ERROR: \"%s\" is not in the base of \"%s\".\n",
+                                entry.name.c_str(), chain[0]->name.c_str()) ;
+                entry.flags &= ~ALLOC_UNCHANGED ;
+                status = 1 ;
+            }
+        }
+    }
+
+    for ( ff = 0 ; ff < chain.size() ; ff++ ) {
+        std::vector< BinaryCheckPointPointer >::iterator pit ;
+        std::vector< int32_t > target_of(chain[ff]->allocs.size(), allocs.size()) ;
+        const char * p = chain[ff]->strings ;
+        const char * end = chain[ff]->end ;
+
+        for ( ii = 0 ; ii < chain[ff]->allocs.size() ; ii++ ) {
+            nit = names[0].find(chain[ff]->allocs[ii].name) ;
+            if ( nit != names[0].end() ) {
+                target_of[ii] = nit->second ;
+            }
+        }
+
+        for ( pit = chain[ff]->pointers.begin() ; pit != chain[ff]->pointers.end() ; pit++ ) {
+            if ( pit->alloc < owner[ff].size() and owner[ff][pit->alloc] >= 0 ) {
+                BinaryCheckPointPointer record = *pit ;
+                record.alloc = owner[ff][pit->alloc] ;
+                if ( record.target >= 0 ) {
+                    // A target missing from the newest table is counted as a bad pointer.
+                    record.target = (uint32_t)record.target < target_of.size() ? target_of[record.target] : allocs.size() ;
+                }
+                pointers.push_back(record) ;
+            }
+        }
+
+        for ( ii = 0 ; ii < chain[ff]->num_strings ; ii++ ) {
+            BinaryCheckPointString value ;
+            if ( !get_u32(p, end, value.alloc) or !get_u32(p, end, value.kind) or !get_u64(p, end, value.offset) or
+                 !get_u64(p, end, value.length) or value.length > (uint64_t)(end - p) ) {
+                message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Binary checkpoint \"%s\" is truncated.\n",
+                                chain[ff]->name.c_str()) ;
+                status = 1 ;
+                break ;
+            }
+            value.value = p ;
+            p += value.length ;
+            if ( value.alloc < owner[ff].size() and owner[ff][value.alloc] >= 0 ) {
+                value.alloc = owner[ff][value.alloc] ;
+                string_values.push_back(value) ;
+            }
+        }
+    }
+    return status ;
+}
+
+/**
+@details
+-# Declare the local allocations and find the others by name
+-# Split the raw blocks and the pointers into jobs and run them with #num_threads threads.
+   Blocks larger than 64MB made only of plain data are split so one large array is copied in parallel.
+-# Assign the strings
+*/
+int Trick::BinaryCheckPointAgent::apply_restore() {
+
+    uint64_t ii , jj ;
+    int status = 0 ;
+    int threads ;
+
+    for ( ii = 0 ; ii < allocs.size() ; ii++ ) {
+        if ( resolve_alloc(allocs[ii]) != 0 ) {
+            status = 1 ;
+        }
+    }
+
+    for ( ii = 0 ; ii < allocs.size() ; ii++ ) {
+        BinaryCheckPointAlloc & entry = allocs[ii] ;
+        BinaryCheckPointJob job ;
+        if ( entry.layout == NULL or entry.data_size == 0 ) {
+            continue ;
+        }
+        job.alloc = ii ;
+        job.begin = 0 ;
+        job.end = entry.data_size ;
+        if ( entry.layout->segments.size() == 1 and entry.layout->segments[0].kind == BinaryCheckPointSegment::RAW and
+             entry.data_size > restore_chunk_size ) {
+            job.kind = BinaryCheckPointJob::CHUNK ;
+            for ( jj = 0 ; jj < entry.data_size ; jj += restore_chunk_size ) {
+                job.begin = jj ;
+                job.end = std::min(jj + restore_chunk_size, entry.data_size) ;
+                jobs.push_back(job) ;
+            }
+        } else {
+            job.kind = BinaryCheckPointJob::BLOCK ;
+            jobs.push_back(job) ;
+        }
+    }
+    for ( ii = 0 ; ii < pointers.size() ; ii += pointers_per_job ) {
+        BinaryCheckPointJob job ;
+        job.kind = BinaryCheckPointJob::POINTERS ;
+        job.alloc = 0 ;
+        job.begin = ii ;
+        job.end = std::min(ii + pointers_per_job, (uint64_t)pointers.size()) ;
+        jobs.push_back(job) ;
+    }
+
+    threads = num_threads ;
+    if ( threads <= 0 ) {
+        threads = std::min(std::max((int)sysconf(_SC_NPROCESSORS_ONLN), 1), 8) ;
+    }
+    threads = std::max(std::min(threads, (int)jobs.size()), 1) ;
+    next_job = 0 ;
+    bad_pointer_count = 0 ;
+    {
+        std::vector< pthread_t > helpers ;
+        pthread_t thread ;
+        for ( ii = 1 ; ii < (uint64_t)threads ; ii++ ) {
+            if ( pthread_create(&thread, NULL, restore_thread, this) == 0 ) {
+                helpers.push_back(thread) ;
+            }
+        }
+        restore_thread(this) ;
+        for ( ii = 0 ; ii < helpers.size() ; ii++ ) {
+            pthread_join(helpers[ii], NULL) ;
+        }
+    }
+    if ( bad_pointer_count > 0 ) {
+        message_publish(MSG_ERROR, "Checkpoint Agent ERROR: %u pointers were set to NULL because the allocation they point to was not restored.\n",
+                        bad_pointer_count) ;
+        status = 1 ;
+    }
+
+    for ( ii = 0 ; ii < string_values.size() ; ii++ ) {
+        BinaryCheckPointString & value = string_values[ii] ;
+        ALLOC_INFO * alloc_info = allocs[value.alloc].alloc_info ;
+        if ( alloc_info != NULL and value.offset < (uint64_t)alloc_info->size * alloc_info->num ) {
+            char * address = (char *)alloc_info->start + value.offset ;
+            if ( value.kind == STRING_STD ) {
+                ((std::string *)address)->assign(value.value, value.length) ;
+            } else if ( value.kind == STRING_CHAR_PTR ) {
+                *(char **)address = mem_mgr->mm_strdup(std::string(value.value, value.length).c_str()) ;
+            }
+        }
+    }
+
+    if ( debug_level ) {
+        message_publish(MSG_DEBUG, "Checkpoint Agent INFO: Restored %lu allocations with %d threads.\n",
+                        (unsigned long)allocs.size(), threads) ;
+    }
+    return status ;
+}
+
+/*
+ Restore file and its bases.  Closes and deletes the bases, the caller owns file.
+*/
+int Trick::BinaryCheckPointAgent::restore_chain( BinaryCheckPointFile * file) {
+
+    std::vector< BinaryCheckPointFile * > chain ;
+    unsigned int ii ;
+    int status ;
+
+    status = load_chain(file, chain) ;
+    if ( status == 0 ) {
+        status = merge_chain(chain) ;
+        status |= apply_restore() ;
+    }
+    clear_tables() ;
+    for ( ii = 1 ; ii < chain.size() ; ii++ ) {
+        close_file(*chain[ii]) ;
+        delete chain[ii] ;
+    }
+    return status ;
+}
+
+// MEMBER FUNCTION
+int Trick::BinaryCheckPointAgent::restore( std::istream* checkpoint_stream) {
+
+    char magic[sizeof(binary_checkpoint_magic)] ;
+    std::streampos start = checkpoint_stream->tellg() ;
+
+    checkpoint_stream->read(magic, sizeof(magic)) ;
+    if ( checkpoint_stream->gcount() == sizeof(magic) and !memcmp(magic, binary_checkpoint_magic, sizeof(magic)) ) {
+        BinaryCheckPointFile file ;
+        file.map = NULL ;
+        file.buffer.assign(magic, sizeof(magic)) ;
+        file.buffer.append(std::istreambuf_iterator<char>(*checkpoint_stream), std::istreambuf_iterator<char>()) ;
+        if ( parse_file(file, file.buffer.data(), file.buffer.size()) != 0 ) {
+            return 1 ;
+        }
+        return restore_chain(&file) ;
+    }
+
+    checkpoint_stream->clear() ;
+    checkpoint_stream->seekg(start) ;
+    return ClassicCheckPointAgent::restore(checkpoint_stream) ;
+}
+
+// MEMBER FUNCTION
+int Trick::BinaryCheckPointAgent::restore_file( const char* filename) {
+
+    BinaryCheckPointFile file ;
+    int status ;
+
+    status = open_file(file, filename) ;
+    if ( status == 0 ) {
+        status = restore_chain(&file) ;
+    }
+    close_file(file) ;
+    return status ;
+}
+
+/**
+@details
+-# Open the delta and its bases and merge them as for a restore
+-# Write the merged table as a full checkpoint, copying each data block from the file that holds it
+*/
+int Trick::BinaryCheckPointAgent::compact( const char* delta_file, const char* out_file) {
+
+    BinaryCheckPointFile file ;
+    std::vector< BinaryCheckPointFile * > chain ;
+    std::string strings ;
+    uint64_t data_size = 0 ;
+    unsigned int ii ;
+    int status ;
+
+    status = open_file(file, delta_file) ;
+    if ( status == 0 ) {
+        status = load_chain(&file, chain) ;
+    }
+    if ( status == 0 ) {
+        status = merge_chain(chain) ;
+    }
+
+    if ( status == 0 ) {
+        std::ofstream out_s(out_file, std::ios::out | std::ios::binary) ;
+        if ( out_s.is_open() ) {
+            for ( ii = 0 ; ii < allocs.size() ; ii++ ) {
+                allocs[ii].data_offset = data_size ;
+                data_size += allocs[ii].data_size ;
+            }
+            for ( ii = 0 ; ii < string_values.size() ; ii++ ) {
+                put_u32(strings, string_values[ii].alloc) ;
+                put_u32(strings, string_values[ii].kind) ;
+                put_u64(strings, string_values[ii].offset) ;
+                put_u64(strings, string_values[ii].length) ;
+                strings.append(string_values[ii].value, string_values[ii].length) ;
+            }
+            write_tables(out_s, std::string(), 0, data_size, string_values.size()) ;
+            for ( ii = 0 ; ii < allocs.size() ; ii++ ) {
+                out_s.write(allocs[ii].data, allocs[ii].data_size) ;
+            }
+            if ( !pointers.empty() ) {
+                out_s.write((const char *)&pointers[0], pointers.size() * sizeof(BinaryCheckPointPointer)) ;
+            }
+            out_s.write(strings.data(), strings.size()) ;
+            out_s.close() ;
+            if ( !out_s ) {
+                message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Couldn't write \"%s\".\n", out_file) ;
+                status = 1 ;
+            }
+        } else {
+            message_publish(MSG_ERROR, "Checkpoint Agent ERROR: Couldn't open \"%s\".\n", out_file) ;
+            status = 1 ;
+        }
+    }
+
+    clear_tables() ;
+    for ( ii = 1 ; ii < chain.size() ; ii++ ) {
+        close_file(*chain[ii]) ;
+        delete chain[ii] ;
+    }
+    close_file(file) ;
+    return status ;
+}
+
+// STATIC MEMBER FUNCTION
+bool Trick::BinaryCheckPointAgent::is_binary_checkpoint( const char* filename) {
+
+    char magic[sizeof(binary_checkpoint_magic)] ;
+    bool ret = false ;
+    FILE * fp ;
+
+    if ( (fp = fopen(filename, "r")) != NULL ) {
+        ret = fread(magic, 1, sizeof(magic), fp) == sizeof(magic) and
+              !memcmp(magic, binary_checkpoint_magic, sizeof(magic)) ;
+        fclose(fp) ;
+    }
+    return ret ;
+}
@@ -7,7 +7,10 @@
 #include <unistd.h>
 #include <sys/syscall.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <string.h>
+#include <time.h>
+#include <fstream>
 
 #ifdef _DMTCP
 #include "dmtcpaware.h"
@@ -27,6 +30,68 @@
 
 Trick::CheckPointRestart * the_cpr ;
 
+/* A checkpoint being written in the background.  A forked writer has a pid, a writer thread
+   has the staged checkpoint in buffer. */
+struct Trick::CheckPointWriter {
+    std::string file_name ;
+    std::string output_file ;
+    bool print_status ;
+    bool binary ;
+    pid_t pid ;
+    pthread_t thread ;
+    std::stringstream * buffer ;
+    int cpu_num ;
+    pthread_mutex_t * mutex ;
+    bool done ;
+    int status ;
+    double start_time ;
+    double stall_time ;
+} ;
+
+static double wall_time() {
+    struct timespec ts ;
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return ts.tv_sec + ts.tv_nsec * 1.0e-9 ;
+}
+
+static void set_writer_cpu( int cpu_num __attribute__((unused)) ) {
+#if __linux
+    if ( cpu_num >= 0 ) {
+        unsigned long mask;
+        mask = 1 << cpu_num ;
+        syscall((long) __NR_sched_setaffinity, 0, sizeof(mask), &mask);
+    }
+#endif
+}
+
+/* Writer thread: saves a checkpoint staged in memory to its file. */
+static void * checkpoint_writer_thread( void * arg ) {
+
+    Trick::CheckPointWriter * writer = (Trick::CheckPointWriter *)arg ;
+    int status = 1 ;
+
+    set_writer_cpu(writer->cpu_num) ;
+    // A buffer that could not be staged in full is not saved.
+    if ( writer->buffer->good() ) {
+        std::ofstream out_s( writer->output_file.c_str(), std::ios::out | std::ios::binary) ;
+        if ( out_s.is_open() ) {
+            out_s << writer->buffer->rdbuf() ;
+            out_s.close() ;
+            if ( out_s.good() ) {
+                status = 0 ;
+            }
+        }
+    }
+    delete writer->buffer ;
+    writer->buffer = NULL ;
+
+    pthread_mutex_lock(writer->mutex) ;
+    writer->status = status ;
+    writer->done = true ;
+    pthread_mutex_unlock(writer->mutex) ;
+    return NULL ;
+}
+
 Trick::CheckPointRestart::CheckPointRestart() {
 
     int num_classes = 0 ;
@@ -36,6 +101,12 @@ Trick::CheckPointRestart::CheckPointRestart() {
     end_checkpoint = false ;
     safestore_enabled = false ;
     cpu_num = -1 ;
+    max_writers = 1 ;
+    snapshot_enabled = false ;
+    last_stall_time = 0.0 ;
+    last_write_time = 0.0 ;
+    last_write_status = 0 ;
+    pthread_mutex_init(&writers_mutex, NULL) ;
     safestore_time = TRICK_MAX_LONG_LONG ;
     load_checkpoint_file_name.clear() ;
 
@@ -91,6 +162,102 @@ int Trick::CheckPointRestart::set_cpu_num(int in_cpu_num) {
     return(0) ;
 }
 
+int Trick::CheckPointRestart::set_max_writers(int in_max_writers) {
+    if ( in_max_writers < 1 ) {
+        max_writers = 1 ;
+    } else {
+        max_writers = in_max_writers ;
+    }
+    return(0) ;
+}
+
+int Trick::CheckPointRestart::set_snapshot_enabled(bool yes_no) {
+    snapshot_enabled = yes_no ;
+    return(0) ;
+}
+
+int Trick::CheckPointRestart::get_num_writers() {
+    return (int)writers.size() ;
+}
+
+void Trick::CheckPointRestart::finish_writer( Trick::CheckPointWriter * writer ) {
+
+    last_write_time = wall_time() - writer->start_time ;
+    last_write_status = writer->status ;
+
+    if ( writer->status != 0 ) {
+        message_publish(MSG_ERROR, "Checkpoint %s failed to write.\n", writer->file_name.c_str()) ;
+    } else if ( writer->print_status ) {
+        message_publish(MSG_INFO, "Dumped %s Checkpoint %s in %.3f s (simulation stalled %.3f ms).\n",
+                        writer->binary ? "Binary" : "ASCII", writer->file_name.c_str(),
+                        last_write_time, writer->stall_time * 1000.0) ;
+    }
+    writers.remove(writer) ;
+    delete writer ;
+}
+
+void Trick::CheckPointRestart::wait_for_oldest_writer() {
+
+    Trick::CheckPointWriter * writer = writers.front() ;
+    int wait_status ;
+
+    if ( writer->pid > 0 ) {
+        if ( waitpid(writer->pid, &wait_status, 0) == writer->pid ) {
+            writer->status = ( WIFEXITED(wait_status) and WEXITSTATUS(wait_status) == 0 ) ? 0 : 1 ;
+        } else {
+            writer->status = 1 ;
+        }
+    } else {
+        pthread_join(writer->thread, NULL) ;
+    }
+    finish_writer(writer) ;
+}
+
+int Trick::CheckPointRestart::check_writers() {
+
+    std::list<Trick::CheckPointWriter *>::iterator it ;
+    Trick::CheckPointWriter * writer ;
+    int wait_status ;
+    bool done ;
+
+    it = writers.begin() ;
+    while ( it != writers.end() ) {
+        writer = *it++ ;
+        if ( writer->pid > 0 ) {
+            pid_t ret = waitpid(writer->pid, &wait_status, WNOHANG) ;
+            done = ( ret != 0 ) ;
+            if ( ret == writer->pid ) {
+                writer->status = ( WIFEXITED(wait_status) and WEXITSTATUS(wait_status) == 0 ) ? 0 : 1 ;
+            } else if ( ret < 0 ) {
+                writer->status = 1 ;
+            }
+        } else {
+            pthread_mutex_lock(&writers_mutex) ;
+            done = writer->done ;
+            pthread_mutex_unlock(&writers_mutex) ;
+            if ( done ) {
+                pthread_join(writer->thread, NULL) ;
+            }
+        }
+        if ( done ) {
+            finish_writer(writer) ;
+        }
+    }
+    return(0) ;
+}
+
+int Trick::CheckPointRestart::wait_for_writers() {
+
+    int num_failed = 0 ;
+
+    while ( ! writers.empty() ) {
+        wait_for_oldest_writer() ;
+        if ( last_write_status != 0 ) {
+            num_failed++ ;
+        }
+    }
+    return num_failed ;
+}
 
 const char * Trick::CheckPointRestart::get_output_file() {
     return output_file.c_str() ;
@@ -200,6 +367,9 @@ int Trick::CheckPointRestart::do_checkpoint(std::string file_name, bool print_st
 
     JobData * curr_job ;
     pid_t pid;
+    double start_time = wall_time() ;
+    bool background = ( snapshot_enabled or cpu_num != -1 ) ;
+    Trick::CheckPointWriter * writer = NULL ;
 
     if ( ! file_name.compare("") ) {
         std::stringstream file_name_stream ;
@@ -208,49 +378,110 @@ int Trick::CheckPointRestart::do_checkpoint(std::string file_name, bool print_st
     }
     output_file = std::string(command_line_args_get_output_dir()) + "/" + file_name ;
 
+    // Reap finished writers.  A writer still saving this file, or one too many, must finish first.
+    check_writers() ;
+    for ( std::list<Trick::CheckPointWriter *>::iterator it = writers.begin() ; it != writers.end() ; it++ ) {
+        if ( (*it)->output_file == output_file ) {
+            while ( writers.front()->output_file != output_file ) {
+                wait_for_oldest_writer() ;
+            }
+            wait_for_oldest_writer() ;
+            break ;
+        }
+    }
+    while ( background and (int)writers.size() >= max_writers ) {
+        wait_for_oldest_writer() ;
+    }
+
     checkpoint_queue.reset_curr_index() ;
     while ( (curr_job = checkpoint_queue.get_next_job()) != NULL ) {
         curr_job->parent_object->call_function(curr_job) ;
     }
 
-    if ( cpu_num != -1 ) {
+    if ( background ) {
+        writer = new Trick::CheckPointWriter ;
+        writer->file_name = file_name ;
+        writer->output_file = output_file ;
+        writer->print_status = print_status ;
+        writer->binary = trick_MM->get_binary_checkpoint() ;
+        writer->pid = 0 ;
+        writer->buffer = NULL ;
+        writer->cpu_num = cpu_num ;
+        writer->mutex = &writers_mutex ;
+        writer->done = false ;
+        writer->status = 0 ;
+        writer->start_time = start_time ;
+    }
+
+    if ( snapshot_enabled ) {
+    // stage the checkpoint in memory and save it from a writer thread
+        writer->buffer = new std::stringstream(std::ios::in | std::ios::out | std::ios::binary) ;
+        if (obj_list.empty()) {
+            trick_MM->write_checkpoint_for_file(*writer->buffer, output_file.c_str()) ;
+        } else {
+            trick_MM->write_checkpoint(*writer->buffer, obj_list) ;
+        }
+        if ( pthread_create(&writer->thread, NULL, checkpoint_writer_thread, writer) != 0 ) {
+            // no thread, save the buffer here
+            checkpoint_writer_thread(writer) ;
+            writer->thread = pthread_self() ;
+            writer->pid = -1 ;
+        }
+    } else if ( cpu_num != -1 ) {
     // if the user specified a cpu number for the checkpoint, fork a process to write the checkpoint
+        // The child's delta hashes are lost when it exits, so it writes a full checkpoint.
+        trick_MM->discard_checkpoint_base(output_file.c_str()) ;
         if ((pid = fork()) == 0) {
-#if __linux
-            if ( cpu_num >= 0 ) {
-                unsigned long mask;
-                mask = 1 << cpu_num ;
-                syscall((long) __NR_sched_setaffinity, 0, sizeof(mask), &mask);
-            }
-#endif
-#if __APPLE__
-            if ( cpu_num >= 0 ) {
-            }
-#endif
+            int status ;
+            set_writer_cpu(cpu_num) ;
+            trick_MM->set_incremental_checkpoint(0) ;
             if (obj_list.empty()) {
-                trick_MM->write_checkpoint(output_file.c_str()) ;
+                status = trick_MM->write_checkpoint(output_file.c_str()) ;
             } else {
-                trick_MM->write_checkpoint(output_file.c_str(), obj_list);
+                status = trick_MM->write_checkpoint(output_file.c_str(), obj_list);
             }
-            _Exit(0) ;
+            _Exit( status ) ;
+        } else if ( pid < 0 ) {
+            writer->pid = -1 ;
+            writer->done = true ;
+            writer->status = 1 ;
+        } else {
+            writer->pid = pid ;
         }
     }
     else {
     // no fork
         if (obj_list.empty()) {
-            trick_MM->write_checkpoint(output_file.c_str()) ;
+            last_write_status = trick_MM->write_checkpoint(output_file.c_str()) ;
         } else {
-            trick_MM->write_checkpoint(output_file.c_str(), obj_list);
+            last_write_status = trick_MM->write_checkpoint(output_file.c_str(), obj_list);
         }
     }
 
+    // Post checkpoint jobs undo what the checkpoint jobs did, so they run once the data is copied.
     post_checkpoint_queue.reset_curr_index() ;
     while ( (curr_job = post_checkpoint_queue.get_next_job()) != NULL ) {
         curr_job->parent_object->call_function(curr_job) ;
     }
 
-    if ( print_status ) {
-        message_publish(MSG_INFO, "Dumped ASCII Checkpoint %s.\n", file_name.c_str()) ;
+    last_stall_time = wall_time() - start_time ;
+
+    if ( writer != NULL ) {
+        writer->stall_time = last_stall_time ;
+        writers.push_back(writer) ;
+        if ( writer->pid < 0 ) {
+            // fork or thread creation failed, the writer is already finished.
+            finish_writer(writer) ;
+        }
+    } else {
+        last_write_time = last_stall_time ;
+        if ( last_write_status != 0 ) {
+            message_publish(MSG_ERROR, "Checkpoint %s failed to write.\n", file_name.c_str()) ;
+        } else if ( print_status ) {
+            message_publish(MSG_INFO, "Dumped %s Checkpoint %s (simulation stalled %.3f ms).\n",
+                            trick_MM->get_binary_checkpoint() ? "Binary" : "ASCII", file_name.c_str(),
+                            last_stall_time * 1000.0) ;
+        }
     }
 
     return 0 ;
@@ -380,6 +611,7 @@ int Trick::CheckPointRestart::write_end_checkpoint() {
     if ( end_checkpoint ) {
         checkpoint(std::string("chkpnt_end")) ;
     }
+    wait_for_writers() ;
     return 0  ;
 }
 
@@ -408,6 +640,9 @@ int Trick::CheckPointRestart::load_checkpoint_job() {
 
     if ( ! load_checkpoint_file_name.empty() ) {
 
+        // the file may be one of the checkpoints still being written
+        wait_for_writers() ;
+
         if ( stat( load_checkpoint_file_name.c_str() , &temp_buf) == 0 ) {
             preload_checkpoint_queue.reset_curr_index() ;
             while ( (curr_job = preload_checkpoint_queue.get_next_job()) != NULL ) {
@@ -109,6 +109,40 @@ extern "C" int checkpoint_cpu( int in_cpu_num ) {
     return(0) ;
 }
 
+/**
+ * @relates Trick::CheckPointRestart
+ * @copydoc Trick::CheckPointRestart::set_max_writers
+ */
+extern "C" int checkpoint_max_writers( int in_max_writers ) {
+    the_cpr->set_max_writers(in_max_writers) ;
+    return(0) ;
+}
+
+/**
+ * @relates Trick::CheckPointRestart
+ * @copydoc Trick::CheckPointRestart::set_snapshot_enabled
+ */
+extern "C" int checkpoint_snapshot( int yes_no ) {
+    the_cpr->set_snapshot_enabled(bool(yes_no)) ;
+    return(0) ;
+}
+
+/**
+ * @relates Trick::CheckPointRestart
+ * @copydoc Trick::CheckPointRestart::get_num_writers
+ */
+extern "C" int checkpoint_num_writers() {
+    return the_cpr->get_num_writers() ;
+}
+
+/**
+ * @relates Trick::CheckPointRestart
+ * @copydoc Trick::CheckPointRestart::wait_for_writers
+ */
+extern "C" int checkpoint_wait() {
+    return the_cpr->wait_for_writers() ;
+}
+
 
 /**
  * @relates Trick::CheckPointRestart
@@ -18,7 +18,7 @@ PROGRAMMERS:
 #include "trick/message_type.h"
 #include "trick/bitfield_proto.h"
 
-Trick::DRAscii::DRAscii( std::string in_name ) : Trick::DataRecordGroup( in_name ) {
+Trick::DRAscii::DRAscii( std::string in_name ) : Trick::DataRecordGroup( in_name ) , row_size(0) {
 
     ascii_float_format = "%20.8g" ;
     ascii_double_format = "%20.16g" ;
@@ -35,7 +35,7 @@ int Trick::DRAscii::format_specific_header( std::fstream & out_st ) {
 @details
 -# If the #delimiter is not empty and not a comma then set the file extension to ".txt"
 -# Else set the file extension to ".csv"
--# Allocate enough memory to hold #record_size of records in memory
+-# Allocate #writer_buff to hold at least #writer_buff_size bytes of rows, and at least one row
 -# Open the log file
    -# Return an error if the open failed.
 -# Write out the title line of the log file.  The title line includes the names of
@@ -55,15 +55,24 @@ int Trick::DRAscii::format_specific_init() {
         file_name.append(".csv");
     }
 
-    /* Calculate a "worst case" for space used for 1 record. */
-    writer_buff = (char *)calloc(1 , record_size * rec_buffer.size()) ;
+    /* Calculate a "worst case" for space used for 1 record.  Rows are gathered in
+       writer_buff and written when it fills. */
+    row_size = (record_size + delimiter.length()) * rec_buffer.size() + 1 ;
+    if ( writer_buff_size < row_size ) {
+        writer_buff_size = row_size ;
+    }
+    if ( writer_buff ) {
+        free(writer_buff) ;
+    }
+    writer_buff = (char *)calloc(1 , writer_buff_size) ;
+    writer_buff_len = 0 ;
 
     /* This loop touches all of the memory locations in the allocation forcing the
        system to actually do the allocation */
-    for ( jj= 0 ; jj < record_size * rec_buffer.size() ; jj += 1024 ) {
+    for ( jj= 0 ; jj < writer_buff_size ; jj += 1024 ) {
         writer_buff[jj] = 1 ;
     }
-    writer_buff[record_size * rec_buffer.size() - 1] = 1 ;
+    writer_buff[writer_buff_size - 1] = 1 ;
 
     out_stream.open(file_name.c_str(), std::fstream::out | std::fstream::app ) ;
     if ( !out_stream || !out_stream.good() ) {
@@ -102,18 +111,21 @@ int Trick::DRAscii::format_specific_init() {
 
 /**
 @details
--# While there is data in memory that has not been written to disk
-   -# Write out the time to a temporary #writer_buff
-   -# Write out each of the other parameter values preceded by the delimiter to the temporary #writer_buff
-   -# Write #writer_buff to the output file
--# Flush the output file stream
--# Return the number of bytes written
+-# If a worst case row does not fit in #writer_buff, flush #writer_buff to the output file
+-# Append the time to #writer_buff
+-# Append each of the other parameter values preceded by the delimiter to #writer_buff
+-# End the row with a newline
+-# Return the number of bytes in the row
 */
 int Trick::DRAscii::format_specific_write_data(unsigned int writer_offset) {
     unsigned int ii ;
     char *buf;
+    char *row;
 
-    buf = writer_buff ;
+    if ( writer_buff_len + row_size > writer_buff_size ) {
+        format_specific_flush() ;
+    }
+    row = buf = writer_buff + writer_buff_len ;
 
     /* Write out the first parameters (time) */
     copy_data_ascii_item(rec_buffer[0], writer_offset, buf );
@@ -127,12 +139,25 @@ int Trick::DRAscii::format_specific_write_data(unsigned int writer_offset) {
         buf += strlen(buf);
     }
 
-    out_stream << writer_buff << std::endl ;
+    *buf++ = '\n' ;
+    writer_buff_len += buf - row ;
+    return(buf - row) ;
+}
+
+/**
+@details
+-# Write the rows gathered in #writer_buff to the output file stream
+-# Flush the output file stream
+*/
+int Trick::DRAscii::format_specific_flush() {
 
-    /*! Flush the output */
-    out_stream.flush() ;
-    /*! +1 for endl */
-    return(strlen(writer_buff) + 1) ;
+    if ( writer_buff_len > 0 ) {
+        out_stream.write(writer_buff , writer_buff_len) ;
+        out_stream.flush() ;
+        write_calls++ ;
+        writer_buff_len = 0 ;
+    }
+    return(0) ;
 }
 
 /**
@@ -7,6 +7,7 @@ PROGRAMMERS:
 */
 
 #include <iostream>
+#include <errno.h>
 #include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
@@ -16,13 +17,26 @@ PROGRAMMERS:
 #include "trick/DRBinary.hh"
 #include "trick/command_line_protos.h"
 #include "trick/memorymanager_c_intf.h"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
 #include "trick/bitfield_proto.h"
 
+/* Rows between entries of the time index.  Must match what the data products expect of a fresh index. */
+static const int index_stride = 1024 ;
+
 /*
    Other classes inherit from DRBinary. In these cases, we don't want to register the memory as DRBinary,
    so register_group will be set to false.
 */
-Trick::DRBinary::DRBinary( std::string in_name , bool register_group ) : Trick::DataRecordGroup(in_name) {
+Trick::DRBinary::DRBinary( std::string in_name , bool register_group ) :
+ Trick::DataRecordGroup(in_name) ,
+ drop_page_cache(false) ,
+ bytes_not_written(0) ,
+ fd(-1) ,
+ row_size(0) ,
+ num_rows(0) ,
+ times_monotonic(true) ,
+ last_time(0.0) {
     if ( register_group ) {
         register_group_with_mm(this, "Trick::DRBinary") ;
     }
@@ -36,7 +50,7 @@ int Trick::DRBinary::format_specific_header( std::fstream & out_stream ) {
 /**
 @details
 -# Set the file extension to ".trk"
--# Allocate enough memory to hold #record_size of records in memory
+-# Allocate #writer_buff to hold at least #writer_buff_size bytes of rows, and at least one row
 -# Open the log file
    -# Return an error if the open failed
 -# Write out the magic Trick-07-[LB] keyword, L for little endian, B for big.
@@ -46,6 +60,7 @@ int Trick::DRBinary::format_specific_header( std::fstream & out_stream ) {
    -# Write out the units
    -# Write out the type
    -# Write out the size
+-# Clear the time index
 -# Declare the recording group to the memory manager so that the group can be checkpointed
    and restored
 */
@@ -63,15 +78,31 @@ int Trick::DRBinary::format_specific_init() {
 
     file_name.append(".trk");
 
-    /* Calculate a "worst case" for space used for 1 record. */
-    writer_buff = (char *)calloc(1 , record_size * rec_buffer.size()) ;
+    /* Rows are gathered in writer_buff and written when it fills. */
+    row_size = 0 ;
+    for (jj = 0; jj < rec_buffer.size(); jj++) {
+        row_size += rec_buffer[jj]->ref->attr->size ;
+    }
+    if ( writer_buff_size < row_size ) {
+        writer_buff_size = row_size ;
+    }
+    if ( writer_buff ) {
+        free(writer_buff) ;
+    }
+    writer_buff = (char *)calloc(1 , writer_buff_size) ;
+    writer_buff_len = 0 ;
 
     /* This loop touches all of the memory locations in the allocation forcing the
        system to actually do the allocation */
-    for ( jj= 0 ; jj < record_size * rec_buffer.size() ; jj += 1024 ) {
+    for ( jj= 0 ; jj < writer_buff_size ; jj += 1024 ) {
         writer_buff[jj] = 1 ;
     }
-    writer_buff[record_size * rec_buffer.size() - 1] = 1 ;
+    writer_buff[writer_buff_size - 1] = 1 ;
+
+    num_rows = 0 ;
+    bytes_not_written = 0 ;
+    time_index.clear() ;
+    times_monotonic = true ;
 
     /* start header information in trk file */
     if ((fd = creat(file_name.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH)) == -1) {
@@ -121,10 +152,10 @@ int Trick::DRBinary::format_specific_init() {
 
 /**
 @details
--# While there is data in memory that has not been written to disk
-   -# Write out each of the other parameter values to the temporary #writer_buff
-   -# Write #writer_buff to the output file
--# return the number of bytes written
+-# If the row does not fit in #writer_buff, flush #writer_buff to the output file
+-# Append each of the parameter values to #writer_buff
+-# Add the time of every index_stride'th row to the time index
+-# return the number of bytes in the row
 */
 int Trick::DRBinary::format_specific_write_data(unsigned int writer_offset) {
 
@@ -133,6 +164,12 @@ int Trick::DRBinary::format_specific_write_data(unsigned int writer_offset) {
     unsigned int ii ;
     unsigned int len = 0 ;
     char *address = 0 ;
+    char *row ;
+
+    if ( writer_buff_len + row_size > writer_buff_size ) {
+        format_specific_flush() ;
+    }
+    row = writer_buff + writer_buff_len ;
 
     /* Write out all parameters */
     for (ii = 0; ii < rec_buffer.size() ; ii++) {
@@ -155,19 +192,19 @@ int Trick::DRBinary::format_specific_write_data(unsigned int writer_offset) {
             case TRICK_UNSIGNED_LONG_LONG:
             case TRICK_STRUCTURED:
             case TRICK_DOUBLE:
-                memcpy(writer_buff + len, address, (size_t)rec_buffer[ii]->ref->attr->size);
+                memcpy(row + len, address, (size_t)rec_buffer[ii]->ref->attr->size);
                 break;
 
             case TRICK_BITFIELD:
                 sbf = GET_BITFIELD(address, rec_buffer[ii]->ref->attr->size,
                  rec_buffer[ii]->ref->attr->index[0].start, rec_buffer[ii]->ref->attr->index[0].size);
-                memcpy(writer_buff + len, &sbf, (size_t)rec_buffer[ii]->ref->attr->size);
+                memcpy(row + len, &sbf, (size_t)rec_buffer[ii]->ref->attr->size);
                 break;
 
             case TRICK_UNSIGNED_BITFIELD:
                 bf = GET_UNSIGNED_BITFIELD(address, rec_buffer[ii]->ref->attr->size,
                  rec_buffer[ii]->ref->attr->index[0].start, rec_buffer[ii]->ref->attr->index[0].size);
-                memcpy(writer_buff + len, &bf, (size_t)rec_buffer[ii]->ref->attr->size);
+                memcpy(row + len, &bf, (size_t)rec_buffer[ii]->ref->attr->size);
                 break;
 
             default:
@@ -177,17 +214,126 @@ int Trick::DRBinary::format_specific_write_data(unsigned int writer_offset) {
 
     }
 
-    return write( fd , writer_buff , len) ;
+    if ( rec_buffer.size() > 0 and rec_buffer[0]->ref->attr->type == TRICK_DOUBLE ) {
+        double time ;
+        memcpy(&time, row, sizeof(double)) ;
+        if ( num_rows % index_stride == 0 ) {
+            time_index.push_back(time) ;
+        }
+        if ( num_rows > 0 and time < last_time ) {
+            times_monotonic = false ;
+        }
+        last_time = time ;
+    }
+    num_rows++ ;
+
+    writer_buff_len += len ;
+    return len ;
+}
+
+/**
+@details
+-# If an earlier write failed, count the gathered rows as not written and discard them
+-# Write the rows gathered in #writer_buff to the output file, retrying partial and interrupted writes
+-# If a write fails, report it, count the bytes not written, and stop recording the group
+-# If dropping the page cache, advise the kernel the file will not be read back
+*/
+int Trick::DRBinary::format_specific_flush() {
+
+    unsigned int written = 0 ;
+    ssize_t ret ;
+
+    if ( bytes_not_written > 0 ) {
+        bytes_not_written += writer_buff_len ;
+        writer_buff_len = 0 ;
+        return -1 ;
+    }
+
+    while ( written < writer_buff_len ) {
+        ret = write( fd , writer_buff + written , writer_buff_len - written ) ;
+        write_calls++ ;
+        if ( ret < 0 and errno == EINTR ) {
+            continue ;
+        }
+        if ( ret <= 0 ) {
+            bytes_not_written += writer_buff_len - written ;
+            message_publish(MSG_ERROR, "Data record group %s could not write to %s: %s.  "
+             "Recording of the group is stopped, %u bytes were not written.\n", group_name.c_str(),
+             file_name.c_str(), ( ret < 0 ) ? strerror(errno) : "no bytes written", writer_buff_len - written) ;
+            record = false ;
+            break ;
+        }
+        written += ret ;
+    }
+    writer_buff_len = 0 ;
+
+#if __linux
+    if ( drop_page_cache and written > 0 ) {
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) ;
+    }
+#endif
+    return ( bytes_not_written > 0 ) ? -1 : 0 ;
+}
+
+int Trick::DRBinary::set_drop_page_cache( bool yes_no ) {
+    drop_page_cache = yes_no ;
+    return 0 ;
+}
+
+/**
+@details
+-# Write the magic TrickIdx-[LB] keyword, L for little endian, B for big.
+-# Write the stride, whether the times never decrease, and the number of rows indexed
+-# Write the times of the indexed rows
+*/
+void Trick::DRBinary::write_time_index() {
+
+    int index_fd ;
+    int write_value ;
+    std::string index_name = file_name + ".idx" ;
+
+    union {
+        long l;
+        char c[sizeof(long)];
+    } byte_order_union;
+
+    /* Without times in the first column there is nothing to index. */
+    if ( time_index.size() != (size_t)((num_rows + index_stride - 1) / index_stride) ) {
+        return ;
+    }
+    if ((index_fd = creat(index_name.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH)) == -1) {
+        return ;
+    }
+    byte_order_union.l = 1 ;
+    if (byte_order_union.c[sizeof(long)-1] != 1) {
+        write( index_fd , "TrickIdx-L", (size_t)10 ) ;
+    } else {
+        write( index_fd , "TrickIdx-B", (size_t)10 ) ;
+    }
+    write_value = index_stride ;
+    write( index_fd , &write_value , sizeof(int) ) ;
+    write_value = times_monotonic ;
+    write( index_fd , &write_value , sizeof(int) ) ;
+    write( index_fd , &num_rows , sizeof(long long) ) ;
+    if ( ! time_index.empty() ) {
+        write( index_fd , &time_index[0] , time_index.size() * sizeof(double) ) ;
+    }
+    close(index_fd) ;
 }
 
 /**
 @details
 -# Close the output file stream
+-# Write the time index, unless rows were lost to a failed write
 */
 int Trick::DRBinary::format_specific_shutdown() {
 
     if ( inited ) {
         close(fd) ;
+        // the index would point past rows that were never written
+        if ( bytes_not_written == 0 ) {
+            write_time_index() ;
+        }
     }
     return(0) ;
 }
\ No newline at end of file
@@ -0,0 +1,325 @@
+/*
+PURPOSE:
+    (Data record to disk in compressed column chunks.)
+*/
+
+#include <iostream>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trick/DRCompressed.hh"
+#include "trick/dr_compress.h"
+#include "trick/command_line_protos.h"
+#include "trick/memorymanager_c_intf.h"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+#include "trick/bitfield_proto.h"
+
+Trick::DRCompressed::DRCompressed( std::string in_name ) :
+ Trick::DataRecordGroup(in_name) ,
+ rows_per_chunk(4096) ,
+ bytes_not_written(0) ,
+ fd(-1) ,
+ file_offset(0) ,
+ chunk_buff(NULL) ,
+ chunk_rows(0) {
+    register_group_with_mm(this, "Trick::DRCompressed") ;
+}
+
+Trick::DRCompressed::~DRCompressed() {
+    if ( chunk_buff ) {
+        free(chunk_buff) ;
+    }
+}
+
+int Trick::DRCompressed::set_rows_per_chunk( unsigned int num ) {
+    if ( num == 0 ) {
+        return -1 ;
+    }
+    rows_per_chunk = num ;
+    return 0 ;
+}
+
+int Trick::DRCompressed::format_specific_header( std::fstream & out_stream ) {
+    out_stream << " byte_order is " << byte_order << std::endl ;
+    return(0) ;
+}
+
+/**
+@details
+-# If an earlier write failed, count the bytes as not written and discard them
+-# Write the bytes, retrying partial and interrupted writes
+-# If a write fails, report it, count the bytes not written, and stop recording the group
+*/
+int Trick::DRCompressed::write_all( const char * buf , unsigned int len ) {
+
+    unsigned int written = 0 ;
+    ssize_t ret ;
+
+    if ( bytes_not_written > 0 ) {
+        bytes_not_written += len ;
+        return 0 ;
+    }
+
+    while ( written < len ) {
+        ret = write( fd , buf + written , len - written ) ;
+        if ( ret < 0 and errno == EINTR ) {
+            continue ;
+        }
+        if ( ret <= 0 ) {
+            bytes_not_written += len - written ;
+            message_publish(MSG_ERROR, "Data record group %s could not write to %s: %s.  "
+             "Recording of the group is stopped, %u bytes were not written.\n", group_name.c_str(),
+             file_name.c_str(), ( ret < 0 ) ? strerror(errno) : "no bytes written", len - written) ;
+            record = false ;
+            break ;
+        }
+        written += ret ;
+    }
+    file_offset += written ;
+    return written ;
+}
+
+/**
+@details
+-# Set the file extension to ".trz"
+-# Allocate #chunk_buff to gather #rows_per_chunk rows of every column
+-# Allocate #writer_buff to hold the worst case compressed chunk
+-# Open the log file
+   -# Return an error if the open failed
+-# Write out the magic Trick-Z1-[LB] keyword, L for little endian, B for big.
+-# Write out the number of variables recorded
+-# For each variable to be recorded
+   -# Write out the name
+   -# Write out the units
+   -# Write out the type
+   -# Write out the size
+-# Write out the rows per chunk
+*/
+int Trick::DRCompressed::format_specific_init() {
+
+    unsigned int jj ;
+    unsigned int row_size = 0 ;
+    int write_value ;
+    std::string header ;
+
+    union {
+        long l;
+        char c[sizeof(long)];
+    } byte_order_union;
+
+    file_name.append(".trz");
+
+    column_sizes.clear() ;
+    column_offsets.clear() ;
+    for (jj = 0; jj < rec_buffer.size(); jj++) {
+        column_offsets.push_back(row_size) ;
+        column_sizes.push_back(rec_buffer[jj]->ref->attr->size) ;
+        row_size += rec_buffer[jj]->ref->attr->size ;
+    }
+
+    if ( chunk_buff ) {
+        free(chunk_buff) ;
+    }
+    chunk_buff = (char *)calloc(rows_per_chunk , row_size) ;
+    chunk_rows = 0 ;
+    chunks.clear() ;
+    bytes_not_written = 0 ;
+
+    writer_buff_size = sizeof(int) + 2 * sizeof(double) + rec_buffer.size() * sizeof(int) ;
+    for (jj = 0; jj < rec_buffer.size(); jj++) {
+        writer_buff_size += dr_compress_bound(rows_per_chunk, column_sizes[jj]) ;
+    }
+    if ( writer_buff ) {
+        free(writer_buff) ;
+    }
+    writer_buff = (char *)calloc(1 , writer_buff_size) ;
+    writer_buff_len = 0 ;
+
+    if ((fd = creat(file_name.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH)) == -1) {
+        message_publish(MSG_ERROR, "Can't open Data Record file %s.\n", file_name.c_str()) ;
+        record = false ;
+        return (-1) ;
+    }
+    file_offset = 0 ;
+
+    /* The header is built in memory and written with one call. */
+    byte_order_union.l = 1 ;
+    if (byte_order_union.c[sizeof(long)-1] != 1) {
+        header.append("Trick-Z1-L") ;
+    } else {
+        header.append("Trick-Z1-B") ;
+    }
+    write_value = rec_buffer.size() ;
+    header.append((char *)&write_value, sizeof(int)) ;
+
+    for (jj = 0; jj < rec_buffer.size(); jj++) {
+        /* name */
+        write_value = strlen(rec_buffer[jj]->ref->reference) ;
+        header.append((char *)&write_value, sizeof(int)) ;
+        header.append(rec_buffer[jj]->ref->reference, write_value) ;
+
+        /* units */
+        if ( rec_buffer[jj]->ref->attr->mods & TRICK_MODS_UNITSDASHDASH ) {
+            write_value = strlen("--") ;
+            header.append((char *)&write_value, sizeof(int)) ;
+            header.append("--", write_value) ;
+        } else {
+            write_value = strlen(rec_buffer[jj]->ref->attr->units) ;
+            header.append((char *)&write_value, sizeof(int)) ;
+            header.append(rec_buffer[jj]->ref->attr->units, write_value) ;
+        }
+
+        write_value = rec_buffer[jj]->ref->attr->type ;
+        header.append((char *)&write_value, sizeof(int)) ;
+
+        write_value = rec_buffer[jj]->ref->attr->size ;
+        header.append((char *)&write_value, sizeof(int)) ;
+    }
+    write_value = rows_per_chunk ;
+    header.append((char *)&write_value, sizeof(int)) ;
+
+    total_bytes_written += write_all(header.data(), header.size()) ;
+    return(0) ;
+}
+
+/**
+@details
+-# Copy each of the parameter values into its column of #chunk_buff
+-# If the chunk is full, compress and write it
+-# Return the number of bytes written to the file
+*/
+int Trick::DRCompressed::format_specific_write_data(unsigned int writer_offset) {
+
+    unsigned long bf ;
+    int sbf ;
+    unsigned int ii ;
+    unsigned int size ;
+    char * address ;
+    char * dest ;
+
+    for (ii = 0; ii < rec_buffer.size() ; ii++) {
+
+        size = column_sizes[ii] ;
+        address = rec_buffer[ii]->buffer + ( writer_offset * size ) ;
+        dest = chunk_buff + rows_per_chunk * column_offsets[ii] + chunk_rows * size ;
+
+        switch (rec_buffer[ii]->ref->attr->type) {
+            case TRICK_BITFIELD:
+                sbf = GET_BITFIELD(address, size,
+                 rec_buffer[ii]->ref->attr->index[0].start, rec_buffer[ii]->ref->attr->index[0].size);
+                memcpy(dest, &sbf, (size_t)size);
+                break;
+
+            case TRICK_UNSIGNED_BITFIELD:
+                bf = GET_UNSIGNED_BITFIELD(address, size,
+                 rec_buffer[ii]->ref->attr->index[0].start, rec_buffer[ii]->ref->attr->index[0].size);
+                memcpy(dest, &bf, (size_t)size);
+                break;
+
+            default:
+                memcpy(dest, address, (size_t)size);
+                break;
+        }
+    }
+
+    if ( ++chunk_rows == rows_per_chunk ) {
+        return write_chunk() ;
+    }
+    return 0 ;
+}
+
+/**
+@details
+-# Write the chunk header, the number of rows and the first and last times
+-# Compress each column of #chunk_buff into #writer_buff and record its length in the header
+-# Write the chunk with one call and add it to the index if all of it was written
+*/
+int Trick::DRCompressed::write_chunk() {
+
+    Trick::DRCompressedChunk chunk ;
+    unsigned int ii ;
+    unsigned int len ;
+    int column_len ;
+    char * column ;
+    int ret ;
+
+    if ( chunk_rows == 0 ) {
+        return 0 ;
+    }
+
+    chunk.offset = file_offset ;
+    chunk.num_rows = chunk_rows ;
+    /* The first column is always the sim time */
+    memcpy(&chunk.start_time, chunk_buff, sizeof(double)) ;
+    memcpy(&chunk.end_time, chunk_buff + (chunk_rows - 1) * sizeof(double), sizeof(double)) ;
+
+    len = 0 ;
+    memcpy(writer_buff + len, &chunk.num_rows, sizeof(int)) ;
+    len += sizeof(int) ;
+    memcpy(writer_buff + len, &chunk.start_time, sizeof(double)) ;
+    len += sizeof(double) ;
+    memcpy(writer_buff + len, &chunk.end_time, sizeof(double)) ;
+    len += sizeof(double) ;
+    column = writer_buff + len + rec_buffer.size() * sizeof(int) ;
+
+    for (ii = 0; ii < rec_buffer.size() ; ii++) {
+        column_len = dr_compress_column((unsigned char *)chunk_buff + rows_per_chunk * column_offsets[ii],
+         chunk_rows, column_sizes[ii], (unsigned char *)column) ;
+        memcpy(writer_buff + len, &column_len, sizeof(int)) ;
+        len += sizeof(int) ;
+        column += column_len ;
+    }
+    len = column - writer_buff ;
+
+    chunk_rows = 0 ;
+    write_calls++ ;
+    ret = write_all(writer_buff, len) ;
+    if ( bytes_not_written == 0 ) {
+        chunks.push_back(chunk) ;
+    }
+    return ret ;
+}
+
+/**
+@details
+-# Compress and write the partial last chunk
+-# Write the chunk index, the number of chunks, the index offset, and the index marker, unless bytes
+   were lost to a failed write.  Readers then find the written chunks by walking the chunk headers.
+-# Close the output file
+*/
+int Trick::DRCompressed::format_specific_shutdown() {
+
+    std::string index ;
+    int64_t index_offset ;
+    int num_chunks ;
+    unsigned int ii ;
+
+    if ( inited and fd != -1 ) {
+        total_bytes_written += write_chunk() ;
+
+        // the index would point at chunks that are not in the file
+        if ( bytes_not_written == 0 ) {
+            index_offset = file_offset ;
+            for ( ii = 0 ; ii < chunks.size() ; ii++ ) {
+                index.append((char *)&chunks[ii].offset, sizeof(int64_t)) ;
+                index.append((char *)&chunks[ii].num_rows, sizeof(int)) ;
+                index.append((char *)&chunks[ii].start_time, sizeof(double)) ;
+                index.append((char *)&chunks[ii].end_time, sizeof(double)) ;
+            }
+            num_chunks = chunks.size() ;
+            index.append((char *)&num_chunks, sizeof(int)) ;
+            index.append((char *)&index_offset, sizeof(int64_t)) ;
+            index.append("TrkZIndx", 8) ;
+            total_bytes_written += write_all(index.data(), index.size()) ;
+        }
+
+        close(fd) ;
+        fd = -1 ;
+    }
+    return(0) ;
+}
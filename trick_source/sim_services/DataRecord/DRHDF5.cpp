@@ -6,6 +6,7 @@ PROGRAMMERS:
 */
 
 #include <iostream>
+#include <algorithm>
 #include <stdlib.h>
 
 #include "trick/DRHDF5.hh"
@@ -219,53 +220,37 @@ int Trick::DRHDF5::format_specific_init() {
 int Trick::DRHDF5::write_data(bool must_write) {
 
 #ifdef HDF5
-    unsigned int local_buffer_num ;
+    uint64_t first ;
     unsigned int num_to_write ;
     unsigned int ii;
     char *buf = 0;
 
+    // A ring buffer's rows are checked one at a time as they are copied out of the ring.
+    if ( buffer_type == DR_Ring_Buffer ) {
+        return Trick::DataRecordGroup::write_data(must_write) ;
+    }
+
     if ( record and inited and (buffer_type == DR_No_Buffer or must_write)) {
 
         // buffer_mutex is used in this one place to prevent forced calls of write_data
         // to not overwrite data being written by the asynchronous thread.
         pthread_mutex_lock(&buffer_mutex) ;
-        local_buffer_num = buffer_num ;
-        if ( (local_buffer_num - writer_num) > max_num ) {
-            num_to_write = max_num ;
-        } else {
-            num_to_write = (local_buffer_num - writer_num) ;
-        }
-        writer_num = local_buffer_num - num_to_write ;
-
-        if ( writer_num != local_buffer_num ) {
-            // Test if the writer pointer to the right of the buffer pointer in the ring
-            if ( (writer_num % max_num) > (local_buffer_num % max_num) ) {
-               // we have 2 segments to write per variable
-               for (ii = 0; ii < parameters.size(); ii++) {
-                   HDF5_INFO * hi = parameters[ii] ;
-                   unsigned int writer_offset = writer_num % max_num ;
-                   buf = hi->drb->buffer + (writer_offset * hi->drb->ref->attr->size) ;
-
-                   /* Append all of the data on the end of the buffer to the packet table. */
-                   H5PTappend( hi->dataset, max_num - writer_offset , buf );
-
-                   buf = hi->drb->buffer ;
-                   /* Append all of the data at the beginning of the buffer to the packet table. */
-                   H5PTappend( hi->dataset, local_buffer_num % max_num , buf );
-               }
-            }  else {
-               // we have 1 continous segment to write per variable
-               for (ii = 0; ii < parameters.size(); ii++) {
-                   HDF5_INFO * hi = parameters[ii] ;
-                   unsigned int writer_offset = writer_num % max_num ;
-                   buf = hi->drb->buffer + (writer_offset * hi->drb->ref->attr->size) ;
-
-                   /* Append all of the data to the packet table. */
-                   H5PTappend( hi->dataset, local_buffer_num - writer_num , buf );
-
-               }
+        num_to_write = consume_rows(first) ;
+
+        if ( num_to_write > 0 ) {
+            unsigned int writer_offset = first % max_num ;
+            // the rows run to the end of the buffer and may continue from its beginning
+            unsigned int first_segment = std::min(num_to_write, max_num - writer_offset) ;
+            for (ii = 0; ii < parameters.size(); ii++) {
+                HDF5_INFO * hi = parameters[ii] ;
+                buf = hi->drb->buffer + (writer_offset * hi->drb->ref->attr->size) ;
+                H5PTappend( hi->dataset, first_segment , buf );
+                if ( num_to_write > first_segment ) {
+                    H5PTappend( hi->dataset, num_to_write - first_segment , hi->drb->buffer );
+                }
             }
-            writer_num = local_buffer_num ;
+            rows_written += num_to_write ;
+            release_rows(first + num_to_write) ;
         }
         pthread_mutex_unlock(&buffer_mutex) ;
 
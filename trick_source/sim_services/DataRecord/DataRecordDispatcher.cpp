@@ -26,46 +26,86 @@
 #include "trick/message_proto.h"
 #include "trick/message_type.h"
 #include "trick/command_line_protos.h"
+#include "trick/TraceLog.hh"
 
 Trick::DataRecordDispatcher * the_drd = NULL ;
 
-Trick::DRDMutexes::DRDMutexes() {
+Trick::DRDMutexes::DRDMutexes() :
+ num_signals(0) ,
+ max_queue_depth(0) {
     pthread_cond_init(&dr_go_cv, NULL);
     pthread_mutex_init(&dr_go_mutex, NULL);
     pthread_cond_init(&init_complete_cv, NULL);
     pthread_mutex_init(&init_complete_mutex, NULL);
+    pthread_cond_init(&write_done_cv, NULL);
 }
 
 Trick::DRDWriterThread::DRDWriterThread(DRDMutexes & in_mutexes, std::vector <Trick::DataRecordGroup *> & in_groups) :
  ThreadBase("DR_Writer"),
+ active_group(NULL) ,
+ groups_written(0) ,
  drd_mutexes(in_mutexes) ,
  groups(in_groups) {}
 
+/* Cancellation cleanup.  A writer cancelled inside pthread_cond_wait owns dr_go_mutex. */
+static void unlock_dr_go_mutex( void * mutex ) {
+    pthread_mutex_unlock((pthread_mutex_t *)mutex) ;
+}
+
+/**
+@details
+-# Tell the main thread that the writer is ready to go
+-# From now until death
+   -# Wait for a group to appear in the write queue
+   -# Take the group off the queue and call its write_data method.  The dispatcher mutex
+      is not held while writing so other writers can take the next groups.
+   -# Signal anyone waiting for the group to finish writing
+*/
 void * Trick::DRDWriterThread::thread_body() {
+    int old_state ;
+
     pthread_mutex_lock(&(drd_mutexes.dr_go_mutex));
+    pthread_cleanup_push(unlock_dr_go_mutex, &(drd_mutexes.dr_go_mutex)) ;
 
     /* tell the main thread that the writer is ready to go */
     pthread_mutex_lock(&(drd_mutexes.init_complete_mutex));
     pthread_cond_signal(&(drd_mutexes.init_complete_cv));
     pthread_mutex_unlock(&(drd_mutexes.init_complete_mutex));
 
-    /* from now until death, wait for the condition variable,
-       then call the write_data method for all of the groups */
     while(1) {
-        pthread_cond_wait(&(drd_mutexes.dr_go_cv), &(drd_mutexes.dr_go_mutex));
-        for ( unsigned int ii = 0 ; ii < groups.size() ; ii++ ) {
-            if ( groups[ii]->buffer_type == Trick::DR_Buffer ) {
-                groups[ii]->write_data(true) ;
-            }
+        while ( drd_mutexes.write_queue.empty() ) {
+            pthread_cond_wait(&(drd_mutexes.dr_go_cv), &(drd_mutexes.dr_go_mutex));
         }
+        active_group = drd_mutexes.write_queue.front() ;
+        drd_mutexes.write_queue.pop_front() ;
+        active_group->write_queued = false ;
+        pthread_mutex_unlock(&(drd_mutexes.dr_go_mutex));
+
+        /* A cancel in the middle of a write would leave the group's buffer mutex locked. */
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old_state) ;
+        unsigned long long trace_start = Trick::TraceLog::start() ;
+        active_group->write_data(true) ;
+        Trick::TraceLog::complete("data_record", "write", trace_start) ;
+        pthread_mutex_lock(&(drd_mutexes.dr_go_mutex));
+        groups_written++ ;
+        active_group = NULL ;
+        pthread_cond_broadcast(&(drd_mutexes.write_done_cv));
+        pthread_setcancelstate(old_state, NULL) ;
     }
-    pthread_mutex_unlock(&(drd_mutexes.dr_go_mutex));
+    pthread_cleanup_pop(1) ;
     return NULL ;
 }
 
 void Trick::DRDWriterThread::dump( std::ostream & oss ) {
     oss << "Trick::DRDWriterThread (" << name << ")" << std::endl ;
     oss << "    number of data record groups = " << groups.size() << std::endl ;
+    oss << "    groups written by this thread = " << groups_written << std::endl ;
+    oss << "    writer signals = " << drd_mutexes.num_signals
+        << ", groups waiting = " << drd_mutexes.write_queue.size()
+        << ", max groups waiting = " << drd_mutexes.max_queue_depth << std::endl ;
+    for ( unsigned int ii = 0 ; ii < groups.size() ; ii++ ) {
+        groups[ii]->dump_write_rates(oss) ;
+    }
     Trick::ThreadBase::dump(oss) ;
 }
 
@@ -74,6 +114,9 @@ Trick::DataRecordDispatcher::DataRecordDispatcher() : drd_writer_thread(drd_mute
 }
 
 Trick::DataRecordDispatcher::~DataRecordDispatcher() {
+    for ( unsigned int ii = 0 ; ii < extra_writer_threads.size() ; ii++ ) {
+        delete extra_writer_threads[ii] ;
+    }
 }
 
 int Trick::DataRecordDispatcher::remove_files() {
@@ -106,19 +149,80 @@ int Trick::DataRecordDispatcher::remove_files() {
 
 /**
 @details
--# Initialize thread mutex and condition variable
--# Create a new thread calling the DataRecordThreaded Writer routine.
--# Wait for the data record thread to initialize before continuing.
+-# For each writer thread that has not been started
+   -# Create a new thread calling the DataRecordThreaded Writer routine.
+   -# Wait for the data record thread to initialize before continuing.
 */
 int Trick::DataRecordDispatcher::init() {
 
-    pthread_mutex_lock(&drd_mutexes.init_complete_mutex);
-    drd_writer_thread.create_thread() ;
-    pthread_cond_wait(&drd_mutexes.init_complete_cv, &drd_mutexes.init_complete_mutex);
+    unsigned int ii ;
+    DRDWriterThread * writer ;
+
+    for ( ii = 0 ; ii < get_num_writer_threads() ; ii++ ) {
+        writer = get_writer_thread(ii) ;
+        if ( writer->get_pthread_id() == 0 ) {
+            pthread_mutex_lock(&drd_mutexes.init_complete_mutex);
+            writer->create_thread() ;
+            pthread_cond_wait(&drd_mutexes.init_complete_cv, &drd_mutexes.init_complete_mutex);
+            pthread_mutex_unlock(&drd_mutexes.init_complete_mutex);
+        }
+    }
 
     return(0) ;
 }
 
+/**
+@details
+-# Writers cannot be removed once running.  Return an error if num is smaller than the
+   number of running writers.
+-# Add or delete writer threads to make num writers.
+-# If the writers are already running, start the new ones.
+*/
+int Trick::DataRecordDispatcher::set_num_writer_threads( unsigned int num ) {
+
+    unsigned int ii ;
+
+    if ( num == 0 ) {
+        message_publish(MSG_ERROR, "Data Record number of writer threads must be at least 1.\n") ;
+        return -1 ;
+    }
+    for ( ii = num ; ii < get_num_writer_threads() ; ii++ ) {
+        if ( get_writer_thread(ii)->get_pthread_id() != 0 ) {
+            message_publish(MSG_ERROR, "Data Record writer thread %d is already running.\n", ii) ;
+            return -1 ;
+        }
+    }
+
+    while ( extra_writer_threads.size() > num - 1 ) {
+        delete extra_writer_threads.back() ;
+        extra_writer_threads.pop_back() ;
+    }
+    while ( extra_writer_threads.size() < num - 1 ) {
+        std::ostringstream oss ;
+        oss << "DR_Writer_" << extra_writer_threads.size() + 1 ;
+        extra_writer_threads.push_back(new DRDWriterThread(drd_mutexes, groups)) ;
+        extra_writer_threads.back()->set_name(oss.str()) ;
+    }
+
+    if ( drd_writer_thread.get_pthread_id() != 0 ) {
+        init() ;
+    }
+    return 0 ;
+}
+
+unsigned int Trick::DataRecordDispatcher::get_num_writer_threads() {
+    return extra_writer_threads.size() + 1 ;
+}
+
+Trick::DRDWriterThread * Trick::DataRecordDispatcher::get_writer_thread( unsigned int ii ) {
+    if ( ii == 0 ) {
+        return &drd_writer_thread ;
+    } else if ( ii <= extra_writer_threads.size() ) {
+        return extra_writer_threads[ii - 1] ;
+    }
+    return NULL ;
+}
+
 /**
 add_sim_object is called by the executive when a new sim_object is added to the sim.
 @details
@@ -161,21 +265,37 @@ int Trick::DataRecordDispatcher::add_group(Trick::DataRecordGroup * in_group, Tr
 
 /**
 @details
--# Remove the data recording group from the dispatcher's list of groups
+-# Remove the data recording group from the dispatcher's list of groups and write queue
+-# Wait for any writer thread writing the group to finish
 -# Remove the group from the executive.
 */
 int Trick::DataRecordDispatcher::remove_group(Trick::DataRecordGroup * in_group) {
 
     std::vector <Trick::DataRecordGroup *>::iterator drg_it ;
+    std::deque <Trick::DataRecordGroup *>::iterator wq_it ;
+    unsigned int ii ;
 
 
     // remove the group from the dispatcher vector of jobs.
     for ( drg_it = groups.begin() ; drg_it != groups.end() ; ) {
         if ( (*drg_it) == in_group ) {
-            // erase the group from the dispatcher. Lock the mutex so we aren't in the
-            // middle of writing data as we delete the group.
+            // erase the group from the dispatcher. Lock the mutex and wait for the writers
+            // so we aren't in the middle of writing data as we delete the group.
             pthread_mutex_lock(&drd_mutexes.dr_go_mutex) ;
             drg_it = groups.erase(drg_it) ;
+            for ( wq_it = drd_mutexes.write_queue.begin() ; wq_it != drd_mutexes.write_queue.end() ; ) {
+                if ( (*wq_it) == in_group ) {
+                    wq_it = drd_mutexes.write_queue.erase(wq_it) ;
+                } else {
+                    wq_it++ ;
+                }
+            }
+            in_group->write_queued = false ;
+            for ( ii = 0 ; ii < get_num_writer_threads() ; ii++ ) {
+                while ( get_writer_thread(ii)->active_group == in_group ) {
+                    pthread_cond_wait(&drd_mutexes.write_done_cv, &drd_mutexes.dr_go_mutex) ;
+                }
+            }
             pthread_mutex_unlock(&drd_mutexes.dr_go_mutex) ;
 
             // call exec_remove_sim_object to remove the data recording jobs from the sim.
@@ -210,19 +330,63 @@ Trick::DataRecordGroup * Trick::DataRecordDispatcher::get_group(std::string in_n
 
 /**
 @details
--# If the writer thread condition variable is unlocked
-   -# Signal the thread to go
+-# Lock the writer mutex.  Writers only hold it to take a group off the queue, never while
+   writing, so the wait is short and a frame's signal is never dropped.
+-# Queue every DR_Buffer group that has records waiting and is not already queued
+-# Wake the writers if any group was queued
 */
 int Trick::DataRecordDispatcher::signal_thread() {
 
-    if (!pthread_mutex_trylock(&drd_mutexes.dr_go_mutex)) {
-        pthread_cond_signal(&drd_mutexes.dr_go_cv);
-        pthread_mutex_unlock(&drd_mutexes.dr_go_mutex);
+    unsigned int ii ;
+    unsigned int queued ;
+
+    pthread_mutex_lock(&drd_mutexes.dr_go_mutex);
+    queued = drd_mutexes.write_queue.size() ;
+    for ( ii = 0 ; ii < groups.size() ; ii++ ) {
+        if ( groups[ii]->buffer_type == Trick::DR_Buffer ) {
+            queue_group(groups[ii]) ;
+        }
+    }
+    if ( drd_mutexes.write_queue.size() > queued ) {
+        drd_mutexes.num_signals++ ;
+        if ( drd_mutexes.write_queue.size() > drd_mutexes.max_queue_depth ) {
+            drd_mutexes.max_queue_depth = drd_mutexes.write_queue.size() ;
+        }
+        pthread_cond_broadcast(&drd_mutexes.dr_go_cv);
     }
+    pthread_mutex_unlock(&drd_mutexes.dr_go_mutex);
 
     return(0) ;
 }
 
+/**
+@details
+-# Record the high water mark of records waiting to be written
+-# Warn once when the buffer is 90% full, the writers are falling behind and records will
+   be lost if it fills.  The warning is rearmed when the buffer drains to half.
+-# If records are waiting and the group is not already queued, queue it
+*/
+void Trick::DataRecordDispatcher::queue_group( Trick::DataRecordGroup * in_group ) {
+
+    unsigned int buffered = in_group->buffered_rows() ;
+
+    if ( buffered > in_group->max_buffered ) {
+        in_group->max_buffered = buffered ;
+    }
+    if ( ! in_group->overflow_warning and buffered >= in_group->max_num - in_group->max_num / 10 ) {
+        message_publish(MSG_WARNING, "Data Record group %s buffer is %u of %u records full, writer threads are behind.\n",
+         in_group->group_name.c_str(), buffered, in_group->max_num) ;
+        in_group->overflow_warning = true ;
+    } else if ( in_group->overflow_warning and buffered < in_group->max_num / 2 ) {
+        in_group->overflow_warning = false ;
+    }
+
+    if ( buffered > 0 and ! in_group->write_queued ) {
+        in_group->write_queued = true ;
+        drd_mutexes.write_queue.push_back(in_group) ;
+    }
+}
+
 /**
 @details
 -# Close out current data record groups
@@ -231,8 +395,18 @@ int Trick::DataRecordDispatcher::signal_thread() {
 */
 int Trick::DataRecordDispatcher::preload_checkpoint() {
     unsigned int ii ;
+    // stop queueing writes, the groups are about to be replaced
+    pthread_mutex_lock(&drd_mutexes.dr_go_mutex) ;
+    drd_mutexes.write_queue.clear() ;
+    for ( ii = 0 ; ii < get_num_writer_threads() ; ii++ ) {
+        while ( get_writer_thread(ii)->active_group != NULL ) {
+            pthread_cond_wait(&drd_mutexes.write_done_cv, &drd_mutexes.dr_go_mutex) ;
+        }
+    }
+    pthread_mutex_unlock(&drd_mutexes.dr_go_mutex) ;
     // close out current data record groups
     for ( ii = 0 ; ii < groups.size() ; ii++ ) {
+        groups[ii]->write_queued = false ;
         groups[ii]->shutdown() ;
     }
     groups.clear() ;
@@ -269,17 +443,18 @@ int Trick::DataRecordDispatcher::dmtcp_restart() {
 
 /**
 @details
--# If the thread was started,
-   -# Wait for the thread to be available
-   -# Cancel the thread
+-# For each writer thread that was started
+   -# Cancel the thread.  A writer in the middle of a group finishes the group first.
 */
 int Trick::DataRecordDispatcher::shutdown() {
 
-    if ( drd_writer_thread.get_pthread_id() != 0 ) {
-        pthread_mutex_lock( &drd_mutexes.dr_go_mutex);
-        pthread_cancel( drd_writer_thread.get_pthread_id()) ;
-        pthread_mutex_unlock( &drd_mutexes.dr_go_mutex);
+    unsigned int ii ;
+
+    pthread_mutex_lock( &drd_mutexes.dr_go_mutex);
+    for ( ii = 0 ; ii < get_num_writer_threads() ; ii++ ) {
+        get_writer_thread(ii)->cancel_thread() ;
     }
+    pthread_mutex_unlock( &drd_mutexes.dr_go_mutex);
 
     return(0) ;
 }
@@ -6,6 +6,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <iomanip>
+#include <sys/time.h>
 
 #ifdef __GNUC__
 #include <cxxabi.h>
@@ -70,15 +71,26 @@ Trick::DataRecordGroup::DataRecordGroup( std::string in_name ) :
  change_variable_alias(NULL),
  max_num(100000),
  buffer_num(0),
+ buffer_claimed(0),
  writer_num(0),
+ rows_dropped(0),
  max_file_size(1<<30), // 1 GB
  total_bytes_written(0),
  max_size_warning(false),
  writer_buff(NULL),
+ writer_buff_size(1<<20), // 1 MB
+ writer_buff_len(0),
+ rows_written(0),
+ write_calls(0),
+ write_start_time(0.0),
+ write_queued(false),
+ max_buffered(0),
+ overflow_warning(false),
  single_prec_only(false),
  buffer_type(DR_Buffer),
  job_class("data_record"),
- curr_time(0.0)
+ curr_time(0.0),
+ copy_plan_stale(true)
 {
 
     union {
@@ -205,6 +217,11 @@ int Trick::DataRecordGroup::set_max_file_size( uint64_t bytes ) {
     return(0) ;
 }
 
+int Trick::DataRecordGroup::set_writer_buff_size( unsigned int bytes ) {
+    writer_buff_size = bytes ;
+    return(0) ;
+}
+
 int Trick::DataRecordGroup::set_single_prec_only( bool in_single_prec_only ) {
     single_prec_only = in_single_prec_only ;
     return(0) ;
@@ -256,6 +273,7 @@ int Trick::DataRecordGroup::add_variable( std::string in_name , std::string alia
     new_var->name = in_name ;
     new_var->alias = alias ;
     rec_buffer.push_back(new_var) ;
+    copy_plan_stale = true ;
     return 0 ;
 }
 
@@ -283,6 +301,7 @@ void Trick::DataRecordGroup::remove_variable( std::string in_name ) {
 
     remove_from(rec_buffer);
     remove_from(change_buffer);
+    copy_plan_stale = true ;
 }
 
 void Trick::DataRecordGroup::remove_all_variables() {
@@ -300,6 +319,7 @@ void Trick::DataRecordGroup::remove_all_variables() {
     }
 
     change_buffer.clear();
+    copy_plan_stale = true ;
 }
 
 int Trick::DataRecordGroup::add_variable( REF2 * ref2 ) {
@@ -315,6 +335,7 @@ int Trick::DataRecordGroup::add_variable( REF2 * ref2 ) {
     new_var->last_value = (char *)calloc(1 , new_var->ref->attr->size) ;
     // Don't allocate space for the temp storage buffer until "init"
     rec_buffer.push_back(new_var) ;
+    copy_plan_stale = true ;
 
     return(0) ;
 
@@ -337,6 +358,7 @@ int Trick::DataRecordGroup::add_change_variable( std::string in_name ) {
     new_var->last_value =  NULL ;
     memcpy(new_var->buffer , ref2->address , ref2->attr->size) ;
     change_buffer.push_back(new_var) ;
+    copy_plan_stale = true ;
 
     return(0) ;
 
@@ -349,6 +371,7 @@ int Trick::DataRecordGroup::add_change_variable( std::string in_name ) {
    -# The endianness of the log file is written to the log header.
    -# The names of the parameters contained in the log file are written to the header.
 -# Memory buffers are allocated to store simulation data
+-# The copy plan used by data_record is built
 -# The DataRecordGroupObject (a derived SimObject) is added to the Scheduler.
 */
 int Trick::DataRecordGroup::init() {
@@ -357,7 +380,14 @@ int Trick::DataRecordGroup::init() {
     int ret ;
 
     // reset counter here so we can "re-init" our recording
-    buffer_num = writer_num = total_bytes_written = 0 ;
+    buffer_num = buffer_claimed = writer_num = rows_dropped = total_bytes_written = 0 ;
+    writer_buff_len = 0 ;
+    rows_written = write_calls = 0 ;
+    max_buffered = 0 ;
+    overflow_warning = false ;
+    struct timeval tv ;
+    gettimeofday(&tv, NULL) ;
+    write_start_time = tv.tv_sec + tv.tv_usec / 1000000.0 ;
 
     output_dir = command_line_args_get_output_dir() ;
     /* this is the common part of the record file name, the format specific will add the correct suffix */
@@ -365,8 +395,8 @@ int Trick::DataRecordGroup::init() {
 
     pthread_mutex_init(&buffer_mutex, NULL);
 
-    // Allocate recording space for time.
-    rec_buffer[0]->buffer = (char *)calloc(max_num , rec_buffer[0]->ref->attr->size) ;
+    // Allocate recording space for time, with the ring writer's slot after the rows.
+    rec_buffer[0]->buffer = (char *)calloc(max_num + 1 , rec_buffer[0]->ref->attr->size) ;
     rec_buffer[0]->last_value = (char *)calloc(1 , rec_buffer[0]->ref->attr->size) ;
 
     /* Loop through all variables looking up names.  Allocate recording space
@@ -390,10 +420,12 @@ int Trick::DataRecordGroup::init() {
             drb->ref->reference = strdup(drb->alias.c_str()) ;
         }
         drb->last_value = (char *)calloc(1 , drb->ref->attr->size) ;
-        drb->buffer = (char *)calloc(max_num , drb->ref->attr->size) ;
+        drb->buffer = (char *)calloc(max_num + 1 , drb->ref->attr->size) ;
         drb->ref_searched = true ;
     }
 
+    build_copy_plan() ;
+
     write_header() ;
 
     // call format specific initialization to open destination and write header
@@ -585,6 +617,172 @@ int Trick::DataRecordGroup::write_header() {
 
 }
 
+/**
+@details
+-# Clear the plans
+-# For each recorded variable
+   -# If the variable is reached through a pointer, add it to the pointer list
+   -# Else add the variable to the list for its size
+-# For each change variable
+   -# If the variable is reached through a pointer, add it to the pointer list
+   -# Else split the variable into the largest words that fit and add them to the lists for their size
+*/
+void Trick::DataRecordGroup::build_copy_plan() {
+
+    unsigned int jj ;
+    Trick::DataRecordCopy drc ;
+
+    copy_plan_8.clear() ;
+    copy_plan_4.clear() ;
+    copy_plan_2.clear() ;
+    copy_plan_1.clear() ;
+    copy_plan_other.clear() ;
+    copy_plan_pointers.clear() ;
+    change_plan_8.clear() ;
+    change_plan_4.clear() ;
+    change_plan_2.clear() ;
+    change_plan_1.clear() ;
+    change_plan_pointers.clear() ;
+
+    for (jj = 0; jj < rec_buffer.size() ; jj++) {
+        Trick::DataRecordBuffer * drb = rec_buffer[jj] ;
+        if ( drb->ref == NULL or drb->buffer == NULL ) {
+            continue ;
+        }
+        if ( drb->ref->pointer_present == 1 ) {
+            copy_plan_pointers.push_back(drb) ;
+            continue ;
+        }
+        drc.address = (char *)drb->ref->address ;
+        drc.buffer = drb->buffer ;
+        drc.size = drb->ref->attr->size ;
+        switch ( drc.size ) {
+            case 8: copy_plan_8.push_back(drc) ; break ;
+            case 4: copy_plan_4.push_back(drc) ; break ;
+            case 2: copy_plan_2.push_back(drc) ; break ;
+            case 1: copy_plan_1.push_back(drc) ; break ;
+            default: copy_plan_other.push_back(drc) ; break ;
+        }
+    }
+
+    for (jj = 0; jj < change_buffer.size() ; jj++) {
+        Trick::DataRecordBuffer * drb = change_buffer[jj] ;
+        if ( drb->ref->pointer_present == 1 ) {
+            change_plan_pointers.push_back(drb) ;
+            continue ;
+        }
+        unsigned int offset = 0 ;
+        unsigned int size = drb->ref->attr->size ;
+        while ( offset < size ) {
+            drc.address = (char *)drb->ref->address + offset ;
+            drc.buffer = drb->buffer + offset ;
+            if ( size - offset >= 8 ) {
+                drc.size = 8 ;
+                change_plan_8.push_back(drc) ;
+            } else if ( size - offset >= 4 ) {
+                drc.size = 4 ;
+                change_plan_4.push_back(drc) ;
+            } else if ( size - offset >= 2 ) {
+                drc.size = 2 ;
+                change_plan_2.push_back(drc) ;
+            } else {
+                drc.size = 1 ;
+                change_plan_1.push_back(drc) ;
+            }
+            offset += drc.size ;
+        }
+    }
+
+    copy_plan_stale = false ;
+}
+
+/* Copies every variable in a same size plan into row offset of its column. */
+template <class T> static inline void copy_plan_row( std::vector <Trick::DataRecordCopy> & plan , unsigned int offset ) {
+    unsigned int ii ;
+    T value ;
+    for ( ii = 0 ; ii < plan.size() ; ii++ ) {
+        memcpy( &value , plan[ii].address , sizeof(T)) ;
+        memcpy( plan[ii].buffer + offset * sizeof(T) , &value , sizeof(T)) ;
+    }
+}
+
+/* Saves the current value of every word in a same size plan.  Returns nonzero if any word changed. */
+template <class T> static inline T change_plan_update( std::vector <Trick::DataRecordCopy> & plan ) {
+    unsigned int ii ;
+    T curr , last , diff = 0 ;
+    for ( ii = 0 ; ii < plan.size() ; ii++ ) {
+        memcpy( &curr , plan[ii].address , sizeof(T)) ;
+        memcpy( &last , plan[ii].buffer , sizeof(T)) ;
+        diff |= curr ^ last ;
+        memcpy( plan[ii].buffer , &curr , sizeof(T)) ;
+    }
+    return diff ;
+}
+
+unsigned int Trick::DataRecordGroup::claim_row() {
+    // release fence: a ring writer that copies any of the row's new data sees the claim
+    __atomic_store_n(&buffer_claimed, buffer_num + 1, __ATOMIC_RELAXED) ;
+    __atomic_thread_fence(__ATOMIC_RELEASE) ;
+    return buffer_num % max_num ;
+}
+
+void Trick::DataRecordGroup::publish_row() {
+    // release: the row's data is visible to the consumer before the new count
+    __atomic_store_n(&buffer_num, buffer_num + 1, __ATOMIC_RELEASE) ;
+}
+
+unsigned int Trick::DataRecordGroup::consume_rows( uint64_t & first ) {
+    // acquire: pairs with publish_row so the rows' data is visible here
+    uint64_t head = __atomic_load_n(&buffer_num, __ATOMIC_ACQUIRE) ;
+    first = writer_num ;
+    if ( head - first > max_num ) {
+        // the ring wrapped over rows that were never written
+        rows_dropped += head - first - max_num ;
+        first = head - max_num ;
+    }
+    return (unsigned int)(head - first) ;
+}
+
+bool Trick::DataRecordGroup::copy_ring_row( uint64_t row ) {
+    unsigned int ii ;
+    unsigned int offset = row % max_num ;
+    for ( ii = 0 ; ii < rec_buffer.size() ; ii++ ) {
+        unsigned int size = rec_buffer[ii]->ref->attr->size ;
+        memcpy( rec_buffer[ii]->buffer + max_num * size , rec_buffer[ii]->buffer + offset * size , size ) ;
+    }
+    // acquire fence: pairs with claim_row.  Row + max_num reuses the slot.
+    __atomic_thread_fence(__ATOMIC_ACQUIRE) ;
+    return __atomic_load_n(&buffer_claimed, __ATOMIC_RELAXED) <= row + max_num ;
+}
+
+void Trick::DataRecordGroup::release_rows( uint64_t end ) {
+    // release: the rows are read before data_record may reuse their slots
+    __atomic_store_n(&writer_num, end, __ATOMIC_RELEASE) ;
+}
+
+unsigned int Trick::DataRecordGroup::buffered_rows() {
+    // the tail first, the head can only have moved further ahead of it
+    uint64_t tail = __atomic_load_n(&writer_num, __ATOMIC_ACQUIRE) ;
+    uint64_t head = __atomic_load_n(&buffer_num, __ATOMIC_ACQUIRE) ;
+    if ( head - tail > max_num ) {
+        // a ring buffer holds only the last max_num rows
+        return max_num ;
+    }
+    return (unsigned int)(head - tail) ;
+}
+
+/**
+@details
+-# Rebuild the copy plan if variables were added or removed since it was built
+-# If recording changes only, compare the change variables to their saved values.
+   Fixed address variables are compared one word at a time without branching.
+-# If a row is to be recorded
+   -# Write the data now if the buffer is nearly full and this is not a ring buffer
+   -# If recording step changes, record the last values
+   -# Copy each size list of the copy plan into the current row
+   -# Follow the address path of pointer variables and copy them into the current row
+   -# Publish each row to the writer
+*/
 int Trick::DataRecordGroup::data_record(double in_time) {
 
     unsigned int jj ;
@@ -595,19 +793,24 @@ int Trick::DataRecordGroup::data_record(double in_time) {
     //TODO: does not handle bitfields correctly!
 
     if ( record == true ) {
+        if ( copy_plan_stale ) {
+            build_copy_plan() ;
+        }
+
         if ( freq != DR_Always ) {
-            for (jj = 0; jj < change_buffer.size() ; jj++) {
-                drb = change_buffer[jj] ;
+            change_detected = ( change_plan_update<int64_t>(change_plan_8) |
+                                change_plan_update<int32_t>(change_plan_4) |
+                                change_plan_update<int16_t>(change_plan_2) |
+                                change_plan_update<int8_t>(change_plan_1) ) != 0 ;
+            for (jj = 0; jj < change_plan_pointers.size() ; jj++) {
+                drb = change_plan_pointers[jj] ;
                 REF2 * ref = drb->ref ;
-                if ( ref->pointer_present == 1 ) {
-                    ref->address = follow_address_path(ref) ;
-                }
+                ref->address = follow_address_path(ref) ;
                 if ( memcmp( drb->buffer , drb->ref->address , drb->ref->attr->size) ) {
                     change_detected = true ;
                     memcpy( drb->buffer , drb->ref->address , drb->ref->attr->size) ;
                 }
             }
-
         }
 
         if ( freq == DR_Always || change_detected == true ) {
@@ -615,7 +818,7 @@ int Trick::DataRecordGroup::data_record(double in_time) {
             // If this is not the ring buffer and
             // we are going to have trouble fitting 2 data sets then write the data now.
             if ( buffer_type != DR_Ring_Buffer ) {
-                if ( buffer_num - writer_num >= (max_num - 2) ) {
+                if ( buffered_rows() >= (max_num - 2) ) {
                     write_data(true) ;
                 }
             }
@@ -623,70 +826,33 @@ int Trick::DataRecordGroup::data_record(double in_time) {
             curr_time = in_time ;
 
             if ( freq == DR_Changes_Step ) {
-                buffer_offset = buffer_num % max_num ;
+                buffer_offset = claim_row() ;
                 *((double *)(rec_buffer[0]->last_value)) = in_time ;
                 for (jj = 0; jj < rec_buffer.size() ; jj++) {
                     drb = rec_buffer[jj] ;
-                    REF2 * ref = drb->ref ;
-                    int param_size = ref->attr->size ;
-                    if ( buffer_offset == 0 ) {
-                       drb->curr_buffer = drb->buffer ;
-                    } else {
-                       drb->curr_buffer += param_size ;
-                    }
-                    switch ( param_size ) {
-                        case 8:
-                            *(int64_t *)drb->curr_buffer = *(int64_t *)drb->last_value ;
-                            break ;
-                        case 4:
-                            *(int32_t *)drb->curr_buffer = *(int32_t *)drb->last_value ;
-                            break ;
-                        case 2:
-                            *(int16_t *)drb->curr_buffer = *(int16_t *)drb->last_value ;
-                            break ;
-                        case 1:
-                            *(int8_t *)drb->curr_buffer = *(int8_t *)drb->last_value ;
-                            break ;
-                        default:
-                            memcpy( drb->curr_buffer , drb->last_value , param_size ) ;
-                            break ;
-                    }
+                    int param_size = drb->ref->attr->size ;
+                    memcpy( drb->buffer + buffer_offset * param_size , drb->last_value , param_size ) ;
                 }
-                buffer_num++ ;
+                publish_row() ;
             }
 
-            buffer_offset = buffer_num % max_num ;
-            for (jj = 0; jj < rec_buffer.size() ; jj++) {
-                drb = rec_buffer[jj] ;
+            buffer_offset = claim_row() ;
+            copy_plan_row<int64_t>(copy_plan_8, buffer_offset) ;
+            copy_plan_row<int32_t>(copy_plan_4, buffer_offset) ;
+            copy_plan_row<int16_t>(copy_plan_2, buffer_offset) ;
+            copy_plan_row<int8_t>(copy_plan_1, buffer_offset) ;
+            for (jj = 0; jj < copy_plan_other.size() ; jj++) {
+                Trick::DataRecordCopy & drc = copy_plan_other[jj] ;
+                memcpy( drc.buffer + buffer_offset * drc.size , drc.address , drc.size ) ;
+            }
+            for (jj = 0; jj < copy_plan_pointers.size() ; jj++) {
+                drb = copy_plan_pointers[jj] ;
                 REF2 * ref = drb->ref ;
-                if ( ref->pointer_present == 1 ) {
-                    ref->address = follow_address_path(ref) ;
-                }
+                ref->address = follow_address_path(ref) ;
                 int param_size = ref->attr->size ;
-                if ( buffer_offset == 0 ) {
-                   drb->curr_buffer = drb->buffer ;
-                } else {
-                   drb->curr_buffer += param_size ;
-                }
-                switch ( param_size ) {
-                    case 8:
-                        *(int64_t *)drb->curr_buffer = *(int64_t *)ref->address ;
-                        break ;
-                    case 4:
-                        *(int32_t *)drb->curr_buffer = *(int32_t *)ref->address ;
-                        break ;
-                    case 2:
-                        *(int16_t *)drb->curr_buffer = *(int16_t *)ref->address ;
-                        break ;
-                    case 1:
-                        *(int8_t *)drb->curr_buffer = *(int8_t *)ref->address ;
-                        break ;
-                    default:
-                        memcpy( drb->curr_buffer , ref->address , param_size ) ;
-                        break ;
-                }
+                memcpy( drb->buffer + buffer_offset * param_size , ref->address , param_size ) ;
             }
-            buffer_num++ ;
+            publish_row() ;
         }
     }
 
@@ -696,32 +862,45 @@ int Trick::DataRecordGroup::data_record(double in_time) {
 
 int Trick::DataRecordGroup::write_data(bool must_write) {
 
-    unsigned int local_buffer_num ;
+    uint64_t row ;
+    uint64_t end ;
     unsigned int num_to_write ;
-    unsigned int writer_offset ;
 
-    if ( record and inited and (buffer_type == DR_No_Buffer or must_write) and (total_bytes_written <= max_file_size)) {
+    if ( record and inited and (buffer_type == DR_No_Buffer or must_write) ) {
 
         // buffer_mutex is used in this one place to prevent forced calls of write_data
         // to not overwrite data being written by the asynchronous thread.
         pthread_mutex_lock(&buffer_mutex) ;
-        local_buffer_num = buffer_num ;
-        if ( (local_buffer_num - writer_num) > max_num ) {
-            num_to_write = max_num ;
-        } else {
-            num_to_write = (local_buffer_num - writer_num) ;
+        num_to_write = consume_rows(row) ;
+        end = row + num_to_write ;
+
+        if ( total_bytes_written > max_file_size ) {
+            // the file is full, discard the rows so recording does not stall on a full buffer
+            rows_dropped += num_to_write ;
+            release_rows(end) ;
+            pthread_mutex_unlock(&buffer_mutex) ;
+            return 0 ;
         }
-        writer_num = local_buffer_num - num_to_write ;
 
         //! This loop pulls a "row" of time homogeneous data and writes it to the file
-        while ( writer_num != local_buffer_num ) {
-
-            writer_offset = writer_num % max_num ;
+        for ( ; row != end ; row++ ) {
+            unsigned int writer_offset = row % max_num ;
+            // data_record keeps filling a ring buffer, so the row is formatted from a copy
+            if ( buffer_type == DR_Ring_Buffer ) {
+                if ( ! copy_ring_row(row) ) {
+                    rows_dropped++ ;
+                    continue ;
+                }
+                writer_offset = max_num ;
+            }
             //! keep record of bytes written to file. Default max is 1GB
             total_bytes_written += format_specific_write_data(writer_offset) ;
-            writer_num++ ;
-
+            rows_written++ ;
         }
+        release_rows(end) ;
+
+        // formats that stage rows write them out once per batch
+        format_specific_flush() ;
 
         if(!max_size_warning && (total_bytes_written > max_file_size)) {
             std::cerr << "WARNING: Data record max file size " << (static_cast<double>(max_file_size))/(1<<20) << "MB reached.\n"
@@ -737,6 +916,25 @@ int Trick::DataRecordGroup::write_data(bool must_write) {
     return 0 ;
 }
 
+int Trick::DataRecordGroup::format_specific_flush() {
+    return 0 ;
+}
+
+void Trick::DataRecordGroup::dump_write_rates( std::ostream & oss ) {
+    struct timeval tv ;
+    double elapsed ;
+    gettimeofday(&tv, NULL) ;
+    elapsed = tv.tv_sec + tv.tv_usec / 1000000.0 - write_start_time ;
+    oss << "    " << group_name << ": rows written = " << rows_written
+        << ", writes = " << write_calls ;
+    if ( inited and elapsed > 0.0 ) {
+        oss << ", rows/s = " << rows_written / elapsed << ", writes/s = " << write_calls / elapsed ;
+    }
+    oss << ", buffered records = " << buffered_rows() << "/" << max_num
+        << ", max buffered = " << max_buffered
+        << ", dropped records = " << rows_dropped << std::endl ;
+}
+
 int Trick::DataRecordGroup::enable() {
     record = true ;
     return(0) ;
@@ -92,3 +92,10 @@ extern "C" int dr_set_max_file_size ( uint64_t bytes ) {
     }
     return -1 ;
 }
+
+extern "C" int dr_set_num_writer_threads ( unsigned int num ) {
+    if ( the_drd != NULL ) {
+    return the_drd->set_num_writer_threads( num ) ;
+    }
+    return -1 ;
+}
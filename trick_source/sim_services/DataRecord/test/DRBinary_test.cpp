@@ -0,0 +1,126 @@
+
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#define private public
+#include "trick/DRBinary.hh"
+#include "trick/CommandLineArguments.hh"
+
+namespace Trick {
+
+class DRBinaryTest : public ::testing::Test {
+
+    protected:
+        Trick::CommandLineArguments cmd ;
+        ATTRIBUTES attr_double ;
+
+        DRBinaryTest() {}
+        ~DRBinaryTest() {}
+
+        virtual void SetUp() {
+            memset(&attr_double, 0, sizeof(ATTRIBUTES)) ;
+            attr_double.type = TRICK_DOUBLE ;
+            attr_double.size = sizeof(double) ;
+            attr_double.units = (char *)"1" ;
+        }
+
+        virtual void TearDown() {
+            unlink("./log_DRBinary_test.trk") ;
+            unlink("./log_DRBinary_test.trk.idx") ;
+            unlink("./log_DRBinary_test.header") ;
+        }
+
+        void add_ref( Trick::DataRecordGroup & drg , std::string name , void * address , ATTRIBUTES * attr ) {
+            REF2 * ref = (REF2 *)calloc(1 , sizeof(REF2)) ;
+            ref->reference = strdup(name.c_str()) ;
+            ref->address = address ;
+            ref->attr = attr ;
+            drg.add_variable(ref) ;
+        }
+
+        std::vector< char > read_file( const char * file_name ) {
+            std::vector< char > data ;
+            FILE * fp = fopen(file_name , "r") ;
+            int ch ;
+            if ( fp ) {
+                while ( (ch = fgetc(fp)) != EOF ) {
+                    data.push_back(ch) ;
+                }
+                fclose(fp) ;
+            }
+            return data ;
+        }
+} ;
+
+TEST_F( DRBinaryTest , WritesEveryRow ) {
+
+    Trick::DRBinary drg("DRBinary_test") ;
+    double position = 0.0 ;
+    const unsigned int num_rows = 5000 ;
+
+    add_ref(drg , "position" , &position , &attr_double) ;
+    drg.set_max_buffer_size(100) ;
+    drg.init() ;
+
+    for ( unsigned int ii = 0 ; ii < num_rows ; ii++ ) {
+        position = ii * 2.0 ;
+        drg.data_record(ii * 0.01) ;
+        if ( ii % 50 == 0 ) {
+            drg.write_data(true) ;
+        }
+    }
+    drg.shutdown() ;
+
+    // the rows are the last num_rows * 16 bytes of the file: time, position
+    std::vector< char > data = read_file("./log_DRBinary_test.trk") ;
+    ASSERT_GT( data.size() , num_rows * 16 ) ;
+    const char * rows = &data[data.size() - num_rows * 16] ;
+    for ( unsigned int ii = 0 ; ii < num_rows ; ii++ ) {
+        double values[2] ;
+        memcpy(values, rows + ii * 16, sizeof(values)) ;
+        ASSERT_EQ( values[0] , ii * 0.01 ) ;
+        ASSERT_EQ( values[1] , ii * 2.0 ) ;
+    }
+    EXPECT_EQ( drg.bytes_not_written , (uint64_t)0 ) ;
+    EXPECT_EQ( access("./log_DRBinary_test.trk.idx", F_OK) , 0 ) ;
+}
+
+TEST_F( DRBinaryTest , FailedWriteStopsRecording ) {
+
+    Trick::DRBinary drg("DRBinary_test") ;
+    double position = 0.0 ;
+
+    add_ref(drg , "position" , &position , &attr_double) ;
+    drg.init() ;
+
+    // every write to /dev/full fails with ENOSPC
+    int full_fd = open("/dev/full", O_WRONLY) ;
+    if ( full_fd < 0 ) {
+        drg.shutdown() ;
+        return ;
+    }
+    dup2(full_fd, drg.fd) ;
+    close(full_fd) ;
+
+    drg.data_record(0.0) ;
+    drg.write_data(true) ;
+    EXPECT_FALSE( drg.record ) ;
+    EXPECT_EQ( drg.bytes_not_written , (uint64_t)16 ) ;
+
+    // recording has stopped
+    drg.data_record(0.01) ;
+    drg.write_data(true) ;
+    EXPECT_EQ( drg.buffered_rows() , (unsigned int)0 ) ;
+
+    // shutdown does not write after the failure, nor an index to rows that are not there
+    drg.shutdown() ;
+    EXPECT_EQ( drg.bytes_not_written , (uint64_t)16 ) ;
+    EXPECT_NE( access("./log_DRBinary_test.trk.idx", F_OK) , 0 ) ;
+}
+
+}
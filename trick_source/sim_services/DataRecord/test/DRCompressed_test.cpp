@@ -0,0 +1,220 @@
+
+#include <iostream>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#define private public
+#include "trick/DRCompressed.hh"
+#include "trick/dr_compress.h"
+#include "trick/CommandLineArguments.hh"
+
+namespace Trick {
+
+struct DRLargeValue {
+    char c[20] ;
+} ;
+
+class DRCompressedTest : public ::testing::Test {
+
+    protected:
+        Trick::CommandLineArguments cmd ;
+        ATTRIBUTES attr_double ;
+        ATTRIBUTES attr_int ;
+
+        DRCompressedTest() {}
+        ~DRCompressedTest() {}
+
+        virtual void SetUp() {
+            set_attr(attr_double , TRICK_DOUBLE , sizeof(double)) ;
+            set_attr(attr_int , TRICK_INTEGER , sizeof(int)) ;
+        }
+
+        virtual void TearDown() {
+            unlink("./log_DRCompressed_test.header") ;
+            unlink("./log_DRCompressed_test.trz") ;
+        }
+
+        void set_attr( ATTRIBUTES & attr , TRICK_TYPE type , int size ) {
+            memset(&attr, 0, sizeof(ATTRIBUTES)) ;
+            attr.type = type ;
+            attr.size = size ;
+            attr.units = (char *)"1" ;
+        }
+
+        void add_ref( Trick::DataRecordGroup & drg , std::string name , void * address , ATTRIBUTES * attr ) {
+            REF2 * ref = (REF2 *)calloc(1 , sizeof(REF2)) ;
+            ref->reference = strdup(name.c_str()) ;
+            ref->address = address ;
+            ref->attr = attr ;
+            drg.add_variable(ref) ;
+        }
+
+        std::vector< unsigned char > read_file( const char * file_name ) {
+            std::vector< unsigned char > data ;
+            FILE * fp = fopen(file_name , "r") ;
+            int ch ;
+            if ( fp ) {
+                while ( (ch = fgetc(fp)) != EOF ) {
+                    data.push_back(ch) ;
+                }
+                fclose(fp) ;
+            }
+            return data ;
+        }
+} ;
+
+template< class T > static std::vector< T > round_trip( const std::vector< T > & values , unsigned int * packed_len ) {
+    std::vector< unsigned char > packed(dr_compress_bound(values.size(), sizeof(T))) ;
+    std::vector< T > out(values.size()) ;
+    *packed_len = dr_compress_column((const unsigned char *)&values[0], values.size(), sizeof(T), &packed[0]) ;
+    EXPECT_LE( *packed_len , packed.size() ) ;
+    EXPECT_EQ( dr_decompress_column(&packed[0], *packed_len, values.size(), sizeof(T), (unsigned char *)&out[0]) , 0 ) ;
+    return out ;
+}
+
+TEST_F( DRCompressedTest , CodecRoundTrip ) {
+
+    std::vector< double > doubles ;
+    std::vector< int > ints ;
+    std::vector< DRLargeValue > large(300) ;
+    unsigned int len ;
+
+    for ( int ii = 0 ; ii < 1000 ; ii++ ) {
+        doubles.push_back(100.0 + sin(ii * 0.001)) ;
+        // long runs exercise multi byte run lengths
+        ints.push_back(ii < 500 ? 0 : -ii / 200) ;
+    }
+    for ( int ii = 0 ; ii < 300 ; ii++ ) {
+        memset(large[ii].c, ii / 7, sizeof(large[ii].c)) ;
+    }
+
+    EXPECT_TRUE( round_trip(doubles, &len) == doubles ) ;
+    EXPECT_LT( len , doubles.size() * sizeof(double) ) ;
+    EXPECT_TRUE( round_trip(ints, &len) == ints ) ;
+    EXPECT_LT( len , (unsigned int)32 ) ;
+    std::vector< DRLargeValue > large_out = round_trip(large, &len) ;
+    EXPECT_EQ( memcmp(&large[0], &large_out[0], large.size() * sizeof(DRLargeValue)) , 0 ) ;
+
+    // truncated input is rejected
+    std::vector< unsigned char > packed(dr_compress_bound(doubles.size(), sizeof(double))) ;
+    len = dr_compress_column((const unsigned char *)&doubles[0], doubles.size(), sizeof(double), &packed[0]) ;
+    EXPECT_EQ( dr_decompress_column(&packed[0], len - 1, doubles.size(), sizeof(double), (unsigned char *)&doubles[0]) , -1 ) ;
+}
+
+TEST_F( DRCompressedTest , WritesChunksAndIndex ) {
+
+    Trick::DRCompressed drg("DRCompressed_test") ;
+    double position = 0.0 ;
+    int mode = 3 ;
+    const unsigned int num_rows = 1000 ;
+
+    add_ref(drg , "position" , &position , &attr_double) ;
+    add_ref(drg , "mode" , &mode , &attr_int) ;
+    drg.set_rows_per_chunk(300) ;
+    drg.set_buffer_type(DR_No_Buffer) ;
+    drg.init() ;
+
+    for ( unsigned int ii = 0 ; ii < num_rows ; ii++ ) {
+        position = 10.0 + 0.25 * ii ;
+        drg.data_record(ii * 0.01) ;
+    }
+    drg.shutdown() ;
+
+    std::vector< unsigned char > data = read_file("./log_DRCompressed_test.trz") ;
+    ASSERT_GT( data.size() , (unsigned int)20 ) ;
+    EXPECT_EQ( memcmp(&data[0], "Trick-Z1-", 9) , 0 ) ;
+    EXPECT_EQ( memcmp(&data[data.size() - 8], "TrkZIndx", 8) , 0 ) ;
+    // time, a double and an int, uncompressed
+    EXPECT_LT( data.size() , num_rows * 20 / 2 ) ;
+
+    int num_chunks ;
+    int64_t index_offset ;
+    memcpy(&num_chunks, &data[data.size() - 20], sizeof(int)) ;
+    memcpy(&index_offset, &data[data.size() - 16], sizeof(int64_t)) ;
+    ASSERT_EQ( num_chunks , 4 ) ;
+
+    // decode every chunk through the index and check the values
+    unsigned int row = 0 ;
+    for ( int cc = 0 ; cc < num_chunks ; cc++ ) {
+        const unsigned char * entry = &data[index_offset + cc * 28] ;
+        int64_t offset ;
+        int rows ;
+        double start_time , end_time ;
+        memcpy(&offset, entry, 8) ;
+        memcpy(&rows, entry + 8, 4) ;
+        memcpy(&start_time, entry + 12, 8) ;
+        memcpy(&end_time, entry + 20, 8) ;
+        EXPECT_EQ( rows , cc < 3 ? 300 : 100 ) ;
+        EXPECT_DOUBLE_EQ( start_time , row * 0.01 ) ;
+        EXPECT_DOUBLE_EQ( end_time , (row + rows - 1) * 0.01 ) ;
+
+        const unsigned char * cp = &data[offset + 20] ;
+        int column_bytes[3] ;
+        memcpy(column_bytes, cp, sizeof(column_bytes)) ;
+        cp += sizeof(column_bytes) ;
+
+        std::vector< double > times(rows) , positions(rows) ;
+        std::vector< int > modes(rows) ;
+        ASSERT_EQ( dr_decompress_column(cp, column_bytes[0], rows, 8, (unsigned char *)&times[0]) , 0 ) ;
+        cp += column_bytes[0] ;
+        ASSERT_EQ( dr_decompress_column(cp, column_bytes[1], rows, 8, (unsigned char *)&positions[0]) , 0 ) ;
+        cp += column_bytes[1] ;
+        ASSERT_EQ( dr_decompress_column(cp, column_bytes[2], rows, 4, (unsigned char *)&modes[0]) , 0 ) ;
+
+        for ( int ii = 0 ; ii < rows ; ii++ , row++ ) {
+            EXPECT_EQ( times[ii] , row * 0.01 ) ;
+            EXPECT_EQ( positions[ii] , 10.0 + 0.25 * row ) ;
+            EXPECT_EQ( modes[ii] , 3 ) ;
+        }
+    }
+    EXPECT_EQ( row , num_rows ) ;
+}
+
+TEST_F( DRCompressedTest , FailedWriteStopsRecording ) {
+
+    Trick::DRCompressed drg("DRCompressed_test") ;
+    double position = 0.0 ;
+
+    add_ref(drg , "position" , &position , &attr_double) ;
+    drg.set_rows_per_chunk(10) ;
+    drg.set_buffer_type(DR_No_Buffer) ;
+    drg.init() ;
+    int64_t header_size = drg.file_offset ;
+
+    // every write to /dev/full fails with ENOSPC
+    int full_fd = open("/dev/full", O_WRONLY) ;
+    if ( full_fd < 0 ) {
+        drg.shutdown() ;
+        return ;
+    }
+    int saved_fd = dup(drg.fd) ;
+    dup2(full_fd, drg.fd) ;
+    close(full_fd) ;
+
+    for ( unsigned int ii = 0 ; ii < 10 ; ii++ ) {
+        drg.data_record(ii * 0.01) ;
+        drg.write_data(true) ;
+    }
+    EXPECT_FALSE( drg.record ) ;
+    EXPECT_GT( drg.bytes_not_written , (uint64_t)0 ) ;
+    EXPECT_EQ( drg.file_offset , header_size ) ;
+    EXPECT_EQ( drg.chunks.size() , (unsigned int)0 ) ;
+
+    // the file is writable again, but nothing more is written after the gap, not even the index
+    dup2(saved_fd, drg.fd) ;
+    close(saved_fd) ;
+    drg.data_record(0.1) ;
+    drg.write_data(true) ;
+    drg.shutdown() ;
+    std::vector< unsigned char > data = read_file("./log_DRCompressed_test.trz") ;
+    EXPECT_EQ( (int64_t)data.size() , header_size ) ;
+}
+
+}
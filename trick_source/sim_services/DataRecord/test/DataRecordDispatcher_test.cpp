@@ -0,0 +1,176 @@
+
+#include <iostream>
+#include <sstream>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+#include "trick/DataRecordDispatcher.hh"
+#include "trick/CommandLineArguments.hh"
+
+namespace Trick {
+
+/* A data record group that takes a while to write each row. */
+class DRSlow : public Trick::DataRecordGroup {
+    public:
+        DRSlow( std::string in_name ) : Trick::DataRecordGroup(in_name) {}
+        virtual int format_specific_header(std::fstream &) { return 0 ; }
+        virtual int format_specific_init() { return 0 ; }
+        virtual int format_specific_write_data(unsigned int) {
+            int now = __sync_add_and_fetch(&writing, 1) ;
+            int seen = max_writing ;
+            while ( now > seen and ! __sync_bool_compare_and_swap(&max_writing, seen, now) ) {
+                seen = max_writing ;
+            }
+            usleep(2000) ;
+            __sync_sub_and_fetch(&writing, 1) ;
+            return 0 ;
+        }
+        virtual int format_specific_shutdown() { return 0 ; }
+
+        static int writing ;
+        static int max_writing ;
+} ;
+
+int DRSlow::writing = 0 ;
+int DRSlow::max_writing = 0 ;
+
+class DataRecordDispatcherTest : public ::testing::Test {
+
+    protected:
+        Trick::CommandLineArguments cmd ;
+        Trick::DataRecordDispatcher drd ;
+        std::vector< Trick::DRSlow * > drgs ;
+        ATTRIBUTES attr_double ;
+        double value ;
+
+        DataRecordDispatcherTest() : value(0.0) {}
+        ~DataRecordDispatcherTest() {}
+
+        virtual void SetUp() {
+            memset(&attr_double, 0, sizeof(ATTRIBUTES)) ;
+            attr_double.type = TRICK_DOUBLE ;
+            attr_double.size = sizeof(double) ;
+            attr_double.units = (char *)"1" ;
+            DRSlow::writing = DRSlow::max_writing = 0 ;
+        }
+
+        virtual void TearDown() {
+            unsigned int ii ;
+            drd.shutdown() ;
+            for ( ii = 0 ; ii < drd.get_num_writer_threads() ; ii++ ) {
+                if ( drd.get_writer_thread(ii)->get_pthread_id() != 0 ) {
+                    pthread_join(drd.get_writer_thread(ii)->get_pthread_id(), NULL) ;
+                }
+            }
+            for ( ii = 0 ; ii < drgs.size() ; ii++ ) {
+                std::string header = "./log_" + drgs[ii]->get_group_name() + ".header" ;
+                unlink(header.c_str()) ;
+                delete drgs[ii] ;
+            }
+        }
+
+        void add_groups( unsigned int num , unsigned int max_num ) {
+            for ( unsigned int ii = 0 ; ii < num ; ii++ ) {
+                std::ostringstream oss ;
+                oss << "DRSlow_test" << ii ;
+                Trick::DRSlow * drg = new Trick::DRSlow(oss.str()) ;
+                REF2 * ref = (REF2 *)calloc(1 , sizeof(REF2)) ;
+                ref->reference = strdup("value") ;
+                ref->address = &value ;
+                ref->attr = &attr_double ;
+                drg->add_variable(ref) ;
+                drg->set_max_buffer_size(max_num) ;
+                drg->init() ;
+                drd.add_sim_object(drg) ;
+                drgs.push_back(drg) ;
+            }
+        }
+
+        void record_all( unsigned int rows ) {
+            for ( unsigned int jj = 0 ; jj < rows ; jj++ ) {
+                for ( unsigned int ii = 0 ; ii < drgs.size() ; ii++ ) {
+                    drgs[ii]->data_record(jj * 0.1) ;
+                }
+            }
+        }
+
+        /* Waits up to 10 seconds for every group to be written. */
+        bool wait_for_writers() {
+            for ( int tries = 0 ; tries < 10000 ; tries++ ) {
+                bool done = true ;
+                for ( unsigned int ii = 0 ; ii < drgs.size() ; ii++ ) {
+                    if ( drgs[ii]->writer_num != drgs[ii]->buffer_num ) {
+                        done = false ;
+                    }
+                }
+                if ( done ) {
+                    return true ;
+                }
+                usleep(1000) ;
+            }
+            return false ;
+        }
+} ;
+
+TEST_F( DataRecordDispatcherTest , GroupsWrittenConcurrently ) {
+
+    EXPECT_EQ( drd.set_num_writer_threads(0) , -1 ) ;
+    EXPECT_EQ( drd.set_num_writer_threads(4) , 0 ) ;
+    EXPECT_EQ( drd.get_num_writer_threads() , (unsigned int)4 ) ;
+    add_groups(8 , 100) ;
+    drd.init() ;
+
+    record_all(10) ;
+    drd.signal_thread() ;
+    ASSERT_TRUE( wait_for_writers() ) ;
+
+    EXPECT_GT( DRSlow::max_writing , 1 ) ;
+    for ( unsigned int ii = 0 ; ii < drgs.size() ; ii++ ) {
+        EXPECT_EQ( drgs[ii]->rows_written , (uint64_t)10 ) ;
+    }
+}
+
+TEST_F( DataRecordDispatcherTest , NoSignalLost ) {
+
+    add_groups(2 , 1000) ;
+    drd.init() ;
+
+    // signal every frame while the single writer is still busy with earlier frames
+    for ( unsigned int jj = 0 ; jj < 50 ; jj++ ) {
+        record_all(1) ;
+        drd.signal_thread() ;
+    }
+    ASSERT_TRUE( wait_for_writers() ) ;
+
+    for ( unsigned int ii = 0 ; ii < drgs.size() ; ii++ ) {
+        EXPECT_EQ( drgs[ii]->rows_written , (uint64_t)50 ) ;
+    }
+}
+
+TEST_F( DataRecordDispatcherTest , WarnsBeforeOverflow ) {
+
+    add_groups(1 , 20) ;
+
+    // writers are not started, the buffer fills
+    record_all(17) ;
+    drd.signal_thread() ;
+    EXPECT_FALSE( drgs[0]->overflow_warning ) ;
+
+    record_all(1) ;
+    drd.signal_thread() ;
+    EXPECT_TRUE( drgs[0]->overflow_warning ) ;
+    EXPECT_EQ( drgs[0]->max_buffered , (unsigned int)18 ) ;
+
+    // the group is queued once no matter how many frames pass
+    drd.signal_thread() ;
+    drd.init() ;
+    ASSERT_TRUE( wait_for_writers() ) ;
+    EXPECT_EQ( drgs[0]->rows_written , (uint64_t)18 ) ;
+
+    drd.signal_thread() ;
+    EXPECT_FALSE( drgs[0]->overflow_warning ) ;
+}
+
+}
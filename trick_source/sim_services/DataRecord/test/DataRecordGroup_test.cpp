@@ -0,0 +1,361 @@
+
+#include <sstream>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "gtest/gtest.h"
+#include "trick/DataRecordGroup.hh"
+#include "trick/CommandLineArguments.hh"
+
+namespace Trick {
+
+/* A data record group that records to memory only. */
+class DRMemory : public Trick::DataRecordGroup {
+    public:
+        DRMemory() : Trick::DataRecordGroup("DRMemory_test") , rows_staged(0) , flushes(0) {}
+        virtual int format_specific_header(std::fstream &) { return 0 ; }
+        virtual int format_specific_init() { return 0 ; }
+        virtual int format_specific_write_data(unsigned int offset) {
+            rows_staged++ ;
+            times_written.push_back(((double *)rec_buffer[0]->buffer)[offset]) ;
+            return 0 ;
+        }
+        virtual int format_specific_flush() { if ( rows_staged ) { flushes++ ; write_calls++ ; rows_staged = 0 ; } return 0 ; }
+        virtual int format_specific_shutdown() { return 0 ; }
+        unsigned int rows_staged ;
+        unsigned int flushes ;
+        std::vector< double > times_written ;
+} ;
+
+/* Checks that every column of each row it formats holds the row's time, slowly, so data_record laps it. */
+class DRRingCheck : public DRMemory {
+    public:
+        DRRingCheck() : torn_rows(0) {}
+        virtual int format_specific_write_data(unsigned int offset) {
+            double time = ((double *)rec_buffer[0]->buffer)[offset] ;
+            for ( unsigned int ii = 1 ; ii < rec_buffer.size() ; ii++ ) {
+                for ( volatile int spin = 0 ; spin < 1000 ; spin++ ) ;
+                if ( ((double *)rec_buffer[ii]->buffer)[offset] != time ) {
+                    torn_rows++ ;
+                    break ;
+                }
+            }
+            return DRMemory::format_specific_write_data(offset) ;
+        }
+        unsigned int torn_rows ;
+} ;
+
+struct DRTestStruct {
+    char c[12] ;
+} ;
+
+class DataRecordGroupTest : public ::testing::Test {
+
+    protected:
+        Trick::CommandLineArguments cmd ;
+        ATTRIBUTES attr_double ;
+        ATTRIBUTES attr_int ;
+        ATTRIBUTES attr_short ;
+        ATTRIBUTES attr_char ;
+        ATTRIBUTES attr_struct ;
+
+        DataRecordGroupTest() {}
+        ~DataRecordGroupTest() {}
+
+        virtual void SetUp() {
+            set_attr(attr_double , TRICK_DOUBLE , sizeof(double)) ;
+            set_attr(attr_int , TRICK_INTEGER , sizeof(int)) ;
+            set_attr(attr_short , TRICK_SHORT , sizeof(short)) ;
+            set_attr(attr_char , TRICK_CHARACTER , sizeof(char)) ;
+            set_attr(attr_struct , TRICK_STRUCTURED , sizeof(DRTestStruct)) ;
+        }
+
+        virtual void TearDown() {
+            unlink("./log_DRMemory_test.header") ;
+        }
+
+        void set_attr( ATTRIBUTES & attr , TRICK_TYPE type , int size ) {
+            memset(&attr, 0, sizeof(ATTRIBUTES)) ;
+            attr.type = type ;
+            attr.size = size ;
+            attr.units = (char *)"1" ;
+        }
+
+        /* Adds a fixed address variable to the group. */
+        void add_ref( Trick::DataRecordGroup & drg , std::string name , void * address , ATTRIBUTES * attr ) {
+            REF2 * ref = (REF2 *)calloc(1 , sizeof(REF2)) ;
+            ref->reference = strdup(name.c_str()) ;
+            ref->address = address ;
+            ref->attr = attr ;
+            drg.add_variable(ref) ;
+        }
+
+        /* Adds a fixed address change variable to the group. */
+        void add_change_ref( Trick::DataRecordGroup & drg , void * address , ATTRIBUTES * attr ) {
+            Trick::DataRecordBuffer * drb = new Trick::DataRecordBuffer ;
+            drb->ref = (REF2 *)calloc(1 , sizeof(REF2)) ;
+            drb->ref->reference = strdup("change") ;
+            drb->ref->address = address ;
+            drb->ref->attr = attr ;
+            drb->buffer = (char *)malloc(attr->size) ;
+            memcpy(drb->buffer , address , attr->size) ;
+            drg.change_buffer.push_back(drb) ;
+        }
+} ;
+
+TEST_F( DataRecordGroupTest , RecordsEverySize ) {
+
+    DRMemory drg ;
+    double d = 0.0 ;
+    int i = 0 ;
+    short s = 0 ;
+    char c = 0 ;
+    DRTestStruct st ;
+
+    add_ref(drg , "d" , &d , &attr_double) ;
+    add_ref(drg , "i" , &i , &attr_int) ;
+    add_ref(drg , "s" , &s , &attr_short) ;
+    add_ref(drg , "c" , &c , &attr_char) ;
+    add_ref(drg , "st" , &st , &attr_struct) ;
+    drg.init() ;
+
+    for ( int ii = 0 ; ii < 10 ; ii++ ) {
+        d = ii * 1.5 ;
+        i = ii * 100 ;
+        s = ii * 10 ;
+        c = 'a' + ii ;
+        memset(st.c, ii, sizeof(st.c)) ;
+        drg.data_record(ii * 0.1) ;
+    }
+
+    EXPECT_EQ( drg.buffer_num , (unsigned int)10 ) ;
+    for ( int ii = 0 ; ii < 10 ; ii++ ) {
+        EXPECT_EQ( ((double *)drg.rec_buffer[0]->buffer)[ii] , ii * 0.1 ) ;
+        EXPECT_EQ( ((double *)drg.rec_buffer[1]->buffer)[ii] , ii * 1.5 ) ;
+        EXPECT_EQ( ((int *)drg.rec_buffer[2]->buffer)[ii] , ii * 100 ) ;
+        EXPECT_EQ( ((short *)drg.rec_buffer[3]->buffer)[ii] , ii * 10 ) ;
+        EXPECT_EQ( ((char *)drg.rec_buffer[4]->buffer)[ii] , 'a' + ii ) ;
+        EXPECT_EQ( drg.rec_buffer[5]->buffer[ii * sizeof(DRTestStruct) + sizeof(DRTestStruct) - 1] , ii ) ;
+    }
+}
+
+TEST_F( DataRecordGroupTest , RecordsChanges ) {
+
+    DRMemory drg ;
+    double d = 0.0 ;
+    int watch = 0 ;
+    DRTestStruct st ;
+
+    memset(st.c, 0, sizeof(st.c)) ;
+    add_ref(drg , "d" , &d , &attr_double) ;
+    add_change_ref(drg , &watch , &attr_int) ;
+    add_change_ref(drg , &st , &attr_struct) ;
+    drg.set_freq(DR_Changes) ;
+    drg.init() ;
+
+    // nothing changed
+    drg.data_record(0.0) ;
+    EXPECT_EQ( drg.buffer_num , (unsigned int)0 ) ;
+
+    watch = 1 ;
+    d = 2.0 ;
+    drg.data_record(0.1) ;
+    EXPECT_EQ( drg.buffer_num , (unsigned int)1 ) ;
+
+    // change is remembered, so the same value does not record again
+    drg.data_record(0.2) ;
+    EXPECT_EQ( drg.buffer_num , (unsigned int)1 ) ;
+
+    // the last byte of the struct falls in the 4 byte tail of the change plan
+    st.c[11] = 1 ;
+    drg.data_record(0.3) ;
+    EXPECT_EQ( drg.buffer_num , (unsigned int)2 ) ;
+
+    EXPECT_EQ( ((double *)drg.rec_buffer[1]->buffer)[0] , 2.0 ) ;
+    EXPECT_EQ( ((double *)drg.rec_buffer[0]->buffer)[1] , 0.3 ) ;
+}
+
+TEST_F( DataRecordGroupTest , RemoveVariableRebuildsPlan ) {
+
+    DRMemory drg ;
+    double d = 1.0 , e = 2.0 ;
+
+    add_ref(drg , "d" , &d , &attr_double) ;
+    add_ref(drg , "e" , &e , &attr_double) ;
+    drg.init() ;
+    drg.data_record(0.0) ;
+
+    drg.remove_variable("d") ;
+    e = 3.0 ;
+    drg.data_record(0.1) ;
+
+    ASSERT_EQ( drg.rec_buffer.size() , (unsigned int)2 ) ;
+    EXPECT_EQ( ((double *)drg.rec_buffer[1]->buffer)[1] , 3.0 ) ;
+}
+
+TEST_F( DataRecordGroupTest , WritesRowsInBatches ) {
+
+    DRMemory drg ;
+    double d = 0.0 ;
+
+    add_ref(drg , "d" , &d , &attr_double) ;
+    drg.init() ;
+
+    for ( int ii = 0 ; ii < 25 ; ii++ ) {
+        d = ii ;
+        drg.data_record(ii * 0.1) ;
+    }
+    drg.write_data(true) ;
+
+    // one flush for all rows gathered since the last write
+    EXPECT_EQ( drg.rows_written , (uint64_t)25 ) ;
+    EXPECT_EQ( drg.flushes , (unsigned int)1 ) ;
+    EXPECT_EQ( drg.write_calls , (uint64_t)1 ) ;
+
+    // nothing new to write does not flush
+    drg.write_data(true) ;
+    EXPECT_EQ( drg.flushes , (unsigned int)1 ) ;
+
+    std::ostringstream oss ;
+    drg.dump_write_rates(oss) ;
+    EXPECT_NE( oss.str().find("rows written = 25") , std::string::npos ) ;
+}
+
+TEST_F( DataRecordGroupTest , RingBufferWritesLastRows ) {
+
+    DRMemory drg ;
+    double d = 0.0 ;
+
+    add_ref(drg , "d" , &d , &attr_double) ;
+    drg.set_max_buffer_size(10) ;
+    drg.set_buffer_type(DR_Ring_Buffer) ;
+    drg.init() ;
+
+    for ( int ii = 0 ; ii < 25 ; ii++ ) {
+        drg.data_record(ii) ;
+    }
+    EXPECT_EQ( drg.buffered_rows() , (unsigned int)10 ) ;
+    drg.write_data(true) ;
+
+    // the ring kept the last 10 rows, the 15 before them were overwritten
+    ASSERT_EQ( drg.times_written.size() , (unsigned int)10 ) ;
+    EXPECT_EQ( drg.times_written[0] , 15.0 ) ;
+    EXPECT_EQ( drg.times_written[9] , 24.0 ) ;
+    EXPECT_EQ( drg.rows_dropped , (uint64_t)15 ) ;
+    EXPECT_EQ( drg.buffered_rows() , (unsigned int)0 ) ;
+}
+
+static bool recording_done ;
+
+/* Writes the group's rows from another thread until recording is done and then writes the rest. */
+static void * write_rows( void * arg ) {
+    DRMemory * drg = (DRMemory *)arg ;
+    while ( ! __atomic_load_n(&recording_done, __ATOMIC_ACQUIRE) ) {
+        drg->write_data(true) ;
+    }
+    drg->write_data(true) ;
+    return NULL ;
+}
+
+TEST_F( DataRecordGroupTest , WriterThreadSeesEveryRow ) {
+
+    DRMemory drg ;
+    double d = 0.0 ;
+    pthread_t writer ;
+
+    add_ref(drg , "d" , &d , &attr_double) ;
+    drg.set_max_buffer_size(64) ;
+    drg.init() ;
+
+    recording_done = false ;
+    pthread_create(&writer, NULL, write_rows, &drg) ;
+    for ( int ii = 0 ; ii < 100000 ; ii++ ) {
+        drg.data_record(ii) ;
+    }
+    __atomic_store_n(&recording_done, true, __ATOMIC_RELEASE) ;
+    pthread_join(writer, NULL) ;
+
+    // every row arrives once, in order, with the data the recording thread copied
+    ASSERT_EQ( drg.times_written.size() , (unsigned int)100000 ) ;
+    for ( int ii = 0 ; ii < 100000 ; ii++ ) {
+        ASSERT_EQ( drg.times_written[ii] , (double)ii ) ;
+    }
+    EXPECT_EQ( drg.rows_dropped , (uint64_t)0 ) ;
+}
+
+TEST_F( DataRecordGroupTest , RingWriterSkipsOverwrittenRows ) {
+
+    DRRingCheck drg ;
+    double d[4] = { 0.0 , 0.0 , 0.0 , 0.0 } ;
+    pthread_t writer ;
+    const unsigned int num_rows = 100000 ;
+    unsigned int ii , jj ;
+
+    for ( jj = 0 ; jj < 4 ; jj++ ) {
+        std::ostringstream name ;
+        name << "d" << jj ;
+        add_ref(drg , name.str() , &d[jj] , &attr_double) ;
+    }
+    drg.set_max_buffer_size(16) ;
+    drg.set_buffer_type(DR_Ring_Buffer) ;
+    drg.init() ;
+
+    recording_done = false ;
+    pthread_create(&writer, NULL, write_rows, &drg) ;
+    for ( ii = 0 ; ii < num_rows ; ii++ ) {
+        for ( jj = 0 ; jj < 4 ; jj++ ) {
+            d[jj] = ii ;
+        }
+        drg.data_record(ii) ;
+    }
+    __atomic_store_n(&recording_done, true, __ATOMIC_RELEASE) ;
+    pthread_join(writer, NULL) ;
+
+    // rows the recording thread overwrote while they were copied are dropped, not written torn
+    EXPECT_EQ( drg.torn_rows , 0u ) ;
+    EXPECT_EQ( drg.rows_written + drg.rows_dropped , (uint64_t)num_rows ) ;
+    ASSERT_EQ( drg.times_written.size() , drg.rows_written ) ;
+    for ( ii = 1 ; ii < drg.times_written.size() ; ii++ ) {
+        ASSERT_GT( drg.times_written[ii] , drg.times_written[ii - 1] ) ;
+    }
+}
+
+TEST_F( DataRecordGroupTest , CopyPlanRecordsManyVariables ) {
+
+    DRMemory drg ;
+    const unsigned int num_vars = 20000 ;
+    const unsigned int num_records = 100 ;
+    std::vector< double > values(num_vars) ;
+    unsigned int ii , jj ;
+
+    for ( ii = 0 ; ii < num_vars ; ii++ ) {
+        std::ostringstream oss ;
+        oss << "v" << ii ;
+        add_ref(drg , oss.str() , &values[ii] , &attr_double) ;
+    }
+    drg.set_max_buffer_size(num_records) ;
+    drg.set_buffer_type(DR_Ring_Buffer) ;
+    drg.init() ;
+
+    for ( jj = 0 ; jj < num_records ; jj++ ) {
+        for ( ii = 0 ; ii < num_vars ; ii++ ) {
+            values[ii] = ii * 1000.0 + jj ;
+        }
+        drg.data_record(jj * 0.001) ;
+    }
+
+    // every variable of every row holds the value it had when the row was recorded.  Buffer 0 is sys.exec.out.time.
+    EXPECT_EQ( drg.buffer_num , num_records ) ;
+    for ( ii = 0 ; ii < num_vars ; ii++ ) {
+        double * buffer = (double *)drg.rec_buffer[ii + 1]->buffer ;
+        for ( jj = 0 ; jj < num_records ; jj++ ) {
+            ASSERT_EQ( buffer[jj] , ii * 1000.0 + jj ) ;
+        }
+    }
+}
+
+}
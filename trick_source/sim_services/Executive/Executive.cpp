@@ -19,6 +19,7 @@ Trick::Executive::Executive() {
 
     advance_sim_time_job = NULL ;
     attach_debugger = false ;
+    batch_job_queues = false ;
     curr_job = NULL ;
 
     struct stat st ;
@@ -313,6 +314,9 @@ void Trick::Executive::reset_job_call_times() {
             }
         }
     }
+    for ( ii = 0 ; ii < threads.size() ; ii++ ) {
+        threads[ii]->job_queue.reschedule() ;
+    }
     return ;
 }
 
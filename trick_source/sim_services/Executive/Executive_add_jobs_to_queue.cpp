@@ -32,6 +32,8 @@
     -# If the sim is not restarting, convert the initial start, stop, and next call times to
        simulation tics.  The next call time is based on the current simulation time + job offset.
        Requirement [@ref r_exec_jobs_3]
+-# The jobs are batched and the batches are committed to the queues after all jobs are processed.
+   If a batch was already started by the caller, the caller commits it.
 */
 int Trick::Executive::add_jobs_to_queue( Trick::SimObject * in_sim_object , bool restart_flag ) {
 
@@ -40,8 +42,10 @@ int Trick::Executive::add_jobs_to_queue( Trick::SimObject * in_sim_object , bool
     Trick::JobData * temp_job  ;
     Trick::Threads * curr_thread ;
     int ret ;
+    bool commit = ! batch_job_queues ;
 
     max_time = TRICK_MAX_LONG_LONG / time_tic_value ;
+    batch_job_queues = true ;
 
     for ( jj = 0 ; jj < in_sim_object->jobs.size() ; jj++ ) {
         temp_job = in_sim_object->jobs[jj] ;
@@ -126,6 +130,10 @@ int Trick::Executive::add_jobs_to_queue( Trick::SimObject * in_sim_object , bool
         }
     }
 
+    if ( commit ) {
+        commit_job_queues() ;
+    }
+
     return(0) ;
 
 }
@@ -159,35 +167,35 @@ int Trick::Executive::add_job_to_queue( Trick::JobData * job ) {
         if ( job->thread != 0 ) {
             /* Add threaded scheduled jobs to the thread scheduled queue */
             if ( job->job_class >= scheduled_start_index ) {
-                threads[job->thread]->job_queue.push(job) ;
+                queue_job(threads[job->thread]->job_queue, job) ;
                 // Add all scheduled jobs to the scheduled_queue for use in the multi-threaded loop
-                scheduled_queue.push(job) ;
+                queue_job(scheduled_queue, job) ;
                 return 0 ;
             /* Threaded top_of_frame/end_of_frame jobs go to thread specific queues. */
             } else if ( ! job->job_class_name.compare("top_of_frame")) {
-                threads[job->thread]->top_of_frame_queue.push(job) ;
+                queue_job(threads[job->thread]->top_of_frame_queue, job) ;
                 return 0 ;
             } else if ( ! job->job_class_name.compare("end_of_frame")) {
-                threads[job->thread]->end_of_frame_queue.push(job) ;
+                queue_job(threads[job->thread]->end_of_frame_queue, job) ;
                 return 0 ;
             /* Other jobs classes are put into the main thread */
             } else if ( (queue_it = class_to_queue.find(job->job_class)) != class_to_queue.end() ) {
                 /* for non-scheduled jobs, the class_to_queue map holds the correct queue to insert the job */
                 curr_queue = queue_it->second ;
-                curr_queue->push( job ) ;
+                queue_job(*curr_queue, job) ;
                 return 0 ;
             }
         } else {
             /* if the job is a "scheduled" type job, insert the job into the proper thread queue */
             if ( job->job_class >= scheduled_start_index ) {
-                threads[0]->job_queue.push(job) ;
+                queue_job(threads[0]->job_queue, job) ;
                 // Add all scheduled jobs to the scheduled_queue for use in the multi-threaded loop
-                scheduled_queue.push(job) ;
+                queue_job(scheduled_queue, job) ;
                 return 0 ;
             } else if ( (queue_it = class_to_queue.find(job->job_class)) != class_to_queue.end() ) {
                 /* for non-scheduled jobs, the class_to_queue map holds the correct queue to insert the job */
                 curr_queue = queue_it->second ;
-                curr_queue->push( job ) ;
+                queue_job(*curr_queue, job) ;
                 return 0 ;
             }
         }
@@ -196,3 +204,35 @@ int Trick::Executive::add_job_to_queue( Trick::JobData * job ) {
     return -1 ;
 
 }
+
+/**
+@details
+-# If jobs are being batched, add the job to the queue's batch and remember the queue.
+-# Else push the job onto the queue.
+*/
+void Trick::Executive::queue_job( Trick::ScheduledJobQueue & queue , Trick::JobData * job ) {
+    if ( batch_job_queues ) {
+        queue.batch_push(job) ;
+        batch_queues.insert(&queue) ;
+    } else {
+        queue.push(job) ;
+    }
+}
+
+/**
+@details
+-# Commit the batch of every queue that was given jobs.
+-# Stop batching jobs.
+*/
+int Trick::Executive::commit_job_queues() {
+
+    std::set<Trick::ScheduledJobQueue *>::iterator it ;
+
+    for ( it = batch_queues.begin() ; it != batch_queues.end() ; ++it ) {
+        (*it)->batch_commit() ;
+    }
+    batch_queues.clear() ;
+    batch_job_queues = false ;
+
+    return(0) ;
+}
@@ -890,6 +890,30 @@ extern "C" int exec_set_thread_cpu_affinity(unsigned int thread_id , int cpu_num
     return -1 ;
 }
 
+/**
+ * @relates Trick::Executive
+ * @copydoc Trick::Executive::set_thread_job_workers
+ * C wrapper for Trick::Executive::set_thread_job_workers
+ */
+extern "C" int exec_set_thread_job_workers(unsigned int thread_id , unsigned int num_workers) {
+    if ( the_exec != NULL ) {
+        return the_exec->set_thread_job_workers(thread_id, num_workers) ;
+    }
+    return -1 ;
+}
+
+/**
+ * @relates Trick::Executive
+ * @copydoc Trick::Executive::set_thread_job_worker_cpu_affinity
+ * C wrapper for Trick::Executive::set_thread_job_worker_cpu_affinity
+ */
+extern "C" int exec_set_thread_job_worker_cpu_affinity(unsigned int thread_id , unsigned int worker , int cpu_num) {
+    if ( the_exec != NULL ) {
+        return the_exec->set_thread_job_worker_cpu_affinity(thread_id, worker, cpu_num) ;
+    }
+    return -1 ;
+}
+
 /**
  * @relates Trick::Executive
  * @copydoc Trick::Executive::set_thread_priority
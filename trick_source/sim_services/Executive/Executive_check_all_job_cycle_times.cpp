@@ -30,6 +30,9 @@ int Trick::Executive::check_all_job_cycle_times() {
             ret = -1 ;
         }
     }
+    for ( ii = 0 ; ii < threads.size() ; ii++ ) {
+        threads[ii]->job_queue.reschedule() ;
+    }
 
     /* Check if time_tic_value is only divisible by 2 and 5 */
     temp_time_tic_value = time_tic_value ;
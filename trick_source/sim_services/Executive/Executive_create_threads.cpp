@@ -27,6 +27,11 @@ int Trick::Executive::create_threads() {
     threads[0]->execute_priority() ;
     threads[0]->execute_cpu_affinity() ;
 
+    /** @li Start the job worker helpers of every thread that asked for them. */
+    for ( kk = 0 ; kk < threads.size() ; kk++ ) {
+        threads[kk]->job_pool.create_workers(threads[kk]->get_name(), threads[kk]->rt_nap) ;
+    }
+
     return(0) ;
 
 }
@@ -18,6 +18,7 @@
         -# Call the job.  Requirement  [@ref r_exec_periodic_0]
         -# If the job is a system job, check to see if the next job call time is the lowest next time by
            calling Trick::ScheduledJobQueue::test_next_job_call_time(Trick::JobData *, long long)
+    -# If the main thread has job workers, the scheduled jobs are called through Trick::JobWorkerPool::call_jobs instead
     -# If the exec_command equals ExitCmd
        -# Call Trick::Executive::exec_terminate_with_return(int, char *, int, char *)
     -# If the elapsed time has reached the termination time
@@ -65,17 +66,21 @@ int Trick::Executive::loop_single_thread() {
         }
 
         /* Call all scheduled jobs that are scheduled to run at the current simulation time step. */
-        main_sched_queue->reset_curr_index() ;
-        while ( (curr_job = main_sched_queue->find_next_job( time_tics )) != NULL ) {
-            //std::cout << "[33mtime = " << time_tics << " " << curr_job->name << " job next = " << curr_job->next_tics << "[00m" << std::endl ;
-            ret = curr_job->call() ;
-            if ( ret != 0 ) {
-                exec_terminate_with_return(ret , curr_job->name.c_str() , 0 , "scheduled job did not return 0") ;
-            }
-            /* System jobs next call time are not set until after they run.
-               Test their next job call time after they have been called */
-            if ( curr_job->system_job_class ) {
-                main_sched_queue->test_next_job_call_time(curr_job , time_tics) ;
+        if ( threads[0]->job_pool.get_num_workers() > 0 ) {
+            threads[0]->job_pool.call_jobs(*main_sched_queue, time_tics) ;
+        } else {
+            main_sched_queue->reset_curr_index() ;
+            while ( (curr_job = main_sched_queue->find_next_job( time_tics )) != NULL ) {
+                //std::cout << "[33mtime = " << time_tics << " " << curr_job->name << " job next = " << curr_job->next_tics << "[00m" << std::endl ;
+                ret = curr_job->call() ;
+                if ( ret != 0 ) {
+                    exec_terminate_with_return(ret , curr_job->name.c_str() , 0 , "scheduled job did not return 0") ;
+                }
+                /* System jobs next call time are not set until after they run.
+                   Test their next job call time after they have been called */
+                if ( curr_job->system_job_class ) {
+                    main_sched_queue->test_next_job_call_time(curr_job , time_tics) ;
+                }
             }
         }
 
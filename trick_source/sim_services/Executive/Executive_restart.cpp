@@ -79,13 +79,16 @@ int Trick::Executive::restart() {
     }
 
     /* restore the executive sim_objects vector from the checkpoint and add back all of
-       the jobs to the schedulers */
+       the jobs to the schedulers.  The jobs of all sim_objects are committed to the queues
+       in one batch. */
+    batch_job_queues = true ;
     for ( sit = sim_objects.begin() ; sit != sim_objects.end() ; sit++ ) {
         add_jobs_to_queue(*sit, true) ;
         for ( ii = 0 ; ii < other_schedulers.size() ; ii++ ) {
             other_schedulers[ii]->add_sim_object(*sit) ;
         }
     }
+    commit_job_queues() ;
     num_sim_objects = sim_objects.size() ;
 
     // The queues have been rebuilt, restore the current position of the input processor queue.
@@ -37,6 +37,10 @@ int Trick::Executive::set_job_cycle(std::string job_name, int instance_num, doub
         }
     }
 
+    for ( unsigned int ii = 0 ; ii < threads.size() ; ii++ ) {
+        threads[ii]->job_queue.reschedule() ;
+    }
+
     return(0) ;
 
 }
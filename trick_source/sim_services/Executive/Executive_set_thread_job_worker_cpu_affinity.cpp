@@ -0,0 +1,20 @@
+
+#include "trick/Executive.hh"
+
+int Trick::Executive::set_thread_job_worker_cpu_affinity(unsigned int thread_id , unsigned int worker , int cpu_num) {
+
+    int ret = 0 ;
+
+    /** @par Detailed Design */
+    if ( (thread_id + 1) > threads.size() ) {
+        /** @li If the thread_id does not exist, return an error */
+        ret = -2 ;
+    } else {
+        /** @li Call Trick::JobWorkerPool::set_worker_cpu_affinity for the thread's pool */
+        ret = threads[thread_id]->job_pool.set_worker_cpu_affinity(worker , cpu_num) ;
+    }
+
+    return(ret) ;
+
+}
+
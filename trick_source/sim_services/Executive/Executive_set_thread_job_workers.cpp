@@ -0,0 +1,20 @@
+
+#include "trick/Executive.hh"
+
+int Trick::Executive::set_thread_job_workers(unsigned int thread_id , unsigned int num_workers) {
+
+    int ret = 0 ;
+
+    /** @par Detailed Design */
+    if ( (thread_id + 1) > threads.size() ) {
+        /** @li If the thread_id does not exist, return an error */
+        ret = -2 ;
+    } else {
+        /** @li Call Trick::JobWorkerPool::set_num_workers for the thread's pool */
+        ret = threads[thread_id]->job_pool.set_num_workers(num_workers) ;
+    }
+
+    return(ret) ;
+
+}
+
@@ -102,6 +102,11 @@ int Trick::Executive::shutdown() {
             process_id, except_file.c_str(), except_message.c_str() ,
             sim_start , get_sim_time() , sim_elapsed_time , actual_cpu_time , sim_to_cpu , cpu_init ) ;
 
+    /* Kill all job worker helpers. */
+    for (ii = 0; ii < threads.size() ; ii++) {
+        threads[ii]->job_pool.cancel_workers() ;
+    }
+
     /* Kill all threads. */
     for (ii = 1; ii < threads.size() ; ii++) {
         if ( threads[ii]->running ) {
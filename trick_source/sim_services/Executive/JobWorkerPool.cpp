@@ -0,0 +1,368 @@
+
+#include <sstream>
+
+#ifdef __linux
+#include <cxxabi.h>
+#endif
+
+#include "trick/JobWorkerPool.hh"
+#include "trick/release.h"
+#include "trick/exec_proto.h"
+
+Trick::JobWorker::JobWorker( Trick::JobWorkerPool * in_pool , unsigned int in_worker_id , std::string in_name ) :
+ Trick::ThreadBase(in_name) ,
+ pool(in_pool) ,
+ worker_id(in_worker_id) {}
+
+/* Cancellation cleanup.  A worker cancelled inside pthread_cond_wait owns the level mutex. */
+static void unlock_level_mutex( void * mutex ) {
+    pthread_mutex_unlock((pthread_mutex_t *)mutex) ;
+}
+
+/**
+@details
+-# Wait for the pool to post a new level
+-# Call Trick::JobWorkerPool::run_chains to run and steal chains until none remain
+*/
+void * Trick::JobWorker::thread_body() {
+
+    unsigned int seen ;
+
+    pthread_mutex_lock(&pool->level_mutex) ;
+    pthread_cleanup_push(unlock_level_mutex, &pool->level_mutex) ;
+    seen = pool->generation ;
+    while (1) {
+        while ( pool->generation == seen ) {
+            pthread_cond_wait(&pool->work_cv, &pool->level_mutex) ;
+        }
+        seen = pool->generation ;
+        pthread_mutex_unlock(&pool->level_mutex) ;
+
+        pool->run_chains(worker_id) ;
+
+        pthread_mutex_lock(&pool->level_mutex) ;
+    }
+    pthread_cleanup_pop(1) ;
+
+    return NULL ;
+}
+
+Trick::JobWorkerPool::JobWorkerPool() :
+ level_depends(false) ,
+ num_chains(0) ,
+ level_class(0) ,
+ level_phase(0) ,
+ generation(0) ,
+ remaining(0) ,
+ rt_nap(true) ,
+ level_error(false) ,
+ level_exception(0, "", 0, "") {
+    pthread_mutex_init(&level_mutex, NULL) ;
+    pthread_cond_init(&work_cv, NULL) ;
+    pthread_cond_init(&done_cv, NULL) ;
+}
+
+Trick::JobWorkerPool::~JobWorkerPool() {
+    unsigned int ii ;
+    /* Workers must be gone before the condition variables they wait on are destroyed. */
+    cancel_workers() ;
+    for ( ii = 0 ; ii < workers.size() ; ii++ ) {
+        if ( workers[ii]->get_pthread_id() != 0 ) {
+            pthread_join(workers[ii]->get_pthread_id(), NULL) ;
+        }
+        delete workers[ii] ;
+    }
+    for ( ii = 0 ; ii < deque_mutexes.size() ; ii++ ) {
+        pthread_mutex_destroy(&deque_mutexes[ii]) ;
+    }
+    pthread_cond_destroy(&done_cv) ;
+    pthread_cond_destroy(&work_cv) ;
+    pthread_mutex_destroy(&level_mutex) ;
+}
+
+int Trick::JobWorkerPool::set_num_workers( unsigned int num_workers ) {
+
+    unsigned int ii ;
+
+    for ( ii = 0 ; ii < workers.size() ; ii++ ) {
+        if ( workers[ii]->get_pthread_id() != 0 ) {
+            return -1 ;
+        }
+    }
+
+    for ( ii = 0 ; ii < workers.size() ; ii++ ) {
+        delete workers[ii] ;
+    }
+    for ( ii = 0 ; ii < deque_mutexes.size() ; ii++ ) {
+        pthread_mutex_destroy(&deque_mutexes[ii]) ;
+    }
+    workers.clear() ;
+
+    /* The mutexes are initialized in place after sizing so they are never copied. */
+    deques.assign(num_workers + 1, std::deque< unsigned int >()) ;
+    deque_mutexes.resize(num_workers + 1) ;
+    for ( ii = 0 ; ii < deque_mutexes.size() ; ii++ ) {
+        pthread_mutex_init(&deque_mutexes[ii], NULL) ;
+    }
+    for ( ii = 0 ; ii < num_workers ; ii++ ) {
+        workers.push_back(new Trick::JobWorker(this, ii + 1, "")) ;
+    }
+
+    return 0 ;
+}
+
+unsigned int Trick::JobWorkerPool::get_num_workers() {
+    return workers.size() ;
+}
+
+int Trick::JobWorkerPool::set_worker_cpu_affinity( unsigned int worker , int cpu_num ) {
+    if ( worker >= workers.size() ) {
+        return -1 ;
+    }
+    return workers[worker]->cpu_set(cpu_num) ;
+}
+
+int Trick::JobWorkerPool::create_workers( std::string in_name , bool in_rt_nap ) {
+
+    unsigned int ii ;
+
+    rt_nap = in_rt_nap ;
+    for ( ii = 0 ; ii < workers.size() ; ii++ ) {
+        // if this is a restart, worker may have already been created
+        if ( workers[ii]->get_pthread_id() == 0 ) {
+            std::ostringstream oss ;
+            oss << in_name << "_w" << ii ;
+            workers[ii]->set_name(oss.str()) ;
+            workers[ii]->create_thread() ;
+        }
+    }
+    return 0 ;
+}
+
+void Trick::JobWorkerPool::cancel_workers() {
+    unsigned int ii ;
+    for ( ii = 0 ; ii < workers.size() ; ii++ ) {
+        workers[ii]->cancel_thread() ;
+    }
+}
+
+/**
+@details
+-# For each job due at time_tics [@ref ScheduledJobQueue]
+    -# If the job is a system job, run the gathered level, then call the job on this thread and
+       test its next job call time with Trick::ScheduledJobQueue::test_next_job_call_time
+    -# Else if the job class or phase differs from the gathered level, run the gathered level
+       and start a new one with this job
+    -# Else add the job to the gathered level
+-# Run the last gathered level
+*/
+int Trick::JobWorkerPool::call_jobs( Trick::ScheduledJobQueue & job_queue , long long time_tics ) {
+
+    Trick::JobData * curr_job ;
+    int ret ;
+
+    num_chains = 0 ;
+    chain_index.clear() ;
+    level_jobs.clear() ;
+    level_depends = false ;
+
+    job_queue.reset_curr_index() ;
+    while ( (curr_job = job_queue.find_next_job( time_tics )) != NULL ) {
+
+        if ( curr_job->system_job_class ) {
+            run_level() ;
+            ret = curr_job->call() ;
+            if ( ret != 0 ) {
+                exec_terminate_with_return(ret , curr_job->name.c_str() , 0 , "scheduled job did not return 0") ;
+            }
+            job_queue.test_next_job_call_time(curr_job , time_tics) ;
+            curr_job->complete = true ;
+            continue ;
+        }
+
+        if ( num_chains > 0 && ( curr_job->job_class != level_class || curr_job->phase != level_phase )) {
+            run_level() ;
+        }
+        add_job(curr_job) ;
+    }
+    run_level() ;
+
+    return 0 ;
+}
+
+void Trick::JobWorkerPool::add_job( Trick::JobData * curr_job ) {
+
+    std::map< int , unsigned int >::iterator mit ;
+    unsigned int chain ;
+
+    if ( num_chains == 0 ) {
+        level_class = curr_job->job_class ;
+        level_phase = curr_job->phase ;
+    }
+    level_jobs.push_back(curr_job) ;
+    if ( ! curr_job->depends.empty() ) {
+        level_depends = true ;
+    }
+
+    mit = chain_index.find(curr_job->sim_object_id) ;
+    if ( mit == chain_index.end() ) {
+        /* Chain vectors are reused from level to level to avoid allocating every frame. */
+        chain = num_chains++ ;
+        if ( chain == chains.size() ) {
+            chains.push_back(std::vector< Trick::JobData * >()) ;
+        }
+        chains[chain].clear() ;
+        chain_index[curr_job->sim_object_id] = chain ;
+    } else {
+        chain = mit->second ;
+    }
+    chains[chain].push_back(curr_job) ;
+}
+
+/**
+@details
+-# A level of one chain, a pool without workers, or a level holding a job that waits on other jobs
+   runs directly on this thread in queue order.  Chains are taken in no fixed order, so a chain
+   waiting on a job in a chain still queued could otherwise hold its worker forever.
+-# Deal the chains round robin to the deques so the starting assignment is the same every frame
+-# Wake the workers and run chains on this thread until the level completes
+-# Rethrow the first exception raised by a job in the level
+*/
+void Trick::JobWorkerPool::run_level() {
+
+    unsigned int ii ;
+
+    if ( num_chains == 0 ) {
+        return ;
+    }
+
+    if ( num_chains == 1 || workers.empty() || level_depends ) {
+        call_chain(level_jobs) ;
+    } else {
+        pthread_mutex_lock(&level_mutex) ;
+        remaining = num_chains ;
+        for ( ii = 0 ; ii < num_chains ; ii++ ) {
+            unsigned int dd = ii % deques.size() ;
+            pthread_mutex_lock(&deque_mutexes[dd]) ;
+            deques[dd].push_back(ii) ;
+            pthread_mutex_unlock(&deque_mutexes[dd]) ;
+        }
+        generation++ ;
+        pthread_cond_broadcast(&work_cv) ;
+        pthread_mutex_unlock(&level_mutex) ;
+
+        run_chains(0) ;
+
+        pthread_mutex_lock(&level_mutex) ;
+        while ( remaining > 0 ) {
+            pthread_cond_wait(&done_cv, &level_mutex) ;
+        }
+        pthread_mutex_unlock(&level_mutex) ;
+    }
+
+    num_chains = 0 ;
+    chain_index.clear() ;
+    level_jobs.clear() ;
+    level_depends = false ;
+
+    if ( level_error ) {
+        level_error = false ;
+        throw level_exception ;
+    }
+}
+
+void Trick::JobWorkerPool::run_chains( unsigned int worker_id ) {
+
+    unsigned int chain ;
+
+    while ( get_chain(worker_id, chain) ) {
+        call_chain(chains[chain]) ;
+        pthread_mutex_lock(&level_mutex) ;
+        if ( --remaining == 0 ) {
+            pthread_cond_signal(&done_cv) ;
+        }
+        pthread_mutex_unlock(&level_mutex) ;
+    }
+}
+
+bool Trick::JobWorkerPool::get_chain( unsigned int worker_id , unsigned int & chain ) {
+
+    unsigned int ii ;
+    unsigned int victim ;
+
+    /* Own work is taken from the back, most recently dealt first. */
+    pthread_mutex_lock(&deque_mutexes[worker_id]) ;
+    if ( ! deques[worker_id].empty() ) {
+        chain = deques[worker_id].back() ;
+        deques[worker_id].pop_back() ;
+        pthread_mutex_unlock(&deque_mutexes[worker_id]) ;
+        return true ;
+    }
+    pthread_mutex_unlock(&deque_mutexes[worker_id]) ;
+
+    /* Steal from the front of the other deques, starting with the next worker over. */
+    for ( ii = 1 ; ii < deques.size() ; ii++ ) {
+        victim = (worker_id + ii) % deques.size() ;
+        pthread_mutex_lock(&deque_mutexes[victim]) ;
+        if ( ! deques[victim].empty() ) {
+            chain = deques[victim].front() ;
+            deques[victim].pop_front() ;
+            pthread_mutex_unlock(&deque_mutexes[victim]) ;
+            return true ;
+        }
+        pthread_mutex_unlock(&deque_mutexes[victim]) ;
+    }
+    return false ;
+}
+
+/**
+@details
+-# For each job in the list
+    -# Wait for all job dependencies to complete.  Requirement  [@ref r_exec_thread_6]
+    -# Call the job.  Requirement  [@ref r_exec_periodic_0]
+    -# Set the job complete flag
+-# If a job terminates the sim, record the exception for the owning thread and skip the rest of the chain
+*/
+void Trick::JobWorkerPool::call_chain( std::vector< Trick::JobData * > & jobs ) {
+
+    Trick::JobData * curr_job ;
+    unsigned int ii , jj ;
+    int ret ;
+
+    try {
+        for ( ii = 0 ; ii < jobs.size() ; ii++ ) {
+            curr_job = jobs[ii] ;
+            for ( jj = 0 ; jj < curr_job->depends.size() ; jj++ ) {
+                while (! curr_job->depends[jj]->complete) {
+                    if (rt_nap == true) {
+                        RELEASE();
+                    }
+                }
+            }
+            ret = curr_job->call() ;
+            if ( ret != 0 ) {
+                exec_terminate_with_return(ret , curr_job->name.c_str() , 0 , "scheduled job did not return 0") ;
+            }
+            curr_job->complete = true ;
+        }
+    } catch (Trick::ExecutiveException & ex ) {
+        pthread_mutex_lock(&level_mutex) ;
+        if ( ! level_error ) {
+            level_error = true ;
+            level_exception = ex ;
+        }
+        pthread_mutex_unlock(&level_mutex) ;
+#ifdef __linux
+    } catch (abi::__forced_unwind&) {
+        //pthread_exit and pthread_cancel will cause an abi::__forced_unwind to be thrown. Rethrow it.
+        throw;
+#endif
+    } catch (std::exception & ex ) {
+        pthread_mutex_lock(&level_mutex) ;
+        if ( ! level_error ) {
+            level_error = true ;
+            level_exception = Trick::ExecutiveException(-1 , jobs[ii]->name , 0 , ex.what()) ;
+        }
+        pthread_mutex_unlock(&level_mutex) ;
+    }
+}
@@ -26,6 +26,7 @@
 #include "trick/exec_proto.h"
 #include "trick/TrickConstant.hh"
 #include "trick/message_proto.h"
+#include "trick/TraceLog.hh"
 
 
 /**
@@ -83,6 +84,7 @@ static int call_next_job(Trick::JobData * curr_job, Trick::ScheduledJobQueue & j
     -# Switch if the child is a synchronous thread
         -# For each scheduled jobs whose next call time is equal to the current simulation time [@ref ScheduledJobQueue]
             -# Call call_next_job(Trick::JobData * curr_job, Trick::ScheduledJobQueue & job_queue, bool rt_nap, long long curr_time_tics)
+        -# If the thread has job workers, call Trick::JobWorkerPool::call_jobs instead
     -# Switch if the child is a asynchronous must finish thread
         -# Do while the job queue time is less than the time of the next AMF sync time.
             -# For each scheduled jobs whose next call time is equal to the current queue time
@@ -105,17 +107,23 @@ void * Trick::Threads::thread_body() {
         do {
 
             /* Block child on trigger until master signals. */
+            unsigned long long trace_start = Trick::TraceLog::start() ;
             trigger_container.getThreadTrigger()->wait() ;
+            Trick::TraceLog::complete("thread", "wait", trace_start) ;
 
             if ( enabled ) {
 
                 switch ( process_type ) {
                     case PROCESS_TYPE_SCHEDULED:
                     /* Loop through all jobs currently scheduled to run at this simulation time step. */
-                    job_queue.reset_curr_index() ;
                     job_queue.set_next_job_call_time(TRICK_MAX_LONG_LONG) ;
-                    while ( (curr_job = job_queue.find_next_job( curr_time_tics )) != NULL ) {
-                        call_next_job(curr_job, job_queue, rt_nap, curr_time_tics) ;
+                    if ( job_pool.get_num_workers() > 0 ) {
+                        job_pool.call_jobs(job_queue, curr_time_tics) ;
+                    } else {
+                        job_queue.reset_curr_index() ;
+                        while ( (curr_job = job_queue.find_next_job( curr_time_tics )) != NULL ) {
+                            call_next_job(curr_job, job_queue, rt_nap, curr_time_tics) ;
+                        }
                     }
                     break ;
 
@@ -170,6 +178,7 @@ void * Trick::Threads::thread_body() {
                                 curr_job->next_tics += curr_job->cycle_tics ;
                             }
                         }
+                        job_queue.reschedule() ;
 
                         // New behavior, run a mini scheduler.
                         /* call the AMF top of frame jobs */
@@ -899,6 +899,13 @@ TEST_F(ExecutiveTest , SetThreadParameters) {
     EXPECT_EQ( exec.set_thread_cpu_affinity(1 , 2) , 0 ) ;
     EXPECT_EQ( exec.set_thread_cpu_affinity(2 , 1) , -2 ) ;
 
+    EXPECT_EQ( exec.set_thread_job_workers(0 , 2) , 0 ) ;
+    EXPECT_EQ( exec.set_thread_job_workers(2 , 2) , -2 ) ;
+    EXPECT_EQ( exec.set_thread_job_worker_cpu_affinity(0 , 1 , 1) , 0 ) ;
+    EXPECT_EQ( exec.set_thread_job_worker_cpu_affinity(0 , 2 , 1) , -1 ) ;
+    EXPECT_EQ( exec.set_thread_job_worker_cpu_affinity(2 , 0 , 1) , -2 ) ;
+    EXPECT_EQ( exec.set_thread_job_workers(0 , 0) , 0 ) ;
+
     EXPECT_EQ( exec.set_thread_priority(0 , 1) , 0 ) ;
     EXPECT_EQ( exec.set_thread_priority(1 , 2) , 0 ) ;
     EXPECT_EQ( exec.set_thread_priority(2 , 1) , -2 ) ;
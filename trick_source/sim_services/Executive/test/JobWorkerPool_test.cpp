@@ -0,0 +1,226 @@
+
+#include <unistd.h>
+#include <pthread.h>
+#include <stdexcept>
+#include <vector>
+#include "gtest/gtest.h"
+
+#define protected public
+#include "trick/JobWorkerPool.hh"
+#include "trick/ScheduledJobQueue.hh"
+#include "trick/SimObject.hh"
+#include "trick/ExecutiveException.hh"
+
+namespace Trick {
+
+/* Number of jobs of the first level that have completed, across all sim objects */
+static unsigned int first_level_done ;
+
+class poolSimObject : public Trick::SimObject {
+    public:
+
+        /* Ids of the jobs called, in the order they were called.  Only one thread runs a sim object's jobs. */
+        std::vector< int > called ;
+        /* Value each job updates from the last, so a change in order changes the result */
+        long long value ;
+        /* The thread the last system job ran on */
+        pthread_t system_thread ;
+        /* first_level_done seen by the last second level job */
+        unsigned int first_level_seen ;
+        /* first_level_done seen by the last system job */
+        unsigned int system_seen ;
+
+        poolSimObject() : value(1) , first_level_seen(0) , system_seen(0) {}
+
+        virtual int call_function( Trick::JobData * curr_job ) {
+            called.push_back(curr_job->id) ;
+            switch ( curr_job->id ) {
+                case 100:
+                    /* second level job */
+                    first_level_seen = __atomic_load_n(&first_level_done, __ATOMIC_ACQUIRE) ;
+                    break ;
+                case 200:
+                    /* system job */
+                    system_thread = pthread_self() ;
+                    system_seen = __atomic_load_n(&first_level_done, __ATOMIC_ACQUIRE) ;
+                    break ;
+                case 300:
+                    return -1 ;
+                case 400:
+                    throw std::runtime_error("job threw") ;
+                default:
+                    /* first level job: stretch it so the other chains run at the same time */
+                    usleep(200) ;
+                    value = value * 31 + curr_job->id * ( id + 1 ) ;
+                    __atomic_fetch_add(&first_level_done, 1, __ATOMIC_RELEASE) ;
+                    break ;
+            }
+            return 0 ;
+        }
+        virtual double call_function_double( Trick::JobData * ) { return 0.0 ; } ;
+} ;
+
+class JobWorkerPoolTest : public ::testing::Test {
+
+    protected:
+        static const unsigned int num_objects = 8 ;
+        static const int jobs_per_object = 5 ;
+
+        Trick::JobWorkerPool pool ;
+        Trick::ScheduledJobQueue queue ;
+        poolSimObject so[num_objects] ;
+        std::vector< Trick::JobData * > jobs ;
+
+        JobWorkerPoolTest() {}
+        ~JobWorkerPoolTest() {
+            for ( unsigned int ii = 0 ; ii < jobs.size() ; ii++ ) {
+                delete jobs[ii] ;
+            }
+        }
+        virtual void SetUp() {
+            first_level_done = 0 ;
+            for ( unsigned int ii = 0 ; ii < num_objects ; ii++ ) {
+                so[ii].id = ii ;
+            }
+        }
+        virtual void TearDown() {}
+
+        Trick::JobData * add_job( unsigned int so_index , int job_id , int job_class , unsigned short phase ,
+                                  bool system_job = false ) {
+            Trick::JobData * job = new Trick::JobData(0, job_id, "scheduled", NULL, 1.0, "job") ;
+            job->parent_object = &so[so_index] ;
+            job->sim_object_id = so_index ;
+            job->job_class = job_class ;
+            job->phase = phase ;
+            job->system_job_class = system_job ;
+            job->cycle_tics = 1 ;
+            job->next_tics = 0 ;
+            job->stop_tics = 1000 ;
+            jobs.push_back(job) ;
+            queue.push(job) ;
+            return job ;
+        }
+
+        /* A first level of every sim object's jobs, then a second level of one job per sim object */
+        void add_two_levels() {
+            for ( unsigned int ii = 0 ; ii < num_objects ; ii++ ) {
+                for ( int jj = 1 ; jj <= jobs_per_object ; jj++ ) {
+                    add_job(ii, jj, 10, 1) ;
+                }
+                add_job(ii, 100, 10, 2) ;
+            }
+        }
+
+        void start_workers( unsigned int num_workers ) {
+            pool.set_num_workers(num_workers) ;
+            pool.create_workers("pool_test", false) ;
+        }
+
+        void run_frame( long long time_tics ) {
+            for ( unsigned int ii = 0 ; ii < jobs.size() ; ii++ ) {
+                jobs[ii]->complete = false ;
+            }
+            pool.call_jobs(queue, time_tics) ;
+        }
+} ;
+
+TEST_F(JobWorkerPoolTest , JobsOfASimObjectRunInOrder) {
+    add_two_levels() ;
+    start_workers(3) ;
+    run_frame(0) ;
+    for ( unsigned int ii = 0 ; ii < num_objects ; ii++ ) {
+        ASSERT_EQ(so[ii].called.size(), (unsigned int)jobs_per_object + 1) ;
+        for ( int jj = 0 ; jj < jobs_per_object ; jj++ ) {
+            EXPECT_EQ(so[ii].called[jj], jj + 1) ;
+        }
+        EXPECT_EQ(so[ii].called[jobs_per_object], 100) ;
+    }
+}
+
+TEST_F(JobWorkerPoolTest , LevelCompletesBeforeTheNextStarts) {
+    add_two_levels() ;
+    start_workers(3) ;
+    run_frame(0) ;
+    for ( unsigned int ii = 0 ; ii < num_objects ; ii++ ) {
+        EXPECT_EQ(so[ii].first_level_seen, num_objects * jobs_per_object) ;
+    }
+}
+
+TEST_F(JobWorkerPoolTest , SystemJobsRunOnTheOwningThread) {
+    add_two_levels() ;
+    /* A system job queued after the first level and before the second */
+    add_job(num_objects - 1, 200, 10, 1, true) ;
+    start_workers(3) ;
+    run_frame(0) ;
+    EXPECT_TRUE(pthread_equal(so[num_objects - 1].system_thread, pthread_self())) ;
+    EXPECT_EQ(so[num_objects - 1].system_seen, num_objects * jobs_per_object) ;
+    EXPECT_EQ(so[num_objects - 1].first_level_seen, num_objects * jobs_per_object) ;
+}
+
+TEST_F(JobWorkerPoolTest , ResultsMatchSerialExecution) {
+    add_two_levels() ;
+    for ( long long tics = 0 ; tics < 5 ; tics++ ) {
+        run_frame(tics) ;
+    }
+    long long serial[num_objects] ;
+    for ( unsigned int ii = 0 ; ii < num_objects ; ii++ ) {
+        serial[ii] = so[ii].value ;
+        so[ii].value = 1 ;
+        so[ii].called.clear() ;
+    }
+    for ( unsigned int ii = 0 ; ii < jobs.size() ; ii++ ) {
+        jobs[ii]->next_tics = 0 ;
+    }
+
+    start_workers(3) ;
+    for ( long long tics = 0 ; tics < 5 ; tics++ ) {
+        run_frame(tics) ;
+    }
+    for ( unsigned int ii = 0 ; ii < num_objects ; ii++ ) {
+        EXPECT_EQ(so[ii].value, serial[ii]) ;
+        EXPECT_EQ(so[ii].called.size(), 5u * ( jobs_per_object + 1 )) ;
+    }
+}
+
+TEST_F(JobWorkerPoolTest , ErrorReturnIsRethrown) {
+    add_two_levels() ;
+    add_job(5, 300, 10, 1) ;
+    start_workers(3) ;
+    EXPECT_THROW(run_frame(0), Trick::ExecutiveException) ;
+    /* The level after the failed one does not run */
+    EXPECT_EQ(so[0].called.size(), (unsigned int)jobs_per_object) ;
+}
+
+TEST_F(JobWorkerPoolTest , ExceptionIsRethrown) {
+    add_two_levels() ;
+    add_job(6, 400, 10, 1) ;
+    start_workers(3) ;
+    try {
+        run_frame(0) ;
+        ADD_FAILURE() << "the job exception was not rethrown" ;
+    } catch ( Trick::ExecutiveException & ex ) {
+        EXPECT_EQ(ex.ret_code, -1) ;
+        EXPECT_EQ(ex.message, "job threw") ;
+    }
+}
+
+TEST_F(JobWorkerPoolTest , DependencyBetweenChains) {
+    /* With one worker, chains 0 and 2 are dealt to the owning thread and 1 and 3 to the worker,
+       and each takes its last chain first.  Chains 2 and 3 wait on chains 0 and 1. */
+    Trick::JobData * a = add_job(0, 1, 10, 1) ;
+    Trick::JobData * b = add_job(1, 1, 10, 1) ;
+    add_job(2, 1, 10, 1)->add_depend(a) ;
+    add_job(3, 1, 10, 1)->add_depend(b) ;
+    start_workers(1) ;
+    /* A deadlock fails the test by ending the process */
+    alarm(30) ;
+    run_frame(0) ;
+    alarm(0) ;
+    for ( unsigned int ii = 0 ; ii < 4 ; ii++ ) {
+        EXPECT_EQ(so[ii].called.size(), 1u) ;
+    }
+    EXPECT_TRUE(a->complete) ;
+    EXPECT_TRUE(b->complete) ;
+}
+
+}
@@ -0,0 +1,529 @@
+/*
+   PURPOSE: ( Native evaluation of simple event conditions )
+   REFERENCE: ( Trick Simulation Environment )
+   ASSUMPTIONS AND LIMITATIONS: ( None )
+   CLASS: ( N/A )
+   LIBRARY DEPENDENCY: ( None )
+*/
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trick/EventCondition.hh"
+#include "trick/attributes.h"
+#include "trick/parameter_types.h"
+#include "trick/memorymanager_c_intf.h"
+
+namespace Trick {
+
+/*
+   Recursive descent compiler for the condition subset, following Python's precedence:
+   or, and, not, comparisons, + -, * /, unary - +.  Each rule appends its postfix code to the
+   condition's program and describes the value it leaves, so operations Python might evaluate
+   differently can be refused.
+ */
+class EventConditionParser {
+
+    public:
+        EventConditionParser( const std::string & str , EventCondition * in_cond ) :
+         cp(str.c_str()) , cond(in_cond) {}
+
+        bool parse() {
+            Operand result ;
+            if ( ! or_expr(result) ) {
+                return false ;
+            }
+            skip_space() ;
+            return *cp == '\0' ;
+        }
+
+    private:
+        /* What is known about a value before the program runs. */
+        struct Operand {
+            Operand() : integer(false) {}
+            bool integer ;
+            /* Units of a model variable, empty if it has none, "?" if they cannot be tracked. */
+            std::string units ;
+        } ;
+
+        const char * cp ;
+        EventCondition * cond ;
+
+        void skip_space() {
+            while ( *cp == ' ' or *cp == '\t' or *cp == '\n' or *cp == '\r' ) {
+                cp++ ;
+            }
+        }
+
+        static bool is_name_char( char c ) {
+            return isalnum((unsigned char)c) or c == '_' ;
+        }
+
+        /* Consume a keyword if it is next and not the start of a longer name. */
+        bool keyword( const char * word ) {
+            size_t len = strlen(word) ;
+            skip_space() ;
+            if ( ! strncmp(cp, word, len) and ! is_name_char(cp[len]) ) {
+                cp += len ;
+                return true ;
+            }
+            return false ;
+        }
+
+        /* Consume an operator if it is next. */
+        bool symbol( const char * sym ) {
+            size_t len = strlen(sym) ;
+            skip_space() ;
+            if ( ! strncmp(cp, sym, len) ) {
+                cp += len ;
+                return true ;
+            }
+            return false ;
+        }
+
+        void emit( EventCondition::OpCode op , double constant = 0.0 , unsigned int variable = 0 ) {
+            EventCondition::Instruction inst ;
+            inst.op = op ;
+            inst.constant = constant ;
+            inst.variable = variable ;
+            inst.target = 0 ;
+            cond->program.push_back(inst) ;
+        }
+
+        /* Emit a jump over the code that follows, returns its index for patch_jump. */
+        unsigned int emit_jump( EventCondition::OpCode op ) {
+            emit(op) ;
+            return cond->program.size() - 1 ;
+        }
+
+        /* Point a jump at the end of the program so far. */
+        void patch_jump( unsigned int jump ) {
+            cond->program[jump].target = cond->program.size() ;
+        }
+
+        /* Units an operation between two values leaves, false if Python could convert between them. */
+        static bool combine_units( const Operand & left , const Operand & right , std::string & units ) {
+            if ( left.units.empty() ) {
+                units = right.units ;
+            } else if ( right.units.empty() ) {
+                units = left.units ;
+            } else if ( left.units == right.units and left.units != "?" ) {
+                units = left.units ;
+            } else {
+                return false ;
+            }
+            return true ;
+        }
+
+        bool or_expr( Operand & result ) {
+            Operand right ;
+            if ( ! and_expr(result) ) {
+                return false ;
+            }
+            while ( keyword("or") ) {
+                /* A true left operand is the result, the right one is not evaluated. */
+                unsigned int jump = emit_jump(EventCondition::JUMP_IF_TRUE_OR_POP) ;
+                if ( ! and_expr(right) ) {
+                    return false ;
+                }
+                patch_jump(jump) ;
+                result.integer = result.integer and right.integer ;
+                result.units = ( result.units == right.units ) ? result.units : "?" ;
+            }
+            return true ;
+        }
+
+        bool and_expr( Operand & result ) {
+            Operand right ;
+            if ( ! not_expr(result) ) {
+                return false ;
+            }
+            while ( keyword("and") ) {
+                /* A false left operand is the result, the right one is not evaluated. */
+                unsigned int jump = emit_jump(EventCondition::JUMP_IF_FALSE_OR_POP) ;
+                if ( ! not_expr(right) ) {
+                    return false ;
+                }
+                patch_jump(jump) ;
+                result.integer = result.integer and right.integer ;
+                result.units = ( result.units == right.units ) ? result.units : "?" ;
+            }
+            return true ;
+        }
+
+        bool not_expr( Operand & result ) {
+            if ( keyword("not") ) {
+                if ( ! not_expr(result) ) {
+                    return false ;
+                }
+                emit(EventCondition::NOT) ;
+                result.integer = true ;
+                result.units.clear() ;
+                return true ;
+            }
+            return comparison(result) ;
+        }
+
+        bool comparison_op( EventCondition::OpCode & op ) {
+            if ( symbol("<=") ) op = EventCondition::LESS_EQUAL ;
+            else if ( symbol(">=") ) op = EventCondition::GREATER_EQUAL ;
+            else if ( symbol("==") ) op = EventCondition::EQUAL ;
+            else if ( symbol("!=") ) op = EventCondition::NOT_EQUAL ;
+            else if ( symbol("<") ) op = EventCondition::LESS ;
+            else if ( symbol(">") ) op = EventCondition::GREATER ;
+            else return false ;
+            return true ;
+        }
+
+        bool comparison( Operand & result ) {
+            Operand right ;
+            EventCondition::OpCode op ;
+            std::string units ;
+            if ( ! sum(result) ) {
+                return false ;
+            }
+            if ( comparison_op(op) ) {
+                if ( ! sum(right) or ! combine_units(result, right, units) ) {
+                    return false ;
+                }
+                /* a < b < c means a < b and b < c in Python. */
+                if ( comparison_op(op) ) {
+                    return false ;
+                }
+                emit(op) ;
+                result.integer = true ;
+                result.units.clear() ;
+            }
+            return true ;
+        }
+
+        bool sum( Operand & result ) {
+            Operand right ;
+            EventCondition::OpCode op ;
+            if ( ! term(result) ) {
+                return false ;
+            }
+            while ( true ) {
+                if ( symbol("+") ) {
+                    op = EventCondition::ADD ;
+                } else if ( symbol("-") ) {
+                    op = EventCondition::SUBTRACT ;
+                } else {
+                    return true ;
+                }
+                if ( ! term(right) or ! combine_units(result, right, result.units) ) {
+                    return false ;
+                }
+                emit(op) ;
+                result.integer = result.integer and right.integer ;
+            }
+        }
+
+        bool term( Operand & result ) {
+            Operand right ;
+            EventCondition::OpCode op ;
+            if ( ! unary(result) ) {
+                return false ;
+            }
+            while ( true ) {
+                skip_space() ;
+                /* Floor division, modulo and powers are left to Python. */
+                if ( ! strncmp(cp, "//", 2) or ! strncmp(cp, "**", 2) or *cp == '%' ) {
+                    return false ;
+                }
+                if ( symbol("*") ) {
+                    op = EventCondition::MULTIPLY ;
+                } else if ( symbol("/") ) {
+                    op = EventCondition::DIVIDE ;
+                } else {
+                    return true ;
+                }
+                if ( ! unary(right) ) {
+                    return false ;
+                }
+                /* Python 2 and 3 disagree on integer division. */
+                if ( op == EventCondition::DIVIDE and result.integer and right.integer ) {
+                    return false ;
+                }
+                emit(op) ;
+                result.integer = result.integer and right.integer ;
+                if ( result.units.empty() ) {
+                    result.units = right.units ;
+                } else if ( ! right.units.empty() ) {
+                    result.units = "?" ;
+                }
+            }
+        }
+
+        bool unary( Operand & result ) {
+            if ( symbol("-") ) {
+                if ( ! unary(result) ) {
+                    return false ;
+                }
+                emit(EventCondition::NEGATE) ;
+                return true ;
+            }
+            if ( symbol("+") ) {
+                return unary(result) ;
+            }
+            return primary(result) ;
+        }
+
+        bool primary( Operand & result ) {
+            skip_space() ;
+            result = Operand() ;
+            if ( symbol("(") ) {
+                if ( ! or_expr(result) ) {
+                    return false ;
+                }
+                return symbol(")") ;
+            }
+            if ( isdigit((unsigned char)*cp) or ( *cp == '.' and isdigit((unsigned char)cp[1]) ) ) {
+                return number(result) ;
+            }
+            if ( keyword("True") ) {
+                emit(EventCondition::PUSH_CONSTANT, 1.0) ;
+                result.integer = true ;
+                return true ;
+            }
+            if ( keyword("False") ) {
+                emit(EventCondition::PUSH_CONSTANT, 0.0) ;
+                result.integer = true ;
+                return true ;
+            }
+            if ( isalpha((unsigned char)*cp) or *cp == '_' ) {
+                return variable(result) ;
+            }
+            return false ;
+        }
+
+        bool number( Operand & result ) {
+            const char * start = cp ;
+            char * end ;
+            double value = strtod(start, &end) ;
+            if ( end == start or is_name_char(*end) or *end == '.' ) {
+                return false ;
+            }
+            /* Hexadecimal, octal and the like are left to Python. */
+            if ( start[0] == '0' and isalpha((unsigned char)start[1]) ) {
+                return false ;
+            }
+            result.integer = ( strpbrk(std::string(start, end - start).c_str(), ".eE") == NULL ) ;
+            cp = end ;
+            emit(EventCondition::PUSH_CONSTANT, value) ;
+            return true ;
+        }
+
+        static bool supported_type( ATTRIBUTES * attr ) {
+            switch ( attr->type ) {
+                case TRICK_UNSIGNED_CHARACTER:
+                case TRICK_SHORT:
+                case TRICK_UNSIGNED_SHORT:
+                case TRICK_INTEGER:
+                case TRICK_UNSIGNED_INTEGER:
+                case TRICK_LONG:
+                case TRICK_UNSIGNED_LONG:
+                case TRICK_LONG_LONG:
+                case TRICK_UNSIGNED_LONG_LONG:
+                case TRICK_BOOLEAN:
+                    return true ;
+                case TRICK_ENUMERATED:
+                    return attr->size == 1 or attr->size == 2 or attr->size == 4 ;
+                case TRICK_FLOAT:
+                case TRICK_DOUBLE:
+                    return true ;
+                default:
+                    return false ;
+            }
+        }
+
+        static bool is_integer_type( ATTRIBUTES * attr ) {
+            return attr->type != TRICK_FLOAT and attr->type != TRICK_DOUBLE ;
+        }
+
+        /* A model variable: names joined by "." with constant indexes, resolved now. */
+        bool variable( Operand & result ) {
+            const char * start = cp ;
+            std::string top_name ;
+            while ( is_name_char(*cp) ) {
+                cp++ ;
+            }
+            top_name.assign(start, cp - start) ;
+            while ( true ) {
+                if ( *cp == '.' and ( isalpha((unsigned char)cp[1]) or cp[1] == '_' ) ) {
+                    cp++ ;
+                    while ( is_name_char(*cp) ) {
+                        cp++ ;
+                    }
+                } else if ( *cp == '[' ) {
+                    cp++ ;
+                    if ( ! isdigit((unsigned char)*cp) ) {
+                        return false ;
+                    }
+                    while ( isdigit((unsigned char)*cp) ) {
+                        cp++ ;
+                    }
+                    if ( *cp++ != ']' ) {
+                        return false ;
+                    }
+                } else {
+                    break ;
+                }
+            }
+            std::string name(start, cp - start) ;
+            /* Function calls and python keywords and names are left to Python. */
+            skip_space() ;
+            if ( *cp == '(' or ! TMM_var_exists(top_name.c_str()) ) {
+                return false ;
+            }
+            REF2 * ref = ref_attributes((char *)name.c_str()) ;
+            if ( ref == NULL ) {
+                return false ;
+            }
+            if ( ref->attr == NULL or ref->num_index_left != 0 or ! supported_type(ref->attr) ) {
+                ref_free(ref) ;
+                free(ref) ;
+                return false ;
+            }
+            result.integer = is_integer_type(ref->attr) ;
+            if ( ref->attr->units != NULL and ! ( ref->attr->mods & TRICK_MODS_UNITSDASHDASH ) and
+                 strcmp(ref->attr->units, "1") and strcmp(ref->attr->units, "--") ) {
+                result.units = ref->attr->units ;
+            }
+            emit(EventCondition::PUSH_VARIABLE, 0.0, cond->variables.size()) ;
+            cond->variables.push_back(ref) ;
+            return true ;
+        }
+} ;
+
+}
+
+Trick::EventCondition * Trick::EventCondition::compile( const std::string & str ) {
+
+    EventCondition * cond = new EventCondition ;
+    EventConditionParser parser(str, cond) ;
+
+    if ( ! parser.parse() ) {
+        delete cond ;
+        return NULL ;
+    }
+    cond->stack.reserve(cond->program.size()) ;
+    return cond ;
+}
+
+Trick::EventCondition::~EventCondition() {
+    for ( unsigned int ii = 0 ; ii < variables.size() ; ii++ ) {
+        ref_free(variables[ii]) ;
+        free(variables[ii]) ;
+    }
+}
+
+/* Read a variable as a double, following its pointers again if it has any. */
+static bool read_variable( REF2 * ref , double & value ) {
+
+    if ( ref->pointer_present ) {
+        ref->address = follow_address_path(ref) ;
+    }
+    if ( ref->address == NULL ) {
+        return false ;
+    }
+    switch ( ref->attr->type ) {
+        case TRICK_UNSIGNED_CHARACTER: value = *(unsigned char *)ref->address ; break ;
+        case TRICK_SHORT: value = *(short *)ref->address ; break ;
+        case TRICK_UNSIGNED_SHORT: value = *(unsigned short *)ref->address ; break ;
+        case TRICK_INTEGER: value = *(int *)ref->address ; break ;
+        case TRICK_UNSIGNED_INTEGER: value = *(unsigned int *)ref->address ; break ;
+        case TRICK_LONG: value = *(long *)ref->address ; break ;
+        case TRICK_UNSIGNED_LONG: value = *(unsigned long *)ref->address ; break ;
+        case TRICK_LONG_LONG: value = *(long long *)ref->address ; break ;
+        case TRICK_UNSIGNED_LONG_LONG: value = *(unsigned long long *)ref->address ; break ;
+        case TRICK_BOOLEAN: value = *(bool *)ref->address ; break ;
+        case TRICK_FLOAT: value = *(float *)ref->address ; break ;
+        case TRICK_DOUBLE: value = *(double *)ref->address ; break ;
+        case TRICK_ENUMERATED:
+            switch ( ref->attr->size ) {
+                case 1: value = *(signed char *)ref->address ; break ;
+                case 2: value = *(short *)ref->address ; break ;
+                default: value = *(int *)ref->address ; break ;
+            }
+            break ;
+        default:
+            return false ;
+    }
+    return true ;
+}
+
+/**
+@details
+-# Run the program over a stack of doubles.  "and" and "or" leave one of their operands, as in Python.
+   Their left operand is tested by a jump that skips the right operand when the left one is the result,
+   so a right operand Python would not evaluate is not evaluated here either.
+-# A variable that cannot be read or a division by zero, where Python would raise, makes the condition false.
+-# The condition is the truth of the value left on the stack.
+*/
+bool Trick::EventCondition::evaluate() {
+
+    double value ;
+    double right ;
+
+    stack.clear() ;
+    for ( unsigned int ii = 0 ; ii < program.size() ; ii++ ) {
+        const Instruction & inst = program[ii] ;
+        switch ( inst.op ) {
+            case PUSH_CONSTANT:
+                stack.push_back(inst.constant) ;
+                continue ;
+            case PUSH_VARIABLE:
+                if ( ! read_variable(variables[inst.variable], value) ) {
+                    return false ;
+                }
+                stack.push_back(value) ;
+                continue ;
+            case NEGATE:
+                stack.back() = -stack.back() ;
+                continue ;
+            case NOT:
+                stack.back() = ( stack.back() == 0.0 ) ;
+                continue ;
+            case JUMP_IF_FALSE_OR_POP:
+                if ( stack.back() == 0.0 ) {
+                    ii = inst.target - 1 ;
+                } else {
+                    stack.pop_back() ;
+                }
+                continue ;
+            case JUMP_IF_TRUE_OR_POP:
+                if ( stack.back() != 0.0 ) {
+                    ii = inst.target - 1 ;
+                } else {
+                    stack.pop_back() ;
+                }
+                continue ;
+            default:
+                break ;
+        }
+        right = stack.back() ;
+        stack.pop_back() ;
+        double & left = stack.back() ;
+        switch ( inst.op ) {
+            case ADD: left += right ; break ;
+            case SUBTRACT: left -= right ; break ;
+            case MULTIPLY: left *= right ; break ;
+            case DIVIDE:
+                if ( right == 0.0 ) {
+                    return false ;
+                }
+                left /= right ;
+                break ;
+            case LESS: left = ( left < right ) ; break ;
+            case LESS_EQUAL: left = ( left <= right ) ; break ;
+            case GREATER: left = ( left > right ) ; break ;
+            case GREATER_EQUAL: left = ( left >= right ) ; break ;
+            case EQUAL: left = ( left == right ) ; break ;
+            case NOT_EQUAL: left = ( left != right ) ; break ;
+            default: break ;
+        }
+    }
+    return ( ! stack.empty() and stack.back() != 0.0 ) ;
+}
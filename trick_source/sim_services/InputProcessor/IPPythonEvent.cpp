@@ -13,6 +13,7 @@
 #include <string.h>
 
 #include "trick/IPPythonEvent.hh"
+#include "trick/EventCondition.hh"
 #include "trick/IPPython.hh"
 #include "trick/MemoryManager.hh"
 #include "trick/exec_proto.h"
@@ -29,6 +30,7 @@ extern Trick::MemoryManager * trick_MM ;
 Trick::IPPython * Trick::IPPythonEvent::ip ;
 Trick::MTV * Trick::IPPythonEvent::mtv ;
 bool Trick::IPPythonEvent::info_msg = false ;
+bool Trick::IPPythonEvent::native_conditions = true ;
 
 Trick::condition_t::condition_t() {
     enabled = 0 ;
@@ -38,6 +40,12 @@ Trick::condition_t::condition_t() {
     fired_time = -1.0 ;
     ref = NULL ;
     job = NULL ;
+    compiled = NULL ;
+    compile_tried = false ;
+}
+
+Trick::condition_t::~condition_t() {
+    delete compiled ;
 }
 
 Trick::action_t::action_t() {
@@ -153,10 +161,24 @@ void Trick::IPPythonEvent::set_event_info_msg_off() {
     info_msg = false;
 }
 
+// Command to turn on native evaluation of simple conditions
+void Trick::IPPythonEvent::set_event_native_conditions_on() {
+    native_conditions = true;
+}
+
+// Command to turn off native evaluation of simple conditions
+void Trick::IPPythonEvent::set_event_native_conditions_off() {
+    native_conditions = false;
+}
+
 void Trick::IPPythonEvent::restart() {
     int jj ;
 
     for (jj=0; jj<condition_count; jj++) {
+        // variables may have moved, compile python conditions again when next evaluated
+        delete condition_list[jj]->compiled ;
+        condition_list[jj]->compiled = NULL ;
+        condition_list[jj]->compile_tried = false ;
         if (condition_list[jj]->cond_type==1) { // condition variable
             condition_list[jj]->ref = ref_attributes((char*)condition_list[jj]->str.c_str());
         }
@@ -231,6 +253,9 @@ int Trick::IPPythonEvent::condition(int num, std::string str, std::string commen
         /** @li Initialize condition variables - default as enabled. */
         condition_list[num]->ref = ref ;
         condition_list[num]->job = job ;
+        delete condition_list[num]->compiled ;
+        condition_list[num]->compiled = NULL ;
+        condition_list[num]->compile_tried = false ;
         condition_list[num]->enabled = true;
         condition_list[num]->hold = false;
         condition_list[num]->fired = false;
@@ -554,9 +579,17 @@ bool Trick::IPPythonEvent::process_user_event( long long curr_time ) {
                     return_val = condition_list[ii]->job->call();
                     condition_list[ii]->job->disabled = save_disabled_state;
                 } else {
-                // otherwise use python to evaluate string
-                    std::string full_in_string ;
-                    ip->parse_condition(condition_list[ii]->str, return_val) ;
+                // otherwise compile the string the first time through, and evaluate it natively if it compiled
+                    if ( native_conditions && ! condition_list[ii]->compile_tried ) {
+                        condition_list[ii]->compiled = Trick::EventCondition::compile(condition_list[ii]->str) ;
+                        condition_list[ii]->compile_tried = true ;
+                    }
+                    if ( native_conditions && condition_list[ii]->compiled != NULL ) {
+                        return_val = condition_list[ii]->compiled->evaluate() ;
+                    } else {
+                // or use python to evaluate string
+                        ip->parse_condition(condition_list[ii]->str, return_val) ;
+                    }
                 }
                 if (return_val) {
                 //TODO: write to log/send_hs that trigger fired
@@ -0,0 +1,134 @@
+
+#include <string>
+
+#include "gtest/gtest.h"
+#define private public
+#include "trick/EventCondition.hh"
+#include "trick/MemoryManager.hh"
+
+namespace Trick {
+
+class EventConditionTest : public ::testing::Test {
+
+    protected:
+        Trick::MemoryManager * memmgr ;
+        double * x ;
+        int * i ;
+
+        EventConditionTest() {}
+        ~EventConditionTest() {}
+
+        virtual void SetUp() {
+            memmgr = new Trick::MemoryManager ;
+            x = (double *)memmgr->declare_var(TRICK_DOUBLE, "", 0, "x", 0, NULL) ;
+            i = (int *)memmgr->declare_var(TRICK_INTEGER, "", 0, "i", 0, NULL) ;
+            *x = 0.0 ;
+            *i = 0 ;
+        }
+
+        virtual void TearDown() {
+            delete memmgr ;
+        }
+
+        /* Compile and evaluate a condition, failing the test if it does not compile */
+        bool run( const char * str ) {
+            EventCondition * cond = EventCondition::compile(str) ;
+            if ( cond == NULL ) {
+                ADD_FAILURE() << "\"" << str << "\" did not compile" ;
+                return false ;
+            }
+            bool result = cond->evaluate() ;
+            delete cond ;
+            return result ;
+        }
+
+        bool compiles( const char * str ) {
+            EventCondition * cond = EventCondition::compile(str) ;
+            delete cond ;
+            return cond != NULL ;
+        }
+} ;
+
+TEST_F( EventConditionTest , RefusesWhatPythonMightEvaluateDifferently ) {
+
+    EXPECT_TRUE( compiles("x > 1.0") ) ;
+    // chained comparisons, integer division, floor division, powers and modulo
+    EXPECT_FALSE( compiles("1 < x < 2") ) ;
+    EXPECT_FALSE( compiles("i / 2 > 0") ) ;
+    EXPECT_FALSE( compiles("x // 2 > 0") ) ;
+    EXPECT_FALSE( compiles("x ** 2 > 0") ) ;
+    EXPECT_FALSE( compiles("x % 2 > 0") ) ;
+    // calls, hexadecimal numbers, names that are not model variables, and syntax errors
+    EXPECT_FALSE( compiles("abs(x) > 1") ) ;
+    EXPECT_FALSE( compiles("x > 0x10") ) ;
+    EXPECT_FALSE( compiles("y > 1") ) ;
+    EXPECT_FALSE( compiles("x >") ) ;
+    EXPECT_FALSE( compiles("x > 1 and") ) ;
+}
+
+TEST_F( EventConditionTest , AndOrSkipTheirRightOperand ) {
+
+    EventCondition * cond = EventCondition::compile("x == 0 or 1 / x > 0.5") ;
+    ASSERT_TRUE( cond != NULL ) ;
+    // The division by zero Python does not reach is not reached here either
+    EXPECT_TRUE( cond->evaluate() ) ;
+    *x = 4.0 ;
+    EXPECT_FALSE( cond->evaluate() ) ;
+    *x = 1.0 ;
+    EXPECT_TRUE( cond->evaluate() ) ;
+    delete cond ;
+
+    cond = EventCondition::compile("x != 0 and 1 / x > 0.5") ;
+    ASSERT_TRUE( cond != NULL ) ;
+    *x = 0.0 ;
+    EXPECT_FALSE( cond->evaluate() ) ;
+    *x = 1.0 ;
+    EXPECT_TRUE( cond->evaluate() ) ;
+    delete cond ;
+
+    // The value of "and" and "or" is the operand that decided it
+    EXPECT_FALSE( run("not ( x == 0 or 1 / x > 0.5 )") ) ;
+    EXPECT_TRUE( run("( x and 0 ) == 0") ) ;
+    EXPECT_TRUE( run("( 0 or 2 ) == 2") ) ;
+    EXPECT_TRUE( run("( 3 and 2 ) == 2") ) ;
+    EXPECT_TRUE( run("( 3 or 1 / ( x - x ) ) == 3") ) ;
+}
+
+TEST_F( EventConditionTest , AgreesWithPython ) {
+
+    // Each condition with the truth Python gives it for x = 2.5, i = 3
+    static const struct {
+        const char * str ;
+        bool python ;
+    } cases[] = {
+        { "x > 2" , true } ,
+        { "-x + 5 == 2.5" , true } ,
+        { "i * 2 >= 7" , false } ,
+        { "i / 2.0 == 1.5" , true } ,
+        { "x / 0.5 == 5" , true } ,
+        { "not x" , false } ,
+        { "not i - 3" , true } ,
+        { "x" , true } ,
+        { "i - 3" , false } ,
+        { "i == 3 and x < 2" , false } ,
+        { "i == 3 and x < 3" , true } ,
+        { "i != 3 or x > 2" , true } ,
+        { "i != 3 or x > 3" , false } ,
+        { "i > 1 and x > 1 or x > 100" , true } ,
+        { "i > 5 or x > 5 and i > 0" , false } ,
+        { "not i > 5 and not x > 5" , true } ,
+        { "( i - 3 or x ) == 2.5" , true } ,
+        { "( i and x - 2.5 ) == 0" , true } ,
+        { "i - 3 or i - 3 or x - 2.5" , false } ,
+        { "True and x > 2" , true } ,
+        { "False or i < 3" , false } ,
+    } ;
+
+    *x = 2.5 ;
+    *i = 3 ;
+    for ( unsigned int ii = 0 ; ii < sizeof(cases) / sizeof(cases[0]) ; ii++ ) {
+        EXPECT_EQ( run(cases[ii].str) , cases[ii].python ) << cases[ii].str ;
+    }
+}
+
+}
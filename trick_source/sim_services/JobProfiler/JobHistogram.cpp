@@ -0,0 +1,67 @@
+
+#include <string.h>
+
+#include "trick/JobHistogram.hh"
+
+Trick::JobHistogram::JobHistogram() :
+ total_count(0) ,
+ total_sum(0) ,
+ max_value(0) {
+    memset(counts, 0, sizeof(counts)) ;
+}
+
+/**
+@details
+-# Buckets below 2 * sub_buckets each hold one value.
+-# Above that, bucket index / sub_buckets + sub_bucket_bits - 1 is the power of two the bucket lies in, and
+   index % sub_buckets which of the sub_buckets pieces of it.
+*/
+unsigned long long Trick::JobHistogram::bucket_highest_value( unsigned int index ) {
+    if ( index < 2 * sub_buckets ) {
+        return index ;
+    }
+    unsigned int shift = index / sub_buckets - 1 ;
+    unsigned long long lowest = (unsigned long long)( index % sub_buckets + sub_buckets ) << shift ;
+    return lowest + ( 1ULL << shift ) - 1 ;
+}
+
+/**
+@details
+-# Find how many values lie at or below each percentile, at least one.
+-# Walk the buckets from the lowest, passing each percentile when that many values have been passed.
+-# A percentile's value is the highest value of the bucket it was passed in, or the largest value
+   recorded if that is smaller or the bucket is the last, which has no highest value.
+-# The counts may be changing under us.  Percentiles not passed when the walk runs out of buckets are
+   given the largest value.
+*/
+void Trick::JobHistogram::values_at_percentiles( const double * percentiles , unsigned long long * values ,
+                                                 unsigned int num ) const {
+
+    unsigned long long total = count() ;
+    unsigned long long largest = max() ;
+    unsigned int next = 0 ;
+
+    if ( total != 0 ) {
+        unsigned long long seen = 0 ;
+        for ( unsigned int ii = 0 ; ii < num_buckets and next < num ; ii++ ) {
+            seen += __atomic_load_n(&counts[ii], __ATOMIC_RELAXED) ;
+            while ( next < num ) {
+                unsigned long long target = (unsigned long long)( percentiles[next] / 100.0 * total + 0.5 ) ;
+                if ( seen < target or seen == 0 ) {
+                    break ;
+                }
+                unsigned long long highest = ( ii < num_buckets - 1 ) ? bucket_highest_value(ii) : largest ;
+                values[next++] = highest < largest ? highest : largest ;
+            }
+        }
+    }
+    for ( ; next < num ; next++ ) {
+        values[next] = largest ;
+    }
+}
+
+unsigned long long Trick::JobHistogram::value_at_percentile( double percentile ) const {
+    unsigned long long value ;
+    values_at_percentiles(&percentile, &value, 1) ;
+    return value ;
+}
@@ -0,0 +1,482 @@
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#if __linux
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#endif
+
+#include "trick/JobProfiler.hh"
+#include "trick/exec_proto.hh"
+#include "trick/exec_proto.h"
+#include "trick/command_line_protos.h"
+#include "trick/memorymanager_c_intf.h"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+
+Trick::JobProfiler * the_jp = NULL ;
+
+/* Name given to the instruments so they can be removed from the jobs. */
+static const char * instrument_name = "trick_instruments.job_profiler" ;
+
+/*
+   The profiler clock.  Jobs are timed with the time stamp counter when it runs at a constant rate in
+   every power state.  Reading it takes a few nanoseconds.  Otherwise they are timed in nanoseconds
+   of the monotonic system clock.
+ */
+static bool use_tsc = false ;
+
+static bool tsc_is_invariant() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax , ebx , ecx , edx ;
+    if ( __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) ) {
+        return ( edx & (1 << 8) ) != 0 ;
+    }
+#endif
+    return false ;
+}
+
+static long long system_nanoseconds() {
+    struct timespec tp ;
+    clock_gettime(CLOCK_MONOTONIC, &tp) ;
+    return (long long)tp.tv_sec * 1000000000LL + tp.tv_nsec ;
+}
+
+static inline unsigned long long profiler_time() {
+#if defined(__x86_64__) || defined(__i386__)
+    if ( use_tsc ) {
+        return __rdtsc() ;
+    }
+#endif
+    return (unsigned long long)system_nanoseconds() ;
+}
+
+/*
+   Hardware counters.  Each thread opens its own group of counters with perf_event_open the first time
+   it runs a profiled job, and keeps them for the life of the thread.  Where the kernel lets user space
+   read the counters with rdpmc, reading one takes a few tens of nanoseconds.  Otherwise each read is a
+   read system call.
+ */
+static bool counters_wanted = false ;
+
+#if __linux
+struct ThreadCounters {
+    int fd[Trick::JobProfilerNumCounters] ;
+    struct perf_event_mmap_page * page[Trick::JobProfilerNumCounters] ;
+} ;
+
+static __thread ThreadCounters * thread_counters = NULL ;
+static __thread bool thread_counters_tried = false ;
+static bool counters_failure_reported = false ;
+
+static ThreadCounters * open_thread_counters() {
+
+    static const unsigned long long configs[Trick::JobProfilerNumCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES , PERF_COUNT_HW_INSTRUCTIONS , PERF_COUNT_HW_CACHE_MISSES } ;
+    long page_size = sysconf(_SC_PAGESIZE) ;
+    ThreadCounters * counters = new ThreadCounters ;
+    int ii ;
+
+    for ( ii = 0 ; ii < Trick::JobProfilerNumCounters ; ii++ ) {
+        counters->fd[ii] = -1 ;
+        counters->page[ii] = NULL ;
+    }
+    for ( ii = 0 ; ii < Trick::JobProfilerNumCounters ; ii++ ) {
+        struct perf_event_attr attr ;
+        memset(&attr, 0, sizeof(attr)) ;
+        attr.size = sizeof(attr) ;
+        attr.type = PERF_TYPE_HARDWARE ;
+        attr.config = configs[ii] ;
+        attr.exclude_kernel = 1 ;
+        attr.exclude_hv = 1 ;
+        // this thread, any cpu, all three counters scheduled together
+        counters->fd[ii] = syscall(__NR_perf_event_open, &attr, 0, -1, ii == 0 ? -1 : counters->fd[0], 0) ;
+        if ( counters->fd[ii] < 0 ) {
+            break ;
+        }
+        void * page = mmap(NULL, page_size, PROT_READ, MAP_SHARED, counters->fd[ii], 0) ;
+        if ( page != MAP_FAILED ) {
+            counters->page[ii] = (struct perf_event_mmap_page *)page ;
+        }
+    }
+
+    if ( ii < Trick::JobProfilerNumCounters ) {
+        if ( ! __atomic_exchange_n(&counters_failure_reported, true, __ATOMIC_RELAXED) ) {
+            message_publish(MSG_WARNING, "Job profiler could not open hardware counters (%s).  "
+             "Check /proc/sys/kernel/perf_event_paranoid.\n", strerror(errno)) ;
+        }
+        for ( ii = 0 ; ii < Trick::JobProfilerNumCounters ; ii++ ) {
+            if ( counters->page[ii] != NULL ) {
+                munmap(counters->page[ii], page_size) ;
+            }
+            if ( counters->fd[ii] >= 0 ) {
+                close(counters->fd[ii]) ;
+            }
+        }
+        delete counters ;
+        return NULL ;
+    }
+    return counters ;
+}
+
+static inline unsigned long long read_counter( ThreadCounters * counters , int ii ) {
+#if defined(__x86_64__) || defined(__i386__)
+    struct perf_event_mmap_page * page = counters->page[ii] ;
+    if ( page != NULL ) {
+        unsigned int seq , index ;
+        long long count ;
+        // the kernel bumps lock around changes to the page, try again if it changed while we read
+        do {
+            seq = __atomic_load_n(&page->lock, __ATOMIC_ACQUIRE) ;
+            index = page->index ;
+            count = page->offset ;
+            if ( page->cap_user_rdpmc and index != 0 and page->pmc_width != 0 ) {
+                unsigned int low , high ;
+                __asm__ volatile ( "rdpmc" : "=a" (low) , "=d" (high) : "c" (index - 1) ) ;
+                long long pmc = (long long)( ( (unsigned long long)high << 32 ) | low ) ;
+                pmc <<= 64 - page->pmc_width ;
+                pmc >>= 64 - page->pmc_width ;
+                count += pmc ;
+            } else {
+                index = 0 ;
+            }
+            __atomic_thread_fence(__ATOMIC_ACQUIRE) ;
+        } while ( __atomic_load_n(&page->lock, __ATOMIC_RELAXED) != seq ) ;
+        if ( index != 0 ) {
+            return (unsigned long long)count ;
+        }
+    }
+#endif
+    unsigned long long value ;
+    if ( read(counters->fd[ii], &value, sizeof(value)) != sizeof(value) ) {
+        value = 0 ;
+    }
+    return value ;
+}
+#endif
+
+/* Read this thread's hardware counters.  Returns false if the thread has none. */
+static inline bool read_counters( unsigned long long * counts ) {
+#if __linux
+    if ( ! counters_wanted ) {
+        return false ;
+    }
+    if ( thread_counters == NULL ) {
+        if ( thread_counters_tried ) {
+            return false ;
+        }
+        thread_counters_tried = true ;
+        if ( (thread_counters = open_thread_counters()) == NULL ) {
+            return false ;
+        }
+    }
+    for ( int ii = 0 ; ii < Trick::JobProfilerNumCounters ; ii++ ) {
+        counts[ii] = read_counter(thread_counters, ii) ;
+    }
+    return true ;
+#else
+    (void)counts ;
+    return false ;
+#endif
+}
+
+Trick::JobRecorder::JobRecorder() :
+ start_time(0) {
+    memset(start_counts, 0, sizeof(start_counts)) ;
+    memset(counter_sums, 0, sizeof(counter_sums)) ;
+}
+
+Trick::JobProfile::JobProfile() :
+ thread(0) ,
+ calls(0) ,
+ mean(0.0) ,
+ p50(0.0) ,
+ p99(0.0) ,
+ p999(0.0) ,
+ max(0.0) ,
+ cycles(0.0) ,
+ instructions(0.0) ,
+ cache_misses(0.0) ,
+ recorder(NULL) {}
+
+/**
+@details
+-# The start instrument runs after every other instrument before the job, the stop instrument
+   before every other instrument after it, so the timing holds as little besides the job as possible.
+*/
+Trick::JobProfilerInstrument::JobProfilerInstrument( Trick::JobRecorder * in_recorder ,
+ Trick::JobData * in_target_job , bool in_start ) :
+ Trick::InstrumentBase(in_target_job) ,
+ recorder(in_recorder) ,
+ start(in_start) {
+    name = instrument_name ;
+    phase = in_start ? 65535 : 0 ;
+}
+
+/**
+@details
+-# At the start of the job read the counters, then the clock.
+-# At the end of the job read the clock, then the counters, and record the differences.
+   The counter sums are read by other threads, so they are stored atomically.
+*/
+int Trick::JobProfilerInstrument::call() {
+    if ( start ) {
+        read_counters(recorder->start_counts) ;
+        recorder->start_time = profiler_time() ;
+    } else {
+        unsigned long long stop_time = profiler_time() ;
+        unsigned long long counts[Trick::JobProfilerNumCounters] ;
+        recorder->histogram.record(stop_time - recorder->start_time) ;
+        if ( read_counters(counts) ) {
+            for ( int ii = 0 ; ii < Trick::JobProfilerNumCounters ; ii++ ) {
+                __atomic_store_n(&recorder->counter_sums[ii],
+                 recorder->counter_sums[ii] + counts[ii] - recorder->start_counts[ii], __ATOMIC_RELAXED) ;
+            }
+        }
+    }
+    return 0 ;
+}
+
+Trick::JobProfiler::JobProfiler() :
+ enabled(false) ,
+ hardware_counters(false) ,
+ num_jobs(0) ,
+ jobs(NULL) ,
+ start_tics(0) ,
+ start_nanoseconds(0) {
+    the_jp = this ;
+}
+
+/**
+@details
+-# If we are enabled already, return
+-# Free the recorders and statistics of the last time profiling was on
+-# Allocate statistics for every job except instrumentation jobs, which run only within the jobs they
+   instrument.  The statistics are allocated by the memory manager so the variable server can read them.
+-# Choose the profiler clock and note when profiling started
+-# Give each job a recorder and insert the instruments around it
+-# Set the enabled flag to true
+*/
+int Trick::JobProfiler::profiler_on() {
+
+    std::vector< Trick::JobData * > all_jobs ;
+    std::vector< Trick::JobData * > profiled_jobs ;
+    unsigned int ii ;
+
+    if ( enabled == true ) {
+        return(0) ;
+    }
+
+    remove_instruments() ;
+    free_statistics() ;
+
+    exec_get_all_jobs_vector(all_jobs) ;
+    for ( ii = 0 ; ii < all_jobs.size() ; ii++ ) {
+        if ( all_jobs[ii]->job_class_name.compare("instrumentation") ) {
+            profiled_jobs.push_back(all_jobs[ii]) ;
+        }
+    }
+    num_jobs = profiled_jobs.size() ;
+    if ( num_jobs > 0 ) {
+        jobs = (Trick::JobProfile *)TMM_declare_var_1d("Trick::JobProfile", num_jobs) ;
+    }
+
+    use_tsc = tsc_is_invariant() ;
+    counters_wanted = hardware_counters ;
+    start_nanoseconds = system_nanoseconds() ;
+    start_tics = profiler_time() ;
+
+    for ( ii = 0 ; ii < num_jobs ; ii++ ) {
+        Trick::JobData * job = profiled_jobs[ii] ;
+        Trick::JobRecorder * recorder = new Trick::JobRecorder ;
+        Trick::JobProfilerInstrument * start_instrument = new Trick::JobProfilerInstrument(recorder, job, true) ;
+        Trick::JobProfilerInstrument * stop_instrument = new Trick::JobProfilerInstrument(recorder, job, false) ;
+
+        jobs[ii].name = job->name ;
+        jobs[ii].thread = job->thread ;
+        jobs[ii].recorder = recorder ;
+        recorders.push_back(recorder) ;
+
+        job->add_inst_before(start_instrument) ;
+        job->add_inst_after(stop_instrument) ;
+        instruments.push_back(start_instrument) ;
+        instruments.push_back(stop_instrument) ;
+    }
+
+    enabled = true ;
+    return(0) ;
+}
+
+/**
+@details
+-# If we are disabled already, return
+-# Refresh the statistics a last time
+-# Remove the instruments.  The recorders and statistics are kept until profiling is turned on again.
+-# Set the enabled flag to false
+*/
+int Trick::JobProfiler::profiler_off() {
+
+    if ( enabled == false ) {
+        return(0) ;
+    }
+    update_statistics() ;
+    remove_instruments() ;
+    enabled = false ;
+    return(0) ;
+}
+
+void Trick::JobProfiler::remove_instruments() {
+    // Removed by name from every job queue, so a target job is never looked up through an instrument.
+    if ( ! instruments.empty() ) {
+        exec_instrument_remove(instrument_name) ;
+    }
+    for ( unsigned int ii = 0 ; ii < instruments.size() ; ii++ ) {
+        delete instruments[ii] ;
+    }
+    instruments.clear() ;
+}
+
+void Trick::JobProfiler::free_statistics() {
+    for ( unsigned int ii = 0 ; ii < recorders.size() ; ii++ ) {
+        delete recorders[ii] ;
+    }
+    recorders.clear() ;
+    if ( jobs != NULL ) {
+        TMM_delete_var_a(jobs) ;
+        jobs = NULL ;
+    }
+    num_jobs = 0 ;
+}
+
+Trick::JobProfile * Trick::JobProfiler::get_profile( std::string job_name ) {
+    for ( unsigned int ii = 0 ; ii < num_jobs ; ii++ ) {
+        if ( ! jobs[ii].name.compare(job_name) ) {
+            return &jobs[ii] ;
+        }
+    }
+    return NULL ;
+}
+
+/**
+@details
+-# If we are disabled, return
+-# Find the length of a profiler clock tic.  The time stamp counter rate is measured against the
+   system clock over the whole time profiling has been on.
+-# For each job with a recorder, compute the mean, percentile, and longest run times in one pass over
+   its histogram, and the mean hardware counts.
+*/
+int Trick::JobProfiler::update_statistics() {
+
+    static const double percentiles[3] = { 50.0 , 99.0 , 99.9 } ;
+    double seconds_per_tic = 1.0e-9 ;
+
+    if ( enabled == false ) {
+        return(0) ;
+    }
+
+    if ( use_tsc ) {
+        long long elapsed_nanoseconds = system_nanoseconds() - start_nanoseconds ;
+        unsigned long long elapsed_tics = profiler_time() - start_tics ;
+        if ( elapsed_nanoseconds <= 0 or elapsed_tics == 0 ) {
+            return(0) ;
+        }
+        seconds_per_tic = elapsed_nanoseconds * 1.0e-9 / elapsed_tics ;
+    }
+
+    for ( unsigned int ii = 0 ; ii < num_jobs ; ii++ ) {
+        Trick::JobProfile & profile = jobs[ii] ;
+        if ( profile.recorder == NULL ) {
+            continue ;
+        }
+        const Trick::JobHistogram & histogram = profile.recorder->histogram ;
+        unsigned long long values[3] ;
+
+        profile.calls = histogram.count() ;
+        if ( profile.calls == 0 ) {
+            continue ;
+        }
+        histogram.values_at_percentiles(percentiles, values, 3) ;
+        profile.mean = histogram.sum() * seconds_per_tic / profile.calls ;
+        profile.p50 = values[0] * seconds_per_tic ;
+        profile.p99 = values[1] * seconds_per_tic ;
+        profile.p999 = values[2] * seconds_per_tic ;
+        profile.max = histogram.max() * seconds_per_tic ;
+
+        unsigned long long * sums = profile.recorder->counter_sums ;
+        profile.cycles = (double)__atomic_load_n(&sums[Trick::JobProfilerCycles], __ATOMIC_RELAXED) / profile.calls ;
+        profile.instructions = (double)__atomic_load_n(&sums[Trick::JobProfilerInstructions], __ATOMIC_RELAXED) / profile.calls ;
+        profile.cache_misses = (double)__atomic_load_n(&sums[Trick::JobProfilerCacheMisses], __ATOMIC_RELAXED) / profile.calls ;
+    }
+    return(0) ;
+}
+
+/**
+@details
+Loading a checkpoint deletes the jobs the instruments are inserted in.  The instruments, recorders,
+and statistics are not checkpointed.
+
+-# Remove the instruments from the jobs by name while the jobs still exist
+-# Free the recorders and statistics
+*/
+int Trick::JobProfiler::preload_checkpoint() {
+    remove_instruments() ;
+    free_statistics() ;
+    return(0) ;
+}
+
+/**
+@details
+-# If profiling is on in the checkpoint, turn it back on with empty histograms
+*/
+int Trick::JobProfiler::restart() {
+
+    if ( enabled == true ) {
+        enabled = false ;
+        profiler_on() ;
+    }
+    return(0) ;
+}
+
+/**
+@details
+-# If profiling was never on, return
+-# Refresh the statistics
+-# Write a line for each job with calls to job_profile.csv in the output directory
+*/
+int Trick::JobProfiler::shutdown() {
+
+    char file_name[1024] ;
+    FILE * fp ;
+
+    if ( jobs == NULL ) {
+        return(0) ;
+    }
+    update_statistics() ;
+
+    snprintf(file_name, sizeof(file_name), "%s/job_profile.csv", command_line_args_get_output_dir()) ;
+    if ( (fp = fopen(file_name, "w")) == NULL ) {
+        message_publish(MSG_ERROR, "Could not open %s for job profiling\n", file_name) ;
+        return(0) ;
+    }
+    fprintf(fp, "job_name {--},thread {--},calls {--},mean {s},p50 {s},p99 {s},p99.9 {s},max {s},"
+     "cycles {--},instructions {--},cache_misses {--}\n") ;
+    for ( unsigned int ii = 0 ; ii < num_jobs ; ii++ ) {
+        Trick::JobProfile & profile = jobs[ii] ;
+        if ( profile.calls == 0 ) {
+            continue ;
+        }
+        fprintf(fp, "%s,%u,%llu,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g\n", profile.name.c_str(), profile.thread,
+         profile.calls, profile.mean, profile.p50, profile.p99, profile.p999, profile.max,
+         profile.cycles, profile.instructions, profile.cache_misses) ;
+    }
+    fclose(fp) ;
+    return(0) ;
+}
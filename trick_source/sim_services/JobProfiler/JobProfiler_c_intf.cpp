@@ -0,0 +1,33 @@
+#include <stdio.h>
+#include "trick/JobProfiler.hh"
+
+/* Global singleton pointer to the job profiler class */
+extern Trick::JobProfiler * the_jp ;
+
+/*************************************************************************/
+/* These routines are the "C" interface to job profiler instrumentation */
+/*************************************************************************/
+
+/**
+ * @relates Trick::JobProfiler
+ * @copydoc Trick::JobProfiler::profiler_on
+ * C wrapper for Trick::JobProfiler::profiler_on
+ */
+extern "C" int job_profiler_on(void) {
+    if (the_jp != NULL) {
+        return the_jp->profiler_on() ;
+    }
+    return(0) ;
+}
+
+/**
+ * @relates Trick::JobProfiler
+ * @copydoc Trick::JobProfiler::profiler_off
+ * C wrapper for Trick::JobProfiler::profiler_off
+ */
+extern "C" int job_profiler_off(void) {
+    if (the_jp != NULL) {
+        return the_jp->profiler_off() ;
+    }
+    return(0) ;
+}
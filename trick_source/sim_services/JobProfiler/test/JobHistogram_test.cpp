@@ -0,0 +1,103 @@
+
+#include <pthread.h>
+
+#include "gtest/gtest.h"
+#include "trick/JobHistogram.hh"
+
+namespace Trick {
+
+class JobHistogramTest : public ::testing::Test {
+
+    protected:
+        Trick::JobHistogram histogram ;
+
+        JobHistogramTest() {}
+        ~JobHistogramTest() {}
+        virtual void SetUp() {}
+        virtual void TearDown() {}
+} ;
+
+TEST_F(JobHistogramTest , EmptyHistogram) {
+    EXPECT_EQ(histogram.count(), 0u) ;
+    EXPECT_EQ(histogram.max(), 0u) ;
+    EXPECT_EQ(histogram.value_at_percentile(50.0), 0u) ;
+}
+
+TEST_F(JobHistogramTest , BucketsCoverEveryValue) {
+    // Each bucket starts one past the end of the one below it
+    EXPECT_EQ(JobHistogram::bucket_index(0), 0u) ;
+    for ( unsigned int ii = 1 ; ii < JobHistogram::num_buckets ; ii++ ) {
+        unsigned long long lowest = JobHistogram::bucket_highest_value(ii - 1) + 1 ;
+        EXPECT_EQ(JobHistogram::bucket_index(lowest), ii) ;
+        EXPECT_EQ(JobHistogram::bucket_index(JobHistogram::bucket_highest_value(ii)), ii) ;
+    }
+    EXPECT_EQ(JobHistogram::bucket_index(~0ULL), JobHistogram::num_buckets - 1) ;
+}
+
+TEST_F(JobHistogramTest , SmallValuesAreExact) {
+    for ( unsigned long long value = 1 ; value <= 50 ; value++ ) {
+        histogram.record(value) ;
+    }
+    EXPECT_EQ(histogram.count(), 50u) ;
+    EXPECT_EQ(histogram.sum(), 1275u) ;
+    EXPECT_EQ(histogram.max(), 50u) ;
+    EXPECT_EQ(histogram.value_at_percentile(50.0), 25u) ;
+    EXPECT_EQ(histogram.value_at_percentile(100.0), 50u) ;
+    EXPECT_EQ(histogram.value_at_percentile(0.0), 1u) ;
+}
+
+TEST_F(JobHistogramTest , LargeValuesWithinBucketPrecision) {
+    for ( unsigned long long value = 1 ; value <= 100000 ; value++ ) {
+        histogram.record(value * 1000) ;
+    }
+    double percentiles[3] = { 50.0 , 99.0 , 99.9 } ;
+    unsigned long long expected[3] = { 50000000ULL , 99000000ULL , 99900000ULL } ;
+    unsigned long long values[3] ;
+    histogram.values_at_percentiles(percentiles, values, 3) ;
+    for ( int ii = 0 ; ii < 3 ; ii++ ) {
+        EXPECT_GE(values[ii], expected[ii]) ;
+        EXPECT_LE(values[ii], expected[ii] + expected[ii] / JobHistogram::sub_buckets) ;
+        EXPECT_EQ(values[ii], histogram.value_at_percentile(percentiles[ii])) ;
+    }
+    EXPECT_EQ(histogram.max(), 100000000u) ;
+}
+
+TEST_F(JobHistogramTest , RareSpikeShowsInTail) {
+    // One call in ten thousand takes a thousand times longer
+    for ( int ii = 0 ; ii < 100000 ; ii++ ) {
+        histogram.record(ii % 10000 == 0 ? 1000000 : 1000) ;
+    }
+    EXPECT_LE(histogram.value_at_percentile(99.0), 1000u + 1000u / JobHistogram::sub_buckets) ;
+    EXPECT_GE(histogram.value_at_percentile(99.995), 1000000u) ;
+    EXPECT_EQ(histogram.max(), 1000000u) ;
+}
+
+TEST_F(JobHistogramTest , OverflowValuesCountedInLastBucket) {
+    histogram.record(1ULL << 50) ;
+    EXPECT_EQ(histogram.count(), 1u) ;
+    EXPECT_EQ(histogram.value_at_percentile(50.0), 1ULL << 50) ;
+}
+
+static void * record_values( void * arg ) {
+    Trick::JobHistogram * histogram = (Trick::JobHistogram *)arg ;
+    for ( unsigned long long value = 0 ; value < 1000000 ; value++ ) {
+        histogram->record(value % 5000) ;
+    }
+    return NULL ;
+}
+
+TEST_F(JobHistogramTest , ReadWhileRecording) {
+    // The recording thread is the only writer.  Reads while it runs see no more than it has recorded.
+    pthread_t writer ;
+    pthread_create(&writer, NULL, record_values, &histogram) ;
+    for ( int ii = 0 ; ii < 100 ; ii++ ) {
+        unsigned long long count = histogram.count() ;
+        EXPECT_LE(count, 1000000u) ;
+        EXPECT_LE(histogram.value_at_percentile(99.0), 4999u) ;
+    }
+    pthread_join(writer, NULL) ;
+    EXPECT_EQ(histogram.count(), 1000000u) ;
+    EXPECT_EQ(histogram.max(), 4999u) ;
+}
+
+}
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include "trick/MemoryManager.hh"
 #include "trick/ClassicCheckPointAgent.hh"
+#include "trick/BinaryCheckPointAgent.hh"
 // Global pointer to the (singleton) MemoryManager for the C language interface.
 Trick::MemoryManager * trick_MM = NULL;
 
@@ -22,6 +23,7 @@ Trick::MemoryManager::MemoryManager()
 
     debug_level = 0;
     hexfloat_checkpoint = 0;
+    binary_checkpoint = 0;
     reduced_checkpoint  = 1;
     expanded_arrays  = 0;
     // start counter at 100mil.  This (hopefully) ensures all alloc'ed ids are after external variables.
@@ -29,12 +31,19 @@ Trick::MemoryManager::MemoryManager()
     // start counter at 0.  This forces extern vars to appear in front of actual allocations in checkpoint.
     extern_alloc_info_map_counter = 0 ;
     pthread_mutex_init(&mm_mutex, NULL);
+    ref_cache_generation = 0 ;
+    pthread_mutex_init(&ref_cache_mutex, NULL);
 
     defaultCheckPointAgent = new ClassicCheckPointAgent( this);
     defaultCheckPointAgent->set_reduced_checkpoint( reduced_checkpoint);
     defaultCheckPointAgent->set_hexfloat_checkpoint( hexfloat_checkpoint);
     defaultCheckPointAgent->set_debug_level( debug_level);
 
+    binaryCheckPointAgent = new BinaryCheckPointAgent( this);
+    binaryCheckPointAgent->set_reduced_checkpoint( reduced_checkpoint);
+    binaryCheckPointAgent->set_hexfloat_checkpoint( hexfloat_checkpoint);
+    binaryCheckPointAgent->set_debug_level( debug_level);
+
     currentCheckPointAgent = defaultCheckPointAgent;
 
     dlhandles.push_back(dlopen( NULL, RTLD_LAZY)) ;
@@ -78,6 +87,7 @@ Trick::MemoryManager::~MemoryManager() {
     }
 
     delete defaultCheckPointAgent ;
+    delete binaryCheckPointAgent ;
 
     for ( ait = alloc_info_map.begin() ; ait != alloc_info_map.end() ; ait++ ) {
         ALLOC_INFO * ai_ptr = (*ait).second ;
@@ -93,6 +103,11 @@ Trick::MemoryManager::~MemoryManager() {
         free(ai_ptr) ;
     }
     alloc_info_map.clear() ;
+
+    while ( !ref_cache.empty() ) {
+        std::string name = ref_cache.begin()->first ;
+        ref_cache_invalidate(name.c_str()) ;
+    }
 }
 
 #include <sstream>
@@ -264,6 +264,43 @@ extern "C" void TMM_hexfloat_checkpoint(int yesno) {
     }
 }
 
+/**
+ @relates Trick::MemoryManager
+ This is the C Language version of Trick::MemoryManager::set_binary_checkpoint( yesno).
+ */
+extern "C" void TMM_binary_checkpoint(int yesno) {
+    if (trick_MM != NULL) {
+        trick_MM->set_binary_checkpoint( yesno!=0 );
+    } else {
+        Trick::MemoryManager::emitError("TMM_binary_checkpoint() called before MemoryManager instantiation.\n") ;
+    }
+}
+
+/**
+ @relates Trick::MemoryManager
+ This is the C Language version of Trick::MemoryManager::set_incremental_checkpoint( max_deltas).
+ */
+extern "C" void TMM_incremental_checkpoint(int max_deltas) {
+    if (trick_MM != NULL) {
+        trick_MM->set_incremental_checkpoint( max_deltas );
+    } else {
+        Trick::MemoryManager::emitError("TMM_incremental_checkpoint() called before MemoryManager instantiation.\n") ;
+    }
+}
+
+/**
+ @relates Trick::MemoryManager
+ This is the C Language version of Trick::MemoryManager::compact_checkpoint( delta_file, out_file).
+ */
+extern "C" int TMM_compact_checkpoint(const char* delta_file, const char* out_file) {
+    if (trick_MM != NULL) {
+        return trick_MM->compact_checkpoint( delta_file, out_file );
+    } else {
+        Trick::MemoryManager::emitError("TMM_compact_checkpoint() called before MemoryManager instantiation.\n") ;
+    }
+    return 1;
+}
+
 
 
 
@@ -351,7 +388,7 @@ extern "C" void TMM_delete_extern_var_n( const char* name) {
  */
 extern "C" void TMM_write_checkpoint(const char* filename) {
     if (trick_MM != NULL) {
-        return ( trick_MM->write_checkpoint( filename));
+        trick_MM->write_checkpoint( filename);
     } else {
         Trick::MemoryManager::emitError("TMM_write_checkpoint_fn() called before MemoryManager instantiation.\n") ;
         return;
@@ -55,6 +55,7 @@ int Trick::MemoryManager::delete_var(void* address, bool destroy ) {
             pthread_mutex_lock(&mm_mutex);
             variable_map.erase( alloc_info->name);
             pthread_mutex_unlock(&mm_mutex);
+            ref_cache_invalidate( alloc_info->name);
             free(alloc_info->name);
         }
 
@@ -179,6 +179,11 @@ void* Trick::MemoryManager::resize_array( void *address, int n_cdims, int *cdims
     alloc_info_map[alloc_info->start] = alloc_info;
     pthread_mutex_unlock(&mm_mutex);
 
+    /** @li Cached references into a named allocation hold its old address and extents. */
+    if (alloc_info->name) {
+        ref_cache_invalidate( alloc_info->name);
+    }
+
     /** @li If debug is enabled, show what happened.*/
     if (debug_level) {
         int i;
@@ -2,24 +2,163 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <ctype.h>
 #include <sstream>
 #include "trick/MemoryManager.hh"
 #include "trick/RefParseContext.hh"
+#include "trick/memorymanager_c_intf.h"
 
 extern int REF_debug;
 
+/* Length of the NAME token at cp, the same pattern as the reference lexer: [_a-zA-Z][_a-zA-Z0-9:]* */
+static int name_length( const char * cp ) {
+    int len = 0 ;
+    if ( isalpha(cp[0]) or cp[0] == '_' ) {
+        len = 1 ;
+        while ( isalnum(cp[len]) or cp[len] == '_' or cp[len] == ':' ) {
+            len++ ;
+        }
+    }
+    return len ;
+}
+
+/*
+ Returns true if the reference is a NAME followed by any number of "[<decimal>]" and ".NAME",
+ the only shapes ref_attributes_fast handles.  top_name is set to the first NAME.
+*/
+static bool is_simple_reference( const char * name , std::string & top_name ) {
+
+    const char * cp = name ;
+    int len ;
+
+    if ( (len = name_length(cp)) == 0 ) {
+        return false ;
+    }
+    top_name.assign(cp, len) ;
+    cp += len ;
+    while ( *cp != '\0' ) {
+        if ( *cp == '.' ) {
+            if ( (len = name_length(++cp)) == 0 ) {
+                return false ;
+            }
+            cp += len ;
+        } else if ( *cp == '[' ) {
+            if ( !isdigit(*(++cp)) ) {
+                return false ;
+            }
+            while ( isdigit(*cp) ) {
+                cp++ ;
+            }
+            if ( *cp++ != ']' ) {
+                return false ;
+            }
+        } else {
+            return false ;
+        }
+    }
+    return true ;
+}
+
+/*
+ Follows the actions of the reference parser rules for a NAME, a "[<decimal>]" index, and a ".NAME".
+*/
+REF2 *Trick::MemoryManager::ref_attributes_fast( const char* name) {
+
+    REF2 R ;
+    REF2 * result ;
+    V_DATA v_data ;
+    const char * cp = name ;
+    int len ;
+    int ret = MM_OK ;
+    std::string token ;
+    std::string reference ;
+
+    memset(&R, 0, sizeof(REF2)) ;
+    R.units = NULL;
+    R.pointer_present = 0;
+    R.ref_type = REF_ADDRESS;
+    R.create_add_path = 1 ;
+    R.address_path = DLL_Create() ;
+
+    len = name_length(cp) ;
+    token.assign(cp, len) ;
+    cp += len ;
+    if ((ret = ref_var( &R, (char *)token.c_str())) == MM_OK) {
+        R.num_index_left = R.attr->num_index;
+        reference = token ;
+        R.reference = (char *)reference.c_str() ;
+    }
+
+    while ( ret == MM_OK and *cp != '\0' ) {
+        if ( *cp == '[' ) {
+            v_data.type = TRICK_INTEGER ;
+            v_data.value.i = atoi(++cp) ;
+            while ( *cp++ != ']' ) ;
+            ret = ref_dim(&R, &v_data) ;
+        } else {
+            len = name_length(++cp) ;
+            token.assign(cp, len) ;
+            cp += len ;
+            /* Check to see if previous parameter specified enough dimensions. */
+            if (R.num_index != R.attr->num_index) {
+                emitError("Dimension mismatch.");
+                ret = MM_PARAMETER_ARRAY_DIM ;
+                break ;
+            }
+            R.num_index = 0;
+            if ((ret = ref_name(&R, (char *)token.c_str())) == MM_OK) {
+                R.num_index_left = R.attr->num_index;
+                reference += "." + token ;
+                R.reference = (char *)reference.c_str() ;
+            }
+        }
+    }
+
+    R.reference = NULL ;
+    if ( ret != MM_OK ) {
+        if ( R.attr != NULL and R.attr == R.ref_attr ) {
+            free(R.ref_attr) ;
+        }
+        ref_free(&R) ;
+        return NULL ;
+    }
+
+    result = (REF2*)malloc( sizeof(REF2));
+    memcpy( result, &R, sizeof(REF2));
+    result->reference = strdup(name);
+    return result ;
+}
+
 REF2 *Trick::MemoryManager::ref_attributes(const char* name) {
 
     std::stringstream reference_sstream;
     REF2 * result = NULL;
     RefParseContext* context = NULL;
+    std::string top_name ;
+    unsigned int generation ;
 
     /** @par Design Details: */
+    /** @li If the reference is only names, "." and decimal indexes */
+    if ( is_simple_reference(name, top_name) ) {
+        /** @li Return a copy of the cached reference if there is one. */
+        if ( (result = ref_cache_lookup(top_name, name)) != NULL ) {
+            return result ;
+        }
+        /** @li Else resolve the reference without the parser and cache it. */
+        pthread_mutex_lock(&ref_cache_mutex) ;
+        generation = ref_cache_generation ;
+        pthread_mutex_unlock(&ref_cache_mutex) ;
+        if ( (result = ref_attributes_fast(name)) != NULL ) {
+            ref_cache_insert(top_name, result, generation) ;
+        }
+        return result ;
+    }
+
     reference_sstream << name;
 
     REF_debug = 0;
 
-    /** @li Create a parse context. */
+    /** @li Otherwise create a parse context. */
     context = new RefParseContext(this, &reference_sstream);
 
     /** @li Call REF_parse to parse the variable reference. */
@@ -40,4 +179,3 @@ REF2 *Trick::MemoryManager::ref_attributes(const char* name) {
     /** @li Return the the REF2 object.*/
     return ( result);
 }
-
@@ -0,0 +1,107 @@
+
+#include <string.h>
+#include <stdlib.h>
+#include "trick/MemoryManager.hh"
+#include "trick/memorymanager_c_intf.h"
+
+/*
+ Make a REF2 the caller may free with ref_free and free() without touching the original.
+ The address path is copied, and a reference attribute made for a named allocation is copied
+ because ref_name frees it.
+*/
+static REF2 * ref_copy( REF2 * R, const char * name ) {
+
+    REF2 * new_ref ;
+    DLLPOS pos ;
+    ADDRESS_NODE * address_node ;
+
+    new_ref = (REF2 *)malloc(sizeof(REF2)) ;
+    memcpy(new_ref, R, sizeof(REF2)) ;
+    new_ref->reference = strdup(name) ;
+
+    if ( R->attr != NULL and R->attr == R->ref_attr ) {
+        new_ref->attr = (ATTRIBUTES *)malloc(sizeof(ATTRIBUTES)) ;
+        memcpy(new_ref->attr, R->attr, sizeof(ATTRIBUTES)) ;
+        new_ref->ref_attr = new_ref->attr ;
+    } else {
+        new_ref->ref_attr = NULL ;
+    }
+
+    new_ref->address_path = DLL_Create() ;
+    if ( R->address_path ) {
+        pos = DLL_GetHeadPosition(R->address_path) ;
+        while ( pos != NULL ) {
+            address_node = new ADDRESS_NODE ;
+            *address_node = *(ADDRESS_NODE *)DLL_GetNext(&pos, R->address_path) ;
+            DLL_AddTail(address_node , new_ref->address_path) ;
+        }
+    }
+    return new_ref ;
+}
+
+static void ref_cache_free( REF2 * R ) {
+    if ( R->ref_attr ) {
+        free(R->ref_attr) ;
+    }
+    ref_free(R) ;
+    free(R) ;
+}
+
+REF2 * Trick::MemoryManager::ref_cache_lookup( const std::string& top_name, const char* name) {
+
+    REF2 * result = NULL ;
+    REF_CACHE::iterator top_it ;
+    std::map<std::string, REF2*>::iterator it ;
+
+    pthread_mutex_lock(&ref_cache_mutex) ;
+    top_it = ref_cache.find(top_name) ;
+    if ( top_it != ref_cache.end() ) {
+        it = top_it->second.find(name) ;
+        if ( it != top_it->second.end() ) {
+            result = ref_copy(it->second, name) ;
+        }
+    }
+    pthread_mutex_unlock(&ref_cache_mutex) ;
+
+    /* Pointers along the path may have changed since the reference was cached. */
+    if ( result != NULL and result->pointer_present ) {
+        result->address = follow_address_path(result) ;
+        if ( result->address == NULL ) {
+            ref_cache_free(result) ;
+            result = NULL ;
+        }
+    }
+    return result ;
+}
+
+void Trick::MemoryManager::ref_cache_insert( const std::string& top_name, REF2* R, unsigned int generation) {
+
+    std::map<std::string, REF2*>::iterator it ;
+
+    pthread_mutex_lock(&ref_cache_mutex) ;
+    if ( generation == ref_cache_generation ) {
+        std::map<std::string, REF2*> & refs = ref_cache[top_name] ;
+        it = refs.find(R->reference) ;
+        if ( it == refs.end() ) {
+            refs[R->reference] = ref_copy(R, R->reference) ;
+        }
+    }
+    pthread_mutex_unlock(&ref_cache_mutex) ;
+}
+
+void Trick::MemoryManager::ref_cache_invalidate( const char* name) {
+
+    REF_CACHE::iterator top_it ;
+    std::map<std::string, REF2*>::iterator it ;
+
+    pthread_mutex_lock(&ref_cache_mutex) ;
+    ref_cache_generation++ ;
+    top_it = ref_cache.find(name) ;
+    if ( top_it != ref_cache.end() ) {
+        for ( it = top_it->second.begin() ; it != top_it->second.end() ; it++ ) {
+            ref_cache_free(it->second) ;
+        }
+        ref_cache.erase(top_it) ;
+    }
+    pthread_mutex_unlock(&ref_cache_mutex) ;
+}
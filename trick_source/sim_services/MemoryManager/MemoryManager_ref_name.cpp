@@ -8,6 +8,7 @@
 #include <sstream>
 
 #include "trick/MemoryManager.hh"
+#include "trick/AttributesMap.hh"
 #include "trick/attributes.h"
 #include "trick/reference.h"
 #include "trick/parameter_types.h"
@@ -22,7 +23,6 @@
 
 int Trick::MemoryManager::ref_name(REF2 * R, char *name) {
 
-    int ii;
     char *addr;
     ATTRIBUTES *attr;
 
@@ -41,16 +41,12 @@ int Trick::MemoryManager::ref_name(REF2 * R, char *name) {
         return (MM_PARAMETER_NAME);
     }
 
-    /* Find the parameter name at this level in the parameter list, 'ii' is the index to the parameter in the list. */
-    ii = 0;
-    while (strcmp(name, attr[ii].name)) {
-        if (attr[ii].name[0] == '\0')
-            return (MM_PARAMETER_NAME);
-        ii++;
+    /* Find the parameter name at this level in the parameter list. */
+    attr = Trick::AttributesMap::attributes_map()->find_member(attr, name);
+    if (attr == NULL) {
+        return (MM_PARAMETER_NAME);
     }
 
-    attr = &(attr[ii]);
-
 //    R->deprecated |= (attr->mods & 0x80000000);
 
 /* Set error_attr just in case we have an error */
@@ -6,21 +6,34 @@
 
 #include "trick/MemoryManager.hh"
 #include "trick/ClassicCheckPointAgent.hh"
+#include "trick/BinaryCheckPointAgent.hh"
 
 int Trick::MemoryManager::read_checkpoint( std::istream *is, bool do_restore_stls /* default is false */) {
 
-    ALLOC_INFO_MAP::iterator pos;
-    ALLOC_INFO* alloc_info;
+    CheckPointAgent* agent = currentCheckPointAgent;
 
     if (debug_level) {
         std::cout << std::endl << "- Reading checkpoint." << std::endl;
         std::cout.flush();
     }
 
-    if (currentCheckPointAgent->restore( is) !=0 ) {
+    // The binary agent restores binary checkpoints and hands classic ones to the classic agent.
+    if (agent == defaultCheckPointAgent) {
+        agent = binaryCheckPointAgent;
+    }
+
+    if (agent->restore( is) !=0 ) {
        emitError("Checkpoint restore failed.") ;
     }
 
+    return finish_restore( do_restore_stls);
+}
+
+int Trick::MemoryManager::finish_restore( bool do_restore_stls) {
+
+    ALLOC_INFO_MAP::iterator pos;
+    ALLOC_INFO* alloc_info;
+
     // Search for stls and restore them
     if(do_restore_stls) {
         for ( pos=alloc_info_map.begin() ; pos!=alloc_info_map.end() ; pos++ ) {
@@ -46,6 +59,7 @@ int Trick::MemoryManager::read_checkpoint( std::istream *is, bool do_restore_stl
 
                 // 1) Unregister the associated variable.
                 variable_map.erase( name);
+                ref_cache_invalidate( name.c_str());
 
                 // 2) free the name
                 free( alloc_info->name);
@@ -60,6 +74,18 @@ int Trick::MemoryManager::read_checkpoint( std::istream *is, bool do_restore_stl
 
 int Trick::MemoryManager::read_checkpoint(const char* filename ) {
 
+    // Binary checkpoints are restored from the mapped file rather than through a stream.
+    if (BinaryCheckPointAgent::is_binary_checkpoint( filename)) {
+        if (debug_level) {
+            std::cout << std::endl << "- Reading binary checkpoint." << std::endl;
+            std::cout.flush();
+        }
+        if (binaryCheckPointAgent->restore_file( filename) != 0) {
+            emitError("Checkpoint restore failed.") ;
+        }
+        return ( finish_restore( true )) ;
+    }
+
     // Create a stream from the named file.
     std::ifstream infile(filename , std::ios::in);
     if (infile.is_open()) {
@@ -1,9 +1,11 @@
 #include "trick/MemoryManager.hh"
+#include "trick/BinaryCheckPointAgent.hh"
 
 void Trick::MemoryManager::set_debug_level(int level) {
     debug_level = level;
     currentCheckPointAgent->set_debug_level(level);
     defaultCheckPointAgent->set_debug_level(level);
+    binaryCheckPointAgent->set_debug_level(level);
     return;
 }
 
@@ -11,12 +13,26 @@ void Trick::MemoryManager::set_reduced_checkpoint(bool flag) {
     reduced_checkpoint = flag;
     currentCheckPointAgent->set_reduced_checkpoint(flag);
     defaultCheckPointAgent->set_reduced_checkpoint(flag);
+    binaryCheckPointAgent->set_reduced_checkpoint(flag);
 }
 
 void Trick::MemoryManager::set_hexfloat_checkpoint(bool flag) {
     hexfloat_checkpoint = flag;
     currentCheckPointAgent->set_hexfloat_checkpoint(flag);
     defaultCheckPointAgent->set_hexfloat_checkpoint(flag);
+    binaryCheckPointAgent->set_hexfloat_checkpoint(flag);
+}
+
+void Trick::MemoryManager::set_binary_checkpoint(bool flag) {
+    binary_checkpoint = flag;
+}
+
+bool Trick::MemoryManager::get_binary_checkpoint() {
+    return binary_checkpoint;
+}
+
+void Trick::MemoryManager::set_incremental_checkpoint(int max_deltas) {
+    binaryCheckPointAgent->max_deltas = (max_deltas > 0) ? max_deltas : 0;
 }
 
 void Trick::MemoryManager::set_expanded_arrays(bool flag) {
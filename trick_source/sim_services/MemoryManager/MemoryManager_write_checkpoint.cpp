@@ -4,6 +4,7 @@
 #include <stdlib.h>  // free()
 #include <algorithm> // std::sort()
 #include "trick/MemoryManager.hh"
+#include "trick/BinaryCheckPointAgent.hh"
 
 // GreenHills stuff
 #if ( __ghs )
@@ -19,10 +20,6 @@ void Trick::MemoryManager::execute_checkpoint( std::ostream& out_s ) {
     int local_anon_var_number;
     int extern_anon_var_number;
 
-    // 1) Generate declaration statements for each the allocations that we are managing.
-    out_s << "// Variable Declarations." << std::endl;
-    out_s.flush();
-
     local_anon_var_number = 0;
     extern_anon_var_number = 0;
 
@@ -49,29 +46,38 @@ void Trick::MemoryManager::execute_checkpoint( std::ostream& out_s ) {
         get_stl_dependencies(alloc_info);
     }
 
-    // Write a declaration statement for all of the LOCAL variables,
     n_depends = dependencies.size();
-    for (int ii = 0 ; ii < n_depends ; ii ++) {
-        alloc_info = dependencies[ii];
-        if ( alloc_info->stcl == TRICK_LOCAL) {
-            currentCheckPointAgent->write_decl( out_s, alloc_info);
+    if (binary_checkpoint) {
+        // The binary agent writes the declarations and the contents of all allocations as one file.
+        binaryCheckPointAgent->write_checkpoint( out_s, dependencies);
+    } else {
+        // 1) Generate declaration statements for each the allocations that we are managing.
+        out_s << "// Variable Declarations." << std::endl;
+        out_s.flush();
+
+        // Write a declaration statement for all of the LOCAL variables,
+        for (int ii = 0 ; ii < n_depends ; ii ++) {
+            alloc_info = dependencies[ii];
+            if ( alloc_info->stcl == TRICK_LOCAL) {
+                currentCheckPointAgent->write_decl( out_s, alloc_info);
+            }
         }
-    }
 
-    // Write a "clear_all_vars" command.
-    if (reduced_checkpoint) {
-        out_s << std::endl << std::endl << "// Clear all allocations to 0." << std::endl;
-        out_s << "clear_all_vars();" << std::endl;
-    }
+        // Write a "clear_all_vars" command.
+        if (reduced_checkpoint) {
+            out_s << std::endl << std::endl << "// Clear all allocations to 0." << std::endl;
+            out_s << "clear_all_vars();" << std::endl;
+        }
 
-    // 2) Dump the contents of each of the dynamic and mapped allocations.
-    out_s << std::endl << std::endl << "// Variable Assignments." << std::endl;
-    out_s.flush();
+        // 2) Dump the contents of each of the dynamic and mapped allocations.
+        out_s << std::endl << std::endl << "// Variable Assignments." << std::endl;
+        out_s.flush();
 
-    for (int ii = 0 ; ii < n_depends ; ii ++) {
-        alloc_info = dependencies[ii];
-        write_var( out_s, alloc_info);
-        out_s << std::endl;
+        for (int ii = 0 ; ii < n_depends ; ii ++) {
+            alloc_info = dependencies[ii];
+            write_var( out_s, alloc_info);
+            out_s << std::endl;
+        }
     }
 
     // Free all of the temporary names that were created for the checkpoint.
@@ -94,6 +100,18 @@ void Trick::MemoryManager::execute_checkpoint( std::ostream& out_s ) {
     }
 }
 
+// MEMBER FUNCTION
+int Trick::MemoryManager::compact_checkpoint( const char* delta_file, const char* out_file) {
+    return binaryCheckPointAgent->compact( delta_file, out_file);
+}
+
+// MEMBER FUNCTION
+void Trick::MemoryManager::discard_checkpoint_base( const char* filename) {
+    // Writing nothing to the file as a full checkpoint drops a base of that name.
+    binaryCheckPointAgent->begin_file( filename, false);
+    binaryCheckPointAgent->end_file( false);
+}
+
 // Local sort function used in write_checkpoint.
 static bool alloc_info_id_compare(ALLOC_INFO * lhs, ALLOC_INFO * rhs) { return ( lhs->id < rhs->id ) ; }
 
@@ -120,17 +138,33 @@ void Trick::MemoryManager::write_checkpoint( std::ostream& out_s) {
 }
 
 // MEMBER FUNCTION
-void Trick::MemoryManager::write_checkpoint(const char* filename) {
+int Trick::MemoryManager::write_checkpoint(const char* filename) {
+
+    // Only binary checkpoints of every allocation may be deltas.
+    binaryCheckPointAgent->begin_file( filename, binary_checkpoint);
 
-   std::ofstream outfile( filename, std::ios::out);
+    std::ofstream outfile( filename, std::ios::out | std::ios::binary);
 
     if (outfile.is_open()) {
         write_checkpoint( outfile);
+        outfile.close();
     } else {
         std::stringstream message;
         message << "Couldn't open \"" << filename << "\".";
         emitError(message.str());
     }
+    // A failed write or close leaves the stream bad.
+    binaryCheckPointAgent->end_file( outfile.good());
+    return outfile.good() ? 0 : 1;
+}
+
+// MEMBER FUNCTION
+int Trick::MemoryManager::write_checkpoint_for_file( std::ostream& out_s, const char* filename) {
+
+    binaryCheckPointAgent->begin_file( filename, binary_checkpoint);
+    write_checkpoint( out_s);
+    binaryCheckPointAgent->end_file( out_s.good());
+    return out_s.good() ? 0 : 1;
 }
 
 // MEMBER FUNCTION
@@ -147,16 +181,21 @@ void Trick::MemoryManager::write_checkpoint( std::ostream& out_s, const char* va
 }
 
 // MEMBER FUNCTION
-void Trick::MemoryManager::write_checkpoint(const char* filename, const char* var_name) {
+int Trick::MemoryManager::write_checkpoint(const char* filename, const char* var_name) {
+
+    binaryCheckPointAgent->begin_file( filename, false);
 
-    std::ofstream out_s( filename, std::ios::out);
+    std::ofstream out_s( filename, std::ios::out | std::ios::binary);
     if (out_s.is_open()) {
         write_checkpoint( out_s, var_name);
+        out_s.close();
     } else {
         std::stringstream message;
         message << "Couldn't open \"" << filename << "\".";
         emitError(message.str());
     }
+    binaryCheckPointAgent->end_file( out_s.good());
+    return out_s.good() ? 0 : 1;
 }
 
 // MEMBER FUNCTION
@@ -180,14 +219,19 @@ void Trick::MemoryManager::write_checkpoint( std::ostream& out_s, std::vector<co
 }
 
 // MEMBER FUNCTION
-void Trick::MemoryManager::write_checkpoint(const char* filename, std::vector<const char*>& var_name_list) {
+int Trick::MemoryManager::write_checkpoint(const char* filename, std::vector<const char*>& var_name_list) {
+
+    binaryCheckPointAgent->begin_file( filename, false);
 
-    std::ofstream out_s( filename, std::ios::out);
+    std::ofstream out_s( filename, std::ios::out | std::ios::binary);
 
     if (out_s.is_open()) {
         write_checkpoint( out_s, var_name_list);
+        out_s.close();
     } else {
         std::cerr << "ERROR: Couldn't open \""<< filename <<"\"." << std::endl;
         std::cerr.flush();
     }
+    binaryCheckPointAgent->end_file( out_s.good());
+    return out_s.good() ? 0 : 1;
 }
@@ -0,0 +1,278 @@
+#include <gtest/gtest.h>
+#define private public
+#include "MM_test.hh"
+#include "MM_write_checkpoint.hh"
+#include "trick/BinaryCheckPointAgent.hh"
+#include <iostream>
+#include <sstream>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/*
+ This tests writing and restoring checkpoints in the binary format.
+ */
+class MM_binary_checkpoint : public ::testing::Test {
+
+        protected:
+                Trick::MemoryManager *memmgr;
+                MM_binary_checkpoint() {
+                        try {
+                                memmgr = new Trick::MemoryManager;
+                        } catch (std::logic_error e) {
+                                memmgr = NULL;
+                        }
+                }
+                ~MM_binary_checkpoint() {
+                        delete memmgr;
+                }
+                void SetUp() {}
+                void TearDown() {}
+};
+
+// ================================================================================
+TEST_F(MM_binary_checkpoint, header) {
+
+    std::stringstream ss;
+
+    double *dbl_p = (double*)memmgr->declare_var("double dbl_singleton");
+    *dbl_p = 3.1415;
+
+    memmgr->set_binary_checkpoint(1);
+    EXPECT_TRUE(memmgr->get_binary_checkpoint());
+    memmgr->write_checkpoint( ss, "dbl_singleton");
+
+    EXPECT_EQ(ss.str().compare(0, 8, "TRICKBCP"), 0);
+}
+
+// ================================================================================
+TEST_F(MM_binary_checkpoint, dbl_array_restore) {
+
+    std::stringstream ss;
+
+    double *dbl_p = (double*)memmgr->declare_var("double dbl_array[5]");
+    for (int ii = 0 ; ii < 5 ; ii++) {
+        dbl_p[ii] = ii * 1.5 + 0.1;
+    }
+
+    memmgr->set_binary_checkpoint(1);
+    memmgr->write_checkpoint( ss, "dbl_array");
+
+    for (int ii = 0 ; ii < 5 ; ii++) {
+        dbl_p[ii] = 0.0;
+    }
+
+    memmgr->read_checkpoint( &ss);
+
+    for (int ii = 0 ; ii < 5 ; ii++) {
+        EXPECT_EQ(dbl_p[ii], ii * 1.5 + 0.1);
+    }
+}
+
+// ================================================================================
+TEST_F(MM_binary_checkpoint, pointers_restore) {
+
+    std::stringstream ss;
+
+    UDT1 *udt1_p = (UDT1*)memmgr->declare_var("UDT1 udt1");
+    double *dbl_p = (double*)memmgr->declare_var("double dbl_array[3]");
+    MONTH *month_p = (MONTH*)memmgr->declare_var("MONTH month");
+
+    udt1_p->x = 42.0;
+    udt1_p->udt_p = udt1_p;
+    udt1_p->dbl_p = &dbl_p[2];
+    udt1_p->month_p = month_p;
+    dbl_p[2] = 7.25;
+    *month_p = MARCH;
+
+    memmgr->set_binary_checkpoint(1);
+    memmgr->write_checkpoint( ss);
+
+    // Restore into a fresh set of allocations.
+    memmgr->init_from_checkpoint( &ss);
+
+    ASSERT_TRUE(memmgr->var_exists("udt1"));
+    udt1_p = (UDT1*)memmgr->variable_map["udt1"]->start;
+    dbl_p = (double*)memmgr->variable_map["dbl_array"]->start;
+    month_p = (MONTH*)memmgr->variable_map["month"]->start;
+
+    EXPECT_EQ(udt1_p->x, 42.0);
+    EXPECT_EQ(udt1_p->udt_p, udt1_p);
+    EXPECT_EQ(udt1_p->dbl_p, &dbl_p[2]);
+    EXPECT_EQ(*udt1_p->dbl_p, 7.25);
+    EXPECT_EQ(udt1_p->month_p, month_p);
+    EXPECT_EQ(*udt1_p->month_p, MARCH);
+}
+
+// ================================================================================
+TEST_F(MM_binary_checkpoint, classic_still_restores) {
+
+    std::stringstream ss;
+
+    double *dbl_p = (double*)memmgr->declare_var("double dbl_singleton");
+    *dbl_p = 2.5;
+
+    memmgr->write_checkpoint( ss, "dbl_singleton");
+    *dbl_p = 0.0;
+
+    memmgr->set_binary_checkpoint(1);
+    memmgr->read_checkpoint( &ss);
+
+    EXPECT_EQ(*dbl_p, 2.5);
+}
+
+// ================================================================================
+TEST_F(MM_binary_checkpoint, incremental) {
+
+    struct stat base_stat , delta_stat ;
+
+    double *big_p = (double*)memmgr->declare_var("double big_array[10000]");
+    double *dbl_p = (double*)memmgr->declare_var("double dbl_singleton");
+    for (int ii = 0 ; ii < 10000 ; ii++) {
+        big_p[ii] = ii;
+    }
+    *dbl_p = 1.0;
+
+    memmgr->set_binary_checkpoint(1);
+    memmgr->set_incremental_checkpoint(2);
+    memmgr->write_checkpoint("MM_binary_checkpoint_base");
+
+    // Only dbl_singleton changed, the delta does not hold big_array.
+    *dbl_p = 2.0;
+    memmgr->write_checkpoint("MM_binary_checkpoint_delta");
+    ASSERT_EQ(stat("MM_binary_checkpoint_base", &base_stat), 0);
+    ASSERT_EQ(stat("MM_binary_checkpoint_delta", &delta_stat), 0);
+    EXPECT_LT(delta_stat.st_size * 10, base_stat.st_size);
+
+    // Restoring the delta restores big_array from the base.
+    big_p[10] = 0.0;
+    *dbl_p = 0.0;
+    memmgr->read_checkpoint("MM_binary_checkpoint_delta");
+    EXPECT_EQ(big_p[10], 10.0);
+    EXPECT_EQ(*dbl_p, 2.0);
+
+    // The compacted checkpoint stands alone.
+    EXPECT_EQ(memmgr->compact_checkpoint("MM_binary_checkpoint_delta", "MM_binary_checkpoint_full"), 0);
+    unlink("MM_binary_checkpoint_base");
+    unlink("MM_binary_checkpoint_delta");
+    big_p[10] = 0.0;
+    *dbl_p = 0.0;
+    memmgr->read_checkpoint("MM_binary_checkpoint_full");
+    EXPECT_EQ(big_p[10], 10.0);
+    EXPECT_EQ(*dbl_p, 2.0);
+    unlink("MM_binary_checkpoint_full");
+}
+
+// ================================================================================
+TEST_F(MM_binary_checkpoint, overwritten_base) {
+
+    struct stat base_stat , rewritten_stat ;
+
+    double *big_p = (double*)memmgr->declare_var("double big_array[10000]");
+    double *dbl_p = (double*)memmgr->declare_var("double dbl_singleton");
+    for (int ii = 0 ; ii < 10000 ; ii++) {
+        big_p[ii] = ii;
+    }
+    *dbl_p = 1.0;
+
+    memmgr->set_binary_checkpoint(1);
+    memmgr->set_incremental_checkpoint(2);
+    memmgr->write_checkpoint("MM_binary_checkpoint_base");
+    ASSERT_EQ(stat("MM_binary_checkpoint_base", &base_stat), 0);
+    *dbl_p = 2.0;
+    memmgr->write_checkpoint("MM_binary_checkpoint_delta");
+
+    // Writing over the base, as safestore does, writes a full checkpoint in its place.
+    big_p[10] = -10.0;
+    *dbl_p = 3.0;
+    memmgr->write_checkpoint("MM_binary_checkpoint_base");
+    ASSERT_EQ(stat("MM_binary_checkpoint_base", &rewritten_stat), 0);
+    EXPECT_EQ(rewritten_stat.st_size, base_stat.st_size);
+    EXPECT_NE(access("MM_binary_checkpoint_base.base", F_OK), 0);
+
+    // The delta's base is gone, the delta is refused rather than restored against the new base.
+    *dbl_p = 0.0;
+    EXPECT_NE(memmgr->binaryCheckPointAgent->restore_file("MM_binary_checkpoint_delta"), 0);
+    EXPECT_EQ(*dbl_p, 0.0);
+
+    // The rewritten checkpoint restores on its own.
+    big_p[10] = 0.0;
+    memmgr->read_checkpoint("MM_binary_checkpoint_base");
+    EXPECT_EQ(big_p[10], -10.0);
+    EXPECT_EQ(*dbl_p, 3.0);
+
+    unlink("MM_binary_checkpoint_base");
+    unlink("MM_binary_checkpoint_delta");
+}
+
+// ================================================================================
+TEST_F(MM_binary_checkpoint, discard_base) {
+
+    struct stat base_stat , full_stat , delta_stat ;
+
+    double *big_p = (double*)memmgr->declare_var("double big_array[10000]");
+    double *dbl_p = (double*)memmgr->declare_var("double dbl_singleton");
+    for (int ii = 0 ; ii < 10000 ; ii++) {
+        big_p[ii] = ii;
+    }
+    *dbl_p = 1.0;
+
+    memmgr->set_binary_checkpoint(1);
+    memmgr->set_incremental_checkpoint(2);
+    memmgr->write_checkpoint("MM_binary_checkpoint_base");
+
+    // Another process overwrites the base, so the next checkpoint is a full one.
+    memmgr->discard_checkpoint_base("MM_binary_checkpoint_base");
+    *dbl_p = 2.0;
+    memmgr->write_checkpoint("MM_binary_checkpoint_full");
+    ASSERT_EQ(stat("MM_binary_checkpoint_base", &base_stat), 0);
+    ASSERT_EQ(stat("MM_binary_checkpoint_full", &full_stat), 0);
+    EXPECT_EQ(full_stat.st_size, base_stat.st_size);
+
+    // Another process writing a different file leaves the base alone.
+    memmgr->discard_checkpoint_base("MM_binary_checkpoint_other");
+    *dbl_p = 3.0;
+    memmgr->write_checkpoint("MM_binary_checkpoint_delta");
+    ASSERT_EQ(stat("MM_binary_checkpoint_delta", &delta_stat), 0);
+    EXPECT_LT(delta_stat.st_size * 10, full_stat.st_size);
+
+    unlink("MM_binary_checkpoint_base");
+    unlink("MM_binary_checkpoint_full");
+    unlink("MM_binary_checkpoint_delta");
+}
+
+// ================================================================================
+TEST_F(MM_binary_checkpoint, stl_restore) {
+
+    std::stringstream ss;
+
+    UDT8 *udt8_p = (UDT8*)memmgr->declare_var("UDT8 udt8");
+    for (int ii = 0 ; ii < 4 ; ii++) {
+        udt8_p->vec.push_back(ii * 1.5);
+        udt8_p->dbl_map[ii * 10] = ii + 0.25;
+    }
+
+    memmgr->set_binary_checkpoint(1);
+    memmgr->write_checkpoint( ss, "udt8");
+
+    // The arrays the STLs were saved in are gone after the write.
+    EXPECT_FALSE(memmgr->var_exists("udt8_vec"));
+
+    udt8_p->vec.clear();
+    udt8_p->vec.push_back(99.0);
+    udt8_p->dbl_map.clear();
+    udt8_p->dbl_map[99] = 99.0;
+
+    memmgr->read_checkpoint( &ss, true);
+
+    ASSERT_EQ(udt8_p->vec.size(), 4u);
+    ASSERT_EQ(udt8_p->dbl_map.size(), 4u);
+    for (int ii = 0 ; ii < 4 ; ii++) {
+        EXPECT_EQ(udt8_p->vec[ii], ii * 1.5);
+        EXPECT_EQ(udt8_p->dbl_map[ii * 10], ii + 0.25);
+    }
+    EXPECT_EQ(udt8_p->dbl_map.count(99), 0u);
+
+    // restore_stls deletes the arrays once the STLs are refilled.
+    EXPECT_FALSE(memmgr->var_exists("udt8_vec"));
+}
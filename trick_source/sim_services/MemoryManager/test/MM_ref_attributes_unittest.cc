@@ -168,3 +168,46 @@ TEST_F(MM_ref_attributes, FailureCases) {
         ASSERT_TRUE(ref == NULL);
 
 }
+
+TEST_F(MM_ref_attributes, CachedReferences) {
+        REF2 *ref;
+
+        double *dbl_p = (double*)memmgr->declare_var("double dbl[5]");
+        ASSERT_TRUE(dbl_p != NULL);
+
+        // The second lookup of the same name comes from the reference cache.
+        ref = memmgr->ref_attributes("dbl[3]");
+        ASSERT_TRUE(ref != NULL);
+        EXPECT_EQ( &dbl_p[3], ref->address);
+        free( ref);
+
+        ref = memmgr->ref_attributes("dbl[3]");
+        ASSERT_TRUE(ref != NULL);
+        EXPECT_EQ( &dbl_p[3], ref->address);
+        free( ref);
+
+        // Deleting the variable removes its cached references.
+        memmgr->delete_var("dbl");
+        ref = memmgr->ref_attributes("dbl[3]");
+        ASSERT_TRUE(ref == NULL);
+
+        // A new variable with the same name resolves to its own address.
+        dbl_p = (double*)memmgr->declare_var("double dbl[5]");
+        ASSERT_TRUE(dbl_p != NULL);
+        ref = memmgr->ref_attributes("dbl[3]");
+        ASSERT_TRUE(ref != NULL);
+        EXPECT_EQ( &dbl_p[3], ref->address);
+        free( ref);
+
+        // Resizing the variable moves it.
+        dbl_p = (double*)memmgr->resize_array("dbl", 50);
+        ASSERT_TRUE(dbl_p != NULL);
+        ref = memmgr->ref_attributes("dbl[30]");
+        ASSERT_TRUE(ref != NULL);
+        EXPECT_EQ( &dbl_p[30], ref->address);
+        free( ref);
+        ref = memmgr->ref_attributes("dbl[3]");
+        ASSERT_TRUE(ref != NULL);
+        EXPECT_EQ( &dbl_p[3], ref->address);
+        free( ref);
+}
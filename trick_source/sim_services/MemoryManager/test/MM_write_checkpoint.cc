@@ -4,6 +4,7 @@
 #include "MM_test.hh"
 #include "MM_write_checkpoint.hh"
 #include <iostream>
+#include <unistd.h>
 
 
 /*
@@ -1046,3 +1047,21 @@ TEST_F(MM_write_checkpoint, ptr_to_array_of_ptrs_to_objects ) {
     EXPECT_EQ( udt7_p->udt3pp[2]->b , 8);
 }
 
+// ================================================================================
+TEST_F(MM_write_checkpoint, write_status) {
+
+    double *dbl_p = (double*)memmgr->declare_var("double dbl_singleton");
+    *dbl_p = 3.1415;
+
+    EXPECT_EQ(memmgr->write_checkpoint("MM_write_checkpoint_status"), 0);
+    EXPECT_EQ(access("MM_write_checkpoint_status", F_OK), 0);
+    unlink("MM_write_checkpoint_status");
+
+    EXPECT_EQ(memmgr->write_checkpoint("no_such_dir/MM_write_checkpoint_status"), 1);
+
+    // The file opens, but every write to /dev/full fails.
+    if (access("/dev/full", W_OK) == 0) {
+        EXPECT_EQ(memmgr->write_checkpoint("/dev/full"), 1);
+        EXPECT_EQ(memmgr->write_checkpoint("/dev/full", "dbl_singleton"), 1);
+    }
+}
@@ -2,6 +2,9 @@
 PURPOSE: (Testing)
 */
 
+#include <vector>
+#include <map>
+
 typedef enum {
     JANUARY = 1, FEBRUARY = 2, MARCH, APRIL, MAY, JUNE, JULY, AUGUST, SEPTEMBER, OCTOBER, NOVEMBER, DECEMBER
     } MONTH;
@@ -42,3 +45,9 @@ class UDT7 {
     double A;
     UDT3** udt3pp;
 };
+
+class UDT8 {
+    public:
+    std::vector<double> vec;
+    std::map<int, double> dbl_map;
+};
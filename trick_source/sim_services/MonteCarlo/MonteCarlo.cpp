@@ -10,6 +10,7 @@ Trick::MonteCarlo::MonteCarlo() :
     custom_slave_dispatch(false),
     timeout(120),
     max_tries(2),
+    binary_dispatch(true),
     verbosity(MC_INFORMATIONAL),
     num_runs(0),
     actual_num_runs(0),
@@ -27,15 +28,18 @@ Trick::MonteCarlo::MonteCarlo() :
 
     memset(&listen_device, 0, sizeof(TCDevice)) ;
     memset(&connection_device, 0, sizeof(TCDevice)) ;
+    memset(&dispatch_device, 0, sizeof(TCDevice)) ;
 
     listen_device.port = 0;
     connection_device.port = 0;
 
     listen_device.disable_handshaking = TC_COMM_TRUE;
     connection_device.disable_handshaking = TC_COMM_TRUE;
+    dispatch_device.disable_handshaking = TC_COMM_TRUE;
 
     tc_error(&listen_device, 0);
     tc_error(&connection_device, 0);
+    tc_error(&dispatch_device, 0);
 
     int num_classes = 0;
     class_map["monte_master_init"] = num_classes;
@@ -68,8 +72,10 @@ Trick::MonteCarlo::~MonteCarlo() {
     /* tc_error allocates memory in the constructor */
     free(listen_device.error_handler) ;
     free(connection_device.error_handler) ;
+    free(dispatch_device.error_handler) ;
     listen_device.error_handler = NULL ;
     connection_device.error_handler = NULL ;
+    dispatch_device.error_handler = NULL ;
 }
 
 
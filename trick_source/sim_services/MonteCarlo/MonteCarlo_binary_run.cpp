@@ -0,0 +1,360 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <math.h>
+#include <arpa/inet.h>
+#include <udunits2.h>
+
+#include "trick/MonteCarlo.hh"
+#include "trick/MonteVarCalculated.hh"
+#include "trick/UdUnits.hh"
+#include "trick/memorymanager_c_intf.h"
+#include "trick/reference.h"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+#include "trick/tc_proto.h"
+
+/* A variable or result named by the master, resolved once by the slave before its runs are forked. */
+struct Trick::MonteSlaveVariable {
+    std::string name;
+    std::string unit;
+    /* NULL if the variable cannot be accessed directly. Values of such variables are parsed as Python, and such
+       results are returned as NaN. */
+    REF2 *ref;
+    cv_converter *converter;
+};
+
+/* Size of one encoded value: a 32-bit index and a 64-bit double. */
+static const unsigned int binary_value_size = 12;
+
+static void put_uint32(std::string &buffer, uint32_t value) {
+    value = htonl(value);
+    buffer.append((char *)&value, sizeof(value));
+}
+
+static uint32_t get_uint32(const char *data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return ntohl(value);
+}
+
+static void put_double(std::string &buffer, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put_uint32(buffer, (uint32_t)(bits >> 32));
+    put_uint32(buffer, (uint32_t)bits);
+}
+
+static double get_double(const char *data) {
+    uint64_t bits = ((uint64_t)get_uint32(data) << 32) | get_uint32(data + 4);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static std::string python_assignment(const std::string &name, const std::string &unit, double value) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%.17g", value);
+    if (unit.empty()) {
+        return name + " = " + buffer + "\n";
+    }
+    return name + " = trick.attach_units(\"" + unit + "\", " + buffer + ")\n";
+}
+
+void Trick::MonteCarlo::set_binary_dispatch(bool in_binary_dispatch) {
+    this->binary_dispatch = in_binary_dispatch;
+}
+
+bool Trick::MonteCarlo::get_binary_dispatch() {
+    return binary_dispatch;
+}
+
+/**
+ * @par Detailed Design:
+ * A value is sent in binary if it is a plain number. Calculated variables are always sent as Python.
+ */
+void Trick::MonteCarlo::set_binary_values(MonteRun *run) {
+    run->binary_variables.clear();
+    run->binary_values.clear();
+    if (!binary_dispatch) {
+        return;
+    }
+    for (std::vector<MonteVar *>::size_type i = 0; i < variables.size(); ++i) {
+        if (dynamic_cast<MonteVarCalculated *>(variables[i]) != NULL) {
+            continue;
+        }
+        const char *value = variables[i]->value.c_str();
+        char *end;
+        double number = strtod(value, &end);
+        if (end == value) {
+            continue;
+        }
+        while (*end == ' ' || *end == '\t') {
+            ++end;
+        }
+        if (*end == '\0') {
+            run->binary_variables.push_back(i);
+            run->binary_values.push_back(number);
+        }
+    }
+}
+
+/** @par Detailed Design: */
+int Trick::MonteCarlo::send_variable_definitions(TCDevice *device) {
+    /** <ul><li> Write the command and the number of variables. */
+    std::string message;
+    put_uint32(message, MonteSlave::MC_DEFINE_VARIABLES);
+    put_uint32(message, variables.size());
+    /** <li> Write the length and text of each variable's name and units. */
+    for (std::vector<MonteVar *>::size_type i = 0; i < variables.size(); ++i) {
+        put_uint32(message, variables[i]->name.length());
+        message += variables[i]->name;
+        put_uint32(message, variables[i]->unit.length());
+        message += variables[i]->unit;
+    }
+    /** <li> Write the results in the same way. </ul> */
+    put_uint32(message, results.size());
+    for (std::vector<MonteResult *>::size_type i = 0; i < results.size(); ++i) {
+        put_uint32(message, results[i]->name.length());
+        message += results[i]->name;
+        put_uint32(message, results[i]->unit.length());
+        message += results[i]->unit;
+    }
+    if (tc_write(device, (char *)message.c_str(), (int)message.length()) != (int)message.length()) {
+        return -1;
+    }
+    return 0;
+}
+
+std::string Trick::MonteCarlo::encode_binary_values(MonteRun *run) {
+    std::string buffer;
+    put_uint32(buffer, run->binary_variables.size());
+    for (std::vector<unsigned int>::size_type i = 0; i < run->binary_variables.size(); ++i) {
+        put_uint32(buffer, run->binary_variables[i]);
+        put_double(buffer, run->binary_values[i]);
+    }
+    return buffer;
+}
+
+static void free_slave_variables(std::vector<Trick::MonteSlaveVariable *> &slave_variables) {
+    for (std::vector<Trick::MonteSlaveVariable *>::size_type i = 0; i < slave_variables.size(); ++i) {
+        if (slave_variables[i]->ref) {
+            ref_free(slave_variables[i]->ref);
+            free(slave_variables[i]->ref);
+        }
+        if (slave_variables[i]->converter) {
+            cv_free(slave_variables[i]->converter);
+        }
+        delete slave_variables[i];
+    }
+    slave_variables.clear();
+}
+
+/*
+ Resolve a variable to its address if it is a single number of a basic type and its units, if given, convert to or
+ from the variable's units.
+*/
+static void resolve_slave_variable(Trick::MonteSlaveVariable *variable, bool to_variable) {
+    REF2 *ref = ref_attributes((char *)variable->name.c_str());
+    if (ref == NULL) {
+        return;
+    }
+    bool resolved = ref->attr != NULL && ref->num_index == ref->attr->num_index;
+    if (resolved) {
+        switch (ref->attr->type) {
+            case TRICK_CHARACTER:
+            case TRICK_UNSIGNED_CHARACTER:
+            case TRICK_SHORT:
+            case TRICK_UNSIGNED_SHORT:
+            case TRICK_INTEGER:
+            case TRICK_UNSIGNED_INTEGER:
+            case TRICK_LONG:
+            case TRICK_UNSIGNED_LONG:
+            case TRICK_LONG_LONG:
+            case TRICK_UNSIGNED_LONG_LONG:
+            case TRICK_FLOAT:
+            case TRICK_DOUBLE:
+            case TRICK_BOOLEAN:
+                break;
+            default:
+                resolved = false;
+                break;
+        }
+    }
+    if (resolved && !variable->unit.empty()) {
+        ut_system *unit_system = Trick::UdUnits::get_u_system();
+        ut_unit *given = ut_parse(unit_system, variable->unit.c_str(), UT_ASCII);
+        ut_unit *own = ref->attr->units ? ut_parse(unit_system, ref->attr->units, UT_ASCII) : NULL;
+        if (given && own) {
+            variable->converter = to_variable ? ut_get_converter(given, own) : ut_get_converter(own, given);
+        }
+        resolved = (variable->converter != NULL);
+        ut_free(given);
+        ut_free(own);
+    }
+    if (resolved) {
+        variable->ref = ref;
+    } else {
+        ref_free(ref);
+        free(ref);
+    }
+}
+
+/* Read a count followed by the length and text of the name and units of each variable. */
+static int read_slave_variables(TCDevice *device, std::vector<Trick::MonteSlaveVariable *> &slave_variables,
+  bool to_variable) {
+    uint32_t count;
+    if (tc_read(device, (char *)&count, (int)sizeof(count)) != (int)sizeof(count)) {
+        return -1;
+    }
+    count = ntohl(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        Trick::MonteSlaveVariable *variable = new Trick::MonteSlaveVariable;
+        variable->ref = NULL;
+        variable->converter = NULL;
+        slave_variables.push_back(variable);
+        std::string *fields[2] = { &variable->name, &variable->unit };
+        for (int j = 0; j < 2; ++j) {
+            uint32_t length;
+            if (tc_read(device, (char *)&length, (int)sizeof(length)) != (int)sizeof(length)) {
+                return -1;
+            }
+            length = ntohl(length);
+            fields[j]->resize(length);
+            if (length && tc_read(device, &(*fields[j])[0], (int)length) != (int)length) {
+                return -1;
+            }
+        }
+        resolve_slave_variable(variable, to_variable);
+    }
+    return 0;
+}
+
+/**
+ * @par Detailed Design:
+ * The addresses stay valid in the runs because they are forked from this process.
+ */
+void Trick::MonteCarlo::slave_define_variables() {
+    /** <ul><li> Forget the previous definitions. */
+    free_slave_variables(slave_variables);
+    free_slave_variables(slave_results);
+
+    /** <li> Read and resolve the variables, whose values are assigned, and the results, whose values are read. </ul> */
+    if (read_slave_variables(&dispatch_device, slave_variables, true) != 0 ||
+        read_slave_variables(&dispatch_device, slave_results, false) != 0) {
+        if (verbosity >= MC_ERROR) {
+            message_publish(MSG_ERROR, "Monte [%s:%d] Lost connection to Master while receiving variables.\nShutting down.\n",
+                            machine_name.c_str(), slave_id) ;
+        }
+        slave_shutdown();
+    }
+}
+
+/** @par Detailed Design: */
+void Trick::MonteCarlo::slave_apply_binary_values(const char *values, unsigned int count, std::string &python,
+  std::string &fallback) {
+    for (unsigned int i = 0; i < count; ++i) {
+        const char *entry = values + i * binary_value_size;
+        uint32_t index = get_uint32(entry);
+        double value = get_double(entry + 4);
+        if (index >= slave_variables.size()) {
+            continue;
+        }
+        MonteSlaveVariable *variable = slave_variables[index];
+        std::string assignment = python_assignment(variable->name, variable->unit, value);
+        python += assignment;
+
+        /** <ul><li> Values of variables that could not be resolved are parsed as Python. */
+        REF2 *ref = variable->ref;
+        if (ref == NULL) {
+            fallback += assignment;
+            continue;
+        }
+        /** <li> Otherwise convert the units and store the value at the resolved address. </ul> */
+        if (variable->converter) {
+            value = cv_convert_double(variable->converter, value);
+        }
+        void *address = ref->address;
+        switch (ref->attr->type) {
+            case TRICK_CHARACTER: *(char *)address = (char)value; break;
+            case TRICK_UNSIGNED_CHARACTER: *(unsigned char *)address = (unsigned char)value; break;
+            case TRICK_SHORT: *(short *)address = (short)value; break;
+            case TRICK_UNSIGNED_SHORT: *(unsigned short *)address = (unsigned short)value; break;
+            case TRICK_INTEGER: *(int *)address = (int)value; break;
+            case TRICK_UNSIGNED_INTEGER: *(unsigned int *)address = (unsigned int)value; break;
+            case TRICK_LONG: *(long *)address = (long)value; break;
+            case TRICK_UNSIGNED_LONG: *(unsigned long *)address = (unsigned long)value; break;
+            case TRICK_LONG_LONG: *(long long *)address = (long long)value; break;
+            case TRICK_UNSIGNED_LONG_LONG: *(unsigned long long *)address = (unsigned long long)value; break;
+            case TRICK_FLOAT: *(float *)address = (float)value; break;
+            case TRICK_DOUBLE: *(double *)address = value; break;
+            case TRICK_BOOLEAN: *(bool *)address = (value != 0.0); break;
+            default: fallback += assignment; break;
+        }
+    }
+}
+
+/**
+ * @par Detailed Design:
+ * Called by a run as it sends its exit status, so the values are those at the end of the run.
+ */
+void Trick::MonteCarlo::slave_send_results() {
+    /** <ul><li> Write the number of results. */
+    std::string message;
+    put_uint32(message, slave_results.size());
+    /** <li> Write the value of each result in its requested units, or NaN if it could not be read. </ul> */
+    for (std::vector<MonteSlaveVariable *>::size_type i = 0; i < slave_results.size(); ++i) {
+        REF2 *ref = slave_results[i]->ref;
+        double value = NAN;
+        if (ref) {
+            void *address = ref->address;
+            switch (ref->attr->type) {
+                case TRICK_CHARACTER: value = *(char *)address; break;
+                case TRICK_UNSIGNED_CHARACTER: value = *(unsigned char *)address; break;
+                case TRICK_SHORT: value = *(short *)address; break;
+                case TRICK_UNSIGNED_SHORT: value = *(unsigned short *)address; break;
+                case TRICK_INTEGER: value = *(int *)address; break;
+                case TRICK_UNSIGNED_INTEGER: value = *(unsigned int *)address; break;
+                case TRICK_LONG: value = *(long *)address; break;
+                case TRICK_UNSIGNED_LONG: value = *(unsigned long *)address; break;
+                case TRICK_LONG_LONG: value = *(long long *)address; break;
+                case TRICK_UNSIGNED_LONG_LONG: value = *(unsigned long long *)address; break;
+                case TRICK_FLOAT: value = *(float *)address; break;
+                case TRICK_DOUBLE: value = *(double *)address; break;
+                case TRICK_BOOLEAN: value = *(bool *)address; break;
+                default: break;
+            }
+            if (slave_results[i]->converter) {
+                value = cv_convert_double(slave_results[i]->converter, value);
+            }
+        }
+        put_double(message, value);
+    }
+    tc_write(&connection_device, (char *)message.c_str(), (int)message.length());
+}
+
+/**
+ * @par Detailed Design:
+ * The values are folded into the statistics of each MonteResult and kept, by run, for the monte_results file.
+ */
+int Trick::MonteCarlo::receive_results_values(MonteRun *run) {
+    /** <ul><li> Read the number of values and the values. */
+    uint32_t count;
+    if (tc_read(&connection_device, (char *)&count, (int)sizeof(count)) != (int)sizeof(count)) {
+        return -1;
+    }
+    count = ntohl(count);
+    std::string values(count * 8, '\0');
+    if (count && tc_read(&connection_device, &values[0], (int)values.length()) != (int)values.length()) {
+        return -1;
+    }
+    /** <li> Add each value to its result. A result the run did not return is missing. </ul> */
+    result_runs.push_back(run->id);
+    for (std::vector<MonteResult *>::size_type i = 0; i < results.size(); ++i) {
+        double value = i < count ? get_double(values.data() + i * 8) : NAN;
+        results[i]->add_value(value);
+        result_values.push_back(value);
+    }
+    return 0;
+}
@@ -91,6 +91,19 @@ extern "C" unsigned int mc_get_max_tries(void) {
     return 0 ;
 }
 
+extern "C" void mc_set_binary_dispatch(int binary_dispatch) {
+    if ( the_mc != NULL ) {
+        the_mc->set_binary_dispatch((bool)binary_dispatch);
+    }
+}
+
+extern "C" int mc_get_binary_dispatch(void) {
+    if ( the_mc != NULL ) {
+        return the_mc->get_binary_dispatch();
+    }
+    return 0 ;
+}
+
 extern "C" void mc_set_user_cmd_string(const char *user_cmd_string) {
     if ( the_mc != NULL ) {
         the_mc->set_user_cmd_string(std::string(user_cmd_string ? user_cmd_string : ""));
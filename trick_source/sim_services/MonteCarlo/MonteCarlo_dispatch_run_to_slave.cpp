@@ -1,6 +1,7 @@
 
 #include <iomanip>
 #include <sstream>
+#include <string.h>
 #include <sys/time.h>
 
 #include "trick/MonteCarlo.hh"
@@ -8,6 +9,57 @@
 #include "trick/message_proto.h"
 #include "trick/message_type.h"
 
+/**
+ * @par Detailed Design:
+ * The connection is kept open for the following dispatches. Workers share the connection of their host.
+ */
+TCDevice * Trick::MonteCarlo::get_dispatch_device(MonteSlave *slave) {
+    unsigned int id = slave->host_id ? slave->host_id : slave->id;
+    std::map<unsigned int, TCDevice *>::iterator it = dispatch_devices.find(id);
+    if (it != dispatch_devices.end()) {
+        return it->second;
+    }
+
+    MonteSlave *host = slave->host_id ? get_slave(slave->host_id) : slave;
+    if (!host) {
+        return NULL;
+    }
+    TCDevice *device = new TCDevice;
+    memset(device, 0, sizeof(TCDevice));
+    device->disable_handshaking = TC_COMM_TRUE;
+    tc_error(device, 0);
+    device->hostname = (char*)host->machine_name.c_str();
+    device->port = host->port;
+    if (tc_connect(device) != TC_SUCCESS) {
+        free(device->error_handler);
+        delete device;
+        return NULL;
+    }
+    dispatch_devices[id] = device;
+    /* A new connection may be to a slave that has not seen the variables. */
+    if (send_variable_definitions(device) != 0) {
+        close_dispatch_device(id);
+        return NULL;
+    }
+    return device;
+}
+
+void Trick::MonteCarlo::close_dispatch_device(unsigned int id) {
+    std::map<unsigned int, TCDevice *>::iterator it = dispatch_devices.find(id);
+    if (it != dispatch_devices.end()) {
+        tc_disconnect(it->second);
+        free(it->second->error_handler);
+        delete it->second;
+        dispatch_devices.erase(it);
+    }
+}
+
+/**
+ * @par Detailed Design:
+ * A dispatch is the MonteSlave::MC_PROCESS_RUN command, the id of the slave or worker, the CPU to run on, the
+ * length and text of the Python part of the run's parameterization, and its binary values. It is written in a single write so dispatches to the workers of a
+ * slave stream over its connection without waiting on each other.
+ */
 void Trick::MonteCarlo::dispatch_run_to_slave(MonteRun *run, MonteSlave *slave) {
     if (slave && run) {
         current_run = run->id;
@@ -15,13 +67,17 @@ void Trick::MonteCarlo::dispatch_run_to_slave(MonteRun *run, MonteSlave *slave)
             return;
         }
         slave->state = MonteSlave::MC_RUNNING;
-        connection_device.hostname = (char*)slave->machine_name.c_str();
-        connection_device.port = slave->port;
-        if (tc_connect(&connection_device) == TC_SUCCESS) {
+        TCDevice *device = get_dispatch_device(slave);
+        if (device) {
             std::stringstream buffer_stream;
             buffer_stream << slave_output_directory << "/RUN_" << std::setw(5) << std::setfill('0') << run->id;
             std::string buffer = "";
+            std::vector<unsigned int>::size_type next_binary = 0;
             for (std::vector<std::string>::size_type j = 0; j < run->variables.size(); ++j) {
+                if (next_binary < run->binary_variables.size() && run->binary_variables[next_binary] == j) {
+                    ++next_binary;
+                    continue;
+                }
                 buffer += run->variables[j] + "\n";
             }
             buffer += std::string("trick.set_output_dir(\"") + buffer_stream.str() + std::string("\")\n");
@@ -34,17 +90,31 @@ void Trick::MonteCarlo::dispatch_run_to_slave(MonteRun *run, MonteSlave *slave)
 		     run->id, slave->machine_name.c_str(), slave->id) ;
             }
 
-            int command = htonl(MonteSlave::MC_PROCESS_RUN);
-            tc_write(&connection_device, (char *)&command, (int)sizeof(command));
-            int num_bytes = htonl(buffer.length());
-            tc_write(&connection_device, (char*)&num_bytes, (int)sizeof(num_bytes));
-            tc_write(&connection_device, (char*)buffer.c_str(), (int)buffer.length());
+            int header[4];
+            header[0] = htonl(MonteSlave::MC_PROCESS_RUN);
+            header[1] = htonl(slave->id);
+            header[2] = htonl(slave->cpu_num);
+            header[3] = htonl(buffer.length());
+            std::string message((char*)header, sizeof(header));
+            message += buffer;
+            message += encode_binary_values(run);
 
             if (verbosity >= MC_ALL) {
                 message_publish(MSG_INFO, "Parameterization of run %d :\n%s\n", run->id, buffer.c_str()) ;
             }
 
-            tc_disconnect(&connection_device);
+            if (tc_write(device, (char*)message.c_str(), (int)message.length()) != (int)message.length()) {
+                close_dispatch_device(slave->host_id ? slave->host_id : slave->id);
+                slave->state = Trick::MonteSlave::MC_DISCONNECTED;
+                // Requeue the run. Counting the try keeps prepare_run from generating its values again.
+                ++run->num_tries;
+                runs.push_front(run);
+                if (verbosity >= MC_ERROR) {
+                    message_publish(MSG_ERROR, "Monte [Master] Lost connection to %s:%d while dispatching run.\n",
+                                    slave->machine_name.c_str(), slave->id) ;
+                }
+                return;
+            }
 
             ++slave->num_dispatches;
             slave->current_run = run;
@@ -55,6 +125,8 @@ void Trick::MonteCarlo::dispatch_run_to_slave(MonteRun *run, MonteSlave *slave)
             ++run->num_tries;
         } else {
             slave->state = Trick::MonteSlave::MC_DISCONNECTED;
+            ++run->num_tries;
+            runs.push_front(run);
             if (verbosity >= MC_ERROR) {
                 message_publish(MSG_ERROR, "Monte [Master] Failed to connect to %s:%d to dispatch run.\n",
                                 slave->machine_name.c_str(), slave->id) ;
@@ -184,6 +184,31 @@ const std::vector<Trick::MonteVar*>& Trick::MonteCarlo::get_variables() {
     return variables;
 }
 
+void Trick::MonteCarlo::add_result(Trick::MonteResult *result) {
+    for (std::vector<Trick::MonteResult *>::const_iterator i = results.begin(); i != results.end(); ++i) {
+        if ( (*i)->name.compare(result->name) == 0 ) {
+            message_publish(MSG_WARNING, "Monte WARNING: Cannot add new MonteResult \"%s\", result of that name already exists.\n",
+                    result->name.c_str() );
+            return;
+        }
+    }
+    results.push_back(result);
+}
+
+Trick::MonteResult * Trick::MonteCarlo::get_result(std::string result_name) {
+
+    for (std::vector<Trick::MonteResult *>::const_iterator i = results.begin(); i != results.end(); ++i) {
+        if ( (*i) and (*i)->name.compare(result_name) == 0 ) {
+            return (*i);
+        }
+    }
+    return (NULL);
+}
+
+const std::vector<Trick::MonteResult*>& Trick::MonteCarlo::get_results() {
+    return results;
+}
+
 void Trick::MonteCarlo::add_slave(std::string in_machine_name) {
     add_slave(new MonteSlave(in_machine_name));
 }
@@ -293,6 +318,7 @@ int Trick::MonteCarlo::shutdown() {
             tc_write(&connection_device, (char*)&id, (int)sizeof(id));
             exit_status = htonl(exit_status);
             tc_write(&connection_device, (char*)&exit_status, (int)sizeof(exit_status));
+            slave_send_results();
             run_queue(&slave_post_queue, "in slave_post queue");
             tc_disconnect(&connection_device);
         } else {
@@ -439,6 +465,8 @@ int  Trick::MonteCarlo::prepare_run(MonteRun *curr_run) {
                 return -1;
             }
         }
+        /** <li> Pick the values that can be dispatched in binary. */
+        set_binary_values(curr_run);
         /** <li> Create the data file </ul>*/
         fprintf(run_data_file, "%05u\t", curr_run->id);
         for (std::vector<std::string>::size_type i = 0; i < variables.size(); ++i) {
@@ -95,3 +95,40 @@ void Trick::MonteCarlo::write_to_run_files(std::string file_name)
         fprintf(run_header_file, "trick_mc.mc.add_variable(var%zu)\n", i);
     }
 }
+
+/**
+ * @par Detailed Design:
+ * The monte_results file is a text header followed by one column of doubles per result, each holding the value of
+ * every run in the order the runs finished. The first column holds the run ids.
+ */
+void Trick::MonteCarlo::write_results_file() {
+    if (results.empty()) {
+        return;
+    }
+    FILE *fp;
+    if (open_file(run_directory + std::string("/monte_results"), &fp) == -1) {
+        return;
+    }
+    /** <ul><li> Write the header: the byte order of the data, the numbers of rows and columns, and the column names. */
+    int one = 1;
+    fprintf(fp, "Trick-MonteResults-1-%c\n", *(char *)&one ? 'L' : 'B');
+    fprintf(fp, "%zu %zu\n", result_runs.size(), results.size() + 1);
+    fprintf(fp, "RUN\n");
+    for (std::vector<MonteResult *>::size_type i = 0; i < results.size(); ++i) {
+        fprintf(fp, "%s %s\n", results[i]->name.c_str(), results[i]->unit.empty() ? "--" : results[i]->unit.c_str());
+    }
+
+    /** <li> Write each column. </ul> */
+    std::vector<double> column(result_runs.size());
+    for (std::vector<unsigned int>::size_type i = 0; i < result_runs.size(); ++i) {
+        column[i] = result_runs[i];
+    }
+    fwrite(column.data(), sizeof(double), column.size(), fp);
+    for (std::vector<MonteResult *>::size_type j = 0; j < results.size(); ++j) {
+        for (std::vector<unsigned int>::size_type i = 0; i < result_runs.size(); ++i) {
+            column[i] = result_values[i * results.size() + j];
+        }
+        fwrite(column.data(), sizeof(double), column.size(), fp);
+    }
+    fclose(fp);
+}
@@ -36,6 +36,7 @@ void Trick::MonteCarlo::master_shutdown() {
     print_statistics(&file_ptr) ;
     print_statistics(&stdout) ;
     fclose(file_ptr) ;
+    write_results_file() ;
 
     if ( !except_return and failed_runs.size() > 0 ) {
         except_return = -2 ;
@@ -52,11 +53,14 @@ void Trick::MonteCarlo::shutdown_slaves() {
 
     for (std::vector<MonteSlave *>::size_type i = 0; i < slaves.size() ; ++i) {
         slaves[i]->state = MonteSlave::MC_FINISHED;
-        connection_device.hostname = (char*)slaves[i]->machine_name.c_str();
-        connection_device.port = slaves[i]->port;
-        if (tc_connect(&connection_device) == TC_SUCCESS) {
+        /* Workers are shut down with their host. */
+        if (slaves[i]->host_id) {
+            continue;
+        }
+        if (TCDevice *device = get_dispatch_device(slaves[i])) {
             int command = htonl(MonteSlave::MC_SHUTDOWN);
-            tc_write(&connection_device, (char*)&command, sizeof(command));
+            tc_write(device, (char*)&command, sizeof(command));
+            close_dispatch_device(slaves[i]->id);
         }
     }
 }
@@ -112,4 +116,11 @@ void Trick::MonteCarlo::print_statistics(FILE** fp) {
               exit_status_string[run->exit_status], run->exit_status);
         }
     }
+
+    if (results.size()) {
+        fprintf(*fp, "\nResult statistics:\n");
+        for (MonteResult* result : results) {
+            fprintf(*fp, "%s", result->describe_result().c_str());
+        }
+    }
 }
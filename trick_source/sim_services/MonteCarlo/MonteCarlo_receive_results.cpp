@@ -72,6 +72,15 @@ void Trick::MonteCarlo::handle_initialization(Trick::MonteSlave& slave) {
 
         slave.state = MonteSlave::MC_READY;
         tc_disconnect(&connection_device);
+
+        /* The slave's workers run in its process. */
+        for (std::vector<MonteSlave *>::size_type i = 0; i < slaves.size(); ++i) {
+            if (slaves[i]->host_id == slave.id && slaves[i]->state == MonteSlave::MC_INITIALIZING) {
+                slaves[i]->machine_name = slave.machine_name;
+                slaves[i]->port = slave.port;
+                slaves[i]->state = MonteSlave::MC_READY;
+            }
+        }
 }
 
 void Trick::MonteCarlo::handle_run_data(Trick::MonteSlave& slave) {
@@ -120,6 +129,13 @@ void Trick::MonteCarlo::handle_run_data(Trick::MonteSlave& slave) {
 
         case MonteRun::MC_RUN_COMPLETE:
         case MonteRun::MC_RUN_FAILED:
+            /* Only a run itself reports these, and it follows them with its results. */
+            if (receive_results_values(slave.current_run) != 0 && verbosity >= MC_ERROR) {
+                message_publish(
+                  MSG_ERROR,
+                  "Monte [Master] %s:%d did not return the results of run %d.\n",
+                  slave.machine_name.c_str(), slave.id, slave.current_run->id) ;
+            }
             resolve_run(slave, static_cast<MonteRun::ExitStatus>(exit_status));
             run_queue(&master_post_queue, "in master_post queue") ;
             break;
@@ -4,30 +4,45 @@
 #include "trick/message_type.h"
 #include "trick/tc_proto.h"
 
-/** @par Detailed Design: */
+/**
+ * @par Detailed Design:
+ * The master keeps its connection open between dispatches, and may send several runs, one for each worker, before
+ * any of them finish. Runs execute in child processes that this process reaps while it waits for the master.
+ */
 int Trick::MonteCarlo::execute_as_slave() {
 
+    bool connected = false;
+
     /** <li> Forever: */
     while (true) {
+        /** <ul><li> If the master is not connected, wait for it to connect. */
+        if (!connected) {
+            slave_wait_for_master(listen_device.socket);
+            if (tc_accept(&listen_device, &dispatch_device) != TC_SUCCESS) {
+                if (verbosity >= MC_ERROR) {
+                    message_publish(MSG_ERROR, "Monte [%s:%d] Lost connection to Master. Shutting down.\n",
+                                    machine_name.c_str(), slave_id) ;
+                }
+                slave_shutdown();
+            }
+            connected = true;
+        }
         if (verbosity >= MC_ALL) {
             message_publish(MSG_INFO, "Monte [%s:%d] Waiting for new run.\n",
                             machine_name.c_str(), slave_id) ;
         }
-        /** <ul><li> On a blocking read, wait for a MonteSlave::Command from the master. */
-        if (tc_accept(&listen_device, &connection_device) != TC_SUCCESS) {
-            if (verbosity >= MC_ERROR) {
-                message_publish(MSG_ERROR, "Monte [%s:%d] Lost connection to Master. Shutting down.\n",
-                                machine_name.c_str(), slave_id) ;
-            }
-            slave_shutdown();
-        }
+        /** <li> On a blocking read, wait for a MonteSlave::Command from the master. */
+        slave_wait_for_master(dispatch_device.socket);
         int command;
-        if (tc_read(&connection_device, (char *)&command, (int)sizeof(command)) != (int)sizeof(command)) {
-            if (verbosity >= MC_ERROR) {
-                message_publish(MSG_ERROR, "Monte [%s:%d] Lost connection to Master while receiving instructions. Shutting down.\n",
+        if (tc_read(&dispatch_device, (char *)&command, (int)sizeof(command)) != (int)sizeof(command)) {
+            /** <li> If the master closed the connection, wait for it to reconnect. */
+            if (verbosity >= MC_ALL) {
+                message_publish(MSG_INFO, "Monte [%s:%d] Master closed the connection.\n",
                                 machine_name.c_str(), slave_id) ;
             }
-            slave_shutdown();
+            tc_disconnect(&dispatch_device);
+            connected = false;
+            continue;
         }
         switch (command = ntohl(command)) {
             int return_value;
@@ -41,6 +56,10 @@ int Trick::MonteCarlo::execute_as_slave() {
                     return return_value;
                 }
                 break;
+            case MonteSlave::MC_DEFINE_VARIABLES:
+                /** <li> MonteSlave::MC_DEFINE_VARIABLES: Call #slave_define_variables. */
+                slave_define_variables();
+                break;
             case MonteSlave::MC_SHUTDOWN:
                 /** <li> MonteSlave::MC_SHUTDOWN: Call #slave_shutdown. */
                 if (verbosity >= MC_INFORMATIONAL) {
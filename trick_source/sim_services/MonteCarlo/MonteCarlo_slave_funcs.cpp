@@ -1,4 +1,6 @@
 
+#include <sys/wait.h>
+
 #include "trick/MonteCarlo.hh"
 
 /** @par Detailed Design: */
@@ -20,7 +22,13 @@ void Trick::MonteCarlo::slave_die() {
 
 /** @par Detailed Design: */
 void Trick::MonteCarlo::slave_kill_run() {
-    /**
+    /** <ul><li> Kill the child process of every worker. */
+    for (std::map<pid_t, unsigned int>::iterator it = slave_children.begin(); it != slave_children.end(); ++it) {
+        kill(it->first, SIGKILL);
+        waitpid(it->first, NULL, 0);
+    }
+    slave_children.clear();
+    /** <li>
      * The child process, if running, has a group ID equal to the parent's process ID. Sending a kill signal to this ID will
      * signal both the child and the parent, so ignore it in the parent, and restore the current signal handler afterward.
      */
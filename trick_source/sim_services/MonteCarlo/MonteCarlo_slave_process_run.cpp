@@ -2,6 +2,9 @@
 #include <sys/stat.h>
 #include <sys/wait.h>
 #include <stdio.h>
+#include <poll.h>
+#include <sched.h>
+#include <errno.h>
 #include <sstream>
 
 #include "trick/MonteCarlo.hh"
@@ -13,25 +16,44 @@
 
 /** @par Detailed Design: */
 int Trick::MonteCarlo::slave_process_run() {
-    int size;
-    /** <ul><li> Read the length of the incoming message. */
-    if (tc_read(&connection_device, (char *)&size, (int)sizeof(size)) != (int)sizeof(size) || (size = ntohl(size)) < 0) {
+    int header[3];
+    /** <ul><li> Read the id of the worker, the CPU to run on, and the length of the incoming message. */
+    if (tc_read(&dispatch_device, (char *)header, (int)sizeof(header)) != (int)sizeof(header) ||
+        (int)ntohl(header[2]) < 0) {
         if (verbosity >= MC_ERROR) {
             message_publish(MSG_ERROR, "Monte [%s:%d] Lost connection to Master while receiving new run.\nShutting down.\n",
                             machine_name.c_str(), slave_id) ;
         }
         slave_shutdown();
     }
+    unsigned int worker_id = ntohl(header[0]);
+    int cpu = ntohl(header[1]);
+    int size = ntohl(header[2]);
     char *input = new char[size + 1];
     /** <li> Read the incoming message. */
-    if (tc_read(&connection_device, input, size) != size) {
+    if (tc_read(&dispatch_device, input, size) != size) {
+        if (verbosity >= MC_ERROR) {
+            message_publish(MSG_ERROR, "Monte [%s:%d] Lost connection to Master while receiving new run.\nShutting down.\n",
+                            machine_name.c_str(), slave_id) ;
+        }
+        slave_shutdown();
+    }
+    /** <li> Read the binary values. */
+    unsigned int num_values = 0;
+    std::string values;
+    bool received = false;
+    if (tc_read(&dispatch_device, (char *)&num_values, (int)sizeof(num_values)) == (int)sizeof(num_values)) {
+        num_values = ntohl(num_values);
+        values.resize(num_values * 12);
+        received = (num_values == 0 || tc_read(&dispatch_device, &values[0], (int)values.length()) == (int)values.length());
+    }
+    if (!received) {
         if (verbosity >= MC_ERROR) {
             message_publish(MSG_ERROR, "Monte [%s:%d] Lost connection to Master while receiving new run.\nShutting down.\n",
                             machine_name.c_str(), slave_id) ;
         }
         slave_shutdown();
     }
-    tc_disconnect(&connection_device);
 
     /**
      * <li> fork() a child process to execute the simulation.
@@ -45,64 +67,48 @@ int Trick::MonteCarlo::slave_process_run() {
                             machine_name.c_str(), slave_id) ;
         }
         slave_shutdown();
-    /** <li>Parent process: */
+    /**
+     * <li>Parent process: Remember which worker the child is running for and go back to waiting for the master.
+     * The child is reaped by #slave_reap_runs.
+     */
     } else if (pid != 0) {
-        int return_value = 0 ;
-        /** <li> Wait for the child to finish. */
-        if (waitpid(pid, &return_value, 0) == -1) {
-            /* (Alex) On the Mac this check gives a lot of false positives.  I've commented out the code for now. */
-            /*
-            if (verbosity >= MC_ERROR) {
-                message_publish(MSG_ERROR, "Monte [%s:%d] Error while waiting for run to finish.\nShutting down.\n",
-                                machine_name.c_str(), slave_id) ;
-            }
-            slave_shutdown();
-            */
-        }
-
-        if (WIFEXITED(return_value)) {
-            // A successful sim sends its exit status to the master itself in
-            // its shutdown job. Users can subvert this by calling exit, in
-            // which case the master will eventually deem this run to have
-            // timed out. But who would do that?!
-            return 0;
-        }
-
-        int signal = WTERMSIG(return_value);
-        /** <li> Extract the exit status of the child. */
-        MonteRun::ExitStatus exit_status = signal == SIGALRM ? MonteRun::MC_RUN_TIMED_OUT : MonteRun::MC_RUN_DUMPED_CORE;
-        if (verbosity >= MC_ERROR) {
-            message_publish(MSG_ERROR, "Monte [%s:%d] Run killed by signal %d: %s\n",
-                            machine_name.c_str(), slave_id, signal, strsignal(signal)) ;
-        }
-        connection_device.port = master_port;
-        if (tc_connect(&connection_device) != TC_SUCCESS) {
-            if (verbosity >= MC_ERROR) {
-                message_publish(MSG_ERROR, "Monte [%s:%d] Lost connection to Master before results could be returned.\nShutting down.\n",
-                                machine_name.c_str(), slave_id) ;
-            }
-            slave_shutdown();
-        }
-        if (verbosity >= MC_ALL) {
-            message_publish(MSG_INFO, "Monte [%s:%d] Sending run exit status to master %d.\n",
-                            machine_name.c_str(), slave_id, exit_status) ;
-        }
-        /** <li> Write the slaves id to the master. </ul> */
-        int id = htonl(slave_id);
-        tc_write(&connection_device, (char *)&id, (int)sizeof(id));
-        /** <li> Write the child's exit status to the master. </ul> */
-        return_value = htonl(exit_status);
-        tc_write(&connection_device, (char *)&return_value, (int)sizeof(return_value));
-        tc_disconnect(&connection_device);
+        slave_children[pid] = worker_id;
+        delete [] input;
         return 0;
     /** <li> Child process: */
     } else {
+        /**
+         * <ul><li> Close the parent's sockets without shutting them down, and report as the worker
+         * the run was dispatched to.
+         */
+        close(dispatch_device.socket);
+        close(listen_device.socket);
+        dispatch_device.socket = TRICKCOMM_INVALID_SOCKET;
+        listen_device.socket = TRICKCOMM_INVALID_SOCKET;
+        slave_children.clear();
+        slave_id = worker_id;
+#if __linux
+        /** <li> Bind the run to its CPU. */
+        if (cpu >= 0) {
+            cpu_set_t cpu_set;
+            CPU_ZERO(&cpu_set);
+            CPU_SET(cpu, &cpu_set);
+            sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+        }
+#else
+        (void)cpu;
+#endif
+
         input[size] = '\0';
-        if ( ip_parse(input) != 0 ) {
+        /** <li> Assign the binary values, then parse the rest of the run's parameterization. */
+        std::string python;
+        std::string fallback;
+        slave_apply_binary_values(values.data(), num_values, python, fallback);
+        if ( ip_parse((fallback + input).c_str()) != 0 ) {
             exit(MonteRun::MC_PROBLEM_PARSING_INPUT);
         }
 
-        /** <ul><li> Create the run directory. */
+        /** <li> Create the run directory. */
         std::string output_dir = command_line_args_get_output_dir();
         if (access(output_dir.c_str(), F_OK) != 0) {
             if (mkdir(output_dir.c_str(), 0775) == -1) {
@@ -122,7 +128,7 @@ int Trick::MonteCarlo::slave_process_run() {
         fprintf(fp, "else:\n");
         fprintf(fp, "    execfile(\"%s\")\n\n", command_line_args_get_input_file());
         fprintf(fp, "trick.mc_set_enabled(0)\n");
-        fprintf(fp, "%s" , input);
+        fprintf(fp, "%s%s" , python.c_str(), input);
         fclose(fp);
         delete [] input;
 
@@ -151,3 +157,72 @@ int Trick::MonteCarlo::slave_process_run() {
     }
     return 0;
 }
+
+/**
+ * @par Detailed Design:
+ * Polls so that finished runs are reaped and reported while the master is idle.
+ */
+void Trick::MonteCarlo::slave_wait_for_master(int socket) {
+    struct pollfd poll_fd;
+    poll_fd.fd = socket;
+    poll_fd.events = POLLIN;
+    while (true) {
+        slave_reap_runs();
+        poll_fd.revents = 0;
+        int ready = poll(&poll_fd, 1, slave_children.empty() ? -1 : 100);
+        if (ready > 0 || (ready < 0 && errno != EINTR)) {
+            return;
+        }
+    }
+}
+
+/** @par Detailed Design: */
+void Trick::MonteCarlo::slave_reap_runs() {
+    std::map<pid_t, unsigned int>::iterator it = slave_children.begin();
+    /** <ul><li> For each running child: */
+    while (it != slave_children.end()) {
+        int return_value = 0;
+        pid_t pid = it->first;
+        unsigned int worker_id = it->second;
+        if (waitpid(pid, &return_value, WNOHANG) == 0) {
+            ++it;
+            continue;
+        }
+        slave_children.erase(it++);
+
+        if (WIFEXITED(return_value)) {
+            // A successful sim sends its exit status to the master itself in
+            // its shutdown job. Users can subvert this by calling exit, in
+            // which case the master will eventually deem this run to have
+            // timed out. But who would do that?!
+            continue;
+        }
+
+        int signal = WTERMSIG(return_value);
+        /** <li> Extract the exit status of the child. */
+        MonteRun::ExitStatus exit_status = signal == SIGALRM ? MonteRun::MC_RUN_TIMED_OUT : MonteRun::MC_RUN_DUMPED_CORE;
+        if (verbosity >= MC_ERROR) {
+            message_publish(MSG_ERROR, "Monte [%s:%d] Run killed by signal %d: %s\n",
+                            machine_name.c_str(), worker_id, signal, strsignal(signal)) ;
+        }
+        connection_device.port = master_port;
+        if (tc_connect(&connection_device) != TC_SUCCESS) {
+            if (verbosity >= MC_ERROR) {
+                message_publish(MSG_ERROR, "Monte [%s:%d] Lost connection to Master before results could be returned.\nShutting down.\n",
+                                machine_name.c_str(), worker_id) ;
+            }
+            slave_shutdown();
+        }
+        if (verbosity >= MC_ALL) {
+            message_publish(MSG_INFO, "Monte [%s:%d] Sending run exit status to master %d.\n",
+                            machine_name.c_str(), worker_id, exit_status) ;
+        }
+        /** <li> Write the worker's id to the master. */
+        int id = htonl(worker_id);
+        tc_write(&connection_device, (char *)&id, (int)sizeof(id));
+        /** <li> Write the child's exit status to the master. </ul> */
+        return_value = htonl(exit_status);
+        tc_write(&connection_device, (char *)&return_value, (int)sizeof(return_value));
+        tc_disconnect(&connection_device);
+    }
+}
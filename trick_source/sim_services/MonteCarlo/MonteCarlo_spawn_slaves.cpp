@@ -70,10 +70,28 @@ void Trick::MonteCarlo::initialize_slave(Trick::MonteSlave* slave_to_init) {
     }
     /** <li> Set the slave's state to MC_INITIALIZING. */
     slave_to_init->state = MonteSlave::MC_INITIALIZING;
+    /** <li> Add the workers that share the slave's process. */
+    add_workers(slave_to_init);
     /** <li> Make the system call to execute the shell. */
     system(buffer.c_str());
 }
 
+/**
+ * @par Detailed Design:
+ * Each worker is a slave without a process of its own. It becomes ready when its host reports in, and its runs are
+ * dispatched to the host, which executes them concurrently with the host's own.
+ */
+void Trick::MonteCarlo::add_workers(Trick::MonteSlave* slave) {
+    for (unsigned int i = 1; i < slave->num_workers; ++i) {
+        MonteSlave *worker = new MonteSlave(slave->machine_name);
+        worker->host_id = slave->id;
+        worker->multiplier = slave->multiplier;
+        worker->cpu_num = slave->cpu_num < 0 ? -1 : slave->cpu_num + (int)i;
+        worker->state = MonteSlave::MC_INITIALIZING;
+        add_slave(worker);
+    }
+}
+
 void Trick::MonteCarlo::default_slave_dispatch_pre_text(Trick::MonteSlave* slave_to_init, std::string &buffer) {
     /** <ul><li> If the slave is running locally, use a local shell. */
     if (!localhost_as_remote &&
@@ -0,0 +1,169 @@
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+
+#include "trick/MonteResult.hh"
+
+/* Magnitudes below this are counted as zero. */
+static const double zero_magnitude = 1.0e-300;
+
+Trick::MonteResult::MonteResult(std::string in_name, std::string in_unit) :
+    name(in_name),
+    unit(in_unit),
+    count(0),
+    num_missing(0),
+    num_infinite(0),
+    mean(0.0),
+    min(0.0),
+    max(0.0),
+    relative_accuracy(0.01),
+    histogram_lower(0.0),
+    histogram_upper(0.0),
+    histogram_underflow(0),
+    histogram_overflow(0),
+    m2(0.0),
+    zero_count(0) {}
+
+void Trick::MonteResult::set_histogram(double lower, double upper, unsigned int num_bins) {
+    histogram_lower = lower;
+    histogram_upper = upper;
+    histogram.assign(upper > lower ? num_bins : 0, 0);
+    histogram_underflow = 0;
+    histogram_overflow = 0;
+}
+
+/**
+ * @par Detailed Design:
+ * The mean and variance are updated with Welford's method, which does not lose precision when the values are large
+ * compared to their spread.
+ */
+void Trick::MonteResult::add_value(double value) {
+    if (std::isnan(value)) {
+        ++num_missing;
+        return;
+    }
+    /* An infinite value has no bucket, and would make the mean and variance infinite or NaN. */
+    if (std::isinf(value)) {
+        ++num_infinite;
+        return;
+    }
+    /** <ul><li> Update the count, extrema, mean, and sum of squared differences. */
+    ++count;
+    if (count == 1) {
+        min = max = value;
+    } else if (value < min) {
+        min = value;
+    } else if (value > max) {
+        max = value;
+    }
+    double delta = value - mean;
+    mean += delta / count;
+    m2 += delta * (value - mean);
+
+    /** <li> Count the value in its quantile bucket. */
+    double magnitude = std::fabs(value);
+    if (magnitude < zero_magnitude) {
+        ++zero_count;
+    } else if (value > 0) {
+        ++positive_buckets[bucket_of(magnitude)];
+    } else {
+        ++negative_buckets[bucket_of(magnitude)];
+    }
+
+    /** <li> Count the value in its histogram bin. </ul> */
+    if (!histogram.empty()) {
+        double bin = std::floor((value - histogram_lower) / (histogram_upper - histogram_lower) * histogram.size());
+        if (bin < 0) {
+            ++histogram_underflow;
+        } else if (bin >= histogram.size()) {
+            ++histogram_overflow;
+        } else {
+            ++histogram[(size_t)bin];
+        }
+    }
+}
+
+double Trick::MonteResult::get_variance() {
+    return count > 1 ? m2 / (count - 1) : 0.0;
+}
+
+double Trick::MonteResult::get_standard_deviation() {
+    return std::sqrt(get_variance());
+}
+
+/* Bucket i holds the magnitudes in (gamma^(i-1), gamma^i]. */
+int Trick::MonteResult::bucket_of(double magnitude) {
+    double gamma = (1.0 + relative_accuracy) / (1.0 - relative_accuracy);
+    return (int)std::ceil(std::log(magnitude) / std::log(gamma));
+}
+
+double Trick::MonteResult::bucket_value(int bucket) {
+    double gamma = (1.0 + relative_accuracy) / (1.0 - relative_accuracy);
+    return 2.0 * std::pow(gamma, bucket) / (gamma + 1.0);
+}
+
+/**
+ * @par Detailed Design:
+ * The buckets are walked from the most negative value upward until the rank of the quantile is reached.
+ */
+double Trick::MonteResult::get_quantile(double quantile) {
+    if (count == 0) {
+        return 0.0;
+    }
+    if (quantile <= 0.0) {
+        return min;
+    }
+    if (quantile >= 1.0) {
+        return max;
+    }
+    unsigned long long rank = (unsigned long long)(quantile * (count - 1));
+    unsigned long long seen = 0;
+    double value = max;
+    bool found = false;
+    for (std::map<int, unsigned long long>::reverse_iterator it = negative_buckets.rbegin();
+      !found && it != negative_buckets.rend(); ++it) {
+        seen += it->second;
+        if (seen > rank) {
+            value = -bucket_value(it->first);
+            found = true;
+        }
+    }
+    if (!found) {
+        seen += zero_count;
+        if (seen > rank) {
+            value = 0.0;
+            found = true;
+        }
+    }
+    for (std::map<int, unsigned long long>::iterator it = positive_buckets.begin();
+      !found && it != positive_buckets.end(); ++it) {
+        seen += it->second;
+        if (seen > rank) {
+            value = bucket_value(it->first);
+            found = true;
+        }
+    }
+    /* The representative value of an end bucket may lie past the extrema. */
+    return value < min ? min : value > max ? max : value;
+}
+
+std::string Trick::MonteResult::describe_result() {
+    std::stringstream ss;
+    ss << std::setprecision(10)
+       << name << (unit.empty() ? "" : " (" + unit + ")") << "\n"
+       << "    count: " << count << "  missing: " << num_missing << "  infinite: " << num_infinite << "\n"
+       << "    mean: " << mean << "  std dev: " << get_standard_deviation() << "\n"
+       << "    min: " << min << "  max: " << max << "\n"
+       << "    5%: " << get_quantile(0.05) << "  median: " << get_quantile(0.5)
+       << "  95%: " << get_quantile(0.95) << "\n";
+    if (!histogram.empty()) {
+        double width = (histogram_upper - histogram_lower) / histogram.size();
+        ss << "    histogram:\n";
+        for (std::vector<unsigned long long>::size_type i = 0; i < histogram.size(); ++i) {
+            ss << "        [" << histogram_lower + i * width << ", " << histogram_lower + (i + 1) * width << "): "
+               << histogram[i] << "\n";
+        }
+        ss << "        below: " << histogram_underflow << "  above: " << histogram_overflow << "\n";
+    }
+    return ss.str();
+}
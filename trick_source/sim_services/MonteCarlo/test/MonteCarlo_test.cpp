@@ -17,6 +17,7 @@
 #include "trick/MonteVarFile.hh"
 #include "trick/MonteVarFixed.hh"
 #include "trick/MonteVarRandom.hh"
+#include "trick/MonteResult.hh"
 #include "trick/montecarlo_c_intf.h"
 #include "trick/exec_proto.h"
 #include "trick/exec_proto.hh"
@@ -883,4 +884,88 @@ TEST_F(MonteCarloTest, MonteVarRandom_StlGaussian_setSeed_TakesEffect) {
 
 #endif // _HAVE_TR1_RANDOM or _HAVE_STL_RANDOM
 
+TEST_F(MonteCarloTest, MonteResult_Statistics) {
+    Trick::MonteResult result("x") ;
+    result.set_histogram(0.0, 1000.0, 10) ;
+    for (int ii = 1; ii <= 1000; ++ii) {
+        result.add_value(ii) ;
+    }
+    result.add_value(NAN) ;
+
+    EXPECT_EQ(result.count, 1000u) ;
+    EXPECT_EQ(result.num_missing, 1u) ;
+    EXPECT_DOUBLE_EQ(result.min, 1.0) ;
+    EXPECT_DOUBLE_EQ(result.max, 1000.0) ;
+    EXPECT_NEAR(result.mean, 500.5, 1e-9) ;
+    EXPECT_NEAR(result.get_variance(), 1000.0 * 1001.0 / 12.0, 1e-6) ;
+    EXPECT_NEAR(result.get_quantile(0.5), 500.0, 500.0 * result.relative_accuracy * 2) ;
+    EXPECT_NEAR(result.get_quantile(0.95), 950.0, 950.0 * result.relative_accuracy * 2) ;
+    EXPECT_DOUBLE_EQ(result.get_quantile(0.0), 1.0) ;
+    EXPECT_DOUBLE_EQ(result.get_quantile(1.0), 1000.0) ;
+    EXPECT_EQ(result.histogram[0], 99u) ;
+    EXPECT_EQ(result.histogram[9], 100u) ;
+    EXPECT_EQ(result.histogram_underflow, 0u) ;
+    EXPECT_EQ(result.histogram_overflow, 1u) ;
+
+    Trick::MonteResult duplicate("x") ;
+    exec.add_result(&result) ;
+    exec.add_result(&duplicate) ;
+    EXPECT_EQ(exec.get_results().size(), 1u) ;
+    EXPECT_EQ(exec.get_result("x"), &result) ;
+}
+
+TEST_F(MonteCarloTest, MonteResult_InfiniteValues) {
+    Trick::MonteResult result("x") ;
+    result.set_histogram(0.0, 10.0, 10) ;
+    result.add_value(INFINITY) ;
+    for (int ii = 1; ii <= 9; ++ii) {
+        result.add_value(ii) ;
+    }
+    result.add_value(-INFINITY) ;
+    result.add_value(NAN) ;
+
+    EXPECT_EQ(result.count, 9u) ;
+    EXPECT_EQ(result.num_infinite, 2u) ;
+    EXPECT_EQ(result.num_missing, 1u) ;
+    EXPECT_DOUBLE_EQ(result.min, 1.0) ;
+    EXPECT_DOUBLE_EQ(result.max, 9.0) ;
+    EXPECT_NEAR(result.mean, 5.0, 1e-9) ;
+    EXPECT_NEAR(result.get_variance(), 7.5, 1e-9) ;
+    EXPECT_NEAR(result.get_quantile(0.5), 5.0, 5.0 * result.relative_accuracy * 2) ;
+    EXPECT_EQ(result.histogram[0], 0u) ;
+    EXPECT_EQ(result.histogram[9], 1u) ;
+}
+
+TEST_F(MonteCarloTest, MonteResult_HistogramBounds) {
+    Trick::MonteResult result("x") ;
+    result.set_histogram(0.0, 10.0, 10) ;
+    result.add_value(-5.0) ;
+    result.add_value(-0.5) ;
+    result.add_value(0.0) ;
+    result.add_value(9.5) ;
+    result.add_value(10.0) ;
+    result.add_value(50.0) ;
+
+    EXPECT_EQ(result.count, 6u) ;
+    EXPECT_EQ(result.histogram_underflow, 2u) ;
+    EXPECT_EQ(result.histogram_overflow, 2u) ;
+    EXPECT_EQ(result.histogram[0], 1u) ;
+    EXPECT_EQ(result.histogram[9], 1u) ;
+    EXPECT_NE(result.describe_result().find("below: 2  above: 2"), std::string::npos) ;
+
+    result.set_histogram(0.0, 10.0, 10) ;
+    EXPECT_EQ(result.histogram_underflow, 0u) ;
+    EXPECT_EQ(result.histogram_overflow, 0u) ;
+}
+
+TEST_F(MonteCarloTest, MonteResult_NegativeQuantiles) {
+    Trick::MonteResult result("x") ;
+    for (int ii = -500; ii < 500; ++ii) {
+        result.add_value(ii) ;
+    }
+    EXPECT_NEAR(result.get_quantile(0.1), -400.0, 400.0 * result.relative_accuracy * 2) ;
+    EXPECT_NEAR(result.get_quantile(0.5), 0.0, 1.0) ;
+    EXPECT_NEAR(result.get_quantile(0.9), 399.0, 399.0 * result.relative_accuracy * 2) ;
+}
+
 }
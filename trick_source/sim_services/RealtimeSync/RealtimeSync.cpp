@@ -15,6 +15,7 @@ PROGRAMMERS:
 #include "trick/message_proto.h"
 #include "trick/message_type.h"
 #include "trick/TrickConstant.hh"
+#include "trick/TraceLog.hh"
 
 Trick::RealtimeSync * the_rts = NULL ;
 
@@ -281,6 +282,7 @@ int Trick::RealtimeSync::start_realtime(double in_frame_time , long long ref_tim
 int Trick::RealtimeSync::rt_monitor(long long sim_time_tics) {
 
     long long curr_clock_time ;
+    unsigned long long trace_start ;
     char buf[512];
 
     /* calculate the current underrun/overrun */
@@ -343,9 +345,12 @@ int Trick::RealtimeSync::rt_monitor(long long sim_time_tics) {
 
         /* stop the sleep timer in an overrun condition */
         sleep_timer->stop() ;
+        Trick::TraceLog::instant("realtime", "overrun") ;
 
         /* Call clock_spin to allow interrupt driven clocks to service their interrupts */
+        trace_start = Trick::TraceLog::start() ;
         curr_clock_time = rt_clock->clock_spin(sim_time_tics) ;
+        Trick::TraceLog::complete("realtime", "spin", trace_start) ;
 
     } else {
 
@@ -355,10 +360,14 @@ int Trick::RealtimeSync::rt_monitor(long long sim_time_tics) {
         frame_overrun_cnt = 0;
 
         /* pause for the timer to signal the end of frame */
+        trace_start = Trick::TraceLog::start() ;
         sleep_timer->pause() ;
+        Trick::TraceLog::complete("realtime", "sleep", trace_start) ;
 
         /* Spin to make sure that we are at the top of the frame */
+        trace_start = Trick::TraceLog::start() ;
         curr_clock_time = rt_clock->clock_spin(sim_time_tics) ;
+        Trick::TraceLog::complete("realtime", "spin", trace_start) ;
 
         /* If the timer requires to be reset at the end of each frame, reset it here. */
         sleep_timer->reset(exec_get_software_frame() / rt_clock->get_rt_clock_ratio()) ;
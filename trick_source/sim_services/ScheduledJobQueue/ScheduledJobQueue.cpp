@@ -3,6 +3,8 @@
 #include <sstream>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <algorithm>
 
 #include "trick/ScheduledJobQueue.hh"
 #include "trick/ScheduledJobQueueInstrument.hh"
@@ -11,16 +13,27 @@
 /**
 @design
 -# Set #list to NULL
--# Set #list_list to 0
+-# Set #list_list and #list_capacity to 0
 -# Set #curr_index to 0
 -# Set #next_job_time to TRICK_MAX_LONG_LONG
+-# Set #use_calendar to false
 */
 Trick::ScheduledJobQueue::ScheduledJobQueue( ) {
 
     list = NULL ;
     list_size = 0 ;
+    list_capacity = 0 ;
+    list_sorted = true ;
     curr_index = 0 ;
     next_job_time = TRICK_MAX_LONG_LONG ;
+    use_calendar = false ;
+    calendar_stale = true ;
+    calendar_time = 0 ;
+    calendar_due = NULL ;
+    calendar_due_time = 0 ;
+    calendar_due_pos = 0 ;
+    calendar_last = NULL ;
+    calendar_last_time = 0 ;
 
 }
 
@@ -36,84 +49,153 @@ Trick::ScheduledJobQueue::~ScheduledJobQueue( ) {
 
 /**
 @design
--# Allocate additional memory for the incoming job
+-# Returns true if job_a executes before job_b.  Jobs are ordered by the job_class, the phase,
+   the sim_object id, and the job_id in that order.
+*/
+bool Trick::ScheduledJobQueue::job_order( const JobData * job_a , const JobData * job_b ) {
+    if ( job_a->job_class != job_b->job_class ) {
+        return job_a->job_class < job_b->job_class ;
+    }
+    if ( job_a->phase != job_b->phase ) {
+        return job_a->phase < job_b->phase ;
+    }
+    if ( job_a->sim_object_id != job_b->sim_object_id ) {
+        return job_a->sim_object_id < job_b->sim_object_id ;
+    }
+    return job_a->id < job_b->id ;
+}
+
+/**
+@design
+-# If the list is full, double the allocated space.  The list is never shrunk.
+*/
+void Trick::ScheduledJobQueue::reserve( unsigned int num_jobs ) {
+
+    if ( num_jobs > list_capacity ) {
+        unsigned int new_capacity = ( list_capacity == 0 ) ? 16 : list_capacity ;
+        while ( new_capacity < num_jobs ) {
+            new_capacity *= 2 ;
+        }
+        list = (JobData **)realloc( list , new_capacity * sizeof(JobData *)) ;
+        list_capacity = new_capacity ;
+    }
+}
+
+/**
+@design
+-# Make room for the incoming job
 -# Find the insertion point in the queue based on the job_class, the phase,
-   the sim_object id, and the job_id
--# While searching for the correct insertion spot, copy all jobs that precede
-   the incoming job to the newly allocated queue space followed by the new job.
--# Copy jobs that are ordered after the incoming job to the new queue
+   the sim_object id, and the job_id.  The incoming job is placed before the first job
+   that executes after it.  If the list is known to be sorted this is a binary search.
+-# Shift jobs that are ordered after the incoming job down one place and insert the job.
 -# Increment the size of the queue.
 */
 int Trick::ScheduledJobQueue::push( JobData * new_job ) {
 
-    unsigned int ii , jj ;
+    unsigned int ii ;
 
-    /* Allocate additional memory for the additional job in the queue */
-    JobData ** new_list = (JobData **)calloc( list_size + 1 , sizeof(JobData *)) ;
+    reserve( list_size + 1 ) ;
 
     new_job->set_handled(true) ;
 
     /* Find the correct insertion spot in the queue by comparing
        the job_class, the phase, the sim_object id, and the job_id in that order. */
-    /* While searching for the correct insertion spot, copy all jobs that precede
-       the incoming job to the newly allocated queue space. */
-    for ( ii = jj = 0 ; ii < list_size ; ii++ ) {
-        if ( list[ii]->job_class == new_job->job_class ) {
-            if ( list[ii]->phase == new_job->phase ) {
-                if ( list[ii]->sim_object_id ==  new_job->sim_object_id ) {
-                    if ( list[ii]->id <= new_job->id ) {
-                        new_list[jj++] = list[ii] ;
-                    } else {
-                        new_list[jj++] = new_job ;
-                        break ;
-                    }
-                } else if ( list[ii]->sim_object_id < new_job->sim_object_id ) {
-                    new_list[jj++] = list[ii] ;
-                } else {
-                    new_list[jj++] = new_job ;
-                    break ;
-                }
-            } else if ( list[ii]->phase < new_job->phase ) {
-                new_list[jj++] = list[ii] ;
-            } else {
-                new_list[jj++] = new_job ;
+    if ( list_sorted ) {
+        ii = std::upper_bound( list , list + list_size , new_job , job_order ) - list ;
+    } else {
+        for ( ii = 0 ; ii < list_size ; ii++ ) {
+            if ( job_order( new_job , list[ii] ) ) {
                 break ;
             }
-        } else if ( list[ii]->job_class < new_job->job_class ) {
-            new_list[jj++] = list[ii] ;
-        } else {
-            new_list[jj++] = new_job ;
-            break ;
         }
     }
 
-    /* Copy remaining jobs that execute after the incoming job to the new queue space. */
-    if ( ii == list_size ) {
-        /* ii == list_size means the incoming job is the last job */
-        new_list[list_size] = new_job ;
-    } else {
+    if ( ii < list_size ) {
         /* Inserted new job before the current job. Increment curr_index to point to the correct job */
         if ( ii < curr_index ) {
             curr_index++ ;
         }
-        for ( ; ii < list_size ; ii++ ) {
-            new_list[jj++] = list[ii] ;
-        }
+        memmove( &list[ii + 1] , &list[ii] , (list_size - ii) * sizeof(JobData *)) ;
     }
+    list[ii] = new_job ;
 
     /* Increment the size of the queue */
     list_size++ ;
 
-    /* Free the old queue space */
+    /* Job indexes have shifted, the calendar must be rebuilt */
+    calendar_stale = true ;
+
+    return(0) ;
+
+}
+
+/**
+@design
+-# Add the incoming job to the batch.  The job is not in the list until batch_commit() is called.
+*/
+int Trick::ScheduledJobQueue::batch_push( JobData * new_job ) {
+    new_job->set_handled(true) ;
+    batch_list.push_back(new_job) ;
+    return(0) ;
+}
+
+/**
+@design
+-# If the list is not known to be sorted, push the batched jobs one at a time.
+-# Sort the batch once by the job_class, the phase, the sim_object id, and the job_id.
+   Batched jobs with the same ordering keep the order they were added.
+-# Merge the sorted batch with the list.  A batched job goes after all jobs in the list
+   that do not execute after it, the same place push() would put it.
+-# Increment #curr_index by the number of jobs inserted before the current job.
+-# Clear the batch.
+*/
+int Trick::ScheduledJobQueue::batch_commit() {
+
+    unsigned int ii , jj , kk ;
+    unsigned int new_curr_index ;
+    unsigned int batch_size = batch_list.size() ;
+    JobData ** new_list ;
+
+    if ( batch_size == 0 ) {
+        return(0) ;
+    }
+
+    if ( ! list_sorted ) {
+        for ( ii = 0 ; ii < batch_size ; ii++ ) {
+            push(batch_list[ii]) ;
+        }
+        batch_list.clear() ;
+        return(0) ;
+    }
+
+    std::stable_sort( batch_list.begin() , batch_list.end() , job_order ) ;
+
+    new_list = (JobData **)malloc( (list_size + batch_size) * sizeof(JobData *)) ;
+    new_curr_index = curr_index ;
+    for ( ii = jj = kk = 0 ; ii < list_size or jj < batch_size ; kk++ ) {
+        if ( jj < batch_size and ( ii == list_size or job_order( batch_list[jj] , list[ii] ))) {
+            if ( ii < curr_index ) {
+                new_curr_index++ ;
+            }
+            new_list[kk] = batch_list[jj++] ;
+        } else {
+            new_list[kk] = list[ii++] ;
+        }
+    }
+
     if ( list ) {
         free(list) ;
     }
-
-    /* Assign the queue pointer to the new space */
     list = new_list ;
+    list_size += batch_size ;
+    list_capacity = list_size ;
+    curr_index = new_curr_index ;
+    batch_list.clear() ;
 
-    return(0) ;
+    /* Job indexes have shifted, the calendar must be rebuilt */
+    calendar_stale = true ;
 
+    return(0) ;
 }
 
 /**
@@ -135,6 +217,8 @@ int Trick::ScheduledJobQueue::push_ignore_sim_object( JobData * new_job ) {
     ret = push(new_job) ;
     /* restore the original sim_object id */
     new_job->sim_object_id = save_sim_object_id ;
+    /* the list is no longer sorted by the jobs' own sim_object ids */
+    list_sorted = false ;
     return(ret) ;
 }
 
@@ -142,39 +226,25 @@ int Trick::ScheduledJobQueue::push_ignore_sim_object( JobData * new_job ) {
 @design
 -# Traverse the list of jobs looking for the job to delete.
  -# If the job to delete is found
-  -# Allocate a new list that holds 1 less job than the current list
-  -# Copy all of the jobs that precede the deleted job to the new list
-  -# Copy all of the jobs that are after the delete job to the new list
+  -# Shift all of the jobs that are after the deleted job up one place
   -# Decrement the size of the list
-  -# Free the memory associated with the current list
-  -# Point the current list to the newly allocated list
 */
 int Trick::ScheduledJobQueue::remove( JobData * delete_job ) {
 
-    unsigned int ii , jj ;
+    unsigned int ii ;
 
     /* Find the job to delete in the queue. */
     for ( ii = 0 ; ii < list_size ; ii++ ) {
         if ( list[ii] == delete_job ) {
-            /* allocate a new list that holds one less element than the current list. */
-            JobData ** new_list = (JobData **)calloc( list_size - 1 , sizeof(JobData *)) ;
-            /* copy all of the jobs that are before the deleted job to the new list */
-            for ( jj = 0 ; jj < ii ; jj++ ) {
-                new_list[jj] = list[jj] ;
-            }
-            /* copy all of the jobs that are after the deleted job to the new list */
-            for ( jj = ii + 1 ; jj < list_size ; jj++ ) {
-                new_list[jj-1] = list[jj] ;
-            }
+            /* shift all of the jobs that are after the deleted job up one place */
+            memmove( &list[ii] , &list[ii + 1] , (list_size - ii - 1) * sizeof(JobData *)) ;
             if ( ii <= curr_index ) {
                 curr_index-- ;
             }
             /* Decrement the size of the queue */
             list_size-- ;
-            /* Free the old queue space */
-            free(list) ;
-            /* Assign the queue pointer to the new space */
-            list = new_list ;
+            /* Job indexes have shifted, the calendar must be rebuilt */
+            calendar_stale = true ;
             return 0 ;
         }
     }
@@ -231,7 +301,7 @@ bool Trick::ScheduledJobQueue::empty() {
 @design
 -# If #list is not NULL free it.
 -# Set #list to NULL
--# Set #list_list to 0
+-# Set #list_list and #list_capacity to 0
 -# Set #curr_index to 0
 -# Set #next_job_time to TRICK_MAX_LONG_LONG
 */
@@ -244,8 +314,15 @@ int Trick::ScheduledJobQueue::clear() {
     /* set all list variables to initial cleared values */
     list = NULL ;
     list_size = 0 ;
+    list_capacity = 0 ;
+    list_sorted = true ;
     curr_index = 0 ;
     next_job_time = TRICK_MAX_LONG_LONG ;
+    batch_list.clear() ;
+    calendar.clear() ;
+    calendar_system_jobs.clear() ;
+    calendar_due = calendar_last = NULL ;
+    calendar_stale = true ;
     return(0) ;
 }
 
@@ -310,12 +387,50 @@ Trick::JobData * Trick::ScheduledJobQueue::get_next_job() {
            set the overall job call time to the current job's next job call time.
         -# Increment the #curr_index.
 -# Return NULL when the end of the list is reached.
+-# If the calendar is in use only the jobs filed under the incoming time and the system jobs
+   are visited.  Rescheduled jobs are filed under their new next call time.
 */
 Trick::JobData * Trick::ScheduledJobQueue::find_next_job(long long time_tics ) {
 
     JobData * curr_job ;
     long long next_call ;
 
+    if ( use_calendar ) {
+        unsigned int ii ;
+
+        build_calendar() ;
+        /* Buckets for times that have already passed can never match again. */
+        if ( time_tics != calendar_time ) {
+            calendar.erase(calendar.begin(), calendar.lower_bound(time_tics)) ;
+            calendar_due = calendar_last = NULL ;
+            calendar_time = time_tics ;
+        }
+        /* Only the jobs filed under this time and the system jobs are visited. */
+        while ( (ii = calendar_find(time_tics)) < list_size ) {
+            curr_job = list[ii] ;
+            curr_index = ii + 1 ;
+            if ( ! curr_job->system_job_class ) {
+                next_call = curr_job->next_tics + curr_job->cycle_tics ;
+                if (next_call > curr_job->stop_tics) {
+                    curr_job->next_tics = TRICK_MAX_LONG_LONG ;
+                    calendar_due->first-- ;
+                } else if ( next_call != time_tics ) {
+                    curr_job->next_tics = next_call;
+                    calendar_due->first-- ;
+                    calendar_insert(next_call , ii) ;
+                }
+                if ( curr_job->next_tics <  next_job_time ) {
+                    next_job_time = curr_job->next_tics ;
+                }
+            }
+            if ( !curr_job->disabled ) {
+                return(curr_job) ;
+            }
+        }
+        curr_index = list_size ;
+        return(NULL) ;
+    }
+
     /* Search through the rest of the queue starting at curr_index looking for
        the next job with it's next execution time is equal to the current simulation time. */
     while (curr_index < list_size ) {
@@ -362,10 +477,27 @@ Trick::JobData * Trick::ScheduledJobQueue::find_next_job(long long time_tics ) {
         -# Return the current job if the job is enabled.
     -# Increment the #curr_index.
 -# Return NULL when the end of the list is reached.
+-# If the calendar is in use only the jobs filed under the incoming time and the system jobs
+   are visited.
 */
 Trick::JobData* Trick::ScheduledJobQueue::find_job(long long time_tics) {
     JobData * curr_job ;
 
+    if ( use_calendar ) {
+        unsigned int ii ;
+
+        build_calendar() ;
+        while ( (ii = calendar_find(time_tics)) < list_size ) {
+            curr_job = list[ii] ;
+            curr_index = ii + 1 ;
+            if (!curr_job->disabled) {
+                return(curr_job) ;
+            }
+        }
+        curr_index = list_size ;
+        return(NULL) ;
+    }
+
     /* Search through the rest of the queue starting at curr_index looking for             */
     /* the next job with it's next execution time is equal to the current simulation time. */
     while (curr_index < list_size) {
@@ -395,9 +527,41 @@ int Trick::ScheduledJobQueue::set_next_job_call_time(long long in_time) {
 @details
 -# Return the next_job_call_time in counts of tics/second
    Requirement [@ref r_exec_time_0]
+-# If the calendar is in use the earliest bucket still holding a job and the system jobs
+   are checked instead of the remainder of the list.
 */
 long long Trick::ScheduledJobQueue::get_next_job_call_time() {
     unsigned int temp_index = curr_index ;
+
+    if ( use_calendar ) {
+        std::map< long long , std::pair< unsigned int , std::vector< unsigned int > > >::iterator it ;
+        std::vector< unsigned int >::iterator vit ;
+
+        build_calendar() ;
+        /* The first bucket with jobs still due is the next non system call time.  Drop the
+           buckets that have been emptied along the way. */
+        it = calendar.begin() ;
+        while ( it != calendar.end() and it->first < next_job_time ) {
+            if ( it->second.first == 0 ) {
+                calendar_spares.push_back(std::vector< unsigned int >()) ;
+                calendar_spares.back().swap(it->second.second) ;
+                calendar.erase(it++) ;
+                calendar_due = calendar_last = NULL ;
+            } else {
+                next_job_time = it->first ;
+                break ;
+            }
+        }
+        /* System jobs set their own call times. Match the linear search, which looks at jobs
+           behind curr_index only if they are after the current time. */
+        for ( vit = calendar_system_jobs.begin() ; vit != calendar_system_jobs.end() ; ++vit ) {
+            long long next_tics = list[*vit]->next_tics ;
+            if ( next_tics < next_job_time and (*vit >= curr_index or next_tics > calendar_time) ) {
+                next_job_time = next_tics ;
+            }
+        }
+        return(next_job_time) ;
+    }
     while (temp_index < list_size ) {
         if ( list[temp_index]->next_tics <  next_job_time ) {
             next_job_time = list[temp_index]->next_tics ;
@@ -420,6 +584,149 @@ int Trick::ScheduledJobQueue::test_next_job_call_time(Trick::JobData * curr_job,
     return(0) ;
 }
 
+/**
+@details
+-# Sets #use_calendar to the incoming value
+-# Marks the calendar to be rebuilt before the next search
+*/
+int Trick::ScheduledJobQueue::set_calendar(bool yes_no) {
+    use_calendar = yes_no ;
+    calendar.clear() ;
+    calendar_system_jobs.clear() ;
+    calendar_due = calendar_last = NULL ;
+    calendar_stale = true ;
+    return(0) ;
+}
+
+/**
+@details
+-# Returns #use_calendar
+*/
+bool Trick::ScheduledJobQueue::get_calendar() {
+    return(use_calendar) ;
+}
+
+/**
+@details
+-# Marks the calendar to be rebuilt before the next search
+*/
+int Trick::ScheduledJobQueue::reschedule() {
+    calendar_stale = true ;
+    return(0) ;
+}
+
+/**
+@details
+-# Return if the calendar is not in use or is up to date
+-# Clear the calendar
+-# For all jobs in the list
+    -# If the job is a system job, add it to the system job list.
+    -# Else if the job has a next call time, file it under that time.
+*/
+void Trick::ScheduledJobQueue::build_calendar() {
+
+    unsigned int ii ;
+
+    if ( ! use_calendar or ! calendar_stale ) {
+        return ;
+    }
+
+    calendar.clear() ;
+    calendar_system_jobs.clear() ;
+    calendar_due = calendar_last = NULL ;
+    for ( ii = 0 ; ii < list_size ; ii++ ) {
+        if ( list[ii]->system_job_class ) {
+            calendar_system_jobs.push_back(ii) ;
+        } else if ( list[ii]->next_tics != TRICK_MAX_LONG_LONG ) {
+            std::pair< unsigned int , std::vector< unsigned int > > & bucket = calendar[list[ii]->next_tics] ;
+            bucket.first++ ;
+            bucket.second.push_back(ii) ;
+        }
+    }
+    calendar_stale = false ;
+}
+
+/**
+@details
+-# Insert the list index into the bucket for time_tics keeping the bucket in list order.
+   Jobs are rescheduled in list order so this is normally an append.  The last bucket
+   used is remembered as jobs of the same rate are rescheduled to the same time.
+*/
+void Trick::ScheduledJobQueue::calendar_insert(long long time_tics , unsigned int ii) {
+
+    if ( calendar_last == NULL or calendar_last_time != time_tics ) {
+        calendar_last = &calendar[time_tics] ;
+        calendar_last_time = time_tics ;
+        /* Reuse the storage of a bucket already emptied for a new time. */
+        if ( calendar_last->second.capacity() == 0 and ! calendar_spares.empty() ) {
+            calendar_last->second.swap(calendar_spares.back()) ;
+            calendar_last->second.clear() ;
+            calendar_spares.pop_back() ;
+        }
+    }
+
+    std::vector< unsigned int > & bucket = calendar_last->second ;
+    if ( bucket.empty() or bucket.back() < ii ) {
+        bucket.push_back(ii) ;
+    } else {
+        /* An index left behind from an earlier visit to this time may be reused. */
+        std::vector< unsigned int >::iterator it = std::lower_bound(bucket.begin(), bucket.end(), ii) ;
+        if ( *it != ii ) {
+            bucket.insert(it, ii) ;
+        }
+    }
+    calendar_last->first++ ;
+}
+
+/**
+@details
+-# Search the bucket for time_tics starting at #curr_index for a job still due at time_tics.
+   The position in the bucket is remembered between calls so a pass walks the bucket once.
+-# Search the system jobs starting at #curr_index for an earlier job due at time_tics.
+-# Return the lower of the two indexes, or #list_size if neither has a job due.
+*/
+unsigned int Trick::ScheduledJobQueue::calendar_find(long long time_tics) {
+
+    unsigned int found = list_size ;
+    std::vector< unsigned int >::iterator vit ;
+
+    if ( calendar_due == NULL or calendar_due_time != time_tics ) {
+        std::map< long long , std::pair< unsigned int , std::vector< unsigned int > > >::iterator it = calendar.find(time_tics) ;
+        calendar_due = ( it == calendar.end() ) ? NULL : &(it->second) ;
+        calendar_due_time = time_tics ;
+        calendar_due_pos = 0 ;
+    }
+
+    if ( calendar_due != NULL ) {
+        std::vector< unsigned int > & bucket = calendar_due->second ;
+        unsigned int pos = calendar_due_pos ;
+        /* Start over from a binary search if curr_index moved back behind the remembered position. */
+        if ( pos > bucket.size() or ( pos > 0 and bucket[pos - 1] >= curr_index ) ) {
+            pos = std::lower_bound(bucket.begin(), bucket.end(), curr_index) - bucket.begin() ;
+        }
+        while ( pos < bucket.size() and
+                ( bucket[pos] < curr_index or list[bucket[pos]]->next_tics != time_tics ) ) {
+            pos++ ;
+        }
+        calendar_due_pos = pos ;
+        if ( pos < bucket.size() ) {
+            found = bucket[pos] ;
+        }
+    }
+
+    if ( ! calendar_system_jobs.empty() ) {
+        for ( vit = std::lower_bound(calendar_system_jobs.begin(), calendar_system_jobs.end(), curr_index) ;
+              vit != calendar_system_jobs.end() and *vit < found ; ++vit ) {
+            if ( list[*vit]->next_tics == time_tics ) {
+                found = *vit ;
+                break ;
+            }
+        }
+    }
+
+    return(found) ;
+}
+
 // Executes the jobs in a queue.  saves and restores Trick::Executive::curr_job
 int Trick::ScheduledJobQueue::execute_all_jobs() {
     Trick::JobData * curr_job ;
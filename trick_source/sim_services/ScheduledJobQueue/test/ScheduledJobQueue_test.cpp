@@ -1,5 +1,7 @@
 
 #include <iostream>
+#include <sstream>
+#include <vector>
 #include <sys/types.h>
 #include <signal.h>
 
@@ -20,6 +22,49 @@ class ScheduledJobQueueTest : public ::testing::Test {
         virtual void SetUp() {}
         virtual void TearDown() {}
 
+        /* Fills queue with num_jobs jobs spread across sim objects.  Out of every 100 jobs 1 cycles
+           at 1000 Hz, 9 at 100 Hz, 30 at 10 Hz, and 60 at 1 Hz. */
+        void add_mixed_rate_jobs( Trick::ScheduledJobQueue & queue , unsigned int num_jobs ) {
+            for ( unsigned int ii = 0 ; ii < num_jobs ; ii++ ) {
+                std::ostringstream oss ;
+                long long cycle_tics ;
+                if ( ii % 100 < 1 ) {
+                    cycle_tics = 1000 ;
+                } else if ( ii % 100 < 10 ) {
+                    cycle_tics = 10000 ;
+                } else if ( ii % 100 < 40 ) {
+                    cycle_tics = 100000 ;
+                } else {
+                    cycle_tics = 1000000 ;
+                }
+                oss << "job_" << ii ;
+                Trick::JobData * job_ptr = new Trick::JobData(0, ii % 10 , "class_100", NULL,
+                 cycle_tics / 1000000.0 , oss.str()) ;
+                job_ptr->sim_object_id = ii / 10 ;
+                job_ptr->job_class = 100 + (ii % 3) ;
+                job_ptr->cycle_tics = cycle_tics ;
+                job_ptr->stop_tics = 1000000000 ;
+                queue.push(job_ptr) ;
+            }
+        }
+
+        /* Runs the queue for num_passes passes and returns the jobs called, each pass ends with a NULL. */
+        std::vector< Trick::JobData * > run_passes( Trick::ScheduledJobQueue & queue , unsigned int num_passes ) {
+            std::vector< Trick::JobData * > called ;
+            Trick::JobData * job_ptr ;
+            long long curr_time = 0 ;
+            for ( unsigned int ii = 0 ; ii < num_passes ; ii++ ) {
+                queue.reset_curr_index() ;
+                queue.set_next_job_call_time(1000000000) ;
+                while ( (job_ptr = queue.find_next_job(curr_time)) != NULL ) {
+                    called.push_back(job_ptr) ;
+                }
+                called.push_back(NULL) ;
+                curr_time = queue.get_next_job_call_time() ;
+            }
+            return called ;
+        }
+
 } ;
 
 TEST_F( ScheduledJobQueueTest , PushJobsbyJobOrder ) {
@@ -546,5 +591,173 @@ TEST_F( ScheduledJobQueueTest , InstrumentBeforeAll ) {
 
 }
 
+TEST_F( ScheduledJobQueueTest , CalendarMatchesLinear ) {
+
+    Trick::ScheduledJobQueue calendar_queue ;
+    Trick::JobData * job_ptr ;
+    std::vector< Trick::JobData * > linear_called , calendar_called ;
+
+    add_mixed_rate_jobs(sjq , 200) ;
+    add_mixed_rate_jobs(calendar_queue , 200) ;
+
+    // A system job sets its own next call time and is always checked.
+    job_ptr = new Trick::JobData(0, 2 , "system_class", NULL, 0.0 , "system_job") ;
+    job_ptr->sim_object_id = 1 ;
+    job_ptr->job_class = 101 ;
+    job_ptr->system_job_class = 1 ;
+    job_ptr->next_tics = 500 ;
+    sjq.push(job_ptr) ;
+    job_ptr = new Trick::JobData(*job_ptr) ;
+    calendar_queue.push(job_ptr) ;
+
+    calendar_queue.set_calendar(true) ;
+    EXPECT_TRUE( calendar_queue.get_calendar() ) ;
+    EXPECT_FALSE( sjq.get_calendar() ) ;
+
+    linear_called = run_passes(sjq , 2000) ;
+    calendar_called = run_passes(calendar_queue , 2000) ;
+
+    ASSERT_EQ( linear_called.size() , calendar_called.size() ) ;
+    for ( unsigned int ii = 0 ; ii < linear_called.size() ; ii++ ) {
+        if ( linear_called[ii] == NULL or calendar_called[ii] == NULL ) {
+            EXPECT_EQ( linear_called[ii] , calendar_called[ii] ) ;
+        } else {
+            EXPECT_EQ( linear_called[ii]->name , calendar_called[ii]->name ) ;
+        }
+    }
+}
+
+TEST_F( ScheduledJobQueueTest , CalendarReschedule ) {
+
+    Trick::JobData * job_ptr ;
+
+    sjq.set_calendar(true) ;
+    add_mixed_rate_jobs(sjq , 4) ;
+
+    // all jobs are due at time 0, then only the 1000 Hz job is due at time 1000
+    run_passes(sjq , 1) ;
+    EXPECT_EQ( sjq.get_next_job_call_time() , 1000 ) ;
+
+    // move a 100 Hz job ahead of everything else outside of find_next_job.
+    sjq.reset_curr_index() ;
+    while ( (job_ptr = sjq.get_next_job()) != NULL ) {
+        if ( ! job_ptr->name.compare("job_3") ) {
+            job_ptr->next_tics = 500 ;
+        }
+    }
+    sjq.reschedule() ;
+    sjq.set_next_job_call_time(1000000000) ;
+    EXPECT_EQ( sjq.get_next_job_call_time() , 500 ) ;
+
+    sjq.reset_curr_index() ;
+    job_ptr = sjq.find_next_job(500) ;
+    ASSERT_TRUE( job_ptr != NULL ) ;
+    EXPECT_STREQ( job_ptr->name.c_str() , "job_3") ;
+    EXPECT_TRUE( sjq.find_next_job(500) == NULL ) ;
+}
+
+TEST_F( ScheduledJobQueueTest , CalendarCallsEveryRate ) {
+
+    Trick::ScheduledJobQueue calendar_queue ;
+    Trick::ScheduledJobQueue * queues[2] = { &sjq , &calendar_queue } ;
+    Trick::JobData * job_ptr ;
+
+    add_mixed_rate_jobs(sjq , 4000) ;
+    add_mixed_rate_jobs(calendar_queue , 4000) ;
+    calendar_queue.set_calendar(true) ;
+
+    for ( unsigned int ii = 0 ; ii < 2 ; ii++ ) {
+        long long curr_time = 0 ;
+        unsigned int num_called = 0 ;
+        for ( unsigned int jj = 0 ; jj < 10000 ; jj++ ) {
+            queues[ii]->reset_curr_index() ;
+            queues[ii]->set_next_job_call_time(1000000000) ;
+            while ( (job_ptr = queues[ii]->find_next_job(curr_time)) != NULL ) {
+                num_called++ ;
+            }
+            curr_time = queues[ii]->get_next_job_call_time() ;
+        }
+        // each rate's jobs over 10 seconds
+        EXPECT_EQ( num_called , (unsigned int)(40 * 10000 + 360 * 1000 + 1200 * 100 + 2400 * 10) ) ;
+    }
 }
 
+TEST_F( ScheduledJobQueueTest , BatchMatchesPush ) {
+
+    Trick::ScheduledJobQueue batch_queue ;
+    std::vector< Trick::JobData * > jobs ;
+    Trick::JobData * job_ptr ;
+
+    // jobs with duplicate orderings, pushed in a scrambled order
+    for ( unsigned int ii = 0 ; ii < 300 ; ii++ ) {
+        std::ostringstream oss ;
+        unsigned int key = (ii * 7919) % 300 ;
+        oss << "job_" << ii ;
+        job_ptr = new Trick::JobData(0, key % 4 , "class_100", NULL, 1.0 , oss.str()) ;
+        job_ptr->sim_object_id = key / 20 ;
+        job_ptr->job_class = 100 + (key % 3) ;
+        job_ptr->phase = 60000 - (key % 2) ;
+        jobs.push_back(job_ptr) ;
+    }
+
+    // a list already holding jobs with a current index part of the way down
+    for ( unsigned int ii = 0 ; ii < 100 ; ii++ ) {
+        sjq.push(jobs[ii]) ;
+        batch_queue.push(jobs[ii]) ;
+    }
+    sjq.set_curr_index(50) ;
+    batch_queue.set_curr_index(50) ;
+
+    for ( unsigned int ii = 100 ; ii < jobs.size() ; ii++ ) {
+        sjq.push(jobs[ii]) ;
+        batch_queue.batch_push(jobs[ii]) ;
+    }
+    EXPECT_EQ( batch_queue.size() , (unsigned int)100 ) ;
+    batch_queue.batch_commit() ;
+
+    ASSERT_EQ( sjq.size() , batch_queue.size() ) ;
+    EXPECT_EQ( sjq.get_curr_index() , batch_queue.get_curr_index() ) ;
+    sjq.reset_curr_index() ;
+    batch_queue.reset_curr_index() ;
+    while ( (job_ptr = sjq.get_next_job()) != NULL ) {
+        EXPECT_EQ( job_ptr , batch_queue.get_next_job() ) ;
+    }
+
+    // removing jobs keeps the rest in order
+    sjq.remove(jobs[10]) ;
+    batch_queue.remove(jobs[10]) ;
+    EXPECT_EQ( sjq.remove(jobs[10]) , -1 ) ;
+    sjq.reset_curr_index() ;
+    batch_queue.reset_curr_index() ;
+    while ( (job_ptr = sjq.get_next_job()) != NULL ) {
+        EXPECT_EQ( job_ptr , batch_queue.get_next_job() ) ;
+    }
+}
+
+TEST_F( ScheduledJobQueueTest , BatchMatchesPushInSimObjectOrder ) {
+
+    Trick::ScheduledJobQueue batch_queue ;
+    std::vector< Trick::JobData * > jobs ;
+    Trick::JobData * job_ptr ;
+
+    // 50000 jobs from 5000 sim_objects added in sim_object order, like Executive::add_sim_object
+    for ( unsigned int ii = 0 ; ii < 50000 ; ii++ ) {
+        job_ptr = new Trick::JobData(0, ii % 10 , "class_100", NULL, 1.0 , "job") ;
+        job_ptr->sim_object_id = ii / 10 ;
+        job_ptr->job_class = 100 + (ii % 5) ;
+        jobs.push_back(job_ptr) ;
+    }
+
+    for ( unsigned int ii = 0 ; ii < jobs.size() ; ii++ ) {
+        sjq.push(jobs[ii]) ;
+        batch_queue.batch_push(jobs[ii]) ;
+    }
+    batch_queue.batch_commit() ;
+
+    ASSERT_EQ( sjq.size() , batch_queue.size() ) ;
+    while ( (job_ptr = sjq.get_next_job()) != NULL ) {
+        EXPECT_EQ( job_ptr , batch_queue.get_next_job() ) ;
+    }
+}
+
+}
@@ -1,6 +1,7 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <string.h>
 #include "trick/AttributesMap.hh"
 #include "trick/attributes.h"
 #include "trick/command_line_protos.h"
@@ -10,6 +11,44 @@ namespace Trick {
 AttributesMap * AttributesMap::pInstance = NULL ;
 }
 
+void Trick::AttributesMap::add_attr( std::string type , ATTRIBUTES * attr , const unsigned int * name_order ) {
+    NameOrder & entry = attr_to_name_order_map[attr] ;
+    name_to_attr_map[type] = attr ;
+    entry.order = name_order ;
+    entry.count = 0 ;
+    while ( attr[entry.count].name[0] != '\0' ) {
+        entry.count++ ;
+    }
+}
+
+ATTRIBUTES * Trick::AttributesMap::find_member( ATTRIBUTES * attr , const char * name ) {
+    std::map<ATTRIBUTES *, NameOrder>::iterator it = attr_to_name_order_map.find(attr) ;
+    if ( it == attr_to_name_order_map.end() ) {
+        for ( int ii = 0 ; attr[ii].name[0] != '\0' ; ii++ ) {
+            if ( ! strcmp(name, attr[ii].name) ) {
+                return &attr[ii] ;
+            }
+        }
+        return NULL ;
+    }
+    // lower bound so the first of two members with the same name is found
+    const unsigned int * order = it->second.order ;
+    unsigned int low = 0 ;
+    unsigned int high = it->second.count ;
+    while ( low < high ) {
+        unsigned int mid = low + (high - low) / 2 ;
+        if ( strcmp(attr[order[mid]].name, name) < 0 ) {
+            low = mid + 1 ;
+        } else {
+            high = mid ;
+        }
+    }
+    if ( low < it->second.count and ! strcmp(attr[order[low]].name, name) ) {
+        return &attr[order[low]] ;
+    }
+    return NULL ;
+}
+
 std::string & Trick::AttributesMap::replace_special_chars( std::string & str) {
 
     // escape &
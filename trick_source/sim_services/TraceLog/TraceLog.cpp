@@ -0,0 +1,383 @@
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <set>
+#if __linux
+#include <sys/syscall.h>
+#endif
+
+#include "trick/TraceLog.hh"
+#include "trick/exec_proto.hh"
+#include "trick/exec_proto.h"
+#include "trick/command_line_protos.h"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+
+Trick::TraceLog * the_tl = NULL ;
+
+bool Trick::TraceLog::active = false ;
+
+/* Name given to the instruments so they can be removed from the jobs. */
+static const char * instrument_name = "trick_instruments.trace_log" ;
+
+/* Every thread's buffer.  A thread creates its buffer with its first event.  Buffers are kept until the
+   process exits because their threads hold on to them. */
+static std::vector< Trick::TraceBuffer * > buffers ;
+static pthread_mutex_t buffers_mutex = PTHREAD_MUTEX_INITIALIZER ;
+static __thread Trick::TraceBuffer * thread_buffer = NULL ;
+
+/* The names of the traced jobs.  Loading a checkpoint deletes the jobs while their events may still be
+   waiting in a buffer, so the events point to these copies, which are kept until the process exits. */
+static std::set< std::string > job_names ;
+
+/**
+@details
+-# Round the size up to a power of two so positions wrap with a mask.
+-# Note the calling thread's id and name for the trace.
+*/
+Trick::TraceBuffer::TraceBuffer( unsigned int in_size ) :
+ named(false) ,
+ write_index(0) ,
+ dropped(0) ,
+ read_index(0) {
+
+    size = 2 ;
+    while ( size < in_size and size < 0x80000000 ) {
+        size <<= 1 ;
+    }
+    mask = size - 1 ;
+    events = new Trick::TraceEvent[size] ;
+
+#if __linux
+    char name[16] ;
+    tid = syscall(SYS_gettid) ;
+    if ( pthread_getname_np(pthread_self(), name, sizeof(name)) == 0 ) {
+        thread_name = name ;
+    }
+#else
+    static long next_tid = 1 ;
+    tid = __atomic_fetch_add(&next_tid, 1, __ATOMIC_RELAXED) ;
+#endif
+}
+
+Trick::TraceBuffer::~TraceBuffer() {
+    delete [] events ;
+}
+
+void Trick::TraceBuffer::pop( std::vector< Trick::TraceEvent > & out ) {
+    unsigned long long head = __atomic_load_n(&write_index, __ATOMIC_ACQUIRE) ;
+    unsigned long long tail = read_index ;
+    for ( ; tail != head ; tail++ ) {
+        out.push_back(events[tail & mask]) ;
+    }
+    __atomic_store_n(&read_index, tail, __ATOMIC_RELEASE) ;
+}
+
+Trick::TraceWriterThread::TraceWriterThread( Trick::TraceLog & in_trace_log ) :
+ Trick::ThreadBase("trace_writer") ,
+ stop(false) ,
+ trace_log(in_trace_log) {}
+
+/**
+@details
+-# Until told to stop, drain the buffers into the trace file every drain period.
+*/
+void * Trick::TraceWriterThread::thread_body() {
+    while ( ! __atomic_load_n(&stop, __ATOMIC_ACQUIRE) ) {
+        trace_log.drain() ;
+        usleep((useconds_t)(trace_log.drain_period * 1000000.0)) ;
+    }
+    return NULL ;
+}
+
+/**
+@details
+-# Jobs tagged TRK are traced in the trick_job category, all others in the job category.
+-# The events carry a copy of the job name that outlives the job.
+-# The start instrument runs after every other instrument before the job, the end instrument
+   before every other instrument after it.
+*/
+Trick::TraceInstrument::TraceInstrument( unsigned long long * in_start_time , Trick::JobData * in_target_job ,
+ bool in_start ) :
+ Trick::InstrumentBase(in_target_job) ,
+ start_time(in_start_time) ,
+ category(in_target_job->tags.count("TRK") ? "trick_job" : "job") ,
+ job_name(job_names.insert(in_target_job->name).first->c_str()) ,
+ start(in_start) {
+    name = instrument_name ;
+    phase = in_start ? 65535 : 0 ;
+}
+
+int Trick::TraceInstrument::call() {
+    if ( start ) {
+        *start_time = Trick::TraceLog::start() ;
+    } else {
+        Trick::TraceLog::complete(category, job_name, *start_time) ;
+    }
+    return 0 ;
+}
+
+Trick::TraceLog::TraceLog() :
+ enabled(false) ,
+ buffer_events(32768) ,
+ drain_period(0.01) ,
+ writer(*this) ,
+ fp(NULL) ,
+ trace_start(0) ,
+ events_written(false) {
+    the_tl = this ;
+}
+
+unsigned long long Trick::TraceLog::now() {
+    struct timespec tp ;
+    clock_gettime(CLOCK_MONOTONIC, &tp) ;
+    return (unsigned long long)tp.tv_sec * 1000000000ULL + tp.tv_nsec ;
+}
+
+void Trick::TraceLog::add_event( const char * category , const char * name , unsigned long long start ,
+ unsigned long long duration ) {
+
+    Trick::TraceBuffer * buffer = thread_buffer ;
+
+    if ( buffer == NULL ) {
+        if ( the_tl == NULL ) {
+            return ;
+        }
+        buffer = new Trick::TraceBuffer(the_tl->buffer_events) ;
+        pthread_mutex_lock(&buffers_mutex) ;
+        buffers.push_back(buffer) ;
+        pthread_mutex_unlock(&buffers_mutex) ;
+        thread_buffer = buffer ;
+    }
+
+    Trick::TraceEvent event = { name , category , start , duration } ;
+    buffer->push(event) ;
+}
+
+/* Write a string as a JSON string. */
+static void write_json_string( FILE * fp , const char * str ) {
+    fputc('"', fp) ;
+    for ( ; *str != '\0' ; str++ ) {
+        unsigned char ch = (unsigned char)*str ;
+        if ( ch == '"' or ch == '\\' ) {
+            fputc('\\', fp) ;
+            fputc(ch, fp) ;
+        } else if ( ch < 0x20 ) {
+            fprintf(fp, "\\u%04x", ch) ;
+        } else {
+            fputc(ch, fp) ;
+        }
+    }
+    fputc('"', fp) ;
+}
+
+/**
+@details
+-# Events are written as JSON objects in a JSON array, one object a line.
+-# Complete events carry their start and duration, instants only their time.  Times are in
+   microseconds from the creation of the trace file.
+*/
+void Trick::TraceLog::write_event( Trick::TraceBuffer * buffer , const Trick::TraceEvent & event ) {
+
+    fputs(events_written ? ",\n{\"name\":" : "{\"name\":", fp) ;
+    events_written = true ;
+    write_json_string(fp, event.name) ;
+    fputs(",\"cat\":", fp) ;
+    write_json_string(fp, event.category) ;
+    if ( event.duration == instant_event ) {
+        fprintf(fp, ",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":%d,\"tid\":%ld}",
+         (event.start - trace_start) / 1000.0, (int)getpid(), buffer->tid) ;
+    } else {
+        fprintf(fp, ",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%ld}",
+         (event.start - trace_start) / 1000.0, event.duration / 1000.0, (int)getpid(), buffer->tid) ;
+    }
+}
+
+/**
+@details
+-# Take a copy of the list of buffers so threads starting up are not held up by the writing.
+-# For each buffer with waiting events
+ -# Name the buffer's thread in the trace the first time
+ -# Write the events
+-# Flush the file so an interrupted sim leaves a readable trace
+*/
+void Trick::TraceLog::drain() {
+
+    std::vector< Trick::TraceBuffer * > current ;
+
+    pthread_mutex_lock(&buffers_mutex) ;
+    current = buffers ;
+    pthread_mutex_unlock(&buffers_mutex) ;
+
+    for ( unsigned int ii = 0 ; ii < current.size() ; ii++ ) {
+        Trick::TraceBuffer * buffer = current[ii] ;
+        drained.clear() ;
+        buffer->pop(drained) ;
+        if ( drained.empty() ) {
+            continue ;
+        }
+        if ( ! buffer->named ) {
+            fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%ld,\"args\":{\"name\":",
+             events_written ? ",\n" : "", (int)getpid(), buffer->tid) ;
+            write_json_string(fp, buffer->thread_name.empty() ? "thread" : buffer->thread_name.c_str()) ;
+            fputs("}}", fp) ;
+            events_written = true ;
+            buffer->named = true ;
+        }
+        for ( unsigned int jj = 0 ; jj < drained.size() ; jj++ ) {
+            write_event(buffer, drained[jj]) ;
+        }
+    }
+    fflush(fp) ;
+}
+
+/**
+@details
+-# If we are enabled already, return
+-# The first time tracing is turned on, create trace.json in the output directory and start the
+   writer thread
+-# Insert the trace instruments around every job except instrumentation jobs, which run only within
+   the jobs they instrument
+-# Set the active and enabled flags to true
+*/
+int Trick::TraceLog::trace_on() {
+
+    std::vector< Trick::JobData * > all_jobs ;
+
+    if ( enabled == true ) {
+        return(0) ;
+    }
+
+    if ( fp == NULL ) {
+        std::string file_name = std::string(command_line_args_get_output_dir()) + "/trace.json" ;
+        if ( (fp = fopen(file_name.c_str(), "w")) == NULL ) {
+            message_publish(MSG_ERROR, "Could not open %s for tracing\n", file_name.c_str()) ;
+            return(0) ;
+        }
+        fprintf(fp, "[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":", (int)getpid()) ;
+        write_json_string(fp, command_line_args_get_output_dir()) ;
+        fputs("}}", fp) ;
+        events_written = true ;
+        trace_start = now() ;
+        writer.stop = false ;
+        writer.create_thread() ;
+    }
+
+    remove_instruments() ;
+    exec_get_all_jobs_vector(all_jobs) ;
+    for ( unsigned int ii = 0 ; ii < all_jobs.size() ; ii++ ) {
+        Trick::JobData * job = all_jobs[ii] ;
+        if ( ! job->job_class_name.compare("instrumentation") ) {
+            continue ;
+        }
+        unsigned long long * start_time = new unsigned long long(0) ;
+        Trick::TraceInstrument * start_instrument = new Trick::TraceInstrument(start_time, job, true) ;
+        Trick::TraceInstrument * end_instrument = new Trick::TraceInstrument(start_time, job, false) ;
+        job->add_inst_before(start_instrument) ;
+        job->add_inst_after(end_instrument) ;
+        job_start_times.push_back(start_time) ;
+        instruments.push_back(start_instrument) ;
+        instruments.push_back(end_instrument) ;
+    }
+
+    __atomic_store_n(&active, true, __ATOMIC_RELAXED) ;
+    enabled = true ;
+    return(0) ;
+}
+
+/**
+@details
+-# If we are disabled already, return
+-# Stop adding events and remove the job instruments.  The writer keeps draining what is buffered.
+-# Set the enabled flag to false
+*/
+int Trick::TraceLog::trace_off() {
+
+    if ( enabled == false ) {
+        return(0) ;
+    }
+    __atomic_store_n(&active, false, __ATOMIC_RELAXED) ;
+    remove_instruments() ;
+    enabled = false ;
+    return(0) ;
+}
+
+void Trick::TraceLog::remove_instruments() {
+    // Removed by name from every job queue, so a target job is never looked up through an instrument.
+    if ( ! instruments.empty() ) {
+        exec_instrument_remove(instrument_name) ;
+    }
+    for ( unsigned int ii = 0 ; ii < instruments.size() ; ii++ ) {
+        delete instruments[ii] ;
+    }
+    instruments.clear() ;
+    for ( unsigned int ii = 0 ; ii < job_start_times.size() ; ii++ ) {
+        delete job_start_times[ii] ;
+    }
+    job_start_times.clear() ;
+}
+
+/**
+@details
+Loading a checkpoint deletes the jobs the instruments are inserted in.  The instruments are not
+checkpointed.
+
+-# Remove the instruments from the jobs by name while the jobs still exist
+*/
+int Trick::TraceLog::preload_checkpoint() {
+    remove_instruments() ;
+    return(0) ;
+}
+
+/**
+@details
+-# If tracing is on in the checkpoint, insert the instruments again and keep tracing
+-# Otherwise stop tracing
+*/
+int Trick::TraceLog::restart() {
+
+    if ( enabled == true ) {
+        enabled = false ;
+        trace_on() ;
+    } else {
+        __atomic_store_n(&active, false, __ATOMIC_RELAXED) ;
+    }
+    return(0) ;
+}
+
+/**
+@details
+-# If tracing was never on, return
+-# Stop adding events
+-# Stop the writer thread and drain the buffers a last time
+-# Report threads that dropped events because the writer fell behind
+-# Close the JSON array and the file
+*/
+int Trick::TraceLog::shutdown() {
+
+    if ( fp == NULL ) {
+        return(0) ;
+    }
+    __atomic_store_n(&active, false, __ATOMIC_RELAXED) ;
+
+    __atomic_store_n(&writer.stop, true, __ATOMIC_RELEASE) ;
+    pthread_join(writer.get_pthread_id(), NULL) ;
+    drain() ;
+
+    pthread_mutex_lock(&buffers_mutex) ;
+    for ( unsigned int ii = 0 ; ii < buffers.size() ; ii++ ) {
+        if ( buffers[ii]->get_dropped() != 0 ) {
+            message_publish(MSG_WARNING, "Trace dropped %llu events of thread %ld (%s).  Increase buffer_events or "
+             "decrease drain_period.\n", buffers[ii]->get_dropped(), buffers[ii]->tid, buffers[ii]->thread_name.c_str()) ;
+        }
+    }
+    pthread_mutex_unlock(&buffers_mutex) ;
+
+    fputs("\n]\n", fp) ;
+    fclose(fp) ;
+    fp = NULL ;
+    return(0) ;
+}
@@ -0,0 +1,33 @@
+#include <stdio.h>
+#include "trick/TraceLog.hh"
+
+/* Global singleton pointer to the trace log class */
+extern Trick::TraceLog * the_tl ;
+
+/*************************************************************************/
+/* These routines are the "C" interface to the trace log                 */
+/*************************************************************************/
+
+/**
+ * @relates Trick::TraceLog
+ * @copydoc Trick::TraceLog::trace_on
+ * C wrapper for Trick::TraceLog::trace_on
+ */
+extern "C" int trace_on(void) {
+    if (the_tl != NULL) {
+        return the_tl->trace_on() ;
+    }
+    return(0) ;
+}
+
+/**
+ * @relates Trick::TraceLog
+ * @copydoc Trick::TraceLog::trace_off
+ * C wrapper for Trick::TraceLog::trace_off
+ */
+extern "C" int trace_off(void) {
+    if (the_tl != NULL) {
+        return the_tl->trace_off() ;
+    }
+    return(0) ;
+}
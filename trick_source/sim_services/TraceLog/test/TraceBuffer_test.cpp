@@ -0,0 +1,104 @@
+
+#include <pthread.h>
+
+#include "gtest/gtest.h"
+#include "trick/TraceLog.hh"
+
+namespace Trick {
+
+class TraceBufferTest : public ::testing::Test {
+
+    protected:
+        Trick::TraceBuffer buffer ;
+        std::vector< Trick::TraceEvent > out ;
+
+        TraceBufferTest() : buffer(6) {}
+        ~TraceBufferTest() {}
+        virtual void SetUp() {}
+        virtual void TearDown() {}
+
+        static Trick::TraceEvent make_event( unsigned long long start ) {
+            Trick::TraceEvent event = { "event" , "test" , start , 1 } ;
+            return event ;
+        }
+} ;
+
+TEST_F(TraceBufferTest , EmptyBuffer) {
+    buffer.pop(out) ;
+    EXPECT_TRUE(out.empty()) ;
+    EXPECT_EQ(buffer.get_dropped(), 0u) ;
+}
+
+TEST_F(TraceBufferTest , EventsComeOutInOrder) {
+    // The size is rounded up to 8 events
+    for ( unsigned long long ii = 0 ; ii < 8 ; ii++ ) {
+        buffer.push(make_event(ii)) ;
+    }
+    buffer.pop(out) ;
+    ASSERT_EQ(out.size(), 8u) ;
+    for ( unsigned long long ii = 0 ; ii < 8 ; ii++ ) {
+        EXPECT_EQ(out[ii].start, ii) ;
+    }
+    EXPECT_EQ(buffer.get_dropped(), 0u) ;
+}
+
+TEST_F(TraceBufferTest , FullBufferDropsNewEvents) {
+    for ( unsigned long long ii = 0 ; ii < 11 ; ii++ ) {
+        buffer.push(make_event(ii)) ;
+    }
+    EXPECT_EQ(buffer.get_dropped(), 3u) ;
+    buffer.pop(out) ;
+    ASSERT_EQ(out.size(), 8u) ;
+    EXPECT_EQ(out.back().start, 7u) ;
+
+    // Popping makes room again
+    out.clear() ;
+    buffer.push(make_event(100)) ;
+    buffer.pop(out) ;
+    ASSERT_EQ(out.size(), 1u) ;
+    EXPECT_EQ(out[0].start, 100u) ;
+}
+
+TEST_F(TraceBufferTest , WrapsAround) {
+    for ( unsigned long long ii = 0 ; ii < 100 ; ii++ ) {
+        buffer.push(make_event(ii)) ;
+        buffer.push(make_event(ii + 1000)) ;
+        buffer.pop(out) ;
+    }
+    ASSERT_EQ(out.size(), 200u) ;
+    EXPECT_EQ(out[198].start, 99u) ;
+    EXPECT_EQ(out[199].start, 1099u) ;
+    EXPECT_EQ(buffer.get_dropped(), 0u) ;
+}
+
+static const unsigned long long num_pushed = 1000000 ;
+static bool pushing_done ;
+
+static void * push_events( void * arg ) {
+    Trick::TraceBuffer * buffer = (Trick::TraceBuffer *)arg ;
+    for ( unsigned long long ii = 0 ; ii < num_pushed ; ii++ ) {
+        Trick::TraceEvent event = { "event" , "test" , ii , 1 } ;
+        buffer->push(event) ;
+    }
+    __atomic_store_n(&pushing_done, true, __ATOMIC_RELEASE) ;
+    return NULL ;
+}
+
+TEST_F(TraceBufferTest , PopWhilePushing) {
+    // Every event pushed is either popped once, in order, or counted as dropped
+    Trick::TraceBuffer shared(1024) ;
+    pthread_t writer ;
+    pushing_done = false ;
+    pthread_create(&writer, NULL, push_events, &shared) ;
+    while ( ! __atomic_load_n(&pushing_done, __ATOMIC_ACQUIRE) ) {
+        shared.pop(out) ;
+    }
+    pthread_join(writer, NULL) ;
+    shared.pop(out) ;
+    EXPECT_EQ(out.size() + shared.get_dropped(), num_pushed) ;
+    for ( unsigned int ii = 1 ; ii < out.size() ; ii++ ) {
+        EXPECT_LT(out[ii - 1].start, out[ii].start) ;
+    }
+}
+
+}
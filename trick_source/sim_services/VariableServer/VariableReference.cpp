@@ -15,6 +15,7 @@ Trick::VariableReference::VariableReference(REF2 * in_ref ) {
 
     // VariableReference copy setup: set address & size to copy into buffer
     conversion_factor = cv_get_trivial() ;
+    needs_conversion = false ;
 
     ref = in_ref ;
     address = ref->address ;
@@ -24,6 +25,8 @@ Trick::VariableReference::VariableReference(REF2 * in_ref ) {
     // so we need to keep track that they are really string and wstring
     string_type = ref->attr->type ;
     need_deref = false ;
+    shared = NULL ;
+    shared_generation = 0 ;
 
     if ( ref->num_index == ref->attr->num_index ) {
         // single value
@@ -60,6 +63,8 @@ Trick::VariableReference::VariableReference(REF2 * in_ref ) {
     buffer_in  = calloc( size, 1 ) ;
     buffer_out = calloc( size, 1 ) ;
 
+    ascii_formatter = vs_ascii_formatter(this) ;
+
 
 }
 
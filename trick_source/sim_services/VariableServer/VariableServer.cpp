@@ -119,3 +119,7 @@ void Trick::VariableServer::set_copy_data_job( Trick::JobData * in_job ) {
 void Trick::VariableServer::set_copy_data_freeze_job( Trick::JobData * in_job ) {
     copy_data_freeze_job = in_job ;
 }
+
+Trick::VariableServerSnapshot & Trick::VariableServer::get_snapshot() {
+    return snapshot ;
+}
@@ -0,0 +1,240 @@
+
+#include <stdlib.h>
+#include <string.h>
+#include "trick/VariableServer.hh"
+#include "trick/VariableServerSnapshot.hh"
+
+Trick::VariableServerSnapshotEntry::VariableServerSnapshotEntry(REF2 * in_ref) :
+ name(in_ref->reference) ,
+ num_clients(0) ,
+ validate_address(false) ,
+ ref_generation(0) {
+
+    // The entry resolves its own copy of the reference.  Units belong to each client.
+    source = new VariableReference(copy_ref(in_ref, NULL)) ;
+    buffer_size = source->size ;
+
+    // The VariableReference buffers hold the values of the two snapshot buffers.
+    values[0] = source->buffer_in ;
+    values[1] = source->buffer_out ;
+    for ( unsigned int ii = 0 ; ii < 2 ; ii++ ) {
+        value_sizes[ii] = 0 ;
+        value_refs[ii] = NULL ;
+        value_generations[ii] = 0 ;
+        value_sequences[ii] = 0 ;
+    }
+}
+
+Trick::VariableServerSnapshotEntry::~VariableServerSnapshotEntry() {
+    free_ref(value_refs[0]) ;
+    free_ref(value_refs[1]) ;
+    // The VariableReference frees only the REF2 itself and its buffers.  The name is the entry's own.
+    free(source->ref->reference) ;
+    source->ref->reference = NULL ;
+    source->buffer_in = values[0] ;
+    source->buffer_out = values[1] ;
+    delete source ;
+}
+
+REF2 * Trick::VariableServerSnapshotEntry::copy_ref( REF2 * in_ref , char * in_units ) {
+    REF2 * new_ref = (REF2 *)malloc(sizeof(REF2)) ;
+    *new_ref = *in_ref ;
+    new_ref->reference = ( in_ref->reference != NULL ) ? strdup(in_ref->reference) : NULL ;
+    new_ref->units = in_units ;
+    return new_ref ;
+}
+
+void Trick::VariableServerSnapshotEntry::free_ref( REF2 * in_ref ) {
+    if ( in_ref != NULL ) {
+        free(in_ref->reference) ;
+        free(in_ref) ;
+    }
+}
+
+Trick::VariableServerSnapshot::VariableServerSnapshot() :
+ cycle(1) ,
+ refreshed_cycle(0) ,
+ published(0) ,
+ next_sequence(1) ,
+ cycles_skipped(0) {
+    for ( unsigned int ii = 0 ; ii < 2 ; ii++ ) {
+        readers[ii] = 0 ;
+        sequences[ii] = 0 ;
+        times[ii] = 0.0 ;
+    }
+    pthread_mutex_init(&snapshot_mutex, NULL);
+}
+
+Trick::VariableServerSnapshot::~VariableServerSnapshot() {
+    // Every entry is either pending or active until the sim thread deletes it.
+    unsigned int ii ;
+    for ( ii = 0 ; ii < pending.size() ; ii++ ) {
+        delete pending[ii] ;
+    }
+    for ( ii = 0 ; ii < active.size() ; ii++ ) {
+        delete active[ii] ;
+    }
+    pending.clear() ;
+    active.clear() ;
+    entries.clear() ;
+    pthread_mutex_destroy(&snapshot_mutex);
+}
+
+Trick::VariableServerSnapshotEntry * Trick::VariableServerSnapshot::subscribe( VariableReference * var ) {
+
+    VariableServerSnapshotEntry * entry ;
+    std::map < std::string , VariableServerSnapshotEntry * >::iterator it ;
+
+    pthread_mutex_lock(&snapshot_mutex) ;
+    it = entries.find(var->ref->reference) ;
+    if ( it != entries.end() ) {
+        entry = (*it).second ;
+        // A dynamic array may have been resized since the entry was made.  Copy it separately.
+        if ( entry->buffer_size != var->size ) {
+            pthread_mutex_unlock(&snapshot_mutex) ;
+            return NULL ;
+        }
+    } else {
+        entry = new VariableServerSnapshotEntry(var->ref) ;
+        entries[entry->name] = entry ;
+        pending.push_back(entry) ;
+    }
+    entry->num_clients++ ;
+    pthread_mutex_unlock(&snapshot_mutex) ;
+
+    return entry ;
+}
+
+void Trick::VariableServerSnapshot::unsubscribe( VariableServerSnapshotEntry * entry ) {
+
+    pthread_mutex_lock(&snapshot_mutex) ;
+    // The sim thread may be copying the entry, it deletes the entry when it sees no clients.
+    if ( --entry->num_clients == 0 ) {
+        entries.erase(entry->name) ;
+    }
+    pthread_mutex_unlock(&snapshot_mutex) ;
+}
+
+void Trick::VariableServerSnapshot::start_cycle() {
+    cycle++ ;
+}
+
+unsigned long long Trick::VariableServerSnapshot::get_cycle() {
+    return cycle ;
+}
+
+void Trick::VariableServerSnapshot::update_active() {
+
+    unsigned int ii , jj ;
+
+    active.insert(active.end(), pending.begin(), pending.end()) ;
+    pending.clear() ;
+    for ( ii = 0 , jj = 0 ; ii < active.size() ; ii++ ) {
+        if ( active[ii]->num_clients == 0 ) {
+            delete active[ii] ;
+        } else {
+            active[jj++] = active[ii] ;
+        }
+    }
+    active.resize(jj) ;
+}
+
+void Trick::VariableServerSnapshot::refresh( VariableServerThread * vst , double in_time ) {
+
+    unsigned int ii ;
+    unsigned int back ;
+    VariableServerSnapshotEntry * entry ;
+    REF2 * old_ref ;
+
+    if ( refreshed_cycle == cycle ) {
+        return ;
+    }
+    refreshed_cycle = cycle ;
+
+    // Pick up entries clients added or released.  A client holding the mutex delays this to a later cycle.
+    if ( pthread_mutex_trylock(&snapshot_mutex) == 0 ) {
+        update_active() ;
+        pthread_mutex_unlock(&snapshot_mutex) ;
+    }
+
+    // Only the sim thread changes published.  A client that counted itself as a reader of the back
+    // buffer before this check keeps it, a client counting itself after sees the buffer is no longer
+    // published and tries again.
+    back = 1 - published ;
+    if ( __atomic_load_n(&readers[back], __ATOMIC_SEQ_CST) != 0 ) {
+        cycles_skipped++ ;
+        return ;
+    }
+
+    for ( ii = 0 ; ii < active.size() ; ii++ ) {
+        entry = active[ii] ;
+        entry->source->buffer_in = entry->values[back] ;
+        old_ref = entry->source->ref ;
+        vst->copy_sim_variable(entry->source, entry->validate_address) ;
+        if ( entry->source->ref != old_ref ) {
+            entry->ref_generation++ ;
+        }
+        // No client reads this buffer, its copy of the reference can be replaced.
+        if ( entry->value_generations[back] != entry->ref_generation ) {
+            VariableServerSnapshotEntry::free_ref(entry->value_refs[back]) ;
+            entry->value_refs[back] = VariableServerSnapshotEntry::copy_ref(entry->source->ref, NULL) ;
+            entry->value_generations[back] = entry->ref_generation ;
+        }
+        entry->value_sizes[back] = entry->source->size ;
+        entry->value_sequences[back] = next_sequence ;
+    }
+    times[back] = in_time ;
+    sequences[back] = next_sequence++ ;
+    __atomic_store_n(&published, back, __ATOMIC_SEQ_CST) ;
+}
+
+unsigned int Trick::VariableServerSnapshot::acquire() {
+
+    unsigned int buffer ;
+
+    while (1) {
+        buffer = __atomic_load_n(&published, __ATOMIC_SEQ_CST) ;
+        __atomic_add_fetch(&readers[buffer], 1, __ATOMIC_SEQ_CST) ;
+        if ( __atomic_load_n(&published, __ATOMIC_SEQ_CST) == buffer ) {
+            return buffer ;
+        }
+        // The sim thread published the other buffer in between and may be filling this one.
+        __atomic_sub_fetch(&readers[buffer], 1, __ATOMIC_SEQ_CST) ;
+    }
+}
+
+void Trick::VariableServerSnapshot::release( unsigned int buffer ) {
+    __atomic_sub_fetch(&readers[buffer], 1, __ATOMIC_SEQ_CST) ;
+}
+
+unsigned long long Trick::VariableServerSnapshot::get_sequence( unsigned int buffer ) {
+    return sequences[buffer] ;
+}
+
+double Trick::VariableServerSnapshot::get_time( unsigned int buffer ) {
+    return times[buffer] ;
+}
+
+unsigned long long Trick::VariableServerSnapshot::get_cycles_skipped() {
+    return cycles_skipped ;
+}
+
+void Trick::VariableServerSnapshot::preload_checkpoint() {
+
+    unsigned int ii ;
+
+    // Clients are suspended, wait for the mutex so no new entry keeps an address into the old memory.
+    pthread_mutex_lock(&snapshot_mutex) ;
+    update_active() ;
+    pthread_mutex_unlock(&snapshot_mutex) ;
+
+    for ( ii = 0 ; ii < active.size() ; ii++ ) {
+        if ( active[ii]->source->ref->address != (char*)&VariableServerThread::bad_ref_int ) {
+            VariableServerThread::bad_ref_preload(active[ii]->source) ;
+        }
+    }
+}
+
+unsigned int Trick::VariableServerSnapshot::size() {
+    return entries.size() ;
+}
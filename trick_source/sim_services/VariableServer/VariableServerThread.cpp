@@ -23,6 +23,8 @@ Trick::VariableServerThread::VariableServerThread(TCDevice * in_listen_dev) :
     freeze_frame_multiple = 1 ;
     freeze_frame_offset = 0 ;
     binary_data = false;
+    binary_delta = false;
+    delta_schema_dirty = true;
     multicast = false;
     byteswap = false ;
 
@@ -52,6 +54,7 @@ Trick::VariableServerThread::VariableServerThread(TCDevice * in_listen_dev) :
     pthread_mutex_init(&restart_pause, NULL);
 
     var_data_staged = false;
+    snapshot_staged = false ;
     packets_copied = 0 ;
 
     incoming_msg = (char *) calloc(1, MAX_CMD_LEN);
@@ -60,6 +63,8 @@ Trick::VariableServerThread::VariableServerThread(TCDevice * in_listen_dev) :
 }
 
 Trick::VariableServerThread::~VariableServerThread() {
+    // Release this client's hold on the shared snapshot entries.
+    var_clear() ;
     free( incoming_msg ) ;
     free( stripped_msg ) ;
 }
@@ -84,7 +89,9 @@ std::ostream& Trick::operator<< (std::ostream& s, Trick::VariableServerThread& v
         s << "    \"client_port\":\"unknown\",";
     }
 
-    if (vst.binary_data) {
+    if (vst.binary_delta) {
+        s << "    \"format\":\"BINARY_DELTA\",\n";
+    } else if (vst.binary_data) {
         s << "    \"format\":\"BINARY\",\n";
     } else {
         s << "    \"format\":\"ASCII\",\n";
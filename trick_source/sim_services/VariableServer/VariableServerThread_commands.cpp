@@ -82,7 +82,15 @@ int Trick::VariableServerThread::var_add(std::string in_name) {
     }
 
     new_var = new VariableReference(new_ref) ;
+    // Time is per client, every other variable is copied once for all clients that add it.
+    if ( new_ref->address != (char *)&time ) {
+        new_var->shared = vs->get_snapshot().subscribe(new_var) ;
+    }
+
+    pthread_mutex_lock(&copy_mutex) ;
     vars.push_back(new_var) ;
+    delta_schema_dirty = true ;
+    pthread_mutex_unlock(&copy_mutex) ;
 
     return(0) ;
 }
@@ -96,14 +104,20 @@ int Trick::VariableServerThread::var_add(std::string var_name, std::string units
 int Trick::VariableServerThread::var_remove(std::string in_name) {
 
     unsigned int ii ;
+    pthread_mutex_lock(&copy_mutex) ;
     for ( ii = 0 ; ii < vars.size() ; ii++ ) {
         std::string var_name = vars[ii]->ref->reference;
         if ( ! var_name.compare(in_name) ) {
+            if ( vars[ii]->shared ) {
+                vs->get_snapshot().unsubscribe(vars[ii]->shared) ;
+            }
             delete vars[ii];
             vars.erase(vars.begin() + ii) ;
+            delta_schema_dirty = true ;
             break ;
         }
     }
+    pthread_mutex_unlock(&copy_mutex) ;
 
     return(0) ;
 
@@ -168,6 +182,10 @@ int Trick::VariableServerThread::var_units(std::string var_name, std::string uni
 
             cv_free(variable->conversion_factor);
             variable->conversion_factor = conversion_factor ;
+            // When sim terminate time is not defined, the related variable is the max of the type.
+            // The unit conversion calculation would throw a floating point exception, so the
+            // value of trick_sys.sched.terminate_time is never converted.
+            variable->needs_conversion = strcmp(variable->ref->reference, "trick_sys.sched.terminate_time") ;
             free(variable->ref->units);
             variable->ref->units = strdup(new_units.c_str());
         }
@@ -211,10 +229,16 @@ int Trick::VariableServerThread::var_exists(std::string in_name) {
 }
 
 int Trick::VariableServerThread::var_clear() {
+    pthread_mutex_lock(&copy_mutex) ;
     while( !vars.empty() ) {
+        if ( vars.back()->shared ) {
+            vs->get_snapshot().unsubscribe(vars.back()->shared) ;
+        }
         delete vars.back();
         vars.pop_back();
     }
+    delta_schema_dirty = true ;
+    pthread_mutex_unlock(&copy_mutex) ;
     return(0) ;
 }
 
@@ -255,17 +279,28 @@ int Trick::VariableServerThread::var_debug(int level) {
 
 int Trick::VariableServerThread::var_ascii() {
     binary_data = 0 ;
+    binary_delta = false ;
     return(0) ;
 }
 
 int Trick::VariableServerThread::var_binary() {
     binary_data = 1 ;
+    binary_delta = false ;
     return(0) ;
 }
 
 int Trick::VariableServerThread::var_binary_nonames() {
     binary_data = 1 ;
     binary_data_nonames = 1 ;
+    binary_delta = false ;
+    return(0) ;
+}
+
+int Trick::VariableServerThread::var_binary_delta() {
+    binary_data = 1 ;
+    binary_delta = true ;
+    // A new schema starts every delta session
+    delta_schema_dirty = true ;
     return(0) ;
 }
 
@@ -16,7 +16,7 @@ int Trick::VariableServerThread::copy_data_freeze() {
     if ( enabled and copy_mode == VS_COPY_TOP_OF_FRAME) {
         temp_frame = curr_frame % freeze_frame_multiple ;
         if ( temp_frame == freeze_frame_offset ) {
-            copy_sim_data() ;
+            copy_sim_data(true) ;
             if ( !pause_cmd and write_mode == VS_WRITE_WHEN_COPIED and is_real_time()) {
                 ret = write_data() ;
                 if ( ret < 0 ) {
@@ -34,7 +34,7 @@ int Trick::VariableServerThread::copy_data_freeze_scheduled(long long curr_tics)
 
     if ( enabled and copy_mode == VS_COPY_SCHEDULED) {
         if ( freeze_next_tics <= curr_tics ) {
-            copy_sim_data() ;
+            copy_sim_data(true) ;
             if ( !pause_cmd and write_mode == VS_WRITE_WHEN_COPIED and is_real_time()) {
                 ret = write_data() ;
                 if ( ret < 0 ) {
@@ -53,7 +53,7 @@ int Trick::VariableServerThread::copy_data_scheduled(long long curr_tics) {
 
     if ( enabled and copy_mode == VS_COPY_SCHEDULED) {
         if ( next_tics <= curr_tics ) {
-            copy_sim_data() ;
+            copy_sim_data(true) ;
             if ( !pause_cmd and write_mode == VS_WRITE_WHEN_COPIED and is_real_time()) {
                 ret = write_data() ;
                 if ( ret < 0 ) {
@@ -75,7 +75,7 @@ int Trick::VariableServerThread::copy_data_top() {
     if ( enabled and copy_mode == VS_COPY_TOP_OF_FRAME) {
         temp_frame = curr_frame % frame_multiple ;
         if ( temp_frame == frame_offset ) {
-            copy_sim_data() ;
+            copy_sim_data(true) ;
             if ( !pause_cmd and write_mode == VS_WRITE_WHEN_COPIED and is_real_time()) {
                 ret = write_data() ;
                 if ( ret < 0 ) {
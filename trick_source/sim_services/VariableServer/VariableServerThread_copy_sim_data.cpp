@@ -1,15 +1,92 @@
 
 #include <iostream>
+#include <stdlib.h>
 #include <string.h>
 
 #include "trick/VariableServer.hh"
 #include "trick/memorymanager_c_intf.h"
 #include "trick/exec_proto.h"
+#include "trick/TraceLog.hh"
 
-int Trick::VariableServerThread::copy_sim_data() {
+void Trick::VariableServerThread::copy_sim_variable( VariableReference * curr_var , bool in_validate ) {
+
+    // if this variable is unresolved, try to resolve it
+    if (curr_var->ref->address == &bad_ref_int) {
+        REF2 *new_ref = ref_attributes(const_cast<char*>(curr_var->ref->reference));
+        if (new_ref != NULL) {
+            VariableServerSnapshotEntry::free_ref(curr_var->ref) ;
+            curr_var->ref = new_ref;
+            curr_var->ascii_formatter = vs_ascii_formatter(curr_var) ;
+        }
+    }
+
+    // if there's a pointer somewhere in the address path, follow it in case pointer changed
+    if ( curr_var->ref->pointer_present == 1 ) {
+        curr_var->address = follow_address_path(curr_var->ref) ;
+        if (curr_var->address == NULL) {
+            std::string save_name(curr_var->ref->reference) ;
+            VariableServerSnapshotEntry::free_ref(curr_var->ref) ;
+            curr_var->ref = make_error_ref(save_name) ;
+            curr_var->address = curr_var->ref->address ;
+            curr_var->ascii_formatter = vs_ascii_formatter(curr_var) ;
+        } else if ( in_validate ) {
+            // The address is not NULL.
+            // If validation is on, check the memory manager if the address falls into
+            // any of the memory blocks it knows of.  Don't do this if we have a std::string or
+            // wstring type, or we already are pointing to a bad ref.
+            if ( (curr_var->string_type != TRICK_STRING) and
+                 (curr_var->string_type != TRICK_WSTRING) and
+                 (curr_var->ref->address != &bad_ref_int) and
+                 (get_alloc_info_of(curr_var->address) == NULL) ) {
+                std::string save_name(curr_var->ref->reference) ;
+                VariableServerSnapshotEntry::free_ref(curr_var->ref) ;
+                curr_var->ref = make_error_ref(save_name) ;
+                curr_var->address = curr_var->ref->address ;
+                curr_var->ascii_formatter = vs_ascii_formatter(curr_var) ;
+            }
+        } else {
+            curr_var->ref->address = curr_var->address ;
+        }
+
+    }
+
+    // if this variable is a string we need to get the raw character string out of it.
+    if (( curr_var->string_type == TRICK_STRING ) && !curr_var->need_deref) {
+        std::string * str_ptr = (std::string *)curr_var->ref->address ;
+        curr_var->address = (void *)(str_ptr->c_str()) ;
+    }
+
+    // if this variable itself is a pointer, dereference it
+    if ( curr_var->need_deref) {
+        curr_var->address = *(void**)curr_var->ref->address ;
+    }
+
+    // handle c++ string and char*
+    if ( curr_var->string_type == TRICK_STRING ) {
+        if (curr_var->address == NULL) {
+            curr_var->size = 0 ;
+        } else {
+            curr_var->size = strlen((char*)curr_var->address) + 1 ;
+        }
+    }
+    // handle c++ wstring and wchar_t*
+    if ( curr_var->string_type == TRICK_WSTRING ) {
+        if (curr_var->address == NULL) {
+            curr_var->size = 0 ;
+        } else {
+            curr_var->size = wcslen((wchar_t *)curr_var->address) * sizeof(wchar_t);
+        }
+    }
+    if(curr_var->address != NULL) {
+        memcpy( curr_var->buffer_in , curr_var->address , curr_var->size ) ;
+    }
+}
+
+int Trick::VariableServerThread::copy_sim_data( bool in_copy_cycle ) {
 
     unsigned int ii ;
     VariableReference * curr_var ;
+    bool any_shared = false ;
 
     if ( vars.size() == 0 ) {
         return 0 ;
@@ -17,83 +94,35 @@ int Trick::VariableServerThread::copy_sim_data() {
 
     if ( pthread_mutex_trylock(&copy_mutex) == 0 ) {
 
+        unsigned long long trace_start = Trick::TraceLog::start() ;
+
         // Get the simulation time we start this copy
         time = (double)exec_get_time_tics() / exec_get_time_tic_value() ;
 
         for ( ii = 0 ; ii < vars.size() ; ii++ ) {
             curr_var = vars[ii] ;
-
-            // if this variable is unresolved, try to resolve it
-            if (curr_var->ref->address == &bad_ref_int) {
-                REF2 *new_ref = ref_attributes(const_cast<char*>(curr_var->ref->reference));
-                if (new_ref != NULL) {
-                    curr_var->ref = new_ref;
-                }
-            }
-
-            // if there's a pointer somewhere in the address path, follow it in case pointer changed
-            if ( curr_var->ref->pointer_present == 1 ) {
-                curr_var->address = follow_address_path(curr_var->ref) ;
-                if (curr_var->address == NULL) {
-                    std::string save_name(curr_var->ref->reference) ;
-                    free(curr_var->ref) ;
-                    curr_var->ref = make_error_ref(save_name) ;
-                    curr_var->address = curr_var->ref->address ;
-                } else if ( validate_address ) {
-                    // The address is not NULL.
-                    // If validate_address is on, check the memory manager if the address falls into
-                    // any of the memory blocks it knows of.  Don't do this if we have a std::string or
-                    // wstring type, or we already are pointing to a bad ref.
-                    if ( (curr_var->string_type != TRICK_STRING) and
-                         (curr_var->string_type != TRICK_WSTRING) and
-                         (curr_var->ref->address != &bad_ref_int) and
-                         (get_alloc_info_of(curr_var->address) == NULL) ) {
-                        std::string save_name(curr_var->ref->reference) ;
-                        free(curr_var->ref) ;
-                        curr_var->ref = make_error_ref(save_name) ;
-                        curr_var->address = curr_var->ref->address ;
-                    }
-                } else {
-                    curr_var->ref->address = curr_var->address ;
+            // Copies outside of a copy cycle (async mode, var_send) always go to the sim.
+            if ( curr_var->shared == NULL or !in_copy_cycle ) {
+                copy_sim_variable(curr_var, validate_address) ;
+            } else {
+                if ( validate_address ) {
+                    curr_var->shared->validate_address = true ;
                 }
-
-            }
-
-            // if this variable is a string we need to get the raw character string out of it.
-            if (( curr_var->string_type == TRICK_STRING ) && !curr_var->need_deref) {
-                std::string * str_ptr = (std::string *)curr_var->ref->address ;
-                curr_var->address = (void *)(str_ptr->c_str()) ;
-            }
-
-            // if this variable itself is a pointer, dereference it
-            if ( curr_var->need_deref) {
-                curr_var->address = *(void**)curr_var->ref->address ;
+                any_shared = true ;
             }
+        }
 
-            // handle c++ string and char*
-            if ( curr_var->string_type == TRICK_STRING ) {
-                if (curr_var->address == NULL) {
-                    curr_var->size = 0 ;
-                } else {
-                    curr_var->size = strlen((char*)curr_var->address) + 1 ;
-                }
-            }
-            // handle c++ wstring and wchar_t*
-            if ( curr_var->string_type == TRICK_WSTRING ) {
-                if (curr_var->address == NULL) {
-                    curr_var->size = 0 ;
-                } else {
-                    curr_var->size = wcslen((wchar_t *)curr_var->address) * sizeof(wchar_t);
-                }
-            }
-            if(curr_var->address != NULL) {
-                memcpy( curr_var->buffer_in , curr_var->address , curr_var->size ) ;
-            }
+        // In a copy cycle the sim thread copies each shared variable once into the snapshot.  The shared
+        // variables are copied out of the snapshot when this client writes.
+        if ( any_shared ) {
+            vs->get_snapshot().refresh(this, time) ;
         }
+        snapshot_staged = any_shared ;
 
         // Indicate that sim data has been written and is now ready in the buffer_in's of the vars variable list.
         var_data_staged = true;
         packets_copied++ ;
+        Trick::TraceLog::complete("variable_server", "copy_sim_data", trace_start) ;
 
         pthread_mutex_unlock(&copy_mutex) ;
     }
@@ -103,3 +132,46 @@ int Trick::VariableServerThread::copy_sim_data() {
 
 }
 
+void Trick::VariableServerThread::copy_snapshot_data() {
+
+    unsigned int ii ;
+    unsigned int buffer ;
+    unsigned long long sequence ;
+    VariableReference * curr_var ;
+    VariableServerSnapshotEntry * entry ;
+    VariableServerSnapshot & snapshot = vs->get_snapshot() ;
+
+    buffer = snapshot.acquire() ;
+    sequence = snapshot.get_sequence(buffer) ;
+    for ( ii = 0 ; ii < vars.size() ; ii++ ) {
+        curr_var = vars[ii] ;
+        entry = curr_var->shared ;
+
+        if ( entry == NULL ) {
+            // Time is sent as the time the snapshot values were copied at.
+            if ( curr_var->ref->address == (char *)&time ) {
+                *(double *)curr_var->buffer_in = snapshot.get_time(buffer) ;
+            }
+            continue ;
+        }
+
+        // A new entry is copied from the next refresh, keep the last value until then.
+        if ( entry->value_sequences[buffer] != sequence ) {
+            continue ;
+        }
+
+        // The entry re-resolved or gave up on the variable, take a copy of its new reference.
+        // The client keeps the units it asked for.
+        if ( curr_var->shared_generation != entry->value_generations[buffer] ) {
+            REF2 * new_ref = VariableServerSnapshotEntry::copy_ref(entry->value_refs[buffer], curr_var->ref->units) ;
+            VariableServerSnapshotEntry::free_ref(curr_var->ref) ;
+            curr_var->ref = new_ref ;
+            curr_var->ascii_formatter = vs_ascii_formatter(curr_var) ;
+            curr_var->shared_generation = entry->value_generations[buffer] ;
+        }
+
+        curr_var->size = entry->value_sizes[buffer] ;
+        memcpy( curr_var->buffer_in , entry->values[buffer] , curr_var->size ) ;
+    }
+    snapshot.release(buffer) ;
+}
@@ -1,6 +1,15 @@
 
 #include <stdlib.h>
-#include "trick/VariableServerThread.hh"
+#include "trick/VariableServer.hh"
+
+void Trick::VariableServerThread::bad_ref_preload( VariableReference * var ) {
+    var->ref->address = (char*)&bad_ref_int;
+    var->ref->attr = new ATTRIBUTES() ;
+    var->ref->attr->type = TRICK_NUMBER_OF_TYPES ;
+    var->ref->attr->units = (char *)"--" ;
+    var->ref->attr->size = sizeof(int) ;
+    var->ascii_formatter = vs_ascii_formatter(var) ;
+}
 
 void Trick::VariableServerThread::preload_checkpoint() {
 
@@ -21,11 +30,7 @@ void Trick::VariableServerThread::preload_checkpoint() {
     // by tagging each as a "bad reference".
     std::vector <VariableReference *>::iterator it ;
     for (it = vars.begin(); it != vars.end() ; it++) {
-        (*it)->ref->address = (char*)&bad_ref_int;
-        (*it)->ref->attr = new ATTRIBUTES() ;
-        (*it)->ref->attr->type = TRICK_NUMBER_OF_TYPES ;
-        (*it)->ref->attr->units = (char *)"--" ;
-        (*it)->ref->attr->size = sizeof(int) ;
+        bad_ref_preload(*it) ;
     }
 
     // Allow data copying to continue.
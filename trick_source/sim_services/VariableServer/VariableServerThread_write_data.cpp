@@ -192,6 +192,11 @@ int Trick::VariableServerThread::write_data() {
     if ( var_data_staged and pthread_mutex_trylock(&copy_mutex) == 0 ) {
         unsigned int ii;
         void * temp_p;
+        // Shared variables are copied out of the snapshot here, off of the sim thread.
+        if ( snapshot_staged ) {
+            copy_snapshot_data() ;
+            snapshot_staged = false ;
+        }
         // Swap buffer_in and buffer_out for each vars[ii].
         for ( ii = 0 ; ii < vars.size() ; ii++ ) {
                           temp_p = vars[ii]->buffer_in;
@@ -203,7 +208,9 @@ int Trick::VariableServerThread::write_data() {
         /* Relinquish sole access to vars[ii]->buffer_in. */
         pthread_mutex_unlock(&copy_mutex) ;
 
-        if (binary_data) {
+        if (binary_delta) {
+            return write_delta_data() ;
+        } else if (binary_data) {
             int Index = 0;
             int PacketNumber = 0;
 
@@ -219,57 +226,54 @@ int Trick::VariableServerThread::write_data() {
 
         } else { /* ascii mode */
             char val[MAX_MSG_LEN];
+            int val_len ;
 
-            sprintf(buf1, "0\t") ;
+            // lengths are tracked so each value is copied once and the packet is never rescanned
+            strcpy(buf1, "0\t") ;
+            len = 2 ;
 
             for (i = 0; i < vars.size(); i++) {
 
-                ret = vs_format_ascii( vars[i] , val);
+                /* leave room in a packet by itself for the value, the next tab or newline, and a null */
+                val_len = vs_format_ascii( vars[i] , val, sizeof(val) - 1 );
 
-                if (ret < 0) {
+                if (val_len < 0) {
                     message_publish(MSG_WARNING, "%p Variable Server string buffer[%d] too small for symbol %s, TRUNCATED IT.\n",
                                     &connection, MAX_MSG_LEN, vars[i]->ref->reference );
+                    val_len = strlen(val) ;
                 }
 
-                /* make sure this message will fit in a packet by itself */
-                if( strlen( val ) + 2 > MAX_MSG_LEN ) {
-                    message_publish(MSG_WARNING, "%p Variable Server buffer[%d] too small for symbol %s, TRUNCATED IT.\n",
-                                    &connection, MAX_MSG_LEN, vars[i]->ref->reference );
-                    val[MAX_MSG_LEN - 1] = '\0';
-                }
-
-                len = strlen(buf1) ;
-
                 /* make sure there is space for the next tab or next newline and null */
-                if( len + strlen( val ) + 2 > MAX_MSG_LEN ) {
+                if( len + val_len + 2 > MAX_MSG_LEN ) {
 
                     if (debug >= 2) {
+                        buf1[len] = '\0' ;
                         message_publish(MSG_DEBUG, "%p tag=<%s> var_server sending %d ascii bytes:\n%s\n",
-                                        &connection, connection.client_tag, (int)strlen(buf1), buf1) ;
+                                        &connection, connection.client_tag, len, buf1) ;
                     }
 
                     ret = tc_write(&connection, (char *) buf1, len);
                     if ( ret != len ) {
                         return(-1) ;
                     }
-                    buf1[0] = '\0';
+                    len = 0 ;
                 }
 
-                strcat(buf1, val);
-                strcat(buf1, "\t");
+                memcpy(buf1 + len, val, val_len) ;
+                len += val_len ;
+                buf1[len++] = '\t' ;
             }
 
-            len = strlen(buf1) ;
-
             if ( len > 0 ) {
-                buf1[ strlen(buf1) - 1 ] = '\n';
+                buf1[len - 1] = '\n';
+                buf1[len] = '\0' ;
 
                 if (debug >= 2) {
                     message_publish(MSG_DEBUG, "%p tag=<%s> var_server sending %d ascii bytes:\n%s\n",
-                                    &connection, connection.client_tag, (int)strlen(buf1), buf1) ;
+                                    &connection, connection.client_tag, len, buf1) ;
                 }
-                ret = tc_write(&connection, (char *) buf1, (int)strlen(buf1));
-                if ( ret != (int)strlen(buf1) ) {
+                ret = tc_write(&connection, (char *) buf1, len);
+                if ( ret != len ) {
                     return(-1) ;
                 }
             }
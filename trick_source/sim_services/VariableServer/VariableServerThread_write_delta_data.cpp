@@ -0,0 +1,200 @@
+/*
+PURPOSE:      (Write changed variable values to the client in the binary delta format)
+*/
+
+#include <string.h>
+#include "trick/VariableServer.hh"
+#include "trick/variable_server_message_types.h"
+#include "trick/parameter_types.h"
+#include "trick/bitfield_proto.h"
+#include "trick/trick_byteswap.h"
+#include "trick/tc_proto.h"
+#include "trick/message_proto.h"
+#include "trick/message_type.h"
+
+void Trick::VariableServerThread::delta_append_int( int value ) {
+    if (byteswap) {
+        value = trick_byteswap_int(value) ;
+    }
+    delta_buffer.append((char *)&value, sizeof(value)) ;
+}
+
+/**
+@details
+-# Start the message with the message type, a placeholder for the message size, and the variable count
+-# Return the offset of the message in #delta_buffer
+*/
+unsigned int Trick::VariableServerThread::delta_start_message( int msg_type , int count ) {
+    unsigned int msg_start = delta_buffer.size() ;
+    delta_append_int(msg_type) ;
+    delta_append_int(0) ;
+    delta_append_int(count) ;
+    return msg_start ;
+}
+
+/**
+@details
+-# Fill in the size of the message started at msg_start, not counting the message type.
+*/
+void Trick::VariableServerThread::delta_end_message( unsigned int msg_start ) {
+    int msg_size = delta_buffer.size() - msg_start - sizeof(int) ;
+    if (byteswap) {
+        msg_size = trick_byteswap_int(msg_size) ;
+    }
+    memcpy(&delta_buffer[msg_start + sizeof(int)], &msg_size, sizeof(msg_size)) ;
+}
+
+/**
+@details
+-# Reverse the bytes of each element_size element in the size bytes at buffer.  A partial element at
+   the end is left alone.
+*/
+static void delta_swap_elements( char * buffer , int size , int element_size ) {
+    char temp ;
+    int ii , jj ;
+    if ( element_size < 2 ) {
+        return ;
+    }
+    for ( ii = 0 ; ii + element_size <= size ; ii += element_size ) {
+        for ( jj = 0 ; jj < element_size / 2 ; jj++ ) {
+            temp = buffer[ii + jj] ;
+            buffer[ii + jj] = buffer[ii + element_size - 1 - jj] ;
+            buffer[ii + element_size - 1 - jj] = temp ;
+        }
+    }
+}
+
+/**
+@details
+-# Append the value of vars[ii] from its buffer_out to #delta_buffer, extracting bitfields as var_binary
+   does.
+-# If byteswap is on, swap the bytes of each element of the value.  var->size bounds the swap, the
+   value may be one element or a slice of a larger array.  Strings are not swapped, wide strings are
+   swapped by character.
+*/
+void Trick::VariableServerThread::delta_append_value( unsigned int ii ) {
+
+    VariableReference * var = vars[ii] ;
+    unsigned int offset = delta_buffer.size() ;
+    int element_size ;
+    int temp_i ;
+    unsigned int temp_ui ;
+
+    delta_buffer.resize(offset + var->size) ;
+    switch ( var->ref->attr->type ) {
+        case TRICK_BITFIELD:
+            temp_i = GET_BITFIELD(var->buffer_out , var->ref->attr->size ,
+              var->ref->attr->index[0].start, var->ref->attr->index[0].size) ;
+            memcpy(&delta_buffer[offset] , &temp_i , (size_t)var->size) ;
+            element_size = sizeof(temp_i) ;
+        break ;
+        case TRICK_UNSIGNED_BITFIELD:
+            temp_ui = GET_UNSIGNED_BITFIELD(var->buffer_out , var->ref->attr->size ,
+              var->ref->attr->index[0].start, var->ref->attr->index[0].size) ;
+            memcpy(&delta_buffer[offset] , &temp_ui , (size_t)var->size) ;
+            element_size = sizeof(temp_ui) ;
+        break ;
+        case TRICK_NUMBER_OF_TYPES:
+            // TRICK_NUMBER_OF_TYPES is an error case
+            memset(&delta_buffer[offset] , 0 , (size_t)var->size) ;
+            element_size = 0 ;
+        break ;
+        default:
+            memcpy(&delta_buffer[offset] , var->buffer_out , (size_t)var->size) ;
+            if ( var->string_type == TRICK_STRING ) {
+                element_size = 0 ;
+            } else if ( var->string_type == TRICK_WSTRING ) {
+                element_size = sizeof(wchar_t) ;
+            } else {
+                element_size = var->ref->attr->size ;
+            }
+        break ;
+    }
+    if (byteswap) {
+        delta_swap_elements(&delta_buffer[offset] , var->size , element_size) ;
+    }
+}
+
+/**
+@details
+-# If the variable list or a variable's type changed since the last schema was sent
+   -# Append a VS_VAR_SCHEMA message that gives each variable an id, its index in the list, and its
+      name, type, and size
+   -# Forget the last values sent so every value is sent in the next delta
+-# Append a VS_VAR_DELTA message holding the id, size, and value of each variable whose value changed
+   since it was last sent
+-# Write the messages to the client with one call.  There is no limit on the message size.
+*/
+int Trick::VariableServerThread::write_delta_data() {
+
+    unsigned int ii ;
+    unsigned int msg_start ;
+    unsigned int len ;
+    int num_changed ;
+    int ret ;
+
+    delta_buffer.clear() ;
+
+    if ( delta_types.size() != vars.size() ) {
+        delta_schema_dirty = true ;
+    } else {
+        for ( ii = 0 ; ii < vars.size() ; ii++ ) {
+            if ( vars[ii]->ref->attr->type != delta_types[ii] ) {
+                delta_schema_dirty = true ;
+                break ;
+            }
+        }
+    }
+
+    if ( delta_schema_dirty ) {
+        delta_types.resize(vars.size()) ;
+        delta_last_values.assign(vars.size(), std::string()) ;
+        delta_sent.assign(vars.size(), false) ;
+
+        msg_start = delta_start_message(VS_VAR_SCHEMA, vars.size()) ;
+        for ( ii = 0 ; ii < vars.size() ; ii++ ) {
+            len = strlen(vars[ii]->ref->reference) ;
+            delta_append_int(ii) ;
+            delta_append_int(len) ;
+            delta_buffer.append(vars[ii]->ref->reference, len) ;
+            delta_append_int(vars[ii]->ref->attr->type) ;
+            delta_append_int(vars[ii]->size) ;
+            delta_types[ii] = vars[ii]->ref->attr->type ;
+        }
+        delta_end_message(msg_start) ;
+        delta_schema_dirty = false ;
+    }
+
+    msg_start = delta_start_message(VS_VAR_DELTA, 0) ;
+    num_changed = 0 ;
+    for ( ii = 0 ; ii < vars.size() ; ii++ ) {
+        std::string & last = delta_last_values[ii] ;
+        if ( delta_sent[ii] and last.size() == (unsigned int)vars[ii]->size and
+             !memcmp(last.data(), vars[ii]->buffer_out, vars[ii]->size) ) {
+            continue ;
+        }
+        last.assign((char *)vars[ii]->buffer_out, vars[ii]->size) ;
+        delta_sent[ii] = true ;
+
+        delta_append_int(ii) ;
+        delta_append_int(vars[ii]->size) ;
+        delta_append_value(ii) ;
+        num_changed++ ;
+    }
+    if (byteswap) {
+        num_changed = trick_byteswap_int(num_changed) ;
+    }
+    memcpy(&delta_buffer[msg_start + 2 * sizeof(int)], &num_changed, sizeof(num_changed)) ;
+    delta_end_message(msg_start) ;
+
+    if (debug >= 2) {
+        message_publish(MSG_DEBUG, "%p tag=<%s> var_server sending %u binary delta bytes.\n", &connection,
+                connection.client_tag, (unsigned int)delta_buffer.size());
+    }
+
+    ret = tc_write(&connection, &delta_buffer[0], delta_buffer.size()) ;
+    if ( ret != (int)delta_buffer.size() ) {
+        return(-1) ;
+    }
+    return(0) ;
+}
@@ -13,6 +13,8 @@ int Trick::VariableServer::copy_data_scheduled() {
 
     next_call_tics = TRICK_MAX_LONG_LONG ;
 
+    // Every client copying in this job shares one copy of each variable.
+    snapshot.start_cycle() ;
     pthread_mutex_lock(&map_mutex) ;
     for ( it = var_server_threads.begin() ; it != var_server_threads.end() ; it++ ) {
         vst = (*it).second ;
@@ -8,6 +8,8 @@ int Trick::VariableServer::copy_data_top() {
 
     std::map < pthread_t , VariableServerThread * >::iterator it ;
 
+    // Every client copying in this job shares one copy of each variable.
+    snapshot.start_cycle() ;
     pthread_mutex_lock(&map_mutex) ;
     for ( it = var_server_threads.begin() ; it != var_server_threads.end() ; it++ ) {
         (*it).second->copy_data_top() ;
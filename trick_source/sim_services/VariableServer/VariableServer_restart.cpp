@@ -34,6 +34,9 @@ int Trick::VariableServer::suspendPreCheckpointReload() {
     }
     pthread_mutex_unlock(&map_mutex) ;
 
+    // The shared snapshot entries are tagged too, so they resolve again after the reload.
+    snapshot.preload_checkpoint() ;
+
     return 0;
 }
 
@@ -0,0 +1,173 @@
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#define protected public
+#include "trick/VariableServer.hh"
+#include "trick/variable_server_message_types.h"
+#include "trick/trick_byteswap.h"
+#include "trick/MemoryManager.hh"
+
+namespace Trick {
+
+class VariableServerDeltaTest : public ::testing::Test {
+
+    protected:
+        Trick::MemoryManager * memmgr ;
+        Trick::VariableServer * vs ;
+        Trick::VariableServerThread * client ;
+        double * position ;
+        int * counts ;
+        double * guard ;
+        unsigned int read_offset ;
+        unsigned int msg_end ;
+
+        VariableServerDeltaTest() {}
+        ~VariableServerDeltaTest() {}
+
+        virtual void SetUp() {
+            int dims[1] = { 4 } ;
+            memmgr = new Trick::MemoryManager ;
+            vs = new Trick::VariableServer ;
+            Trick::VariableServerThread::set_vs_ptr(vs) ;
+            position = (double *)memmgr->declare_var(TRICK_DOUBLE, "", 0, "position", 1, dims) ;
+            counts = (int *)memmgr->declare_var(TRICK_INTEGER, "", 0, "counts", 1, dims) ;
+            guard = (double *)memmgr->declare_var(TRICK_DOUBLE, "", 0, "guard", 0, NULL) ;
+            for ( unsigned int ii = 0 ; ii < 4 ; ii++ ) {
+                position[ii] = ii + 0.5 ;
+                counts[ii] = ii + 1 ;
+            }
+            *guard = 7.0 ;
+            client = new Trick::VariableServerThread(NULL) ;
+            // Build the messages in delta_buffer without writing them anywhere
+            client->connection.disabled = TC_COMM_TRUE ;
+            client->var_binary_delta() ;
+        }
+
+        virtual void TearDown() {
+            delete client ;
+            delete vs ;
+            delete memmgr ;
+        }
+
+        /* Send the variables and start reading the messages built */
+        void send() {
+            client->var_send() ;
+            read_offset = 0 ;
+        }
+
+        int read_int() {
+            int value ;
+            memcpy(&value, &client->delta_buffer[read_offset], sizeof(value)) ;
+            read_offset += sizeof(value) ;
+            return client->byteswap ? trick_byteswap_int(value) : value ;
+        }
+
+        std::string read_bytes( unsigned int len ) {
+            std::string value = client->delta_buffer.substr(read_offset, len) ;
+            read_offset += len ;
+            return value ;
+        }
+
+        /* Read a message header, returning the variable count */
+        int read_header( int msg_type ) {
+            EXPECT_EQ( read_int() , msg_type ) ;
+            // the size does not count the message type
+            msg_end = read_offset ;
+            msg_end += read_int() ;
+            return read_int() ;
+        }
+
+        /* Check the entries read filled the message exactly */
+        void end_message() {
+            EXPECT_EQ( read_offset , msg_end ) ;
+        }
+
+        void read_schema_entry( int id , const char * name , int type , int size ) {
+            EXPECT_EQ( read_int() , id ) ;
+            int len = read_int() ;
+            EXPECT_EQ( read_bytes(len) , std::string(name) ) ;
+            EXPECT_EQ( read_int() , type ) ;
+            EXPECT_EQ( read_int() , size ) ;
+        }
+
+        /* Read a changed value, reversing the bytes of each element_size element when byteswap is on */
+        std::string read_value( int id , int size , int element_size ) {
+            EXPECT_EQ( read_int() , id ) ;
+            EXPECT_EQ( read_int() , size ) ;
+            std::string value = read_bytes(size) ;
+            if ( client->byteswap ) {
+                for ( int ii = 0 ; ii < size ; ii += element_size ) {
+                    std::reverse(value.begin() + ii, value.begin() + ii + element_size) ;
+                }
+            }
+            return value ;
+        }
+} ;
+
+TEST_F( VariableServerDeltaTest , SchemaThenChangedValues ) {
+
+    client->var_add("position[2]") ;
+    client->var_add("counts") ;
+
+    // The first message gives the schema, then every value
+    send() ;
+    ASSERT_EQ( read_header(VS_VAR_SCHEMA) , 2 ) ;
+    read_schema_entry(0, "position[2]", TRICK_DOUBLE, sizeof(double)) ;
+    read_schema_entry(1, "counts", TRICK_INTEGER, 4 * sizeof(int)) ;
+    end_message() ;
+    ASSERT_EQ( read_header(VS_VAR_DELTA) , 2 ) ;
+    EXPECT_EQ( read_value(0, sizeof(double), sizeof(double)) , std::string((char *)&position[2], sizeof(double)) ) ;
+    EXPECT_EQ( read_value(1, 4 * sizeof(int), sizeof(int)) , std::string((char *)counts, 4 * sizeof(int)) ) ;
+    end_message() ;
+    EXPECT_EQ( read_offset , client->delta_buffer.size() ) ;
+
+    // Nothing changed, an empty delta and no schema
+    send() ;
+    ASSERT_EQ( read_header(VS_VAR_DELTA) , 0 ) ;
+    end_message() ;
+    EXPECT_EQ( read_offset , client->delta_buffer.size() ) ;
+
+    // Only the changed value is sent
+    counts[3] = 10 ;
+    send() ;
+    ASSERT_EQ( read_header(VS_VAR_DELTA) , 1 ) ;
+    EXPECT_EQ( read_value(1, 4 * sizeof(int), sizeof(int)) , std::string((char *)counts, 4 * sizeof(int)) ) ;
+    end_message() ;
+
+    // A new variable sends a new schema and every value again
+    client->var_add("guard") ;
+    send() ;
+    ASSERT_EQ( read_header(VS_VAR_SCHEMA) , 3 ) ;
+    read_schema_entry(0, "position[2]", TRICK_DOUBLE, sizeof(double)) ;
+    read_schema_entry(1, "counts", TRICK_INTEGER, 4 * sizeof(int)) ;
+    read_schema_entry(2, "guard", TRICK_DOUBLE, sizeof(double)) ;
+    end_message() ;
+    ASSERT_EQ( read_header(VS_VAR_DELTA) , 3 ) ;
+}
+
+TEST_F( VariableServerDeltaTest , ByteswapEachElement ) {
+
+    client->var_byteswap(true) ;
+    client->var_add("position[2]") ;
+    client->var_add("counts") ;
+    client->var_add("guard") ;
+
+    // An element of an array is swapped alone, a whole array one element at a time
+    send() ;
+    ASSERT_EQ( read_header(VS_VAR_SCHEMA) , 3 ) ;
+    read_schema_entry(0, "position[2]", TRICK_DOUBLE, sizeof(double)) ;
+    read_schema_entry(1, "counts", TRICK_INTEGER, 4 * sizeof(int)) ;
+    read_schema_entry(2, "guard", TRICK_DOUBLE, sizeof(double)) ;
+    end_message() ;
+    ASSERT_EQ( read_header(VS_VAR_DELTA) , 3 ) ;
+    EXPECT_EQ( read_value(0, sizeof(double), sizeof(double)) , std::string((char *)&position[2], sizeof(double)) ) ;
+    EXPECT_EQ( read_value(1, 4 * sizeof(int), sizeof(int)) , std::string((char *)counts, 4 * sizeof(int)) ) ;
+    EXPECT_EQ( read_value(2, sizeof(double), sizeof(double)) , std::string((char *)guard, sizeof(double)) ) ;
+    end_message() ;
+    EXPECT_EQ( read_offset , client->delta_buffer.size() ) ;
+}
+
+}
@@ -0,0 +1,298 @@
+
+#include <string.h>
+#include <stdlib.h>
+
+#include "gtest/gtest.h"
+#define protected public
+#include "trick/VariableServer.hh"
+#include "trick/VariableServerSnapshot.hh"
+#include "trick/MemoryManager.hh"
+
+namespace Trick {
+
+class VariableServerSnapshotTest : public ::testing::Test {
+
+    protected:
+        Trick::MemoryManager * memmgr ;
+        Trick::VariableServer * vs ;
+        double * position ;
+        ATTRIBUTES attr_double ;
+
+        VariableServerSnapshotTest() {}
+        ~VariableServerSnapshotTest() {}
+
+        virtual void SetUp() {
+            memmgr = new Trick::MemoryManager ;
+            vs = new Trick::VariableServer ;
+            Trick::VariableServerThread::set_vs_ptr(vs) ;
+            position = (double *)memmgr->declare_var(TRICK_DOUBLE, "", 0, "position", 0, NULL) ;
+            *position = 1.0 ;
+            memset(&attr_double, 0, sizeof(ATTRIBUTES)) ;
+            attr_double.type = TRICK_DOUBLE ;
+            attr_double.size = sizeof(double) ;
+        }
+
+        virtual void TearDown() {
+            delete vs ;
+            delete memmgr ;
+        }
+
+        /* A client variable made the way var_add makes it, with its own reference name */
+        VariableReference * make_var( const char * name , double * address ) {
+            REF2 * ref = (REF2 *)calloc(1, sizeof(REF2)) ;
+            ref->reference = strdup(name) ;
+            ref->address = address ;
+            ref->attr = &attr_double ;
+            return new VariableReference(ref) ;
+        }
+
+        double value_of( VariableServerThread & vst , unsigned int index ) {
+            return *(double *)vst.vars[index]->buffer_in ;
+        }
+} ;
+
+TEST_F( VariableServerSnapshotTest , ClientsShareOneEntry ) {
+
+    VariableServerSnapshot & snapshot = vs->get_snapshot() ;
+    VariableReference * var_a = make_var("position", position) ;
+    VariableReference * var_b = make_var("position", position) ;
+
+    VariableServerSnapshotEntry * entry_a = snapshot.subscribe(var_a) ;
+    VariableServerSnapshotEntry * entry_b = snapshot.subscribe(var_b) ;
+    ASSERT_TRUE( entry_a != NULL ) ;
+    EXPECT_EQ( entry_a , entry_b ) ;
+    EXPECT_EQ( entry_a->num_clients , 2u ) ;
+    EXPECT_EQ( snapshot.size() , 1u ) ;
+
+    snapshot.unsubscribe(entry_a) ;
+    EXPECT_EQ( entry_b->num_clients , 1u ) ;
+    EXPECT_EQ( snapshot.size() , 1u ) ;
+    snapshot.unsubscribe(entry_b) ;
+    EXPECT_EQ( snapshot.size() , 0u ) ;
+
+    delete var_a ;
+    delete var_b ;
+}
+
+TEST_F( VariableServerSnapshotTest , DifferentSizesAreNotShared ) {
+
+    VariableServerSnapshot & snapshot = vs->get_snapshot() ;
+    VariableReference * var_a = make_var("position", position) ;
+    VariableReference * var_b = make_var("position", position) ;
+    var_b->size = sizeof(double) * 2 ;
+
+    VariableServerSnapshotEntry * entry_a = snapshot.subscribe(var_a) ;
+    EXPECT_TRUE( entry_a != NULL ) ;
+    EXPECT_TRUE( snapshot.subscribe(var_b) == NULL ) ;
+    EXPECT_EQ( entry_a->num_clients , 1u ) ;
+
+    snapshot.unsubscribe(entry_a) ;
+    delete var_a ;
+    delete var_b ;
+}
+
+TEST_F( VariableServerSnapshotTest , EntryOutlivesFirstClient ) {
+
+    VariableServerSnapshot & snapshot = vs->get_snapshot() ;
+    VariableReference * var_a = make_var("position", position) ;
+    VariableReference * var_b = make_var("position", position) ;
+
+    VariableServerSnapshotEntry * entry = snapshot.subscribe(var_a) ;
+    snapshot.subscribe(var_b) ;
+
+    // the entry has its own copy of the name, and no units
+    EXPECT_NE( entry->source->ref->reference , var_a->ref->reference ) ;
+    EXPECT_TRUE( entry->source->ref->units == NULL ) ;
+
+    // the first client goes away and its reference is released
+    snapshot.unsubscribe(entry) ;
+    memset(var_a->ref->reference, 'x', strlen(var_a->ref->reference)) ;
+    free(var_a->ref->reference) ;
+    delete var_a ;
+
+    EXPECT_STREQ( entry->source->ref->reference , "position" ) ;
+    EXPECT_EQ( entry->num_clients , 1u ) ;
+
+    snapshot.unsubscribe(entry) ;
+    delete var_b ;
+}
+
+TEST_F( VariableServerSnapshotTest , CopyRefKeepsClientUnits ) {
+
+    VariableReference * var = make_var("position", position) ;
+    char * units = strdup("ft") ;
+
+    REF2 * copy = VariableServerSnapshotEntry::copy_ref(var->ref, units) ;
+    EXPECT_STREQ( copy->reference , "position" ) ;
+    EXPECT_NE( copy->reference , var->ref->reference ) ;
+    EXPECT_EQ( copy->units , units ) ;
+    EXPECT_EQ( copy->attr , var->ref->attr ) ;
+    EXPECT_EQ( copy->address , var->ref->address ) ;
+
+    free(copy->reference) ;
+    free(copy->units) ;
+    free(copy) ;
+    delete var ;
+}
+
+TEST_F( VariableServerSnapshotTest , CopiesOncePerCycle ) {
+
+    VariableServerThread client_a(NULL) ;
+    VariableServerThread client_b(NULL) ;
+    VariableServerSnapshot & snapshot = vs->get_snapshot() ;
+
+    client_a.var_add("position") ;
+    client_b.var_add("position") ;
+    ASSERT_EQ( snapshot.size() , 1u ) ;
+
+    // In a copy cycle, the first client refreshes the snapshot from the sim and the second does not
+    snapshot.start_cycle() ;
+    *position = 2.0 ;
+    client_a.copy_sim_data(true) ;
+    *position = 3.0 ;
+    client_b.copy_sim_data(true) ;
+    EXPECT_TRUE( client_a.snapshot_staged ) ;
+    EXPECT_TRUE( client_b.snapshot_staged ) ;
+
+    // Clients copy the shared values out of the snapshot when they write
+    client_a.copy_snapshot_data() ;
+    client_b.copy_snapshot_data() ;
+    EXPECT_EQ( value_of(client_a, 0) , 2.0 ) ;
+    EXPECT_EQ( value_of(client_b, 0) , 2.0 ) ;
+
+    // The next cycle copies from the sim again
+    snapshot.start_cycle() ;
+    client_b.copy_sim_data(true) ;
+    client_a.copy_sim_data(true) ;
+    client_a.copy_snapshot_data() ;
+    client_b.copy_snapshot_data() ;
+    EXPECT_EQ( value_of(client_a, 0) , 3.0 ) ;
+    EXPECT_EQ( value_of(client_b, 0) , 3.0 ) ;
+
+    // Copies outside a copy cycle always go to the sim
+    *position = 4.0 ;
+    client_a.copy_sim_data(false) ;
+    EXPECT_FALSE( client_a.snapshot_staged ) ;
+    EXPECT_EQ( value_of(client_a, 0) , 4.0 ) ;
+
+    // The entry stays until its last client removes the variable
+    client_a.var_clear() ;
+    EXPECT_EQ( snapshot.size() , 1u ) ;
+    snapshot.start_cycle() ;
+    *position = 5.0 ;
+    client_b.copy_sim_data(true) ;
+    client_b.copy_snapshot_data() ;
+    EXPECT_EQ( value_of(client_b, 0) , 5.0 ) ;
+    client_b.var_remove("position") ;
+    EXPECT_EQ( snapshot.size() , 0u ) ;
+}
+
+TEST_F( VariableServerSnapshotTest , ReadBufferIsNotOverwritten ) {
+
+    VariableServerThread client(NULL) ;
+    VariableServerSnapshot & snapshot = vs->get_snapshot() ;
+
+    client.var_add("position") ;
+    VariableServerSnapshotEntry * entry = client.vars[0]->shared ;
+
+    snapshot.start_cycle() ;
+    *position = 2.0 ;
+    client.copy_sim_data(true) ;
+
+    // A client holds the published buffer while the sim fills and publishes the other one
+    unsigned int held = snapshot.acquire() ;
+    EXPECT_EQ( *(double *)entry->values[held] , 2.0 ) ;
+    snapshot.start_cycle() ;
+    *position = 3.0 ;
+    client.copy_sim_data(true) ;
+    EXPECT_EQ( snapshot.acquire() , 1u - held ) ;
+    snapshot.release(1u - held) ;
+
+    // The held buffer is next to be filled, the sim skips the cycle instead of waiting
+    snapshot.start_cycle() ;
+    *position = 4.0 ;
+    client.copy_sim_data(true) ;
+    EXPECT_EQ( snapshot.get_cycles_skipped() , 1u ) ;
+    EXPECT_EQ( *(double *)entry->values[held] , 2.0 ) ;
+    client.copy_snapshot_data() ;
+    EXPECT_EQ( value_of(client, 0) , 3.0 ) ;
+
+    // Once released the buffer is filled again
+    snapshot.release(held) ;
+    snapshot.start_cycle() ;
+    client.copy_sim_data(true) ;
+    EXPECT_EQ( snapshot.get_cycles_skipped() , 1u ) ;
+    client.copy_snapshot_data() ;
+    EXPECT_EQ( value_of(client, 0) , 4.0 ) ;
+}
+
+TEST_F( VariableServerSnapshotTest , NewReferenceKeepsClientUnits ) {
+
+    VariableServerThread client_a(NULL) ;
+    VariableServerThread client_b(NULL) ;
+    VariableServerSnapshot & snapshot = vs->get_snapshot() ;
+
+    client_a.var_add("position") ;
+    client_b.var_add("position") ;
+    client_b.vars[0]->ref->units = strdup("ft") ;
+
+    // The entry replaced its reference.  Each client takes its own copy and keeps its units.
+    VariableServerSnapshotEntry * entry = client_a.vars[0]->shared ;
+    entry->ref_generation++ ;
+    snapshot.start_cycle() ;
+    client_a.copy_sim_data(true) ;
+    client_a.copy_snapshot_data() ;
+    client_b.copy_snapshot_data() ;
+
+    EXPECT_NE( client_a.vars[0]->ref->reference , entry->source->ref->reference ) ;
+    EXPECT_NE( client_b.vars[0]->ref->reference , entry->source->ref->reference ) ;
+    EXPECT_STREQ( client_b.vars[0]->ref->reference , "position" ) ;
+    ASSERT_TRUE( client_b.vars[0]->ref->units != NULL ) ;
+    EXPECT_STREQ( client_b.vars[0]->ref->units , "ft" ) ;
+    EXPECT_EQ( client_b.vars[0]->shared_generation , entry->ref_generation ) ;
+}
+
+
+TEST_F( VariableServerSnapshotTest , ReplacedReferenceIsFormattedByItsType ) {
+
+    VariableServerThread client(NULL) ;
+    VariableServerSnapshot & snapshot = vs->get_snapshot() ;
+    char value[64] ;
+
+    client.var_add("position") ;
+    snapshot.start_cycle() ;
+    client.copy_sim_data(true) ;
+    client.copy_snapshot_data() ;
+    memcpy(client.vars[0]->buffer_out, client.vars[0]->buffer_in, client.vars[0]->size) ;
+    vs_format_ascii(client.vars[0], value, sizeof(value)) ;
+    EXPECT_STREQ( value , "1" ) ;
+
+    // The entry gave up on the variable.  The client's new reference is sent as a bad reference.
+    VariableServerSnapshotEntry * entry = client.vars[0]->shared ;
+    REF2 * error_ref = client.make_error_ref("position") ;
+    error_ref->address = (char *)&VariableServerThread::do_not_resolve_bad_ref_int ;
+    VariableServerSnapshotEntry::free_ref(entry->source->ref) ;
+    entry->source->ref = error_ref ;
+    entry->source->address = error_ref->address ;
+    entry->source->size = error_ref->attr->size ;
+    entry->ref_generation++ ;
+    snapshot.start_cycle() ;
+    client.copy_sim_data(true) ;
+    client.copy_snapshot_data() ;
+    vs_format_ascii(client.vars[0], value, sizeof(value)) ;
+    EXPECT_STREQ( value , "BAD_REF" ) ;
+}
+
+TEST_F( VariableServerSnapshotTest , ReloadedReferenceIsFormattedAsBadRef ) {
+
+    VariableServerThread client(NULL) ;
+    char value[64] ;
+
+    client.var_add("position") ;
+    client.preload_checkpoint() ;
+    vs_format_ascii(client.vars[0], value, sizeof(value)) ;
+    EXPECT_STREQ( value , "BAD_REF" ) ;
+    client.restart() ;
+}
+
+}
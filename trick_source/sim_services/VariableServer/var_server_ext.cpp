@@ -166,6 +166,15 @@ int var_binary_nonames() {
     return(0) ;
 }
 
+int var_binary_delta() {
+    Trick::VariableServerThread * vst ;
+    vst = get_vst() ;
+    if (vst != NULL ) {
+        vst->var_binary_delta() ;
+    }
+    return(0) ;
+}
+
 int var_set_copy_mode(int mode) {
     Trick::VariableServerThread * vst ;
     vst = get_vst() ;
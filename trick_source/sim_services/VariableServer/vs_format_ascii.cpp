@@ -4,10 +4,12 @@ PROGRAMMERS: (((Keith Vetter) (LinCom) (September 2001) (--)))
 */
 
 #include <iostream>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <limits>
+#include <math.h>
 #include <udunits2.h>
 
 #include "trick/parameter_types.h"
@@ -17,229 +19,289 @@ PROGRAMMERS: (((Keith Vetter) (LinCom) (September 2001) (--)))
 #include "trick/VariableServer.hh"
 #include "trick/TrickConstant.hh"
 
-/* PROTO */
-size_t escape_str(const char *in_s, char *out_s);
-
-#define MAX_VAL_STRLEN 2048
-
-int vs_format_ascii(Trick::VariableReference * var, char *value) {
+/*
+   Each formatter writes every element of a variable's buffer_out at out, separated by commas, and
+   advances out past what it wrote.  It never writes at or past end.  If the value does not fit it
+   writes what does and returns false.  One is chosen for each variable by vs_ascii_formatter when
+   the variable is added, and again whenever its reference is replaced or marked bad.
+ */
 
-    /* for string types, return -1 if string is too big to fit in buffer (MAX_VAL_STRLEN) */
-    REF2 * ref ;
-    ref = var->ref ;
-    std::string var_name = ref->reference;
+/* Write an unsigned integer without the printf machinery. */
+static bool append_unsigned( char *& out , char * end , unsigned long long value ) {
+    char digits[24] ;
+    int num_digits = 0 ;
+    do {
+        digits[num_digits++] = '0' + (char)(value % 10) ;
+        value /= 10 ;
+    } while ( value != 0 ) ;
+    if ( end - out < num_digits ) {
+        return false ;
+    }
+    while ( num_digits > 0 ) {
+        *out++ = digits[--num_digits] ;
+    }
+    return true ;
+}
 
-    // handle returning an array
-    int size = 0 ;
-    value[0] = '\0' ;
-    // data to send was copied to buffer in copy_sim_data
-    void * buf_ptr = var->buffer_out ;
-    while (size < var->size) {
-        size += var->ref->attr->size ;
+static bool append_signed( char *& out , char * end , long long value ) {
+    if ( value < 0 ) {
+        char * start = out ;
+        if ( out >= end ) {
+            return false ;
+        }
+        *out++ = '-' ;
+        if ( ! append_unsigned(out, end, 0ULL - (unsigned long long)value) ) {
+            out = start ;
+            return false ;
+        }
+        return true ;
+    }
+    return append_unsigned(out, end, (unsigned long long)value) ;
+}
 
-        switch (ref->attr->type) {
+/* Write text, or as much of it as fits. */
+static bool append_text( char *& out , char * end , const char * text , size_t len ) {
+    bool fits = ( (size_t)(end - out) >= len ) ;
+    if ( ! fits ) {
+        len = end - out ;
+    }
+    memcpy(out, text, len) ;
+    out += len ;
+    return fits ;
+}
 
-        case TRICK_CHARACTER:
-            if (ref->attr->num_index == ref->num_index) {
-                sprintf(value, "%s%d", value,(char)cv_convert_double(var->conversion_factor, *(char *)buf_ptr));
-            } else {
-                /* All but last dim specified, leaves a char array */
-                escape_str((char *) buf_ptr, value);
-                size = var->size ;
-            }
-            break;
-        case TRICK_UNSIGNED_CHARACTER:
-            if (ref->attr->num_index == ref->num_index) {
-                sprintf(value, "%s%u", value,(unsigned char)cv_convert_double(var->conversion_factor,*(unsigned char *)buf_ptr));
-            } else {
-                /* All but last dim specified, leaves a char array */
-                escape_str((char *) buf_ptr, value);
-                size = var->size ;
-            }
-            break;
-
-        case TRICK_WCHAR:{
-                if (ref->attr->num_index == ref->num_index) {
-                    sprintf(value, "%s%d", value,*(wchar_t *) buf_ptr);
-                } else {
-                    // convert wide char string char string
-                    size_t len = wcs_to_ncs_len((wchar_t *)buf_ptr) + 1 ;
-                    if (len > MAX_VAL_STRLEN) {
-                        return (-1);
-                    }
-                    wcs_to_ncs((wchar_t *) buf_ptr, value, len);
-                    size = var->size ;
-                }
+/* Elements of type T printed as the integer type P, converted if var_units asked for it. */
+template < typename T , typename P >
+static bool format_integers( Trick::VariableReference * var , char *& out , char * end ) {
+    T * element = (T *)var->buffer_out ;
+    int count = var->size / sizeof(T) ;
+    for ( int ii = 0 ; ii < count ; ii++ ) {
+        P value ;
+        if ( var->needs_conversion ) {
+            value = (P)(T)cv_convert_double(var->conversion_factor, element[ii]) ;
+        } else {
+            value = (P)element[ii] ;
+        }
+        if ( ii > 0 and ! append_text(out, end, ",", 1) ) {
+            return false ;
+        }
+        if ( std::numeric_limits<P>::is_signed ) {
+            if ( ! append_signed(out, end, (long long)value) ) {
+                return false ;
             }
-            break;
+        } else if ( ! append_unsigned(out, end, (unsigned long long)value) ) {
+            return false ;
+        }
+    }
+    return true ;
+}
 
-        case TRICK_STRING:
-            if ((char *) buf_ptr != NULL) {
-                escape_str((char *) buf_ptr, value);
-                size = var->size ;
-            } else {
-                value[0] = '\0';
+/*
+   %.<precision>g prints a whole number smaller than 10^precision as its digits, so those skip snprintf.
+   -0 keeps its sign.
+ */
+template < typename T >
+static bool format_floats( Trick::VariableReference * var , char *& out , char * end , const char * format , double integer_limit ) {
+    T * element = (T *)var->buffer_out ;
+    int count = var->size / sizeof(T) ;
+    for ( int ii = 0 ; ii < count ; ii++ ) {
+        double value = var->needs_conversion ? cv_convert_double(var->conversion_factor, element[ii]) : element[ii] ;
+        if ( ii > 0 and ! append_text(out, end, ",", 1) ) {
+            return false ;
+        }
+        if ( value > -integer_limit and value < integer_limit and value == (double)(long long)value and
+             ( value != 0.0 or ! signbit(value) ) ) {
+            if ( ! append_signed(out, end, (long long)value) ) {
+                return false ;
             }
-            break;
+            continue ;
+        }
+        int len = snprintf(out, end - out + 1, format, value) ;
+        if ( len < 0 or len > end - out ) {
+            return false ;
+        }
+        out += len ;
+    }
+    return true ;
+}
 
-        case TRICK_WSTRING:
-            if ((wchar_t *) buf_ptr != NULL) {
-                // convert wide char string char string
-                size_t len = wcs_to_ncs_len((wchar_t *)buf_ptr) + 1 ;
-                if (len > MAX_VAL_STRLEN) {
-                    return (-1);
-                }
-                wcs_to_ncs((wchar_t *) buf_ptr, value, len);
-                size = var->size ;
-            } else {
-                value[0] = '\0';
+static bool format_float( Trick::VariableReference * var , char *& out , char * end ) {
+    return format_floats<float>(var, out, end, "%.8g", 1.0e8) ;
+}
+
+static bool format_double( Trick::VariableReference * var , char *& out , char * end ) {
+    return format_floats<double>(var, out, end, "%.16g", 1.0e16) ;
+}
+
+/* A char array holding a string, with the non printable characters escaped. */
+static bool format_char_string( Trick::VariableReference * var , char *& out , char * end ) {
+    const char * in = (const char *)var->buffer_out ;
+    for ( ; *in != '\0' ; in++ ) {
+        int ch = (unsigned char)*in ;
+        char work_s[6];
+        size_t len = 2 ;
+
+        if (isprint(ch)) {
+            if ( out >= end ) {
+                return false ;
             }
-            break;
+            *out++ = ch ;
+            continue ;
+        }
+        if (ch == '\a') {
+            memcpy(work_s, "\\a", 2) ;
+        } else if (ch == '\b') {
+            memcpy(work_s, "\\b", 2) ;
+        } else if (ch == '\f') {
+            memcpy(work_s, "\\f", 2) ;
+        } else if (ch == '\n') {
+            memcpy(work_s, "\\n", 2) ;
+        } else if (ch == '\r') {
+            memcpy(work_s, "\\n", 2) ;
+        } else if (ch == '\t') {
+            memcpy(work_s, "\\t", 2) ;
+        } else if (ch == '\v') {
+            memcpy(work_s, "\\v", 2) ;
+        } else {
+            len = sprintf(work_s, "\\x%02x", ch) ;
+        }
+        if ( (size_t)(end - out) < len ) {
+            return false ;
+        }
+        memcpy(out, work_s, len) ;
+        out += len ;
+    }
+    return true ;
+}
+
+/* A wide char array holding a string, converted to a char string. */
+static bool format_wchar_string( Trick::VariableReference * var , char *& out , char * end ) {
+    wchar_t * value = (wchar_t *)var->buffer_out ;
+    size_t len = wcs_to_ncs_len(value) + 1 ;
+    if ( len > (size_t)(end - out) + 1 ) {
+        return false ;
+    }
+    wcs_to_ncs(value, out, len) ;
+    out += strlen(out) ;
+    return true ;
+}
 
+static bool format_wchars( Trick::VariableReference * var , char *& out , char * end ) {
+    wchar_t * element = (wchar_t *)var->buffer_out ;
+    int count = var->size / sizeof(wchar_t) ;
+    for ( int ii = 0 ; ii < count ; ii++ ) {
+        if ( ii > 0 and ! append_text(out, end, ",", 1) ) {
+            return false ;
+        }
+        if ( ! append_signed(out, end, element[ii]) ) {
+            return false ;
+        }
+    }
+    return true ;
+}
+
+static bool format_bitfield( Trick::VariableReference * var , char *& out , char * end ) {
+    ATTRIBUTES * attr = var->ref->attr ;
+    return append_signed(out, end, GET_BITFIELD(var->buffer_out, attr->size, attr->index[0].start, attr->index[0].size)) ;
+}
+
+static bool format_unsigned_bitfield( Trick::VariableReference * var , char *& out , char * end ) {
+    ATTRIBUTES * attr = var->ref->attr ;
+    return append_unsigned(out, end, GET_UNSIGNED_BITFIELD(var->buffer_out, attr->size, attr->index[0].start, attr->index[0].size)) ;
+}
+
+static bool format_bad_ref( Trick::VariableReference * , char *& out , char * end ) {
+    return append_text(out, end, "BAD_REF", 7) ;
+}
+
+/**
+ * Choose the formatter for a variable from its type.  Returns NULL for types ascii mode cannot send.
+ */
+Trick::VariableReference::AsciiFormatter vs_ascii_formatter(Trick::VariableReference * var) {
+
+    REF2 * ref = var->ref ;
+    bool whole_array = ( ref->attr->num_index != ref->num_index ) ;
+
+    switch (ref->attr->type) {
+        case TRICK_CHARACTER:
+            /* All but last dim specified leaves a char array */
+            return whole_array ? format_char_string : format_integers<char, int> ;
+        case TRICK_UNSIGNED_CHARACTER:
+            return whole_array ? format_char_string : format_integers<unsigned char, unsigned int> ;
+        case TRICK_WCHAR:
+            return whole_array ? format_wchar_string : format_wchars ;
+        case TRICK_STRING:
+            return format_char_string ;
+        case TRICK_WSTRING:
+            return format_wchar_string ;
 #if ( __linux | __sgi )
         case TRICK_BOOLEAN:
-            sprintf(value, "%s%d", value,(unsigned char)cv_convert_double(var->conversion_factor,*(unsigned char *)buf_ptr));
-            break;
+            return format_integers<unsigned char, int> ;
 #endif
-
         case TRICK_SHORT:
-            sprintf(value, "%s%d", value, (short)cv_convert_double(var->conversion_factor,*(short *)buf_ptr));
-            break;
-
+            return format_integers<short, int> ;
         case TRICK_UNSIGNED_SHORT:
-            sprintf(value, "%s%u", value,(unsigned short)cv_convert_double(var->conversion_factor,*(unsigned short *)buf_ptr));
-            break;
-
+            return format_integers<unsigned short, unsigned int> ;
         case TRICK_INTEGER:
         case TRICK_ENUMERATED:
 #if ( __sun | __APPLE__ )
         case TRICK_BOOLEAN:
 #endif
-            sprintf(value, "%s%d", value, (int)cv_convert_double(var->conversion_factor,*(int *)buf_ptr));
-            break;
-
+            return format_integers<int, int> ;
         case TRICK_BITFIELD:
-            sprintf(value, "%d", GET_BITFIELD(buf_ptr, ref->attr->size, ref->attr->index[0].start, ref->attr->index[0].size));
-            break;
-
+            return format_bitfield ;
         case TRICK_UNSIGNED_BITFIELD:
-            sprintf(value, "%u", GET_UNSIGNED_BITFIELD(buf_ptr, ref->attr->size, ref->attr->index[0].start, ref->attr->index[0].size));
-            break;
+            return format_unsigned_bitfield ;
         case TRICK_UNSIGNED_INTEGER:
-            sprintf(value, "%s%u", value, (unsigned int)cv_convert_double(var->conversion_factor,*(unsigned int *)buf_ptr));
-            break;
-
+            return format_integers<unsigned int, unsigned int> ;
         case TRICK_LONG:
-            sprintf(value, "%s%ld", value, (long)cv_convert_double(var->conversion_factor,*(long *)buf_ptr));
-            break;
-
+            return format_integers<long, long> ;
         case TRICK_UNSIGNED_LONG:
-            sprintf(value, "%s%lu", value, (unsigned long)cv_convert_double(var->conversion_factor,*(unsigned long *)buf_ptr));
-            break;
-
+            return format_integers<unsigned long, unsigned long> ;
         case TRICK_FLOAT:
-            sprintf(value, "%s%.8g", value, cv_convert_float(var->conversion_factor,*(float *)buf_ptr));
-            break;
-
+            return format_float ;
         case TRICK_DOUBLE:
-            sprintf(value, "%s%.16g", value, cv_convert_double(var->conversion_factor,*(double *)buf_ptr));
-            break;
-
+            return format_double ;
         case TRICK_LONG_LONG:
-            // This is a work-round for when terminate_time is not defined and is requested through variable server.
-            // When sim terminate time is not defined, the related variable is the max of the type.
-            // The unit conversion calculation will throw floating point exception.
-            // For trick_sys.sched.terminate_time, there is no need to perform such conversion.
-            if (!var_name.compare("trick_sys.sched.terminate_time")) {
-                    sprintf(value, "%s%lld", value, *(long long *)buf_ptr);
-            } else {
-                    sprintf(value, "%s%lld", value, (long long)cv_convert_double(var->conversion_factor,*(long long *)buf_ptr));
-            }
-            break;
-
+            return format_integers<long long, long long> ;
         case TRICK_UNSIGNED_LONG_LONG:
-            sprintf(value, "%s%llu", value,(unsigned long long)cv_convert_double(var->conversion_factor,*(unsigned long long *)buf_ptr));
-            break;
-
+            return format_integers<unsigned long long, unsigned long long> ;
         case TRICK_NUMBER_OF_TYPES:
-            sprintf(value, "BAD_REF" );
-            break;
-
-        default:{
-                return (-1);
-            }
-        } // end switch
-
-        if (size < var->size) {
-        // if returning an array, continue array as comma separated values
-            strcat(value, ",") ;
-            buf_ptr = (void*) ((long)buf_ptr + var->ref->attr->size) ;
-        }
-    } //end while
-
-    if (ref->units) {
-        if ( ref->attr->mods & TRICK_MODS_UNITSDASHDASH ) {
-            sprintf(value, "%s {--}", value);
-        } else {
-            sprintf(value, "%s {%s}", value, ref->units);
-        }
+            return format_bad_ref ;
+        default:
+            return NULL ;
     }
-
-    return (0);
 }
 
-
 /**
- * Escape all of the non printable characters in a string.
+ * Format a variable's value and units into value, which holds value_size bytes.
+ * Returns the length of the text, or -1 if the variable cannot be sent or was truncated to fit.
  */
-size_t escape_str(const char *in_s, char *out_s)
-{
-    size_t i, in_len, out_len;
-    if (in_s == NULL) {
-        out_s[0] = '\0';
-        return 0;
-    }
-    in_len = strlen(in_s);
-    out_len = 0;
-    if (out_s != NULL) {
-        out_s[0] = '\0';
+int vs_format_ascii(Trick::VariableReference * var, char *value, size_t value_size) {
+
+    char * out = value ;
+    /* leave room for the terminating null */
+    char * end = value + value_size - 1 ;
+    REF2 * ref = var->ref ;
+    bool fits ;
+
+    if ( var->ascii_formatter == NULL ) {
+        value[0] = '\0' ;
+        return (-1);
     }
-    for (i = 0; i < in_len; i++) {
-        int ch = in_s[i];
-        char work_s[6];
+    // data to send was copied to buffer in copy_sim_data
+    fits = var->ascii_formatter(var, out, end) ;
 
-        if (isprint(ch)) {
-            work_s[0] = ch;
-            work_s[1] = '\0';
+    if (fits and ref->units) {
+        if ( ref->attr->mods & TRICK_MODS_UNITSDASHDASH ) {
+            fits = append_text(out, end, " {--}", 5) ;
         } else {
-            if (ch == '\a') {
-                sprintf(work_s, "\\a");
-            } else if (ch == '\b') {
-                sprintf(work_s, "\\b");
-            } else if (ch == '\f') {
-                sprintf(work_s, "\\f");
-            } else if (ch == '\n') {
-                sprintf(work_s, "\\n");
-            } else if (ch == '\r') {
-                sprintf(work_s, "\\n");
-            } else if (ch == '\t') {
-                sprintf(work_s, "\\t");
-            } else if (ch == '\v') {
-                sprintf(work_s, "\\v");
-            } else {
-                sprintf(work_s, "\\x%02x", ch);
-            }
-        }
-        out_len += strlen(work_s);
-        if (out_s != NULL) {
-            if (out_len < MAX_VAL_STRLEN) {
-                strcat(out_s, work_s);
-            } else {
-                // indicate string is truncated because it's too big
-                return -1;
-            }
+            fits = append_text(out, end, " {", 2) and
+                   append_text(out, end, ref->units, strlen(ref->units)) and
+                   append_text(out, end, "}", 1) ;
         }
     }
+    *out = '\0' ;
 
-    return (out_len);
+    return fits ? (int)(out - value) : -1 ;
 }
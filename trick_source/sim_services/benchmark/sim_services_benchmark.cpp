@@ -0,0 +1,223 @@
+
+/*
+   Timings of sim_services code paths against the code they replaced.  These are kept out of the unit
+   tests, which only check results.  Run every benchmark, or only the ones named on the command line:
+
+   sim_services_benchmark [name ...]
+*/
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "trick/DataRecordGroup.hh"
+#include "trick/CommandLineArguments.hh"
+#include "trick/ScheduledJobQueue.hh"
+
+/* Seconds from start to now. */
+static double seconds_since( const struct timeval & start ) {
+    struct timeval end ;
+    gettimeofday(&end, NULL) ;
+    return (end.tv_sec - start.tv_sec) + (end.tv_usec - start.tv_usec) / 1000000.0 ;
+}
+
+/* A data record group that records to memory only. */
+class DRMemory : public Trick::DataRecordGroup {
+    public:
+        DRMemory() : Trick::DataRecordGroup("DRMemory_benchmark") {}
+        virtual int format_specific_header(std::fstream &) { return 0 ; }
+        virtual int format_specific_init() { return 0 ; }
+        virtual int format_specific_write_data(unsigned int) { return 0 ; }
+        virtual int format_specific_shutdown() { return 0 ; }
+} ;
+
+/* data_record's copy plans against the per variable copy they replaced. */
+static void copy_plan() {
+
+    DRMemory drg ;
+    const unsigned int num_vars = 20000 ;
+    const unsigned int num_records = 1000 ;
+    std::vector< double > values(num_vars) ;
+    ATTRIBUTES attr_double ;
+    struct timeval start ;
+    unsigned int ii , jj ;
+
+    memset(&attr_double, 0, sizeof(ATTRIBUTES)) ;
+    attr_double.type = TRICK_DOUBLE ;
+    attr_double.size = sizeof(double) ;
+    attr_double.units = (char *)"1" ;
+    for ( ii = 0 ; ii < num_vars ; ii++ ) {
+        std::ostringstream oss ;
+        oss << "v" << ii ;
+        REF2 * ref = (REF2 *)calloc(1 , sizeof(REF2)) ;
+        ref->reference = strdup(oss.str().c_str()) ;
+        ref->address = &values[ii] ;
+        ref->attr = &attr_double ;
+        drg.add_variable(ref) ;
+    }
+    drg.set_max_buffer_size(num_records) ;
+    drg.set_buffer_type(Trick::DR_Ring_Buffer) ;
+    drg.init() ;
+
+    // The per variable copy data_record used before copy plans
+    gettimeofday(&start, NULL) ;
+    for ( jj = 0 ; jj < num_records ; jj++ ) {
+        for ( ii = 0 ; ii < drg.rec_buffer.size() ; ii++ ) {
+            Trick::DataRecordBuffer * drb = drg.rec_buffer[ii] ;
+            REF2 * ref = drb->ref ;
+            int param_size = ref->attr->size ;
+            char * curr_buffer = drb->buffer + jj * param_size ;
+            switch ( param_size ) {
+                case 8: *(int64_t *)curr_buffer = *(int64_t *)ref->address ; break ;
+                case 4: *(int32_t *)curr_buffer = *(int32_t *)ref->address ; break ;
+                case 2: *(int16_t *)curr_buffer = *(int16_t *)ref->address ; break ;
+                case 1: *(int8_t *)curr_buffer = *(int8_t *)ref->address ; break ;
+                default: memcpy( curr_buffer , ref->address , param_size ) ; break ;
+            }
+        }
+    }
+    std::cout << num_vars << " doubles, " << num_records << " records, per variable: "
+              << seconds_since(start) << " s" << std::endl ;
+
+    gettimeofday(&start, NULL) ;
+    for ( jj = 0 ; jj < num_records ; jj++ ) {
+        drg.data_record(jj * 0.001) ;
+    }
+    std::cout << num_vars << " doubles, " << num_records << " records, copy plan: "
+              << seconds_since(start) << " s" << std::endl ;
+
+    unlink("./log_DRMemory_benchmark.header") ;
+}
+
+/* Fills queue with num_jobs jobs spread across sim objects.  Out of every 100 jobs 1 cycles
+   at 1000 Hz, 9 at 100 Hz, 30 at 10 Hz, and 60 at 1 Hz. */
+static void add_mixed_rate_jobs( Trick::ScheduledJobQueue & queue , unsigned int num_jobs ) {
+    for ( unsigned int ii = 0 ; ii < num_jobs ; ii++ ) {
+        std::ostringstream oss ;
+        long long cycle_tics ;
+        if ( ii % 100 < 1 ) {
+            cycle_tics = 1000 ;
+        } else if ( ii % 100 < 10 ) {
+            cycle_tics = 10000 ;
+        } else if ( ii % 100 < 40 ) {
+            cycle_tics = 100000 ;
+        } else {
+            cycle_tics = 1000000 ;
+        }
+        oss << "job_" << ii ;
+        Trick::JobData * job_ptr = new Trick::JobData(0, ii % 10 , "class_100", NULL,
+         cycle_tics / 1000000.0 , oss.str()) ;
+        job_ptr->sim_object_id = ii / 10 ;
+        job_ptr->job_class = 100 + (ii % 3) ;
+        job_ptr->cycle_tics = cycle_tics ;
+        job_ptr->stop_tics = 1000000000 ;
+        queue.push(job_ptr) ;
+    }
+}
+
+/* find_next_job over a calendar queue against the linear scan of every job. */
+static void calendar() {
+
+    Trick::ScheduledJobQueue linear_queue ;
+    Trick::ScheduledJobQueue calendar_queue ;
+    Trick::ScheduledJobQueue * queues[2] = { &linear_queue , &calendar_queue } ;
+    const char * names[2] = { "linear" , "calendar" } ;
+    Trick::JobData * job_ptr ;
+    struct timeval start ;
+
+    add_mixed_rate_jobs(linear_queue , 4000) ;
+    add_mixed_rate_jobs(calendar_queue , 4000) ;
+    calendar_queue.set_calendar(true) ;
+
+    for ( unsigned int ii = 0 ; ii < 2 ; ii++ ) {
+        long long curr_time = 0 ;
+        unsigned int num_called = 0 ;
+        gettimeofday(&start, NULL) ;
+        for ( unsigned int jj = 0 ; jj < 10000 ; jj++ ) {
+            queues[ii]->reset_curr_index() ;
+            queues[ii]->set_next_job_call_time(1000000000) ;
+            while ( (job_ptr = queues[ii]->find_next_job(curr_time)) != NULL ) {
+                num_called++ ;
+            }
+            curr_time = queues[ii]->get_next_job_call_time() ;
+        }
+        std::cout << "4000 mixed rate jobs, 10000 passes, " << names[ii] << ": "
+                  << seconds_since(start) << " s, " << num_called << " calls" << std::endl ;
+    }
+}
+
+/* Building a queue with batch_push and batch_commit against one push per job. */
+static void batch() {
+
+    Trick::ScheduledJobQueue push_queue ;
+    Trick::ScheduledJobQueue batch_queue ;
+    std::vector< Trick::JobData * > jobs ;
+    struct timeval start ;
+    Trick::JobData * job_ptr ;
+
+    // 50000 jobs from 5000 sim_objects added in sim_object order, like Executive::add_sim_object
+    for ( unsigned int ii = 0 ; ii < 50000 ; ii++ ) {
+        job_ptr = new Trick::JobData(0, ii % 10 , "class_100", NULL, 1.0 , "job") ;
+        job_ptr->sim_object_id = ii / 10 ;
+        job_ptr->job_class = 100 + (ii % 5) ;
+        jobs.push_back(job_ptr) ;
+    }
+
+    gettimeofday(&start, NULL) ;
+    for ( unsigned int ii = 0 ; ii < jobs.size() ; ii++ ) {
+        push_queue.push(jobs[ii]) ;
+    }
+    std::cout << "50000 jobs, push: " << seconds_since(start) << " s" << std::endl ;
+
+    gettimeofday(&start, NULL) ;
+    for ( unsigned int ii = 0 ; ii < jobs.size() ; ii++ ) {
+        batch_queue.batch_push(jobs[ii]) ;
+    }
+    batch_queue.batch_commit() ;
+    std::cout << "50000 jobs, batch: " << seconds_since(start) << " s" << std::endl ;
+}
+
+static const struct {
+    const char * name ;
+    void (*run)() ;
+} benchmarks[] = {
+    { "copy_plan" , copy_plan } ,
+    { "calendar" , calendar } ,
+    { "batch" , batch } ,
+} ;
+
+int main( int argc , char * argv[] ) {
+
+    const unsigned int num_benchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]) ;
+    std::vector< bool > selected(num_benchmarks, argc < 2) ;
+
+    for ( int ii = 1 ; ii < argc ; ii++ ) {
+        unsigned int jj = 0 ;
+        while ( jj < num_benchmarks and strcmp(argv[ii], benchmarks[jj].name) ) {
+            jj++ ;
+        }
+        if ( jj == num_benchmarks ) {
+            std::cerr << "unknown benchmark " << argv[ii] << ", choose from:" ;
+            for ( jj = 0 ; jj < num_benchmarks ; jj++ ) {
+                std::cerr << " " << benchmarks[jj].name ;
+            }
+            std::cerr << std::endl ;
+            return 1 ;
+        }
+        selected[jj] = true ;
+    }
+
+    // The data record groups write their headers to the output directory
+    Trick::CommandLineArguments cmd ;
+    for ( unsigned int ii = 0 ; ii < num_benchmarks ; ii++ ) {
+        if ( selected[ii] ) {
+            benchmarks[ii].run() ;
+        }
+    }
+    return 0 ;
+}
@@ -46,6 +46,7 @@
 #include "trick/command_line_protos.h"
 #include "trick/DRAscii.hh"
 #include "trick/DRBinary.hh"
+#include "trick/DRCompressed.hh"
 #ifdef HDF5
 #include "trick/DRHDF5.hh"
 #endif
@@ -59,6 +60,10 @@
 #include "trick/debug_pause_proto.h"
 #include "trick/EchoJobs.hh"
 #include "trick/echojobs_proto.h"
+#include "trick/JobProfiler.hh"
+#include "trick/job_profiler_proto.h"
+#include "trick/TraceLog.hh"
+#include "trick/trace_log_proto.h"
 #include "trick/Environment.hh"
 #include "trick/env_proto.h"
 #include "trick/Executive.hh"
@@ -127,6 +132,7 @@
 #include "trick/message_proto.h"
 #include "trick/MonteCarlo.hh"
 #include "trick/montecarlo_c_intf.h"
+#include "trick/MonteResult.hh"
 #include "trick/MonteVarCalculated.hh"
 #include "trick/MonteVarFile.hh"
 #include "trick/MonteVarFixed.hh"